@@ -36,6 +36,16 @@
 #endif
 
 
+// Use SSE2 / AVX2 (selected at runtime) to search for delimiters in split_full and split_any
+#ifndef IM_STR_USE_SIMD
+	#if defined( __x86_64__ ) || defined( _M_X64 )
+		#define IM_STR_USE_SIMD 1
+	#else
+		#define IM_STR_USE_SIMD 0
+	#endif
+#endif
+
+
 #ifndef IM_STR_USE_CUSTOM_DYN_ARRAY
 	#define IM_STR_USE_CUSTOM_DYN_ARRAY	1
 #else
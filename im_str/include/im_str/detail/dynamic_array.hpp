@@ -1,8 +1,10 @@
 #ifndef IM_STR_DYNAMIC_ARRAY_HPP
 #define IM_STR_DYNAMIC_ARRAY_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 
 namespace mba::_detail_im_str {
@@ -0,0 +1,217 @@
+#ifndef IM_STR_FIND_DELIMITERS_HPP
+#define IM_STR_FIND_DELIMITERS_HPP
+
+#include "./config.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if IM_STR_USE_SIMD
+#include <immintrin.h>
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#include <intrin.h>
+#endif
+#endif
+
+// clang-format off
+#if IM_STR_USE_SIMD && ( defined( __GNUC__ ) || defined( __clang__ ) )
+	#define IM_STR_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#else
+	#define IM_STR_TARGET_AVX2
+#endif
+// clang-format on
+
+namespace mba::_detail_im_str {
+
+/**
+ * Single pass search for delimiters (used by im_str::split_full and im_str::split_any)
+ *
+ * The SIMD versions compare 16 (SSE2) or 32 (AVX2) characters at once against each delimiter and
+ * turn the result into a bitmask, whose set bits are the positions of the delimiters in that block.
+ * Which version is used is determined at runtime (see active_simd_isa).
+ */
+enum class simd_isa { scalar, sse2, avx2 };
+
+inline simd_isa detect_simd_isa() noexcept
+{
+#if IM_STR_USE_SIMD
+#if defined( _MSC_VER ) && !defined( __clang__ )
+	int info[4];
+	__cpuid( info, 0 );
+	if( info[0] < 7 ) { return simd_isa::sse2; }
+
+	// the os also has to save the ymm registers on a context switch
+	__cpuid( info, 1 );
+	const bool has_avx = ( info[2] & ( 1 << 27 ) ) && ( info[2] & ( 1 << 28 ) ) && ( ( _xgetbv( 0 ) & 0x6 ) == 0x6 );
+	__cpuidex( info, 7, 0 );
+	return has_avx && ( info[1] & ( 1 << 5 ) ) ? simd_isa::avx2 : simd_isa::sse2;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" ) ? simd_isa::avx2 : simd_isa::sse2;
+#endif
+#else
+	return simd_isa::scalar;
+#endif
+}
+
+/**
+ * The instruction set used by for_each_delimiter.
+ * Can be set to a less capable one (e.g. to compare the implementations in a benchmark)
+ */
+inline std::atomic<simd_isa>& active_simd_isa() noexcept
+{
+	static std::atomic<simd_isa> isa{ detect_simd_isa() };
+	return isa;
+}
+
+// more delimiters are handled by the scalar version (one comparison per delimiter and block doesn't pay off)
+constexpr std::size_t max_simd_delimiters = 8;
+
+/**
+ * Stores the first positions in a local buffer, so most strings can be split without an additional allocation
+ */
+class delimiter_positions {
+public:
+	void push_back( std::size_t pos )
+	{
+		if( _size < local_capacity ) {
+			_local[_size] = pos;
+		} else {
+			_overflow.push_back( pos );
+		}
+		++_size;
+	}
+
+	std::size_t size() const noexcept { return _size; }
+
+	std::size_t operator[]( std::size_t i ) const noexcept
+	{
+		return i < local_capacity ? _local[i] : _overflow[i - local_capacity];
+	}
+
+private:
+	static constexpr std::size_t local_capacity = 128;
+
+	std::size_t              _size = 0;
+	std::size_t              _local[local_capacity];
+	std::vector<std::size_t> _overflow;
+};
+
+namespace _simd {
+
+inline int count_trailing_zeros( std::uint32_t mask ) noexcept
+{
+#if defined( _MSC_VER ) && !defined( __clang__ )
+	unsigned long idx;
+	_BitScanForward( &idx, mask );
+	return static_cast<int>( idx );
+#else
+	return __builtin_ctz( mask );
+#endif
+}
+
+template<class F>
+void report_matches( std::uint32_t mask, std::size_t block_start, F& f )
+{
+	while( mask != 0 ) {
+		f( block_start + count_trailing_zeros( mask ) );
+		mask &= mask - 1; // clear lowest set bit
+	}
+}
+
+template<class F>
+void scan_scalar( std::string_view str, std::size_t start, std::string_view delims, F& f )
+{
+	if( delims.size() == 1 ) {
+		// find usually boils down to memchr
+		for( auto pos = str.find( delims[0], start ); pos != std::string_view::npos; pos = str.find( delims[0], pos + 1 ) ) {
+			f( pos );
+		}
+		return;
+	}
+
+	bool is_delim[256] = {};
+	for( const char c : delims ) {
+		is_delim[static_cast<unsigned char>( c )] = true;
+	}
+	for( std::size_t i = start; i < str.size(); ++i ) {
+		if( is_delim[static_cast<unsigned char>( str[i] )] ) { f( i ); }
+	}
+}
+
+#if IM_STR_USE_SIMD
+
+// returns the position up to which str has been scanned (the remainder is smaller than a block)
+template<class F>
+std::size_t scan_sse2( std::string_view str, std::string_view delims, F& f )
+{
+	__m128i needles[max_simd_delimiters];
+	for( std::size_t k = 0; k < delims.size(); ++k ) {
+		needles[k] = _mm_set1_epi8( delims[k] );
+	}
+
+	std::size_t i = 0;
+	for( ; i + 16 <= str.size(); i += 16 ) {
+		const __m128i block = _mm_loadu_si128( reinterpret_cast<const __m128i*>( str.data() + i ) );
+
+		__m128i matches = _mm_cmpeq_epi8( block, needles[0] );
+		for( std::size_t k = 1; k < delims.size(); ++k ) {
+			matches = _mm_or_si128( matches, _mm_cmpeq_epi8( block, needles[k] ) );
+		}
+		report_matches( static_cast<std::uint32_t>( _mm_movemask_epi8( matches ) ), i, f );
+	}
+	return i;
+}
+
+template<class F>
+IM_STR_TARGET_AVX2 std::size_t scan_avx2( std::string_view str, std::string_view delims, F& f )
+{
+	__m256i needles[max_simd_delimiters];
+	for( std::size_t k = 0; k < delims.size(); ++k ) {
+		needles[k] = _mm256_set1_epi8( delims[k] );
+	}
+
+	std::size_t i = 0;
+	for( ; i + 32 <= str.size(); i += 32 ) {
+		const __m256i block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( str.data() + i ) );
+
+		__m256i matches = _mm256_cmpeq_epi8( block, needles[0] );
+		for( std::size_t k = 1; k < delims.size(); ++k ) {
+			matches = _mm256_or_si256( matches, _mm256_cmpeq_epi8( block, needles[k] ) );
+		}
+		report_matches( static_cast<std::uint32_t>( _mm256_movemask_epi8( matches ) ), i, f );
+	}
+	return i;
+}
+
+#endif // IM_STR_USE_SIMD
+
+} // namespace _simd
+
+/**
+ * Calls f( pos ) for each position in str, at which one of the characters in delims is found (in ascending order)
+ */
+template<class F>
+void for_each_delimiter( std::string_view str, std::string_view delims, F&& f )
+{
+	if( delims.empty() ) { return; }
+
+	std::size_t scanned = 0;
+#if IM_STR_USE_SIMD
+	if( delims.size() <= max_simd_delimiters ) {
+		switch( active_simd_isa().load( std::memory_order_relaxed ) ) {
+			case simd_isa::avx2: scanned = _simd::scan_avx2( str, delims, f ); break;
+			case simd_isa::sse2: scanned = _simd::scan_sse2( str, delims, f ); break;
+			case simd_isa::scalar: break;
+		}
+	}
+#endif
+	_simd::scan_scalar( str, scanned, delims, f );
+}
+
+} // namespace mba::_detail_im_str
+
+#endif
@@ -3,9 +3,11 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstddef> // offsetof
 #include <cstdint>
 #include <cstdlib>
-#include <new>     // placement new
+#include <new> // placement new
+#include <type_traits>
 #include <utility> // std::move
 
 #include "./config.hpp"
@@ -106,17 +108,28 @@ constexpr T c_expr_exchange( T& obj, U&& new_value ) noexcept
 	return old_value;
 }
 
+template<class Handle>
 struct AllocResult;
+
 /**
  * Note: Almost all of the member functions are labled constexpr.
  * However, they can only be used in a constexpr context if the
  * handle is default constructed (i.e. _cnt == nullptr)
+ *
+ * CntT is either std::atomic_int (atomic_ref_cnt_buffer - handles can be copied and destroyed concurrently)
+ * or a plain int (local_ref_cnt_buffer - all handles referring to the same buffer have to be used from a
+ * single thread, but changing the ref count doesn't require atomic read-modify-write instructions).
  */
-class atomic_ref_cnt_buffer {
-	using Cnt_t     = std::atomic_int;
+template<class CntT>
+class basic_ref_cnt_buffer {
+	using Cnt_t     = CntT;
 	using size_type = int;
 
+	static constexpr bool is_atomic = !std::is_same_v<Cnt_t, int>;
+
 public:
+	using count_type = Cnt_t;
+
 /*
  * Use different types	to somewhat mitigate the ODR viaolation problem:
  * Function versions that have been compiled with support for  std::pmr::memory_resource will
@@ -129,25 +142,25 @@ public:
 	using alloc_ptr_t = std::nullptr_t;
 #endif
 	/*vvvv Constructors and special member functions vvvvv*/
-	static AllocResult allocate_null_terminated_char_buffer( int size, alloc_ptr_t = nullptr );
+	static AllocResult<basic_ref_cnt_buffer> allocate_null_terminated_char_buffer( int size, alloc_ptr_t = nullptr );
 
-	constexpr atomic_ref_cnt_buffer() noexcept = default;
-	constexpr atomic_ref_cnt_buffer( const atomic_ref_cnt_buffer& other, defer_ref_cnt_tag_t ) noexcept
+	constexpr basic_ref_cnt_buffer() noexcept = default;
+	constexpr basic_ref_cnt_buffer( const basic_ref_cnt_buffer& other, defer_ref_cnt_tag_t ) noexcept
 		: _cnt{ other._cnt }
 	{
 	}
 
-	constexpr atomic_ref_cnt_buffer( const atomic_ref_cnt_buffer& other ) noexcept
+	constexpr basic_ref_cnt_buffer( const basic_ref_cnt_buffer& other ) noexcept
 		: _cnt{ other._cnt }
 	{
 		_incref();
 	}
-	constexpr atomic_ref_cnt_buffer( atomic_ref_cnt_buffer&& other ) noexcept
+	constexpr basic_ref_cnt_buffer( basic_ref_cnt_buffer&& other ) noexcept
 		: _cnt{ c_expr_exchange( other._cnt, nullptr ) }
 	{
 	}
 
-	constexpr atomic_ref_cnt_buffer& operator=( const atomic_ref_cnt_buffer& other ) noexcept
+	constexpr basic_ref_cnt_buffer& operator=( const basic_ref_cnt_buffer& other ) noexcept
 	{
 		// inc before dec to protect against dropping in self assignment
 		other._incref();
@@ -155,7 +168,7 @@ public:
 		_cnt = other._cnt;
 		return *this;
 	}
-	constexpr atomic_ref_cnt_buffer& operator=( atomic_ref_cnt_buffer&& other ) noexcept
+	constexpr basic_ref_cnt_buffer& operator=( basic_ref_cnt_buffer&& other ) noexcept
 	{
 		assert( ( ( _cnt == nullptr ) || ( this != &other ) ) && "Move assignment to self is not allowed, if cnt!=0" );
 		_decref();
@@ -163,9 +176,9 @@ public:
 		return *this;
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 ~atomic_ref_cnt_buffer() { _decref(); }
+	IM_STR_CONSTEXPR_IN_CPP_20 ~basic_ref_cnt_buffer() { _decref(); }
 
-	friend constexpr void swap( atomic_ref_cnt_buffer& l, atomic_ref_cnt_buffer& r ) noexcept
+	friend constexpr void swap( basic_ref_cnt_buffer& l, basic_ref_cnt_buffer& r ) noexcept
 	{
 		// TODO: C++20 		std::swap( l._cnt, r._cnt );  (not yet constexpr)
 		auto tmp = l._cnt;
@@ -180,7 +193,7 @@ public:
 	/**
 	 * @brief Bump the ref count by \p cnt
 	 *
-	 * Intended to be used with the atomic_ref_cnt_buffer( const atomic_ref_cnt_buffer& other, defer_ref_cnt_tag_t )
+	 * Intended to be used with the basic_ref_cnt_buffer( const basic_ref_cnt_buffer& other, defer_ref_cnt_tag_t )
 	 * constructor
 	 *
 	 * @param cnt
@@ -188,26 +201,76 @@ public:
 	 */
 	constexpr int add_ref_cnt( int cnt ) const noexcept
 	{
-		if( _cnt == nullptr ) {
+		if( !_owns_buffer() ) {
 			return 0;
 		} else {
 			stats().inc_ref();
-			return _cnt->fetch_add( cnt, std::memory_order_relaxed ) + cnt;
+			return _fetch_add( cnt ) + cnt;
 		}
 	}
 
 	constexpr void release() { _cnt = nullptr; }
 
+	/**
+	 * Instead of referring to a buffer, a handle can store a small integer payload (im_str uses this to mark
+	 * strings that are stored inline). Such a handle doesn't own anything, so copying and destroying it
+	 * never touches a ref count, but it compares unequal to nullptr.
+	 */
+	static basic_ref_cnt_buffer make_payload_handle( std::size_t payload ) noexcept
+	{
+		basic_ref_cnt_buffer ret;
+		ret._cnt = reinterpret_cast<Cnt_t*>( ( static_cast<std::uintptr_t>( payload ) << 1 ) | payload_flag );
+		return ret;
+	}
+
+	constexpr bool has_payload() const noexcept { return _cnt != nullptr && _is_payload(); }
+
+	std::size_t payload() const noexcept
+	{
+		assert( has_payload() );
+		return static_cast<std::size_t>( reinterpret_cast<std::uintptr_t>( _cnt ) >> 1 );
+	}
+
+	// true, if this is the only handle that refers to the buffer
+	bool is_unique() const noexcept { return _owns_buffer() && _load() == 1; }
+
+	/**
+	 * @brief Hands the buffer over to a handle with a different ref count type (e.g. local -> atomic)
+	 *
+	 * The header is converted in place, so the data stays where it is. This is only safe, if no other handle
+	 * refers to the same buffer, hence the precondition. Afterwards, this handle is empty.
+	 */
+	template<class OtherCntT>
+	basic_ref_cnt_buffer<OtherCntT> convert_unique() && noexcept
+	{
+		using OtherHeader = typename basic_ref_cnt_buffer<OtherCntT>::Header;
+		static_assert( sizeof( OtherHeader ) == sizeof( Header ) && alignof( OtherHeader ) == alignof( Header ) );
+		static_assert( offsetof( OtherHeader, ref_cnt ) == 0 && offsetof( Header, ref_cnt ) == 0 );
+
+		assert( is_unique() );
+		Header* const     header = static_cast<Header*>( static_cast<void*>( _cnt ) );
+		const size_type   size   = header->size;
+		const alloc_ptr_t alloc  = header->alloc;
+		header->~Header();
+		_cnt = nullptr;
+
+		auto* const other_header = new( static_cast<void*>( header ) ) OtherHeader{ OtherCntT{ 1 }, size, alloc };
+		return basic_ref_cnt_buffer<OtherCntT>{ *other_header };
+	}
+
 	/*^^^^ API ^^^^*/
 
 	// clang-format off
-	friend constexpr bool operator==( const atomic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt == nullptr; }
-	friend constexpr bool operator==( std::nullptr_t, const atomic_ref_cnt_buffer& r ) noexcept { return r._cnt == nullptr; }
-	friend constexpr bool operator!=( const atomic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt != nullptr; }
-	friend constexpr bool operator!=( std::nullptr_t, const atomic_ref_cnt_buffer& r ) noexcept { return r._cnt != nullptr; }
+	friend constexpr bool operator==( const basic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt == nullptr; }
+	friend constexpr bool operator==( std::nullptr_t, const basic_ref_cnt_buffer& r ) noexcept { return r._cnt == nullptr; }
+	friend constexpr bool operator!=( const basic_ref_cnt_buffer& l, std::nullptr_t ) noexcept { return l._cnt != nullptr; }
+	friend constexpr bool operator!=( std::nullptr_t, const basic_ref_cnt_buffer& r ) noexcept { return r._cnt != nullptr; }
 	// clang-format on
 
 private:
+	template<class>
+	friend class basic_ref_cnt_buffer;
+
 	struct Header {
 		Cnt_t       ref_cnt;
 		size_type   size;
@@ -217,18 +280,55 @@ private:
 				   <= 4 + 4 + sizeof( void* ) ); // make sure there is no padding and we use 32bit integers
 
 	// This is used in allocate_null_terminated_char_buffer
-	constexpr explicit atomic_ref_cnt_buffer( Header& buffer ) noexcept
+	constexpr explicit basic_ref_cnt_buffer( Header& buffer ) noexcept
 		: _cnt( &( buffer.ref_cnt ) )
 	{
 	}
 
 	static void dealloc_buffer( Header* ptr );
 
+	// Cnt_t is more than 1 byte aligned, so the lowest bit of a real pointer is never set
+	static constexpr std::uintptr_t payload_flag = 1;
+	static_assert( alignof( Cnt_t ) > 1 );
+
+	bool _is_payload() const noexcept { return ( reinterpret_cast<std::uintptr_t>( _cnt ) & payload_flag ) != 0; }
+
+	// short circuits before _is_payload, so a default constructed handle can still be used in constexpr contexts
+	constexpr bool _owns_buffer() const noexcept { return _cnt != nullptr && !_is_payload(); }
+
+	int _fetch_add( int cnt ) const noexcept
+	{
+		if constexpr( is_atomic ) {
+			return _cnt->fetch_add( cnt, std::memory_order_relaxed );
+		} else {
+			return c_expr_exchange( *_cnt, *_cnt + cnt );
+		}
+	}
+
+	int _fetch_sub_one() const noexcept
+	{
+		if constexpr( is_atomic ) {
+			return _cnt->fetch_sub( 1 );
+		} else {
+			return ( *_cnt )--;
+		}
+	}
+
+	int _load() const noexcept
+	{
+		if constexpr( is_atomic ) {
+			// acquire: pairs with the decrements of handles that have been destroyed in other threads
+			return _cnt->load( std::memory_order_acquire );
+		} else {
+			return *_cnt;
+		}
+	}
+
 	constexpr void _decref() const noexcept
 	{
-		if( _cnt ) {
+		if( _owns_buffer() ) {
 			stats().dec_ref();
-			if( _cnt->fetch_sub( 1 ) == 1 ) {
+			if( _fetch_sub_one() == 1 ) {
 				Header* header = static_cast<Header*>( static_cast<void*>( _cnt ) );
 				dealloc_buffer( header );
 			}
@@ -237,9 +337,9 @@ private:
 
 	constexpr void _incref() const noexcept
 	{
-		if( _cnt ) {
+		if( _owns_buffer() ) {
 			stats().inc_ref();
-			_cnt->fetch_add( 1, std::memory_order_relaxed );
+			_fetch_add( 1 );
 		}
 	}
 
@@ -248,12 +348,18 @@ private:
 	static constexpr auto alignment = alignof( Header );
 };
 
+using atomic_ref_cnt_buffer = basic_ref_cnt_buffer<std::atomic_int>;
+using local_ref_cnt_buffer  = basic_ref_cnt_buffer<int>;
+
+template<class Handle>
 struct AllocResult {
-	char*                 data;
-	atomic_ref_cnt_buffer handle;
+	char*  data;
+	Handle handle;
 };
 
-inline AllocResult atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer( size_type size, alloc_ptr_t resource )
+template<class CntT>
+inline AllocResult<basic_ref_cnt_buffer<CntT>>
+basic_ref_cnt_buffer<CntT>::allocate_null_terminated_char_buffer( size_type size, alloc_ptr_t resource )
 {
 	assert( size >= 0 );
 	stats().alloc();
@@ -274,10 +380,11 @@ inline AllocResult atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
 	auto* const data_ptr = start + sizeof( Header ); // Start of string
 	data_ptr[size]       = '\0';                     // zero terminate
 
-	return { data_ptr, atomic_ref_cnt_buffer{ *header_ptr } };
+	return { data_ptr, basic_ref_cnt_buffer{ *header_ptr } };
 }
 
-inline void atomic_ref_cnt_buffer::dealloc_buffer( Header* header )
+template<class CntT>
+inline void basic_ref_cnt_buffer<CntT>::dealloc_buffer( Header* header )
 {
 	stats().dealloc();
 
@@ -0,0 +1,143 @@
+#ifndef IM_STR_SPLIT_RANGE_HPP
+#define IM_STR_SPLIT_RANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace mba::_detail_im_str {
+
+/**
+ * Creates tokens, that are just views into the original string (used by im_str::split_view_sv)
+ */
+class string_view_token_maker {
+public:
+	constexpr explicit string_view_token_maker( std::string_view source ) noexcept
+		: _source( source )
+	{
+	}
+
+	constexpr std::string_view source() const noexcept { return _source; }
+	constexpr std::string_view operator()( std::string_view token ) const noexcept { return token; }
+
+private:
+	std::string_view _source;
+};
+
+/**
+ * Lazy input range over the tokens of a string (same semantics as im_str::split_full)
+ *
+ * The next delimiter is only searched for, when the iterator is incremented, so nothing has to be
+ * allocated and iteration can be stopped at any point without scanning the rest of the string.
+ *
+ * Each dereference of an iterator creates a token by calling TokenMaker::operator()( std::string_view ).
+ * TokenMaker::source() returns the string that gets split.
+ *
+ * The iterators refer to the range, so it can neither be copied nor moved (returning it from a function
+ * works anyway due to guaranteed copy elision).
+ */
+template<class TokenMaker>
+class split_range {
+public:
+	using value_type = decltype( std::declval<TokenMaker&>()( std::string_view{} ) );
+
+	/**
+	 * @param delim_to_prev  delimiter is the last character of the token before it (Split::After)
+	 * @param delim_to_next  delimiter is the first character of the token after it (Split::Before)
+	 */
+	split_range( TokenMaker maker, char delim, bool delim_to_prev, bool delim_to_next )
+		: _maker( std::move( maker ) )
+		, _str( _maker.source() )
+		, _delim( delim )
+		, _delim_to_prev( delim_to_prev )
+		, _delim_to_next( delim_to_next )
+		, _done( _str.empty() )
+	{
+		if( !_done ) { _find_token(); }
+	}
+
+	split_range( const split_range& ) = delete;
+	split_range& operator=( const split_range& ) = delete;
+
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type        = typename split_range::value_type;
+		using difference_type   = std::ptrdiff_t;
+		using pointer           = void;
+		using reference         = value_type;
+
+		constexpr iterator() noexcept = default;
+
+		reference operator*() const { return _range->_maker( _range->_token ); }
+
+		iterator& operator++()
+		{
+			_range->_advance();
+			return *this;
+		}
+
+		void operator++( int ) { ++*this; }
+
+		friend bool operator==( const iterator& l, const iterator& r ) noexcept { return l._at_end() == r._at_end(); }
+		friend bool operator!=( const iterator& l, const iterator& r ) noexcept { return !( l == r ); }
+
+	private:
+		friend split_range;
+		constexpr explicit iterator( split_range* range ) noexcept
+			: _range( range )
+		{
+		}
+
+		bool _at_end() const noexcept { return _range == nullptr || _range->_done; }
+
+		split_range* _range = nullptr;
+	};
+
+	iterator begin() noexcept { return iterator( this ); }
+	iterator end() noexcept { return iterator(); }
+
+	// the current token without creating it via the TokenMaker
+	std::string_view current_view() const noexcept { return _token; }
+
+	bool empty() const noexcept { return _done; }
+
+private:
+	void _find_token() noexcept
+	{
+		const auto pos = _str.find( _delim, _search_pos );
+		if( pos == std::string_view::npos ) {
+			_token      = _str.substr( _token_start );
+			_last_token = true;
+			return;
+		}
+		_token       = _str.substr( _token_start, pos + _delim_to_prev - _token_start );
+		_token_start = _delim_to_next ? pos : pos + 1;
+		_search_pos  = pos + 1;
+	}
+
+	void _advance() noexcept
+	{
+		if( _last_token ) {
+			_done = true;
+		} else {
+			_find_token();
+		}
+	}
+
+	TokenMaker       _maker;
+	std::string_view _str;
+	std::string_view _token{};
+	std::size_t      _token_start = 0;
+	std::size_t      _search_pos  = 0;
+	char             _delim;
+	bool             _delim_to_prev;
+	bool             _delim_to_next;
+	bool             _last_token = false;
+	bool             _done;
+};
+
+} // namespace mba::_detail_im_str
+
+#endif
@@ -2,7 +2,9 @@
 #define IM_STR_IM_STR_H
 
 #include "detail/config.hpp"
+#include "detail/find_delimiters.hpp"
 #include "detail/ref_cnt_buf.hpp"
+#include "detail/split_range.hpp"
 #include "detail/string_view_mixin.hpp"
 
 #if IM_STR_USE_CUSTOM_DYN_ARRAY
@@ -32,36 +34,89 @@ class im_zstr;
  * im_str is an immutable string class that doesn't allocate
  * when constructed from string litterals
  *
- * Forward declaration, as some im_str member functions return a
- * zero terminated im_str
+ * Strings with up to inline_capacity characters (15 on 64 bit platforms) that are created at runtime
+ * are stored inside the object itself (small string optimization), so they don't allocate either
+ * and copying them doesn't touch a ref count.
+ *
+ * The ref count policy is determined by the Handle type:
+ * - im_str       (_detail_im_str::atomic_ref_cnt_buffer): copies can be created and destroyed concurrently
+ * - local_im_str (_detail_im_str::local_ref_cnt_buffer): uses a plain int as ref count, so copying, slicing and
+ *   destroying strings is cheaper, but all strings sharing a buffer have to be used from the same thread.
+ *   Convert to im_str (explicit constructor) before handing a string over to a different thread.
  */
-class im_str : public mba::_detail::str_view_mixin<im_str> {
-	using Base_t = mba::_detail::str_view_mixin<im_str>;
+template<class Handle>
+class basic_im_str : public mba::_detail::str_view_mixin<basic_im_str<Handle>> {
+	using Base_t = mba::_detail::str_view_mixin<basic_im_str<Handle>>;
 
 protected:
-	using Handle_t = _detail_im_str::atomic_ref_cnt_buffer;
+	using Handle_t = Handle;
+
+	template<class>
+	friend class basic_im_str;
 
 public:
+	// members of the (dependent) base class that are used in the implementation
+	using typename Base_t::iterator;
+	using typename Base_t::size_type;
+	using Base_t::begin;
+	using Base_t::data;
+	using Base_t::end;
+	using Base_t::npos;
+	using Base_t::size;
+
 #ifdef IM_STR_USE_CUSTOM_DYN_ARRAY
-	using DynArray_t = _detail_im_str::dynamic_array<im_str>;
+	using DynArray_t = _detail_im_str::dynamic_array<basic_im_str>;
 #else
-	using DynArray_t = std::vector<im_str>;
+	using DynArray_t = std::vector<basic_im_str>;
 #endif
+	// strings up to this size are stored inline (the remaining byte holds the terminating zero)
+	static constexpr std::size_t inline_capacity = sizeof( std::string_view ) - 1;
+
 	/* #################### CTORS ################################################################################### */
 
 	// Default ConstString points at empty string
-	constexpr im_str() noexcept = default;
+	constexpr basic_im_str() noexcept = default;
 
-	IM_STR_CONSTEXPR_IN_CPP_20 explicit im_str( std::string_view                                   other,
-												_detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc = nullptr )
+	IM_STR_CONSTEXPR_IN_CPP_20 explicit basic_im_str( std::string_view                  other,
+													  typename Handle_t::alloc_ptr_t alloc = nullptr )
 	{
 		_copy_from( other, alloc );
 	}
 
+	/**
+	 * Conversion between the different ref count policies (e.g. local_im_str -> im_str)
+	 *
+	 * Strings with static lifetime and inline strings are just copied over. Buffers can't be shared between
+	 * handles with different ref count types, so the data gets copied into a new buffer (using the default
+	 * allocator) - unless the source is an rvalue that is the only owner of its buffer. In that case, the
+	 * buffer is taken over without copying the data.
+	 */
+	template<class OtherHandle, class = std::enable_if_t<!std::is_same_v<OtherHandle, Handle>>>
+	IM_STR_CONSTEXPR_IN_CPP_20 explicit basic_im_str( const basic_im_str<OtherHandle>& other )
+	{
+		if( other.wrapps_a_string_litteral() ) {
+			_storage.view = other._storage.view;
+		} else {
+			_copy_from( other._as_strview(), nullptr );
+		}
+	}
+
+	template<class OtherHandle, class = std::enable_if_t<!std::is_same_v<OtherHandle, Handle>>>
+	IM_STR_CONSTEXPR_IN_CPP_20 explicit basic_im_str( basic_im_str<OtherHandle>&& other )
+	{
+		if( other._handle.is_unique() ) {
+			_storage.view = other._storage.view;
+			_handle       = std::move( other._handle ).template convert_unique<typename Handle_t::count_type>();
+			other._storage = {};
+		} else {
+			*this = basic_im_str( static_cast<const basic_im_str<OtherHandle>&>( other ) );
+		}
+	}
+
 	// NOTE: Use only for string literals (arrays with static storage duration)!!!
 	template<std::size_t N>
-	constexpr im_str( const char ( &other )[N] ) noexcept
-		: _view( other )
+	constexpr basic_im_str( const char ( &other )[N] ) noexcept
+		: _storage{ std::string_view( other ) }
 	// we don't have to copy the data to the freestore as string litterals already have static lifetime
 	{
 	}
@@ -83,75 +138,70 @@ public:
 	 * @param Tag type
 	 * @return
 	 */
-	constexpr im_str( std::string_view string, trust_me_this_is_from_a_string_litteral_t ) noexcept
-		: _view( string )
+	constexpr basic_im_str( std::string_view string, trust_me_this_is_from_a_string_litteral_t ) noexcept
+		: _storage{ string }
 	{
 	}
 
 	// don't accept c-strings in the form of pointer
 	// if you need to create a im_str from a c string use the factory function im_str::from_c_str
 	template<class T>
-	im_str( T const* const& other ) = delete;
+	basic_im_str( T const* const& other ) = delete;
 
-	IM_STR_CONSTEXPR_IN_CPP_20 static im_str from_c_str( const char* str )
+	IM_STR_CONSTEXPR_IN_CPP_20 static basic_im_str from_c_str( const char* str )
 	{
-		return im_str{ std::string_view( str ) };
+		return basic_im_str{ std::string_view( str ) };
 	};
 
 
 	/* ############### Special member functions ##################################################################### */
-	constexpr im_str( const im_str& other ) noexcept = default;
-	constexpr im_str( im_str&& other ) noexcept
-		: _view( _detail_im_str::c_expr_exchange( other._as_strview(), std::string_view{} ) )
+	constexpr basic_im_str( const basic_im_str& other ) noexcept = default;
+	constexpr basic_im_str( basic_im_str&& other ) noexcept
+		: _storage( _detail_im_str::c_expr_exchange( other._storage, Storage{} ) )
 		, _handle( std::move( other._handle ) )
 	{
 	}
 
 	// NOTE could be = defaulted in c++20 but needs to be written down explicitly in c++17 in order to be constexpr
-	constexpr im_str& operator=( const im_str& other ) noexcept
+	constexpr basic_im_str& operator=( const basic_im_str& other ) noexcept
 	{
-		this->_view   = other._view;
-		this->_handle = other._handle;
+		this->_storage = other._storage;
+		this->_handle  = other._handle;
 		return *this;
 	}
 
-	constexpr im_str& operator=( im_str&& other ) noexcept
+	constexpr basic_im_str& operator=( basic_im_str&& other ) noexcept
 	{
-		this->_view   = _detail_im_str::c_expr_exchange( other._as_strview(), std::string_view{} );
-		this->_handle = std::move( other._handle );
+		this->_storage = _detail_im_str::c_expr_exchange( other._storage, Storage{} );
+		this->_handle  = std::move( other._handle );
 		return *this;
 	}
 
 	/* ################## String functions  ######################################################################### */
-	constexpr operator std::string_view() const { return this->_view; }
+	constexpr operator std::string_view() const { return this->_as_strview(); }
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( std::size_t offset = 0, std::size_t count = npos ) const& noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( std::size_t offset = 0, std::size_t count = npos ) const& noexcept
 	{
-		return {
-			this->_as_strview().substr( offset, count ), //
-			this->_handle                                //
-		};
+		return _slice( this->_as_strview().substr( offset, count ) );
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( std::size_t offset = 0, std::size_t count = npos ) && noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( std::size_t offset = 0, std::size_t count = npos ) && noexcept
 	{
+		if( _is_inline() ) { return _slice( this->_as_strview().substr( offset, count ) ); }
 		return {
 			this->_as_strview().substr( offset, count ), //
 			std::move( this->_handle )                   //
 		};
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( std::string_view range ) const noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( std::string_view range ) const noexcept
 	{
 		// TODO: strictly speaking those pointer comparisons are UB
 		assert( ( data() <= range.data() ) && ( range.data() + range.size() <= data() + size() ) );
-		return {
-			range,        //
-			this->_handle //
-		};
+		return _slice( range );
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr( iterator start, iterator end ) const noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr( iterator start, iterator end ) const noexcept
 	{
 		assert( end >= start );
 		// UGLY: start-begin()+data() is necessary to convert from an iterator to a pointer
@@ -159,9 +209,9 @@ public:
 		return substr( std::string_view( start - begin() + data(), static_cast<size_type>( end - start ) ) );
 	}
 
-	IM_STR_CONSTEXPR_IN_CPP_20 im_str substr_sentinel( std::size_t offset, char sentinel ) const noexcept
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str substr_sentinel( std::size_t offset, char sentinel ) const noexcept
 	{
-		const auto size = _view.find( sentinel, offset );
+		const auto size = _as_strview().find( sentinel, offset );
 		return substr( offset, size - offset );
 	}
 
@@ -176,13 +226,13 @@ public:
 	enum class Split { Drop, Before, After };
 
 	// split string into two substrings [0,i) and [i, this->size() )
-	[[deprecated( "Use split_at instead" )]] std::pair<im_str, im_str> split( std::size_t i ) const
+	[[deprecated( "Use split_at instead" )]] std::pair<basic_im_str, basic_im_str> split( std::size_t i ) const
 	{
 		return split_at( i );
 	}
 
 	// split string into two substrings [0,i) and [i, this->size() )
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_at( std::size_t i ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_at( std::size_t i ) const
 	{
 		assert( i < size() || i == npos );
 		if( i == npos ) { return { *this, {} }; }
@@ -190,7 +240,7 @@ public:
 	}
 
 	// split string into two substrings [0,i) and [i, this->size() )
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_at( std::size_t i, Split s ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_at( std::size_t i, Split s ) const
 	{
 		assert( i < size() || i == npos );
 		if( i == npos ) { return { *this, {} }; }
@@ -199,30 +249,30 @@ public:
 	}
 
 	// split string on first occurence of c.
-	[[deprecated( "Use split_on_first instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str>
+	[[deprecated( "Use split_on_first instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str>
 																			  split_first( char c = ' ', Split s = Split::Drop ) const
 	{
 		return split_on_first( c, s );
 	}
 
 	// split string on last occurence of c.
-	[[deprecated( "Use split_on_last instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str>
+	[[deprecated( "Use split_on_last instead" )]] IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str>
 																			 split_last( char c = ' ', Split s = Split::Drop ) const
 	{
 		return split_on_last( c, s );
 	}
 
 	// split string on first occurence of c.
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_on_first( char c = ' ', Split s = Split::Drop ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_on_first( char c = ' ', Split s = Split::Drop ) const
 	{
-		auto pos = _view.find( c );
+		auto pos = _as_strview().find( c );
 		return split_at( pos, s );
 	}
 
 	// split string on last occurence of c
-	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<im_str, im_str> split_on_last( char c = ' ', Split s = Split::Drop ) const
+	IM_STR_CONSTEXPR_IN_CPP_20 std::pair<basic_im_str, basic_im_str> split_on_last( char c = ' ', Split s = Split::Drop ) const
 	{
-		auto pos = _view.rfind( c );
+		auto pos = _as_strview().rfind( c );
 		return split_at( pos, s );
 	}
 
@@ -242,67 +292,66 @@ public:
 	 */
 	DynArray_t split_full( const char delimiter, const Split s = Split::Drop ) const noexcept
 	{
-		if( size() == 0 ) { return {}; }
-
-		const auto split_cnt = 1 + std::count( begin(), end(), delimiter );
-
-		DynArray_t ret( split_cnt );
-		{
-			/* DANGER:
-			 * Inside the following loop we create im_str copies of the current im_str, but don't bump the ref count one
-			 * by one for efficiency reasons, but only once at the end. In case an exception is thrown midway, we have
-			 * to make sure that the already created slices don't decrement the ref-count when they are destructed
-			 */
-
-			struct ScopeGuard {
-				DynArray_t& slices;
-				bool        comitted = false;
-				~ScopeGuard()
-				{
-					if( !comitted ) {
-						for( auto& slice : slices ) {
-							slice.release();
-						}
-					}
-				}
-			} guard{ ret };
+		return _split_on_any( std::string_view( &delimiter, 1 ), s );
+	}
 
-			const std::string_view self_view = this->_as_strview();
-			std::size_t            start_pos = 0;
-			for( auto& slice : ret ) {
+	/**
+	 * @brief  Splits string at each occurence of any of the characters in \p delimiters
+	 *
+	 * Example:
+	 * auto groups = im_str("a=1;b=2").split_any("=;");
+	 * assert( groups.size() == 4 );
+	 * assert( groups[3] == "2" );
+	 *
+	 * @return Same as split_full
+	 */
+	DynArray_t split_any( const std::string_view delimiters, const Split s = Split::Drop ) const noexcept
+	{
+		return _split_on_any( delimiters, s );
+	}
 
-				const auto found_pos = _view.find( delimiter, start_pos + (s == Split::Before) );
+protected:
+	class _slice_maker;
 
-				slice = im_str(
-					// std::string_view::substr(offset,count) allows count to be bigger than size,
-					// so we don't have to check for npos here
-					self_view.substr( start_pos, found_pos - start_pos + ( s == Split::After ) ),
-					_handle,
-					_detail_im_str::defer_ref_cnt_tag // ref count will be incremented at the end of the function
-				);
+public:
+	// the ref count of the split string is incremented in steps of this size by split_view
+	static constexpr int split_view_ref_cnt_batch_size = 16;
 
-				start_pos = found_pos + ( s == Split::Drop || s == Split::After );
-			}
+	using split_view_t    = _detail_im_str::split_range<_slice_maker>;
+	using split_view_sv_t = _detail_im_str::split_range<_detail_im_str::string_view_token_maker>;
 
-#ifdef _MSC_VER
-#pragma warning( push )
-#pragma warning( disable : 4307 ) // we know that this overflows
-#endif
-			assert( start_pos == std::string_view::npos + ( std::size_t )( s == Split::Drop || s == Split::After ) );
-#ifdef _MSC_VER
-#pragma warning( pop )
-#endif
-			guard.comitted = true;
-		}
-		_handle.add_ref_cnt( static_cast<int>( split_cnt ) );
+	/**
+	 * @brief Lazy version of split_full
+	 *
+	 * Returns an input range that finds the next token only when its iterator gets incremented and doesn't
+	 * allocate. Dereferencing the iterator returns the token as a new string that shares the buffer with
+	 * this one. Instead of incrementing the ref count for each token, it is incremented in batches of
+	 * split_view_ref_cnt_batch_size and references that haven't been used are given back when the range
+	 * is destroyed.
+	 *
+	 * Example:
+	 * for( im_str token : im_str("123;456;78").split_view(';') ) { ... }
+	 *
+	 * The range holds its own copy of this string, so it can be used with temporaries.
+	 */
+	split_view_t split_view( char delimiter, Split s = Split::Drop ) const noexcept;
 
-		return ret;
+	/**
+	 * Same as split_view, but returns the tokens as std::string_views into this string (no ref counting at all)
+	 * The string has to outlive the range and the tokens.
+	 */
+	split_view_sv_t split_view_sv( char delimiter, Split s = Split::Drop ) const noexcept
+	{
+		return split_view_sv_t(
+			_detail_im_str::string_view_token_maker( this->_as_strview() ), delimiter, s == Split::After, s == Split::Before );
 	}
 
 	constexpr bool is_zero_terminated() const noexcept { return this->data()[size()] == '\0'; }
 
 	constexpr bool wrapps_a_string_litteral() const noexcept { return _handle == nullptr; }
 
+	constexpr bool is_stored_inline() const noexcept { return _is_inline(); }
+
 	/**
 	 * This will create a new im_str (actually a im_zstr) whose data resides in a freshly
 	 * allocated memory block
@@ -327,26 +376,29 @@ protected:
 	class is_zero_terminated_tag {
 	};
 
-	constexpr im_str( std::string_view sv, static_lifetime_tag )  noexcept
-		: _view( sv )
+	class inline_storage_tag {
+	};
+
+	constexpr basic_im_str( std::string_view sv, static_lifetime_tag )  noexcept
+		: _storage{ sv }
 	{
 	}
 
 	// mostly used in substr
-	constexpr im_str( std::string_view sv, const Handle_t& data ) noexcept
-		: _view( sv )
+	constexpr basic_im_str( std::string_view sv, const Handle_t& data ) noexcept
+		: _storage{ sv }
 		, _handle{ data }
 	{
 	}
 
-	constexpr im_str( std::string_view sv, Handle_t&& data ) noexcept
-		: _view( sv )
+	constexpr basic_im_str( std::string_view sv, Handle_t&& data ) noexcept
+		: _storage{ sv }
 		, _handle{ std::move(data) }
 	{
 	}
 
-	constexpr im_str( std::string_view sv, const Handle_t& data, _detail_im_str::defer_ref_cnt_tag_t ) noexcept
-		: _view( sv )
+	constexpr basic_im_str( std::string_view sv, const Handle_t& data, _detail_im_str::defer_ref_cnt_tag_t ) noexcept
+		: _storage{ sv }
 		, _handle{ data, _detail_im_str::defer_ref_cnt_tag_t{} }
 	{
 	}
@@ -354,35 +406,183 @@ protected:
 	/**
 	 * private constructor, that takes ownership of a buffer and a size (used in _copy_from and _concat_impl)
 	 */
-	constexpr im_str( Handle_t&& handle, const char* data, size_t size )
-		: _view( data, size )
+	constexpr basic_im_str( Handle_t&& handle, const char* data, size_t size )
+		: _storage{ std::string_view( data, size ) }
 		, _handle( std::move( handle ) )
 	{
 	}
 
-	friend constexpr void swap( im_str& l, im_str& r ) noexcept;
+	// copies sv into the object itself (sv.size() <= inline_capacity)
+	basic_im_str( std::string_view sv, inline_storage_tag ) noexcept
+		: _handle( Handle_t::make_payload_handle( sv.size() ) )
+	{
+		assert( sv.size() <= inline_capacity );
+		std::copy_n( sv.data(), sv.size(), _storage.chars );
+		_storage.chars[sv.size()] = '\0';
+	}
+
+	friend constexpr void swap( basic_im_str& l, basic_im_str& r ) noexcept
+	{
+		swap( l._handle, r._handle );
+
+		// TODO: in c++20:
+		// using std::swap;
+		// swap( l._storage, r._storage );  // not yet constexpr
+		const auto t = l._storage;
+		l._storage   = r._storage;
+		r._storage   = t;
+	}
 
-	friend void swap( im_str& l, std::string_view& r ) = delete;
-	friend void swap( std::string_view& l, im_str& r ) = delete;
+	friend void swap( basic_im_str& l, std::string_view& r ) = delete;
+	friend void swap( std::string_view& l, basic_im_str& r ) = delete;
 
 protected:
-	std::string_view _view{};
-	Handle_t         _handle{};
+	/*
+	 * Strings that are stored inline use chars as the active member and _handle stores their size
+	 * (see Handle_t::make_payload_handle). All other strings use view and _handle either
+	 * refers to the buffer that view points into or is null (string litterals).
+	 */
+	union Storage {
+		std::string_view view{};
+		char             chars[sizeof( std::string_view )];
+	};
+
+	Storage  _storage{};
+	Handle_t _handle{};
 
 	friend Base_t;
-	constexpr std::size_t _size_for_mixin() const noexcept { return _view.size(); }
-	constexpr const char* _data_for_mixin() const noexcept { return _view.data(); }
+	constexpr std::size_t _size_for_mixin() const noexcept
+	{
+		return _is_inline() ? _handle.payload() : _storage.view.size();
+	}
+	constexpr const char* _data_for_mixin() const noexcept
+	{
+		return _is_inline() ? _storage.chars : _storage.view.data();
+	}
 
-	constexpr std::string_view&       _as_strview() { return _view; }
-	constexpr const std::string_view& _as_strview() const { return _view; }
+	constexpr bool _is_inline() const noexcept { return _handle.has_payload(); }
+
+	constexpr std::string_view _as_strview() const noexcept
+	{
+		return std::string_view( _data_for_mixin(), _size_for_mixin() );
+	}
+
+	// a substring of this, that either shares the buffer with this or is an inline copy
+	IM_STR_CONSTEXPR_IN_CPP_20 basic_im_str _slice( std::string_view sv ) const noexcept
+	{
+		if( _is_inline() ) { return basic_im_str( sv, inline_storage_tag{} ); }
+		return { sv, _handle };
+	}
 
 	constexpr void release() noexcept { _handle.release(); }
 
-	IM_STR_CONSTEXPR_IN_CPP_20 void _copy_from( const std::string_view                             other,
-												_detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc )
+	// Creates the tokens for split_view (see split_range)
+	class _slice_maker {
+	public:
+		explicit _slice_maker( const basic_im_str& str ) noexcept
+			: _str( str )
+		{
+		}
+
+		_slice_maker( _slice_maker&& other ) noexcept
+			: _str( std::move( other._str ) )
+			, _prepaid( _detail_im_str::c_expr_exchange( other._prepaid, 0 ) )
+		{
+		}
+		_slice_maker& operator=( _slice_maker&& other ) = delete;
+
+		~_slice_maker()
+		{
+			// give back the references that haven't been used
+			if( _prepaid != 0 ) { _str._handle.add_ref_cnt( -_prepaid ); }
+		}
+
+		std::string_view source() const noexcept { return _str._as_strview(); }
+
+		basic_im_str operator()( std::string_view token ) noexcept
+		{
+			if( _str._is_inline() ) { return basic_im_str( token, inline_storage_tag{} ); }
+			if( _prepaid == 0 ) {
+				_str._handle.add_ref_cnt( split_view_ref_cnt_batch_size );
+				_prepaid = split_view_ref_cnt_batch_size;
+			}
+			--_prepaid;
+			return basic_im_str( token, _str._handle, _detail_im_str::defer_ref_cnt_tag );
+		}
+
+	private:
+		basic_im_str _str;
+		int          _prepaid = 0;
+	};
+
+	DynArray_t _split_on_any( const std::string_view delimiters, const Split s ) const noexcept
+	{
+		if( size() == 0 ) { return {}; }
+
+		const std::string_view self_view = this->_as_strview();
+
+		// single pass over the string (see find_delimiters.hpp)
+		_detail_im_str::delimiter_positions positions;
+		_detail_im_str::for_each_delimiter(
+			self_view, delimiters, [&positions]( std::size_t pos ) { positions.push_back( pos ); } );
+
+		const std::size_t split_cnt = positions.size() + 1;
+
+		DynArray_t ret( split_cnt );
+		{
+			/* DANGER:
+			 * Inside the following loop we create im_str copies of the current im_str, but don't bump the ref count one
+			 * by one for efficiency reasons, but only once at the end. In case an exception is thrown midway, we have
+			 * to make sure that the already created slices don't decrement the ref-count when they are destructed
+			 */
+
+			struct ScopeGuard {
+				DynArray_t& slices;
+				bool        comitted = false;
+				~ScopeGuard()
+				{
+					if( !comitted ) {
+						for( auto& slice : slices ) {
+							slice.release();
+						}
+					}
+				}
+			} guard{ ret };
+
+			const bool        is_inline  = _is_inline();
+			const std::size_t keep_delim = s == Split::After;                      // delimiter ends the slice
+			const std::size_t skip_delim = s == Split::Drop || s == Split::After; // delimiter isn't part of the next
+			std::size_t       start_pos  = 0;
+			for( std::size_t i = 0; i < split_cnt; ++i ) {
+				const std::size_t end_pos = i < positions.size() ? positions[i] + keep_delim : self_view.size();
+
+				const std::string_view slice_view( self_view.data() + start_pos, end_pos - start_pos );
+
+				// slices of an inline string are inline themselves, so there is no ref count to defer
+				ret[i] = is_inline ? basic_im_str( slice_view, inline_storage_tag{} )
+								   : basic_im_str( slice_view,
+												   _handle,
+												   _detail_im_str::defer_ref_cnt_tag // ref count will be incremented at
+																					 // the end of the function
+									 );
+
+				if( i < positions.size() ) { start_pos = positions[i] + skip_delim; }
+			}
+			guard.comitted = true;
+		}
+		_handle.add_ref_cnt( static_cast<int>( split_cnt ) );
+
+		return ret;
+	}
+
+	IM_STR_CONSTEXPR_IN_CPP_20 void _copy_from( const std::string_view other, typename Handle_t::alloc_ptr_t alloc )
 	{
 		if( other.data() == nullptr ) {
-			this->_as_strview() = std::string_view{ "" };
+			this->_storage.view = std::string_view{ "" };
+			return;
+		}
+		if( other.size() <= inline_capacity ) {
+			*this = basic_im_str( other, inline_storage_tag{} );
 			return;
 		}
 		// create buffer and copy data over
@@ -390,21 +590,12 @@ protected:
 		std::copy_n( other.data(), other.size(), data );
 
 		// initialize data fields;
-		*this = im_str( std::move( handle ), data, other.size() );
+		*this = basic_im_str( std::move( handle ), data, other.size() );
 	}
 };
 
-constexpr void swap( im_str& l, im_str& r ) noexcept
-{
-	swap( l._handle, r._handle );
-
-	// TODO: in c++20:
-	// using std::swap;
-	// swap( l._as_strview(), r._as_strview() );  // not yet constexpr
-	std::string_view t = l._as_strview();
-	l._as_strview()    = r._as_strview();
-	r._as_strview()    = t;
-}
+using im_str       = basic_im_str<_detail_im_str::atomic_ref_cnt_buffer>;
+using local_im_str = basic_im_str<_detail_im_str::local_ref_cnt_buffer>;
 
 namespace _detail_im_str_concat {
 // ARGS must be std::string_view
@@ -514,30 +705,41 @@ constexpr void swap( im_zstr& l, im_zstr& r ) noexcept
 
 	// TODO: in c++20:
 	// using std::swap;
-	// swap( l._as_strview(), r._as_strview() );  // not yet constexpr
-	std::string_view t = l._as_strview();
-	l._as_strview()    = r._as_strview();
-	r._as_strview()    = t;
+	// swap( l._storage, r._storage );  // not yet constexpr
+	const auto t = l._storage;
+	l._storage   = r._storage;
+	r._storage   = t;
+}
+
+template<class Handle>
+inline typename basic_im_str<Handle>::split_view_t basic_im_str<Handle>::split_view( char delimiter, Split s ) const noexcept
+{
+	return split_view_t( _slice_maker( *this ), delimiter, s == Split::After, s == Split::Before );
 }
 
-IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr im_str::unshare() const
+template<class Handle>
+IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr basic_im_str<Handle>::unshare() const
 {
 	return im_zstr( static_cast<std::string_view>( *this ) );
 }
 
-IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr im_str::create_zstr() const&
+template<class Handle>
+IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr basic_im_str<Handle>::create_zstr() const&
 {
 	if( is_zero_terminated() ) {
-		return im_zstr{ { *this }, is_zero_terminated_tag{} }; // just copy
+		// just copy (local_im_str has to be converted first)
+		return im_zstr{ im_str( *this ), im_str::is_zero_terminated_tag{} };
 	} else {
 		return unshare();
 	}
 }
 
-IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr im_str::create_zstr() &&
+template<class Handle>
+IM_STR_CONSTEXPR_IN_CPP_20 inline im_zstr basic_im_str<Handle>::create_zstr() &&
 {
 	if( is_zero_terminated() ) {
-		return im_zstr{ std::move( *this ), is_zero_terminated_tag{} }; // already zero terminated - just move
+		// already zero terminated - just move
+		return im_zstr{ im_str( std::move( *this ) ), im_str::is_zero_terminated_tag{} };
 	} else {
 		return unshare();
 	}
@@ -559,6 +761,13 @@ im_zstr variadic_helper( const ARGS... args )
 	static_assert( ( std::is_same_v<ARGS, std::string_view> && ... ) );
 	const std::size_t newSize = ( 0 + ... + args.size() );
 
+	if( newSize <= im_str::inline_capacity ) {
+		char  small_buffer[im_str::inline_capacity];
+		char* tmp_data_ptr = small_buffer;
+		( addTo( tmp_data_ptr, args ), ... );
+		return im_zstr( std::string_view( small_buffer, newSize ) );
+	}
+
 	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
 		static_cast<int>( newSize ) );
 
@@ -576,6 +785,15 @@ im_zstr range_helper( const T& args )
 			  return s + std::string_view( str ).size();
 		  } );
 
+	if( newSize <= im_str::inline_capacity ) {
+		char  small_buffer[im_str::inline_capacity];
+		char* tmp_data_ptr = small_buffer;
+		for( auto&& e : args ) {
+			addTo( tmp_data_ptr, std::string_view( e ) );
+		}
+		return im_zstr( std::string_view( small_buffer, newSize ) );
+	}
+
 	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
 		static_cast<int>( newSize ) );
 
@@ -595,6 +813,13 @@ im_zstr variadic_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t allo
 	static_assert( ( std::is_same_v<ARGS, std::string_view> && ... ) );
 	const std::size_t newSize = ( 0 + ... + args.size() );
 
+	if( newSize <= im_str::inline_capacity ) {
+		char  small_buffer[im_str::inline_capacity];
+		char* tmp_data_ptr = small_buffer;
+		( addTo( tmp_data_ptr, args ), ... );
+		return im_zstr( std::string_view( small_buffer, newSize ) );
+	}
+
 	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
 		static_cast<int>( newSize ), alloc );
 
@@ -612,6 +837,15 @@ im_zstr range_helper( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc,
 			  return s + std::string_view( str ).size();
 		  } );
 
+	if( newSize <= im_str::inline_capacity ) {
+		char  small_buffer[im_str::inline_capacity];
+		char* tmp_data_ptr = small_buffer;
+		for( auto&& e : args ) {
+			addTo( tmp_data_ptr, std::string_view( e ) );
+		}
+		return im_zstr( std::string_view( small_buffer, newSize ) );
+	}
+
 	auto buffer = ::mba::_detail_im_str::atomic_ref_cnt_buffer::allocate_null_terminated_char_buffer(
 		static_cast<int>( newSize ), alloc );
 
@@ -657,6 +891,7 @@ inline auto concat( _detail_im_str::atomic_ref_cnt_buffer::alloc_ptr_t alloc, co
 }
 
 static_assert( sizeof( im_str ) <= 3 * sizeof( void* ) );
+static_assert( sizeof( local_im_str ) <= 3 * sizeof( void* ) );
 static_assert( sizeof( im_zstr ) <= 3 * sizeof( void* ) );
 
 } // namespace mba
@@ -0,0 +1,207 @@
+#ifndef IM_STR_INTERNING_HPP
+#define IM_STR_INTERNING_HPP
+
+#include "im_str.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <functional> // std::hash
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace mba {
+
+class intern_pool;
+
+/**
+ * Handle to a string in an intern_pool
+ *
+ * All interned_str that have been created for the same content (by the same pool) refer to the same
+ * canonical im_zstr, so comparing and hashing them is just a pointer comparison / hash.
+ * Copying an interned_str doesn't touch a ref count either.
+ *
+ * Interned strings are never removed from their pool, so an interned_str is valid as long as the pool
+ * (for mba::intern: the whole program).
+ */
+class interned_str {
+public:
+	// refers to the empty string (same as the result of interning an empty string with any pool)
+	interned_str() noexcept
+		: _str( &_empty() )
+	{
+	}
+
+	const im_zstr& str() const noexcept { return *_str; }
+
+	std::string_view view() const noexcept { return std::string_view( *_str ); }
+	operator std::string_view() const noexcept { return view(); }
+
+	const char* c_str() const noexcept { return _str->c_str(); }
+	const char* data() const noexcept { return _str->data(); }
+	std::size_t size() const noexcept { return _str->size(); }
+	bool        empty() const noexcept { return _str->empty(); }
+
+	friend bool operator==( const interned_str& l, const interned_str& r ) noexcept { return l._str == r._str; }
+	friend bool operator!=( const interned_str& l, const interned_str& r ) noexcept { return l._str != r._str; }
+
+	std::size_t hash() const noexcept { return std::hash<const void*>{}( _str ); }
+
+private:
+	friend intern_pool;
+
+	explicit interned_str( const im_zstr& str ) noexcept
+		: _str( &str )
+	{
+	}
+
+	static const im_zstr& _empty() noexcept
+	{
+		static const im_zstr empty{};
+		return empty;
+	}
+
+	const im_zstr* _str;
+};
+
+/**
+ * Concurrent pool of canonical strings
+ *
+ * The strings are distributed over multiple shards (by hash), each protected by its own reader-writer lock,
+ * so lookups of strings that are already in the pool only take a shared lock and threads that access
+ * different shards don't contend at all.
+ *
+ * The canonical strings are stored in a deque per shard, so their address (which is used as identity
+ * by interned_str) never changes.
+ */
+class intern_pool {
+public:
+	static constexpr std::size_t default_shard_cnt = 64;
+
+	explicit intern_pool( std::size_t shard_cnt = default_shard_cnt )
+		: _shard_cnt( shard_cnt == 0 ? 1 : shard_cnt )
+		, _shards( std::make_unique<Shard[]>( _shard_cnt ) )
+	{
+	}
+
+	intern_pool( const intern_pool& ) = delete;
+	intern_pool& operator=( const intern_pool& ) = delete;
+
+	// allocates, if the string isn't in the pool yet and doesn't fit into an im_zstr inline
+	interned_str intern( std::string_view str )
+	{
+		return _intern( str, [str] { return im_zstr( str ); } );
+	}
+
+	// doesn't allocate, if str is zero terminated - the pool just keeps a copy of it
+	interned_str intern( const im_str& str )
+	{
+		return _intern( str, [&str] { return str.create_zstr(); } );
+	}
+
+	// NOTE: Use only for string literals (arrays with static storage duration)!!!
+	template<std::size_t N>
+	interned_str intern( const char ( &str )[N] )
+	{
+		return _intern( std::string_view( str ), [&str] { return im_zstr( str ); } );
+	}
+
+	// number of strings in the pool (not counting the empty string)
+	std::size_t size() const
+	{
+		std::size_t ret = 0;
+		for( std::size_t i = 0; i < _shard_cnt; ++i ) {
+			std::shared_lock<std::shared_mutex> lock( _shards[i].mutex );
+			ret += _shards[i].map.size();
+		}
+		return ret;
+	}
+
+private:
+	struct Key {
+		std::string_view str;
+		std::size_t      hash;
+
+		friend bool operator==( const Key& l, const Key& r ) noexcept { return l.str == r.str; }
+	};
+
+	struct KeyHash {
+		std::size_t operator()( const Key& key ) const noexcept { return key.hash; }
+	};
+
+	// aligned to avoid false sharing between the locks of different shards
+	struct alignas( 64 ) Shard {
+		mutable std::shared_mutex                        mutex;
+		std::unordered_map<Key, const im_zstr*, KeyHash> map;
+		std::deque<im_zstr>                              strings;
+	};
+
+	template<class MakeCanonical>
+	interned_str _intern( std::string_view str, MakeCanonical&& make_canonical )
+	{
+		if( str.empty() ) { return interned_str{}; }
+
+		const Key key{ str, std::hash<std::string_view>{}( str ) };
+		Shard&    shard = _shards[key.hash % _shard_cnt];
+
+		{
+			std::shared_lock<std::shared_mutex> lock( shard.mutex );
+			const auto                          it = shard.map.find( key );
+			if( it != shard.map.end() ) { return interned_str( *it->second ); }
+		}
+
+		std::unique_lock<std::shared_mutex> lock( shard.mutex );
+		// another thread might have inserted the string in the meantime
+		const auto it = shard.map.find( key );
+		if( it != shard.map.end() ) { return interned_str( *it->second ); }
+
+		const im_zstr& canonical = shard.strings.emplace_back( make_canonical() );
+		try {
+			shard.map.emplace( Key{ std::string_view( canonical ), key.hash }, &canonical );
+		} catch( ... ) {
+			shard.strings.pop_back();
+			throw;
+		}
+		return interned_str( canonical );
+	}
+
+	std::size_t              _shard_cnt;
+	std::unique_ptr<Shard[]> _shards;
+};
+
+// pool used by mba::intern
+inline intern_pool& default_intern_pool()
+{
+	static intern_pool pool;
+	return pool;
+}
+
+inline interned_str intern( std::string_view str )
+{
+	return default_intern_pool().intern( str );
+}
+
+inline interned_str intern( const im_str& str )
+{
+	return default_intern_pool().intern( str );
+}
+
+// NOTE: Use only for string literals (arrays with static storage duration)!!!
+template<std::size_t N>
+interned_str intern( const char ( &str )[N] )
+{
+	return default_intern_pool().intern( str );
+}
+
+} // namespace mba
+
+namespace std {
+template<>
+struct hash<mba::interned_str> {
+	std::size_t operator()( const mba::interned_str& str ) const noexcept { return str.hash(); }
+};
+} // namespace std
+
+#endif
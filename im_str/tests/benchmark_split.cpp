@@ -39,13 +39,15 @@ std::vector<std::string> generate_random_strings( int cnt )
 	return ret;
 }
 
-im_str::DynArray_t flatten( std::vector<im_str::DynArray_t>& collections )
+// Str is either im_str or local_im_str (non-atomic ref count)
+template<class Str>
+typename Str::DynArray_t flatten( std::vector<typename Str::DynArray_t>& collections )
 {
 	const std::size_t total_size
 		= std::accumulate( collections.begin(), collections.end(), size_t( 0 ), []( size_t size, const auto& e ) {
 			  return size + e.size();
 		  } );
-	im_str::DynArray_t ret( total_size );
+	typename Str::DynArray_t ret( total_size );
 
 	auto out_it = ret.begin();
 
@@ -56,32 +58,85 @@ im_str::DynArray_t flatten( std::vector<im_str::DynArray_t>& collections )
 	return ret;
 }
 
-template<int Algo>
-im_str run( const im_str::DynArray_t& strings, const std::vector<char>& split_chars )
+// Algo 0: split_full on each split char in turn
+// Algo 1: split_any on all split chars at once (same result as Algo 0)
+template<class Str, int Algo>
+im_zstr run( const typename Str::DynArray_t& strings, const std::vector<char>& split_chars )
 {
+	static_assert( 0 <= Algo && Algo < 2, "No algorithm with that number available at the moment" );
+
+	if constexpr( Algo == 1 ) {
+		const std::string_view                delims( split_chars.data(), split_chars.size() );
+		std::vector<typename Str::DynArray_t> tmp( strings.size() );
+
+		size_t i = 0;
+		for( auto&& s : strings ) {
+			tmp[i++] = s.split_any( delims );
+		}
+		return concat( flatten<Str>( tmp ) );
+	}
+
 	auto cstrings = strings;
 	for( char split_char : split_chars ) {
-		std::vector<im_str::DynArray_t> tmp( cstrings.size() );
+		std::vector<typename Str::DynArray_t> tmp( cstrings.size() );
 
 		size_t i = 0;
 
 		for( auto&& s : cstrings ) {
-			static_assert( 0 <= Algo && Algo < 1, "No algorithm with that number available at the moment" );
-			if constexpr( Algo == 0 ) {
-				tmp[i++] = s.split_full( split_char );
-			} /*else {
-				// put other algorithm here
-			} */
+			tmp[i++] = s.split_full( split_char );
 		}
-		cstrings = flatten( tmp );
+		cstrings = flatten<Str>( tmp );
 	}
 
 	return concat( cstrings );
 }
 
-template<int Algo, int Rep = 10, int It = 20>
+/*
+ * Delimiter scanning only (no im_str involved):
+ * the two pass algorithm split_full used before (std::count + repeated find) vs. the single pass
+ * for_each_delimiter with the given instruction set
+ */
+std::size_t scan_two_pass( std::string_view str, char delim )
+{
+	std::size_t sum = static_cast<std::size_t>( std::count( str.begin(), str.end(), delim ) );
+	for( auto pos = str.find( delim ); pos != std::string_view::npos; pos = str.find( delim, pos + 1 ) ) {
+		sum += pos;
+	}
+	return sum;
+}
+
+std::size_t scan_single_pass( std::string_view str, char delim )
+{
+	std::size_t sum = 0;
+	_detail_im_str::for_each_delimiter( str, std::string_view( &delim, 1 ), [&sum]( std::size_t pos ) {
+		sum += pos + 1;
+	} );
+	return sum;
+}
+
+template<bool TwoPass, int It = 200>
+void test_scan( const std::vector<std::string>& strings, const std::vector<char>& split_chars )
+{
+	using namespace std::chrono;
+
+	std::size_t sum   = 0;
+	const auto  start = steady_clock::now();
+	for( int i = 0; i < It; ++i ) {
+		for( const auto& s : strings ) {
+			for( char c : split_chars ) {
+				sum += TwoPass ? scan_two_pass( s, c ) : scan_single_pass( s, c );
+			}
+		}
+	}
+	const auto end = steady_clock::now();
+
+	std::cout << duration_cast<microseconds>( end - start ).count() / It << "us per iteration (checksum " << sum
+			  << ")" << std::endl;
+}
+
+template<class Str, int Algo, int Rep = 10, int It = 20>
 // __declspec(noinline)
-void test_algo( const im_str::DynArray_t& s, const std::vector<char>& split_chars )
+void test_algo( const typename Str::DynArray_t& s, const std::vector<char>& split_chars )
 {
 	using namespace std::chrono;
 	std::vector<int> res( Rep );
@@ -91,7 +146,7 @@ void test_algo( const im_str::DynArray_t& s, const std::vector<char>& split_char
 
 		const auto start = steady_clock::now();
 		for( int i = 0; i < It; ++i ) {
-			run<Algo>( s, split_chars );
+			run<Str, Algo>( s, split_chars );
 		}
 		const auto end = steady_clock::now();
 
@@ -110,30 +165,88 @@ void test_algo( const im_str::DynArray_t& s, const std::vector<char>& split_char
 
 }
 
+/*
+ * Streaming tokenizer: visits each token once
+ * Mode 0: split_full, 1: split_view, 2: split_view_sv
+ */
+template<int Mode, int It = 200>
+void test_tokenize( const im_str::DynArray_t& strings, char split_char )
+{
+	using namespace std::chrono;
+
+	std::size_t sum   = 0;
+	const auto  start = steady_clock::now();
+	for( int i = 0; i < It; ++i ) {
+		for( const auto& s : strings ) {
+			if constexpr( Mode == 0 ) {
+				for( const auto& token : s.split_full( split_char ) ) {
+					sum += token.size();
+				}
+			} else if constexpr( Mode == 1 ) {
+				for( const auto& token : s.split_view( split_char ) ) {
+					sum += token.size();
+				}
+			} else {
+				for( const auto& token : s.split_view_sv( split_char ) ) {
+					sum += token.size();
+				}
+			}
+		}
+	}
+	const auto end = steady_clock::now();
+
+	std::cout << duration_cast<microseconds>( end - start ).count() / It << "us per iteration (checksum " << sum
+			  << ")" << std::endl;
+}
+
 int main()
 {
 	const auto my_strings = generate_random_strings( 200 );
 
-	const std::vector<char> split_chars{ ' ', ':', '/', ';', ',' };
-	im_str::DynArray_t      cstrings( my_strings.size() );
+	const std::vector<char>  split_chars{ ' ', ':', '/', ';', ',' };
+	im_str::DynArray_t       cstrings( my_strings.size() );
+	local_im_str::DynArray_t local_cstrings( my_strings.size() );
 
-	auto it = cstrings.begin();
-	for( const auto& s : my_strings ) {
-		*it = ( im_str( s ) );
-		++it;
+	for( std::size_t i = 0; i < my_strings.size(); ++i ) {
+		cstrings[i]       = im_str( my_strings[i] );
+		local_cstrings[i] = local_im_str( my_strings[i] );
 	}
 
-	test_algo<0>( cstrings, split_chars );
+	using _detail_im_str::simd_isa;
+	const simd_isa    detected = _detail_im_str::detect_simd_isa();
+	const char* const isa_names[] = { "scalar", "sse2", "avx2" };
+
+	std::cout << "Delimiter scanning, two pass (count + find):" << std::endl;
+	test_scan<true>( my_strings, split_chars );
+	for( const auto isa : { simd_isa::scalar, simd_isa::sse2, simd_isa::avx2 } ) {
+		if( isa > detected ) { continue; }
+		_detail_im_str::active_simd_isa() = isa;
+		std::cout << "Delimiter scanning, single pass (" << isa_names[static_cast<int>( isa )] << "):" << std::endl;
+		test_scan<false>( my_strings, split_chars );
+	}
+	std::cout << "========================================================" << std::endl;
+
+	for( const auto isa : { simd_isa::scalar, simd_isa::sse2, simd_isa::avx2 } ) {
+		if( isa > detected ) { continue; }
+		_detail_im_str::active_simd_isa() = isa;
+		std::cout << "im_str split_full (" << isa_names[static_cast<int>( isa )] << "):" << std::endl;
+		test_algo<im_str, 0>( cstrings, split_chars );
+		std::cout << "========================================================" << std::endl;
+	}
+
+	std::cout << "Tokenize, split_full:" << std::endl;
+	test_tokenize<0>( cstrings, ' ' );
+	std::cout << "Tokenize, split_view:" << std::endl;
+	test_tokenize<1>( cstrings, ' ' );
+	std::cout << "Tokenize, split_view_sv:" << std::endl;
+	test_tokenize<2>( cstrings, ' ' );
+	std::cout << "========================================================" << std::endl;
+
+	std::cout << "im_str split_any (" << isa_names[static_cast<int>( detected )] << "):" << std::endl;
+	test_algo<im_str, 1>( cstrings, split_chars );
 	std::cout << "========================================================" << std::endl;
-	// test_algo<2>( cstrings, split_chars );
-	// std::cout << "========================================================" << std::endl;
-	// test_algo<3>( cstrings, split_chars );
-	// std::cout << "========================================================" << std::endl;
-	// test_algo<3>( cstrings, split_chars );
-	// std::cout << "========================================================" << std::endl;
-	// test_algo<2>( cstrings, split_chars );
-	// std::cout << "========================================================" << std::endl;
-	// test_algo<1>( cstrings, split_chars );
-	// std::cout << mba::detail::stats().get_total_allocs() << std::endl;
+	std::cout << "local_im_str split_full (non-atomic ref count, " << isa_names[static_cast<int>( detected )]
+			  << "):" << std::endl;
+	test_algo<local_im_str, 0>( local_cstrings, split_chars );
 	std::cout << "========================================================" << std::endl;
 }
@@ -86,7 +86,7 @@ TEST_CASE( "custom_alloc", "[im_str]" )
 {
 #if IM_STR_USE_ALLOC
 	{ 	// construction from string causes single allocation
-		std::string s{ "Hello World" };
+		std::string s{ "Hello World, this is a long string" };
 		CHECK( alloc.allocs.size() == 0 );
 		mba::im_zstr str( s, &alloc );
 		CHECK( alloc.allocs.size() == 1 );
@@ -97,7 +97,7 @@ TEST_CASE( "custom_alloc", "[im_str]" )
 		CHECK( str2[1] == 'e' );
 
 		// second construction causes second allocation
-		mba::im_zstr str3( std::string_view("Hello World3"), &alloc );
+		mba::im_zstr str3( std::string_view("Hello World3, this is a long string"), &alloc );
 		CHECK( alloc.allocs.size() == 2 );
 
 		// move assignment causes deallocation of original memory
@@ -116,3 +116,54 @@ TEST_CASE( "custom_alloc", "[im_str]" )
 	CHECK( alloc.all_allocs.size() == 2 );
 #endif
 }
+
+TEST_CASE( "small_strings_dont_allocate", "[im_str]" )
+{
+#if IM_STR_USE_ALLOC
+	alloc.all_allocs.clear();
+	{
+		const std::string small( mba::im_str::inline_capacity, 'x' );
+		const std::string big( mba::im_str::inline_capacity + 1, 'y' );
+
+		mba::im_zstr s1( small, &alloc );
+		CHECK( s1.is_stored_inline() );
+		CHECK( !s1.wrapps_a_string_litteral() );
+		CHECK( s1 == small );
+		CHECK( s1.c_str()[s1.size()] == '\0' );
+
+		// copies, moves and substrings of inline strings are inline too
+		mba::im_str s2 = s1;
+		mba::im_str s3 = std::move( s2 );
+		auto        s4 = s3.substr( 2, 3 );
+		CHECK( s3 == small );
+		CHECK( s4 == "xxx" );
+		CHECK( s4.is_stored_inline() );
+		CHECK( s4.is_zero_terminated() );
+
+		mba::im_str words( std::string_view( "ab;cd;e" ), &alloc );
+		const auto  parts = words.split_full( ';' );
+		REQUIRE( parts.size() == 3 );
+		CHECK( parts[1] == "cd" );
+		CHECK( parts[2].is_stored_inline() );
+
+		// small concatenations are stored inline, bigger ones need a single allocation
+		auto c1 = mba::concat( &alloc, "ab", small.substr( 2 ) );
+		CHECK( c1.is_stored_inline() );
+		CHECK( alloc.all_allocs.size() == 0 );
+
+		mba::im_zstr b1( big, &alloc );
+		auto         c2 = mba::concat( &alloc, small, "z" );
+		CHECK( !b1.is_stored_inline() );
+		CHECK( !c2.is_stored_inline() );
+		CHECK( alloc.all_allocs.size() == 2 );
+
+		// substrings of allocated strings keep sharing the buffer, even if they are small
+		auto b2 = b1.substr( 0, 2 );
+		CHECK( !b2.is_stored_inline() );
+		CHECK( b2.data() == b1.data() );
+		CHECK( alloc.all_allocs.size() == 2 );
+	}
+	CHECK( alloc.allocs.size() == 0 );
+#endif
+	CHECK( sizeof( mba::im_str ) <= 3 * sizeof( void* ) );
+}
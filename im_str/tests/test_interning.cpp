@@ -0,0 +1,114 @@
+#include <im_str/interning.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace ::mba;
+
+TEST_CASE( "interning_returns_canonical_strings", "[interned_str]" )
+{
+	intern_pool pool;
+
+	const std::string long_str = "This string is long enough to be allocated on the heap";
+
+	const interned_str s1 = pool.intern( std::string_view( long_str ) );
+	const interned_str s2 = pool.intern( std::string_view( std::string( long_str ) ) );
+	const interned_str s3 = pool.intern( im_str( long_str ) );
+	CHECK( s1 == s2 );
+	CHECK( s1 == s3 );
+	CHECK( s1.data() == s2.data() );
+	CHECK( s1.str() == long_str );
+	CHECK( std::string( s1.c_str() ) == long_str );
+	CHECK( s1.hash() == s2.hash() );
+
+	const interned_str small1 = pool.intern( std::string_view( "small" ) );
+	const interned_str small2 = pool.intern( std::string( "small" ) );
+	const interned_str small3 = pool.intern( "small" );
+	CHECK( small1 == small2 );
+	CHECK( small1 == small3 );
+	CHECK( small1.data() == small2.data() );
+	CHECK( small1 != s1 );
+
+	CHECK( pool.size() == 2 );
+
+	// a different pool has its own canonical instances
+	intern_pool other;
+	CHECK( other.intern( "small" ) != small1 );
+	CHECK( other.intern( "small" ).view() == small1.view() );
+}
+
+TEST_CASE( "interning_empty_and_default", "[interned_str]" )
+{
+	intern_pool pool;
+
+	CHECK( interned_str{} == pool.intern( std::string_view{} ) );
+	CHECK( interned_str{} == pool.intern( "" ) );
+	CHECK( interned_str{}.empty() );
+	CHECK( std::string( interned_str{}.c_str() ).empty() );
+	CHECK( pool.size() == 0 );
+}
+
+TEST_CASE( "interning_reuses_existing_buffers", "[interned_str]" )
+{
+	intern_pool pool;
+
+	const im_zstr      heap( std::string_view( "This string is long enough to be allocated on the heap" ) );
+	const interned_str a = pool.intern( heap );
+	CHECK( a.data() == heap.data() );
+
+	const interned_str lit = pool.intern( "A string literal that is longer than 15 characters" );
+	CHECK( lit.str().wrapps_a_string_litteral() );
+
+	// not zero terminated -> the pool has to make a copy
+	const interned_str sub = pool.intern( heap.substr( 0, 20 ) );
+	CHECK( sub.view() == heap.substr( 0, 20 ) );
+	CHECK( sub.data() != heap.data() );
+}
+
+TEST_CASE( "interning_hash_container", "[interned_str]" )
+{
+	intern_pool pool;
+
+	std::unordered_set<interned_str> set;
+	set.insert( pool.intern( "a" ) );
+	set.insert( pool.intern( std::string( "a" ) ) );
+	set.insert( pool.intern( "b" ) );
+	CHECK( set.size() == 2 );
+	CHECK( set.count( pool.intern( std::string_view( "b" ) ) ) == 1 );
+}
+
+TEST_CASE( "interning_concurrently", "[interned_str]" )
+{
+	intern_pool pool( 8 );
+
+	constexpr int thread_cnt = 8;
+	constexpr int name_cnt   = 500;
+
+	std::vector<std::vector<interned_str>> results( thread_cnt );
+	std::vector<std::thread>               threads;
+	for( int t = 0; t < thread_cnt; ++t ) {
+		threads.emplace_back( [&pool, &result = results[t], t] {
+			for( int i = 0; i < name_cnt; ++i ) {
+				// each thread interns the names in a different order
+				const int n = ( i * 7 + t * 13 ) % name_cnt;
+				result.push_back( pool.intern( "module_name_with_some_length_" + std::to_string( n ) ) );
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+
+	CHECK( pool.size() == name_cnt );
+	for( int t = 0; t < thread_cnt; ++t ) {
+		for( int i = 0; i < name_cnt; ++i ) {
+			const int n = ( i * 7 + t * 13 ) % name_cnt;
+			const auto expected = pool.intern( "module_name_with_some_length_" + std::to_string( n ) );
+			if( results[t][i] != expected ) { FAIL( "different canonical instance for " << expected.view() ); }
+		}
+	}
+}
@@ -0,0 +1,119 @@
+#include <im_str/im_str.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <thread>
+
+using namespace ::mba;
+
+TEST_CASE( "local_im_str_basic", "[local_im_str]" )
+{
+	local_im_str s( std::string( "Hello World, this is a long string" ) );
+	REQUIRE( s == "Hello World, this is a long string" );
+	REQUIRE( !s.is_stored_inline() );
+	REQUIRE( s.is_zero_terminated() );
+
+	const auto sub = s.substr( 6, 5 );
+	REQUIRE( sub == "World" );
+	REQUIRE( sub.data() == s.data() + 6 );
+
+	const auto parts = s.split_full( ' ' );
+	REQUIRE( parts.size() == 7 );
+	REQUIRE( parts[0] == "Hello" );
+	REQUIRE( parts[6] == "string" );
+	REQUIRE( parts[6].data() == s.data() + s.size() - 6 );
+
+	const auto [h, w] = s.split_on_first( ',' );
+	REQUIRE( h == "Hello World" );
+	REQUIRE( w == " this is a long string" );
+
+	const local_im_str small( std::string( "small" ) );
+	REQUIRE( small.is_stored_inline() );
+	REQUIRE( small == "small" );
+}
+
+TEST_CASE( "local_im_str_convert_to_im_str", "[local_im_str]" )
+{
+	const std::string text = "This string is too long to be stored inline";
+
+	SECTION( "shared buffer gets copied" )
+	{
+		local_im_str l( text );
+		local_im_str copy = l;
+
+		im_str s( l );
+		REQUIRE( s == text );
+		REQUIRE( s.data() != l.data() );
+		REQUIRE( s.is_zero_terminated() );
+
+		im_str s2( std::move( copy ) ); // copy isn't the only owner
+		REQUIRE( s2 == text );
+		REQUIRE( s2.data() != l.data() );
+	}
+
+	SECTION( "unique buffer is taken over" )
+	{
+		local_im_str l( text );
+		const char*  data = l.data();
+
+		im_str s( std::move( l ) );
+		REQUIRE( s == text );
+		REQUIRE( s.data() == data );
+		REQUIRE( l.empty() );
+	}
+
+	SECTION( "substring of unique buffer is taken over" )
+	{
+		local_im_str l = local_im_str( text ).substr( 5, 30 );
+		const char*  data = l.data();
+
+		im_str s( std::move( l ) );
+		REQUIRE( s == text.substr( 5, 30 ) );
+		REQUIRE( s.data() == data );
+	}
+
+	SECTION( "literals and inline strings" )
+	{
+		const local_im_str lit = "Hello World";
+		const im_str       s1( lit );
+		REQUIRE( s1.data() == lit.data() );
+		REQUIRE( s1.wrapps_a_string_litteral() );
+
+		const local_im_str small( std::string( "small" ) );
+		const im_str       s2( small );
+		REQUIRE( s2 == "small" );
+		REQUIRE( s2.is_stored_inline() );
+	}
+
+	SECTION( "back to local" )
+	{
+		im_str       s( text );
+		local_im_str l( std::move( s ) );
+		REQUIRE( l == text );
+
+		const im_zstr z = l.create_zstr();
+		REQUIRE( z == text );
+		REQUIRE( z.data() != l.data() );
+	}
+}
+
+TEST_CASE( "local_im_str_hand_over_to_other_thread", "[local_im_str]" )
+{
+	local_im_str l( std::string( "This string is going to be used by a different thread" ) );
+	const auto   parts = l.split_full( ' ' );
+
+	// each converted part has its own buffer, so they can be destroyed concurrently with the local parts
+	im_str::DynArray_t shared( parts.size() );
+	for( std::size_t i = 0; i < parts.size(); ++i ) {
+		shared[i] = im_str( parts[i] );
+	}
+
+	std::thread t( [s = std::move( shared )]() mutable {
+		REQUIRE( s[0] == "This" );
+		s = {};
+	} );
+	t.join();
+
+	REQUIRE( parts[0] == "This" );
+}
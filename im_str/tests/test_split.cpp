@@ -298,3 +298,89 @@ TEST_CASE( "Split_on_first_char", "[im_str]" )
 		CHECK( second == "ello" );
 	}
 }
+
+TEST_CASE( "Split_any", "[im_str]" )
+{
+	im_str s( std::string( "key=value;other key=other value" ) );
+
+	const auto drop = s.split_any( "=;" );
+	REQUIRE( drop.size() == 4 );
+	CHECK( drop[0] == "key" );
+	CHECK( drop[1] == "value" );
+	CHECK( drop[2] == "other key" );
+	CHECK( drop[3] == "other value" );
+
+	const auto before = s.split_any( "=;", im_str::Split::Before );
+	REQUIRE( before.size() == 4 );
+	CHECK( before[1] == "=value" );
+	CHECK( before[2] == ";other key" );
+
+	const auto after = s.split_any( "=;", im_str::Split::After );
+	REQUIRE( after.size() == 4 );
+	CHECK( after[1] == "value;" );
+	CHECK( after[3] == "other value" );
+
+	REQUIRE( s.split_any( "" ).size() == 1 );
+	REQUIRE( s.split_any( "#" )[0] == s );
+}
+
+TEST_CASE( "Split_full_delimiter_at_the_borders", "[im_str]" )
+{
+	im_str s( std::string( ";a;;b;" ) );
+
+	const std::vector<im_str> ref_drop{ "", "a", "", "b", "" };
+	const std::vector<im_str> ref_before{ "", ";a", ";", ";b", ";" };
+	const std::vector<im_str> ref_after{ ";", "a;", ";", "b;", "" };
+
+	const auto drop = s.split_full( ';' );
+	CHECK( std::equal( ref_drop.begin(), ref_drop.end(), drop.begin(), drop.end() ) );
+	const auto before = s.split_full( ';', im_str::Split::Before );
+	CHECK( std::equal( ref_before.begin(), ref_before.end(), before.begin(), before.end() ) );
+	const auto after = s.split_full( ';', im_str::Split::After );
+	CHECK( std::equal( ref_after.begin(), ref_after.end(), after.begin(), after.end() ) );
+}
+
+namespace {
+std::vector<std::string_view> naive_split( std::string_view str, std::string_view delims )
+{
+	std::vector<std::string_view> ret;
+	std::size_t                   start = 0;
+	for( std::size_t i = 0; i <= str.size(); ++i ) {
+		if( i == str.size() || delims.find( str[i] ) != std::string_view::npos ) {
+			ret.push_back( str.substr( start, i - start ) );
+			start = i + 1;
+		}
+	}
+	return ret;
+}
+} // namespace
+
+TEST_CASE( "Split_all_instruction_sets", "[im_str]" )
+{
+	using mba::_detail_im_str::simd_isa;
+	const simd_isa detected = mba::_detail_im_str::detect_simd_isa();
+
+	// long enough for multiple blocks, a remainder and an overflow of the local position buffer
+	std::string base;
+	for( int i = 0; i < 300; ++i ) {
+		base += std::string( static_cast<std::size_t>( i % 37 ), 'x' ) + ( i % 3 ? ";" : "," );
+	}
+
+	for( const auto isa : { simd_isa::scalar, simd_isa::sse2, simd_isa::avx2 } ) {
+		if( isa > detected ) { continue; }
+		mba::_detail_im_str::active_simd_isa() = isa;
+
+		for( std::size_t offset : { 0, 1, 7, 31 } ) {
+			const im_str s = im_str( base ).substr( offset );
+
+			const auto ref_full = naive_split( s, ";" );
+			const auto full     = s.split_full( ';' );
+			CHECK( std::equal( ref_full.begin(), ref_full.end(), full.begin(), full.end() ) );
+
+			const auto ref_any = naive_split( s, ";,x" );
+			const auto any     = s.split_any( ";,x" );
+			CHECK( std::equal( ref_any.begin(), ref_any.end(), any.begin(), any.end() ) );
+		}
+	}
+	mba::_detail_im_str::active_simd_isa() = detected;
+}
@@ -0,0 +1,120 @@
+#include <im_str/im_str.hpp>
+
+#include "include_catch.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace ::mba;
+
+namespace {
+
+template<class Range>
+std::vector<std::string> collect( Range&& range )
+{
+	std::vector<std::string> ret;
+	for( auto&& token : range ) {
+		ret.emplace_back( token );
+	}
+	return ret;
+}
+
+std::vector<std::string> collect_full( const im_str::DynArray_t& parts )
+{
+	return std::vector<std::string>( parts.begin(), parts.end() );
+}
+
+} // namespace
+
+TEST_CASE( "split_view_same_result_as_split_full", "[im_str]" )
+{
+	const std::string long_str = ";Hello my dear;; How are you? I hope you are fine;";
+
+	for( const im_str& s : { im_str( "Hello my dear! How are you?" ), // literal
+							im_str( std::string( "a;b;;c " ) ),     // inline
+							im_str( long_str ),
+							im_str( long_str ).substr( 1 ),
+							im_str() } ) {
+		for( const char delim : { ' ', ';', '#' } ) {
+			for( const auto split : { im_str::Split::Drop, im_str::Split::Before, im_str::Split::After } ) {
+				const auto ref = collect_full( s.split_full( delim, split ) );
+				CHECK( collect( s.split_view( delim, split ) ) == ref );
+				CHECK( collect( s.split_view_sv( delim, split ) ) == ref );
+			}
+		}
+	}
+}
+
+TEST_CASE( "split_view_tokens_share_the_buffer", "[im_str]" )
+{
+	const im_str s( std::string( "This string is long enough to be allocated on the heap" ) );
+
+	std::vector<im_str> tokens;
+	for( im_str token : s.split_view( ' ' ) ) {
+		tokens.push_back( std::move( token ) );
+	}
+	REQUIRE( tokens.size() == 11 );
+	CHECK( tokens[0].data() == s.data() );
+	CHECK( tokens[10] == "heap" );
+	CHECK( tokens[10].data() + tokens[10].size() == s.data() + s.size() );
+
+	// tokens outlive the range and the string
+	const std::string copy( s );
+	{
+		const im_str tmp( copy );
+		tokens.clear();
+		for( im_str token : tmp.split_view( ' ' ) ) {
+			tokens.push_back( std::move( token ) );
+		}
+	}
+	CHECK( tokens[3] == "long" );
+
+	std::vector<std::string_view> views;
+	for( std::string_view token : s.split_view_sv( ' ' ) ) {
+		views.push_back( token );
+	}
+	REQUIRE( views.size() == 11 );
+	CHECK( views[1].data() == s.data() + 5 );
+}
+
+TEST_CASE( "split_view_gives_back_unused_references", "[im_str]" )
+{
+	// a local_im_str can only take over the buffer of an im_str, if the ref count is exactly one
+	std::string str;
+	for( int i = 0; i < 100; ++i ) {
+		str += "token ";
+	}
+
+	im_str      s( str );
+	const char* data = s.data();
+	{
+		std::size_t cnt = 0;
+		for( im_str token : s.split_view( ' ' ) ) {
+			CHECK( token == ( cnt < 100 ? "token" : "" ) );
+			if( ++cnt == 42 ) { break; } // stop early
+		}
+	}
+
+	const local_im_str l( std::move( s ) );
+	CHECK( l.data() == data );
+}
+
+TEST_CASE( "split_view_iterators", "[im_str]" )
+{
+	im_str s( std::string( "one two three" ) );
+	auto   range = s.split_view( ' ' );
+
+	auto it = range.begin();
+	REQUIRE( it != range.end() );
+	CHECK( *it == "one" );
+	CHECK( range.current_view() == "one" );
+	++it;
+	CHECK( *it == "two" );
+	it++;
+	CHECK( *it == "three" );
+	++it;
+	CHECK( it == range.end() );
+	CHECK( range.empty() );
+
+	CHECK( im_str().split_view( ' ' ).empty() );
+}
@@ -42,24 +42,24 @@ namespace mart {
 class [[deprecated( "Use mba::im_str or mba::im_zstr directly" )]] ConstString : public mba::im_str
 {
 public:
-	using im_str::im_str;
+	using mba::im_str::im_str;
 	ConstString( const mba::im_zstr& other )
-		: im_str( static_cast<const mba::im_str&>( other ) )
+		: mba::im_str( static_cast<const mba::im_str&>( other ) )
 	{
 	}
 
 	ConstString( mba::im_zstr && other )
-		: im_str( std::move( static_cast<mba::im_str&&>( other ) ) )
+		: mba::im_str( std::move( static_cast<mba::im_str&&>( other ) ) )
 	{
 	}
 
 	ConstString( const mba::im_str& other )
-		: im_str( other )
+		: mba::im_str( other )
 	{
 	}
 
 	ConstString( mba::im_str && other )
-		: im_str( std::move( other ) )
+		: mba::im_str( std::move( other ) )
 	{
 	}
 
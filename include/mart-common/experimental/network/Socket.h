@@ -16,6 +16,7 @@
 
 /* ######## INCLUDES ######### */
 /* Standard Library Includes */
+#include <utility>
 
 /* Proprietary Library Includes */
 #include "../../ArrayView.h"
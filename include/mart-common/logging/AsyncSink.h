@@ -0,0 +1,420 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_ASYNC_SINK_H
+#define LIB_MART_COMMON_GUARD_LOGGING_ASYNC_SINK_H
+/**
+ * AsyncSink.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	log sink that writes to other sinks from a background thread
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/* Proprietary Library Includes */
+#include <im_str/im_str.hpp>
+
+/* Project Includes */
+#include "../mt/SpscByteRing.h"
+#include "../port_layer.h"
+#include "ILogSink.h"
+#include "SinkConfigs.h"
+#include "buffer_formatter.h"
+#include "deferred_formatter.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+/**
+ * Sink that forwards all messages to a set of target sinks from a background thread
+ *
+ * Every thread that writes to an AsyncSink gets its own lock-free ring buffer (allocated with the first message),
+ * so writing a message is a memcpy and never waits on a mutex or on file I/O
+ * (except when OverflowPolicy::Block is selected and the buffer is full).
+ * A background thread drains all buffers and writes the messages in batches to the targets.
+ * Records created by Logger::log_deferred are stored as they are and only get formatted by the background thread.
+ *
+ * Messages from the same thread keep their order, but there is no ordering guarantee between threads.
+ * flush() blocks until all messages written before the call have been passed to the targets and those have been flushed.
+ * The destructor writes all pending messages before it returns.
+ */
+class AsyncSink final : public ILogSink {
+public:
+	explicit AsyncSink( const AsyncSinkConfig_t& cfg )
+		: ILogSink( cfg.maxLogLvl )
+		, _targets( cfg.targets )
+		, _bufferSize( cfg.perThreadBufferSize )
+		, _overflowPolicy( cfg.overflowPolicy )
+		, _drainInterval( cfg.drainInterval )
+		, _name( _createName( cfg.targets ) )
+	{
+		// synchronization between the threads happens via the per-thread buffers
+		this->enableThreadSafeMode( false );
+		_drainThread = std::thread( [this] { _drainLoop(); } );
+	}
+
+	AsyncSink( const AsyncSink& ) = delete;
+	AsyncSink& operator=( const AsyncSink& ) = delete;
+
+	~AsyncSink() override
+	{
+		{
+			std::lock_guard<std::mutex> lg( _mx );
+			_stop = true;
+		}
+		_cv.notify_all();
+		_drainThread.join();
+
+		// threads that still hold a reference to their buffer will notice that it isn't used anymore
+		for( auto& ring : _rings ) {
+			ring->closed.store( true, std::memory_order_relaxed );
+		}
+	}
+
+	mba::im_zstr getName() const override { return _name; }
+
+	/// Number of messages that have been discarded so far, because the buffer of the logging thread was full
+	std::uint64_t droppedMessageCount() const noexcept { return _totalDrops.load( std::memory_order_relaxed ); }
+
+private:
+	enum class RecordKind : std::uint8_t { Text, Deferred };
+
+	struct RecordHeader {
+		Level      lvl;
+		RecordKind kind;
+	};
+
+	struct Ring {
+		explicit Ring( std::size_t size )
+			: buffer( size )
+		{
+		}
+		mart::mt::SpscByteRing buffer;
+		std::atomic<bool>      orphaned{false}; // the producing thread has terminated
+		std::atomic<bool>      closed{false};   // the sink has been destroyed
+	};
+
+	// per thread list of the buffers used to write to the different AsyncSinks
+	struct ThreadLocalRings {
+		struct Entry {
+			std::uint64_t         sinkId;
+			std::shared_ptr<Ring> ring;
+		};
+		std::vector<Entry> entries;
+
+		~ThreadLocalRings()
+		{
+			for( auto& e : entries ) {
+				e.ring->orphaned.store( true, std::memory_order_release );
+			}
+		}
+	};
+
+	static constexpr std::size_t max_batch_size = 64 * 1024;
+
+	const std::uint64_t                          _id = _nextId();
+	const std::vector<std::shared_ptr<ILogSink>> _targets;
+	const std::size_t                            _bufferSize;
+	const OverflowPolicy                         _overflowPolicy;
+	const std::chrono::milliseconds              _drainInterval;
+	const mba::im_zstr                           _name;
+
+	std::atomic<std::uint64_t> _totalDrops{0};
+	std::atomic<std::uint64_t> _unreportedDrops{0};
+
+	// members protected by _mx
+	std::mutex                         _mx;
+	std::condition_variable            _cv;
+	std::condition_variable            _cvFlushed;
+	std::condition_variable            _cvSpace; // producers that wait for room in their buffer (OverflowPolicy::Block)
+	std::vector<std::shared_ptr<Ring>> _rings;
+	std::uint64_t                      _ringsGeneration  = 0;
+	std::uint64_t                      _flushRequested   = 0;
+	std::uint64_t                      _flushCompleted   = 0;
+	std::size_t                        _blockedProducers = 0;
+	bool                               _drainRequested   = false; // a blocked producer wants the drain thread to wake up
+	bool                               _stop             = false;
+
+	// only accessed by the drain thread
+	std::string        _batch;
+	Level              _batchLvl = Level::TRACE;
+	LogBuffer          _formatBuffer;
+
+	std::thread _drainThread;
+
+	static std::uint64_t _nextId()
+	{
+		static std::atomic<std::uint64_t> id{0};
+		return id.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	static mba::im_zstr _createName( const std::vector<std::shared_ptr<ILogSink>>& targets )
+	{
+		std::vector<mba::im_zstr>     names;
+		std::vector<std::string_view> parts{"Async("};
+		names.reserve( targets.size() );
+		for( const auto& t : targets ) {
+			names.push_back( t->getName() );
+		}
+		for( const auto& n : names ) {
+			if( parts.size() > 1 ) { parts.push_back( "," ); }
+			parts.push_back( n );
+		}
+		parts.push_back( ")" );
+		return mba::concat( parts );
+	}
+
+	static ThreadLocalRings& _threadLocalRings()
+	{
+		thread_local ThreadLocalRings rings;
+		return rings;
+	}
+
+	Ring& _getRing()
+	{
+		for( auto& e : _threadLocalRings().entries ) {
+			if( e.sinkId == _id ) { return *e.ring; }
+		}
+		return _registerRing();
+	}
+
+	LIB_MART_COMMON_NO_INLINE Ring& _registerRing()
+	{
+		auto& entries = _threadLocalRings().entries;
+		// get rid of buffers belonging to sinks that no longer exist
+		entries.erase( std::remove_if( entries.begin(),
+									   entries.end(),
+									   []( const auto& e ) { return e.ring->closed.load( std::memory_order_relaxed ); } ),
+					   entries.end() );
+
+		auto ring = std::make_shared<Ring>( _bufferSize );
+		{
+			std::lock_guard<std::mutex> lg( _mx );
+			_rings.push_back( ring );
+			++_ringsGeneration;
+		}
+		entries.push_back( {_id, ring} );
+		return *ring;
+	}
+
+	void _do_writeToLog( std::string_view msg, Level lvl ) override
+	{
+		_push( RecordHeader{lvl, RecordKind::Text}, msg.data(), msg.size() );
+	}
+
+	bool _do_writeDeferredToLog( mart::ConstMemoryView record, Level lvl ) override
+	{
+		_push( RecordHeader{lvl, RecordKind::Deferred}, record.data(), record.size() );
+		return true;
+	}
+
+	void _push( const RecordHeader header, const void* data, std::size_t size )
+	{
+		auto&             ring       = _getRing().buffer;
+		const std::size_t total_size = sizeof( RecordHeader ) + size;
+
+		auto mem = ring.try_reserve( total_size );
+		if( mem.data() == nullptr ) {
+			if( _overflowPolicy != OverflowPolicy::Block || total_size > ring.max_record_size() ) {
+				_registerDrop();
+				return;
+			}
+			mem = _waitForSpace( ring, total_size );
+		}
+
+		std::memcpy( mem.data(), &header, sizeof( header ) );
+		std::memcpy( mem.data() + sizeof( header ), data, size );
+		ring.commit();
+	}
+
+	mart::MemoryView _waitForSpace( mart::mt::SpscByteRing& ring, std::size_t total_size )
+	{
+		std::unique_lock<std::mutex> ul( _mx );
+		++_blockedProducers;
+		_drainRequested = true;
+		_cv.notify_one();
+		mart::MemoryView mem;
+		_cvSpace.wait( ul, [&] {
+			mem = ring.try_reserve( total_size );
+			return mem.data() != nullptr;
+		} );
+		--_blockedProducers;
+		return mem;
+	}
+
+	// only called when someone bypasses _do_writeToLog
+	void _do_writeToLogImpl( std::string_view msg ) override { _do_writeToLog( msg, Level::TRACE ); }
+
+	void _do_flush() override
+	{
+		std::unique_lock<std::mutex> ul( _mx );
+		const auto                   ticket = ++_flushRequested;
+		_cv.notify_all();
+		_cvFlushed.wait( ul, [&] { return _flushCompleted >= ticket; } );
+	}
+
+	void _registerDrop() noexcept
+	{
+		_totalDrops.fetch_add( 1, std::memory_order_relaxed );
+		if( _overflowPolicy == OverflowPolicy::CountAndDrop ) {
+			_unreportedDrops.fetch_add( 1, std::memory_order_relaxed );
+		}
+	}
+
+	/*##### drain thread #####*/
+
+	void _drainLoop()
+	{
+		std::vector<std::shared_ptr<Ring>> rings;
+		std::uint64_t                      ringsGeneration = 0;
+		std::uint64_t                      flushed         = 0;
+
+		while( true ) {
+			std::uint64_t flushTicket = 0;
+			bool          stop        = false;
+			{
+				std::lock_guard<std::mutex> lg( _mx );
+				flushTicket     = _flushRequested;
+				stop            = _stop;
+				_drainRequested = false;
+				if( ringsGeneration != _ringsGeneration ) {
+					rings           = _rings;
+					ringsGeneration = _ringsGeneration;
+				}
+			}
+
+			const bool drainedSomething = _drainAll( rings );
+			_wakeBlockedProducers();
+
+			if( flushTicket != flushed || stop ) {
+				for( const auto& t : _targets ) {
+					t->flush();
+				}
+				flushed = flushTicket;
+				{
+					std::lock_guard<std::mutex> lg( _mx );
+					_flushCompleted = flushTicket;
+				}
+				_cvFlushed.notify_all();
+			}
+
+			if( stop ) { return; }
+
+			if( !drainedSomething ) {
+				_removeOrphanedRings( rings, ringsGeneration );
+				std::unique_lock<std::mutex> ul( _mx );
+				_cv.wait_for( ul, _drainInterval, [&] { return _stop || _drainRequested || _flushRequested != flushed; } );
+			}
+		}
+	}
+
+	// Producers check for room and start waiting while holding _mx. Checking _blockedProducers only after
+	// the rings have been drained (and under _mx) ensures, that a producer either sees the room made by the
+	// drain or is already waiting when it gets notified.
+	void _wakeBlockedProducers()
+	{
+		bool blocked = false;
+		{
+			std::lock_guard<std::mutex> lg( _mx );
+			blocked = _blockedProducers != 0;
+		}
+		if( blocked ) { _cvSpace.notify_all(); }
+	}
+
+	bool _drainAll( const std::vector<std::shared_ptr<Ring>>& rings )
+	{
+		bool drainedSomething = false;
+		for( const auto& ring : rings ) {
+			drainedSomething |= _drain( ring->buffer );
+		}
+		_writeBatch();
+
+		if( const auto drops = _unreportedDrops.exchange( 0, std::memory_order_relaxed ); drops != 0 ) {
+			const std::string msg
+				= "[AsyncSink] Dropped " + std::to_string( drops ) + " log messages due to full buffers\n";
+			_writeToTargets( msg, Level::ERROR );
+		}
+		return drainedSomething;
+	}
+
+	bool _drain( mart::mt::SpscByteRing& ring )
+	{
+		bool drainedSomething = false;
+		for( auto rec = ring.front(); rec.data() != nullptr; rec = ring.front() ) {
+			drainedSomething = true;
+
+			RecordHeader header;
+			std::memcpy( &header, rec.data(), sizeof( header ) );
+			const auto payload = rec.subview( sizeof( header ) );
+
+			std::string_view msg( payload.asConstCharPtr(), payload.size() );
+			if( header.kind == RecordKind::Deferred ) {
+				_formatBuffer.clear();
+				detail::formatDeferredRecord( _formatBuffer, payload );
+				msg = _formatBuffer.view();
+			}
+
+			if( header.lvl != _batchLvl || _batch.size() + msg.size() > max_batch_size ) { _writeBatch(); }
+			_batchLvl = header.lvl;
+			_batch.append( msg );
+
+			ring.pop();
+		}
+		return drainedSomething;
+	}
+
+	void _writeBatch()
+	{
+		if( _batch.empty() ) { return; }
+		_writeToTargets( _batch, _batchLvl );
+		_batch.clear();
+	}
+
+	void _writeToTargets( std::string_view msg, Level lvl )
+	{
+		for( const auto& t : _targets ) {
+			t->writeToLog( msg, lvl );
+		}
+	}
+
+	void _removeOrphanedRings( std::vector<std::shared_ptr<Ring>>& rings, std::uint64_t& ringsGeneration )
+	{
+		const auto is_done = []( const std::shared_ptr<Ring>& r ) {
+			return r->orphaned.load( std::memory_order_acquire ) && r->buffer.empty();
+		};
+		if( std::none_of( rings.begin(), rings.end(), is_done ) ) { return; }
+
+		std::lock_guard<std::mutex> lg( _mx );
+		_rings.erase( std::remove_if( _rings.begin(), _rings.end(), is_done ), _rings.end() );
+		rings           = _rings;
+		ringsGeneration = ++_ringsGeneration;
+	}
+};
+
+inline std::shared_ptr<ILogSink> makeSink( const AsyncSinkConfig_t& cfg )
+{
+	return std::make_shared<AsyncSink>( cfg );
+}
+
+} // namespace log
+} // namespace mart
+
+#endif
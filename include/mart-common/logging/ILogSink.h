@@ -16,9 +16,16 @@
 
 #include "types.h"
 
+#include "../ArrayView.h"
+#include "../mt/MpscQueue.h"
+
 #include <atomic>
+#include <cstddef>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <string_view>
+#include <thread>
 
 namespace mba {
 class im_zstr;
@@ -26,43 +33,104 @@ class im_zstr;
 
 namespace mart {
 namespace log {
+
+/**
+ * How a sink protects its implementation against concurrent calls of writeToLog / flush
+ *
+ * None:     The sink is either only used from a single thread or synchronizes internally
+ * Mutex:    Every call is executed under a mutex (default)
+ * LockFree: Messages are copied into a lock-free queue. Whichever writer finds no other thread currently
+ *           writing to the sink takes over and writes all queued messages, so writers never wait on each other,
+ *           as long as the queue isn't full. The sink implementation is still only called by one thread at a time.
+ */
+enum class ThreadSafety { None, Mutex, LockFree };
+
 /**
  * Interface which log sinks must implement in order to be compatible with the logger
  */
 class ILogSink {
 public:
+	static constexpr std::size_t default_lock_free_queue_size = 1024;
+
 	ILogSink( Level lvl = Level::TRACE ) noexcept
 		: maxlvl( lvl )
 	{
 	}
 	virtual ~ILogSink() = default;
 
-	void enableThreadSafeMode( bool enable ) noexcept { _threadSafe = enable; }
+	void enableThreadSafeMode( bool enable ) { setThreadSafety( enable ? ThreadSafety::Mutex : ThreadSafety::None ); }
 
-	bool isInThreadSafeMode() const noexcept { return _threadSafe; }
+	bool isInThreadSafeMode() const noexcept { return threadSafety() != ThreadSafety::None; }
+
+	/**
+	 * Must not be called while other threads are writing to the sink.
+	 * @param lockFreeQueueSize number of messages that can be queued in ThreadSafety::LockFree mode
+	 */
+	void setThreadSafety( ThreadSafety mode, std::size_t lockFreeQueueSize = default_lock_free_queue_size )
+	{
+		if( threadSafety() == ThreadSafety::LockFree ) { _drainQueue(); }
+		if( mode == ThreadSafety::LockFree ) {
+			_queue = std::make_unique<mart::mt::MpscQueue<QueuedMessage>>( lockFreeQueueSize );
+		} else {
+			_queue.reset();
+		}
+		_threadSafety = mode;
+	}
+
+	ThreadSafety threadSafety() const noexcept { return _threadSafety.load( std::memory_order_relaxed ); }
 
 	void writeToLog( std::string_view msg, Level lvl )
 	{
 		// only log messages with lower or equal log level (higher importance) than maxlvl
 		if( lvl > maxlvl ) { return; }
 
-		if( _threadSafe ) {
-			std::lock_guard<std::mutex> ul( _mux );
-			_do_writeToLogImpl( msg );
-			if( lvl <= Level::STATUS ) { _do_flush(); }
-		} else {
-			_do_writeToLogImpl( msg );
-			if( lvl <= Level::STATUS ) { _do_flush(); }
+		switch( threadSafety() ) {
+			case ThreadSafety::None: _do_writeToLog( msg, lvl ); break;
+			case ThreadSafety::Mutex: {
+				std::lock_guard<std::mutex> ul( _mux );
+				_do_writeToLog( msg, lvl );
+			} break;
+			case ThreadSafety::LockFree: _enqueue( msg, lvl ); break;
 		}
 	}
 
+	/**
+	 * Writes a binary record created by Logger::log_deferred (see deferred_formatter.h)
+	 *
+	 * Returns false if the sink can't handle such records,
+	 * in which case the caller has to format the message and call writeToLog instead.
+	 */
+	bool writeDeferredToLog( mart::ConstMemoryView record, Level lvl )
+	{
+		return _writeRecord( lvl, [&] { return _do_writeDeferredToLog( record, lvl ); } );
+	}
+
+	/**
+	 * Writes a binary record created by Logger::log_structured (see structured.h)
+	 *
+	 * Returns false if the sink can't handle such records,
+	 * in which case the caller has to format the message and call writeToLog instead.
+	 */
+	bool writeStructuredToLog( mart::ConstMemoryView record, Level lvl )
+	{
+		return _writeRecord( lvl, [&] { return _do_writeStructuredToLog( record, lvl ); } );
+	}
+
+	/// In ThreadSafety::LockFree mode, also writes all queued messages before the sink is flushed
 	void flush()
 	{
-		if( _threadSafe ) {
-			std::lock_guard<std::mutex> ul( _mux );
-			_do_flush();
-		} else {
-			_do_flush();
+		switch( threadSafety() ) {
+			case ThreadSafety::None: _do_flush(); break;
+			case ThreadSafety::Mutex: {
+				std::lock_guard<std::mutex> ul( _mux );
+				_do_flush();
+			} break;
+			case ThreadSafety::LockFree:
+				_runAsConsumer( [&] {
+					_drainQueue();
+					_do_flush();
+				} );
+				break;
 		}
 	};
 
@@ -72,12 +140,120 @@ public:
 	std::atomic<Level> maxlvl;
 
 private:
-	std::mutex        _mux;
-	std::atomic<bool> _threadSafe{true};
+	struct QueuedMessage {
+		std::string msg;
+		Level       lvl = Level::TRACE;
+	};
+
+	std::mutex                                           _mux;
+	std::atomic<ThreadSafety>                            _threadSafety{ThreadSafety::Mutex};
+	std::unique_ptr<mart::mt::MpscQueue<QueuedMessage>> _queue;
+	std::atomic<bool>                                    _consumerActive{false};
+
+	void _enqueue( std::string_view msg, Level lvl )
+	{
+		const auto fill = [&]( QueuedMessage& slot ) {
+			slot.msg.assign( msg.data(), msg.size() );
+			slot.lvl = lvl;
+		};
+		while( !_queue->try_push( fill ) ) {
+			// queue is full -> help emptying it
+			if( !_tryConsume() ) { std::this_thread::yield(); }
+		}
+		_tryConsume();
+	}
+
+	template<class F>
+	bool _writeRecord( Level lvl, F&& write )
+	{
+		if( lvl > maxlvl ) { return true; }
+
+		switch( threadSafety() ) {
+			case ThreadSafety::None: return write();
+			case ThreadSafety::Mutex: {
+				std::lock_guard<std::mutex> ul( _mux );
+				return write();
+			}
+			case ThreadSafety::LockFree: {
+				// keep the order with respect to already queued messages
+				bool ret = false;
+				_runAsConsumer( [&] {
+					_drainQueue();
+					ret = write();
+				} );
+				return ret;
+			}
+		}
+		return false;
+	}
+
+	struct ConsumerGuard {
+		std::atomic<bool>& active;
+		~ConsumerGuard() { active.store( false ); }
+	};
+
+	// Writes queued messages, unless another thread is already doing it. Returns false in that case
+	bool _tryConsume()
+	{
+		bool consumed = false;
+		while( !_consumerActive.exchange( true ) ) {
+			consumed = true;
+			bool        wroteAny{};
+			std::size_t popCount{};
+			{
+				ConsumerGuard _{_consumerActive};
+				wroteAny = _drainQueue();
+				popCount = _queue->pop_count();
+			}
+
+			// Threads that pushed a message while we were the consumer couldn't take over,
+			// so we have to make sure those messages get written, too
+			if( _queue->push_count() == popCount ) { break; }
+			if( !wroteAny ) { std::this_thread::yield(); } // some push is still in progress
+		}
+		return consumed;
+	}
+
+	template<class F>
+	void _runAsConsumer( F&& f )
+	{
+		while( _consumerActive.exchange( true ) ) {
+			std::this_thread::yield();
+		}
+		{
+			ConsumerGuard _{_consumerActive};
+			f();
+		}
+		_tryConsume();
+	}
+
+	// must only be called by the consumer
+	bool _drainQueue()
+	{
+		if( !_queue ) { return false; }
+		bool wroteAny = false;
+		while( _queue->try_pop( [this]( QueuedMessage& m ) { _do_writeToLog( m.msg, m.lvl ); } ) ) {
+			wroteAny = true;
+		}
+		return wroteAny;
+	}
 
 	/// actual logging function that has to be implemented by sinks
 	virtual void _do_writeToLogImpl( std::string_view msg ) = 0;
 	virtual void _do_flush()                                = 0;
+
+	/// can be overridden by sinks that need to know the level of each message (e.g. to forward it to other sinks)
+	virtual void _do_writeToLog( std::string_view msg, Level lvl )
+	{
+		_do_writeToLogImpl( msg );
+		if( lvl <= Level::STATUS ) { _do_flush(); }
+	}
+
+	/// can be overridden by sinks that can store or forward deferred records without formatting them first
+	virtual bool _do_writeDeferredToLog( mart::ConstMemoryView, Level ) { return false; }
+
+	/// can be overridden by sinks that can store or forward structured records without formatting them first
+	virtual bool _do_writeStructuredToLog( mart::ConstMemoryView, Level ) { return false; }
 };
 } // namespace log
 } // namespace mart
@@ -39,7 +39,12 @@
 #include "ILogSink.h"
 #include "LoggerConfig.h"
 #include "MartLogFWD.h"
+#include "ModuleRegistry.h"
+#include "RateLimit.h"
+#include "buffer_formatter.h"
 #include "default_formatter.h"
+#include "deferred_formatter.h"
+#include "structured.h"
 #include "types.h"
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -80,14 +85,16 @@ public:
 	 * Normal constructor only requiring a module name
 	 * @param moduleName Name of the module by which the logger is used (this will be printed at the beginning of each
 	 * line in the log)
+	 * @param logLvl Initial level of the module. Ignored if the module is already registered (e.g. by another
+	 * logger or the logger config), so creating a logger doesn't change the level of existing loggers
 	 */
 	Logger( const std::string_view moduleName, Level logLvl = defaultLogLevel )
 		: _startTime{mart::now()}
-		, _currentLogLevel{logLvl}
 		, _enabled{true}
 		, _sinks{}
 		, _loggingName( _createLoggingName( moduleName ) )
 	{
+		_attachToModule( logLvl );
 	}
 
 	/**
@@ -110,7 +117,8 @@ public:
 	/**
 	 * Constructs logger from parent logger.
 	 *
-	 * Copies all settings and adds submodule name
+	 * Copies all settings and adds submodule name.
+	 * If the submodule isn't registered yet, it starts with the current level of the parent module
 	 * @param moduleName
 	 * @param other
 	 */
@@ -118,6 +126,7 @@ public:
 		: Logger( other )
 	{
 		_loggingName = _createLoggingName( subModuleName, other._loggingName );
+		_attachToModule( other.getLogLevel() );
 	}
 
 	Logger( const Logger& other )     = default;
@@ -196,6 +205,110 @@ public:
 		_writeBufferToSinks( lvl );
 	}
 
+	/**
+	 * Same output as log( site.lvl, args... ), but arguments are only copied into a binary record here.
+	 * Formatting happens in sinks that support deferred records (e.g. in the background thread of an AsyncSink)
+	 * or, for all other sinks, immediately.
+	 *
+	 * Only strings, memory views (their content is copied) and trivially copyable types are supported as arguments (see MART_LOG_DEFERRED)
+	 */
+	template<class... ARGS>
+	inline void log_deferred( const LogSite& site, ARGS&&... args )
+	{
+		if( !_shouldBeLogged( site.lvl ) ) return;
+
+		log_deferred_impl( site, detail::forward_as_string_view_if_possible( args )... );
+	}
+
+	template<class... ARGS>
+	LIB_MART_COMMON_NO_INLINE void log_deferred_impl( const LogSite& site, const ARGS&... args )
+	{
+		auto&      buffer = detail::deferredRecordBuffer();
+		const auto size   = detail::deferredRecordSize( _loggingName, args... );
+		if( size > buffer.size() ) {
+			log_impl( site.lvl, args... );
+			return;
+		}
+
+		detail::DeferredRecordHeader header{};
+		header.site         = &site;
+		header.sinceStart   = mart::now() - _startTime;
+		header.withThreadId = getLogLevel() == Level::TRACE;
+		header.threadId     = std::this_thread::get_id();
+		header.spacer       = _spacer;
+		detail::encodeDeferredRecord( buffer.data(), header, _loggingName, args... );
+
+		const mart::ConstMemoryView record( buffer.data(), size );
+
+		// sinks that can't handle deferred records get the formatted text
+		LogBuffer& text = _sbuffer();
+		for( const auto& se : _sinks ) {
+			if( se->writeDeferredToLog( record, site.lvl ) ) { continue; }
+			if( text.empty() ) { detail::formatDeferredRecord( text, record ); }
+			se->writeToLog( text.view(), site.lvl );
+		}
+		text.clear();
+	}
+
+	/**
+	 * Logs a message with typed key/value fields, e.g.
+	 *
+	 *     logger.log_structured( Level::STATUS, "request done", field( "id", id ), field( "duration", dt ) );
+	 *
+	 * Sinks that support structured records (e.g. mart::nw::log::DatagramLogSink) get the fields as a binary record
+	 * (see structured.h), all other sinks get the text "<message> id=<id> duration=<dt>".
+	 * Supported field types: integers, floating point numbers, bool, std::chrono::duration, strings
+	 * and enums (written as mart::to_string_view(value)).
+	 */
+	template<class... T>
+	inline void log_structured( Level lvl, std::string_view message, const Field<T>&... fields )
+	{
+		if( !_shouldBeLogged( lvl ) ) return;
+
+		log_structured_impl( lvl, message, fields... );
+	}
+
+	template<class... T>
+	LIB_MART_COMMON_NO_INLINE void log_structured_impl( Level lvl, std::string_view message, const Field<T>&... fields )
+	{
+		auto&      buffer = detail::structuredRecordBuffer();
+		const auto size   = detail::structuredRecordSize( _loggingName, message, fields... );
+		if( size > buffer.size() ) {
+			log_impl( lvl, message, fields... );
+			return;
+		}
+		encodeStructuredRecord(
+			buffer.data(), lvl, RecordKind::Structured, detail::structuredTimestamp(), _loggingName, message, fields... );
+
+		const mart::ConstMemoryView record( buffer.data(), size );
+
+		// sinks that can't handle structured records get the formatted text
+		LogBuffer& text = _sbuffer();
+		for( const auto& se : _sinks ) {
+			if( se->writeStructuredToLog( record, lvl ) ) { continue; }
+			if( text.empty() ) { _fillBuffer( lvl, AddNewline::Yes, message, fields... ); }
+			se->writeToLog( text.view(), lvl );
+		}
+		text.clear();
+	}
+
+	/**
+	 * Same as log( site.lvl, args... ), but only if @p limiter (TokenBucketLimiter, EveryNLimiter, FirstNLimiter)
+	 * lets the message through. Suppressed messages are reported as "Suppressed K messages from <file>:<line>".
+	 *
+	 * The limiter is only consulted if the level is enabled, and before anything gets formatted
+	 * (see MART_LOG_RATE_LIMITED, MART_LOG_EVERY_N, MART_LOG_FIRST_N)
+	 */
+	template<class Limiter, class... ARGS>
+	inline void log_limited( const LogSite& site, Limiter& limiter, ARGS&&... args )
+	{
+		if( !_shouldBeLogged( site.lvl ) ) return;
+
+		const RateLimitResult res = limiter.check();
+		if( res.suppressed != 0 ) { _logSuppressed( site, res.suppressed ); }
+		if( res.pass ) { log_impl( site.lvl, detail::forward_as_string_view_if_possible( args )... ); }
+	}
+
 	template<class... ARGS>
 	inline void error_msg( ARGS&&... args )
 	{
@@ -223,10 +336,20 @@ public:
 	/* ### Change logging behavior #### */
 	/**
 	 * Gets the highest (TRACE > ERROR) log level with which messages are currently written to log
+	 *
+	 * The level belongs to the module (see ModuleRegistry), so setting it affects all loggers with the same name,
+	 * including copies of this logger
 	 * @return current log level
 	 */
-	Level getLogLevel() const noexcept { return _currentLogLevel.load( std::memory_order_relaxed ); }
-	void  setLogLevel( Level lvl ) noexcept { _currentLogLevel.store( lvl, std::memory_order_relaxed ); }
+	Level getLogLevel() const noexcept { return _currentLogLevel->load( std::memory_order_relaxed ); }
+	void  setLogLevel( Level lvl ) noexcept { _currentLogLevel->store( lvl, std::memory_order_relaxed ); }
+
+	/**
+	 * Sets the log level of this module and all submodules (loggers created via make_child, also indirectly)
+	 */
+	void setSubtreeLogLevel( Level lvl ) { ModuleRegistry::instance().setSubtreeLevel( _loggingName, lvl ); }
+
+	ModuleId getModuleId() const noexcept { return _moduleId; }
 
 	/**
 	 * Enables or disables logging, without changing log level - currently only way to prevent logging of errors
@@ -236,7 +359,11 @@ public:
 	void disable() noexcept { enable( false ); }
 	bool isEnabled() const noexcept { return _enabled; }
 
-	void setName( const std::string_view name ) { _loggingName = _createLoggingName( name ); }
+	void setName( const std::string_view name )
+	{
+		_loggingName = _createLoggingName( name );
+		_attachToModule( getLogLevel() );
+	}
 
 	/* ### Change sinks ###*/
 	void addSink( std::shared_ptr<ILogSink> sink )
@@ -294,9 +421,10 @@ public:
 
 private:
 	/*### Variables controlling logging behavior ###*/
-	mart::copter_time_point     _startTime;
-	mart::CopyableAtomic<Level> _currentLogLevel;
-	mart::CopyableAtomic<bool>  _enabled;
+	mart::copter_time_point    _startTime;
+	ModuleId                   _moduleId        = ModuleRegistry::overflow_id;
+	std::atomic<Level>*        _currentLogLevel = nullptr; // slot of the module in the ModuleRegistry
+	mart::CopyableAtomic<bool> _enabled;
 
 	std::vector<std::shared_ptr<ILogSink>> _sinks;
 
@@ -307,10 +435,10 @@ private:
 	static constexpr std::string_view space_string_litteral
 		= "                                                                                                         ";
 
-	static std::ostringstream& _sbuffer()
+	static LogBuffer& _sbuffer()
 	{
-		thread_local std::ostringstream stream;
-		return stream;
+		thread_local LogBuffer buffer;
+		return buffer;
 	}
 
 	// checks if a message  with priority <lvl> should be logged or not
@@ -319,7 +447,20 @@ private:
 	{
 		// TODO: look at log Level of attached logger?
 		return _enabled.load( std::memory_order_relaxed )
-			   && ( lvl <= _currentLogLevel.load( std::memory_order_relaxed ) );
+			   && ( lvl <= _currentLogLevel->load( std::memory_order_relaxed ) );
+	}
+
+	// @p initialLvl is only used, if the module isn't registered yet
+	void _attachToModule( Level initialLvl )
+	{
+		auto& registry   = ModuleRegistry::instance();
+		_moduleId        = registry.resolve( _loggingName, initialLvl );
+		_currentLogLevel = &registry.levelSlot( _moduleId );
+	}
+
+	LIB_MART_COMMON_NO_INLINE void _logSuppressed( const LogSite& site, std::uint64_t cnt )
+	{
+		log_impl( site.lvl, "Suppressed ", cnt, " messages from ", site.file, ":", site.line );
 	}
 
 	static mba::im_zstr _createLoggingName( const std::string_view moduleName, const std::string_view parentName = {} )
@@ -331,32 +472,31 @@ private:
 	template<class... ARGS>
 	void _fillBuffer( Level lvl, AddNewline newLine, ARGS&&... args )
 	{
-		std::ostream& buffer = _sbuffer();
-		// line prefix
-		formatForLog(
-			buffer, lvl, " - At ", std::setw( 7 ), passedTime<milliseconds>( _startTime ), " - ", _loggingName, ": " );
-
-		// Add thread Id and spacer in trace mode
-		if( _currentLogLevel == Level::TRACE ) {
-			ostream_flag_saver _( buffer );
-			formatForLog( buffer, "[ThreadID: ", std::this_thread::get_id(), "]: ", _spacer );
-		}
+		LogBuffer& buffer = _sbuffer();
+		// line prefix (+ thread Id and spacer in trace mode)
+		detail::formatLinePrefix( buffer,
+								  lvl,
+								  passedTime<milliseconds>( _startTime ),
+								  _loggingName,
+								  getLogLevel() == Level::TRACE,
+								  std::this_thread::get_id(),
+								  _spacer );
 
 		// write actual message
 		formatForLog( buffer, args... );
 
 		// Append new line if requested
-		if( newLine == AddNewline::Yes ) { buffer << '\n'; }
+		if( newLine == AddNewline::Yes ) { buffer.append( '\n' ); }
 	}
 
-	// write contents to all registered log sinks and reset buffer
+	// write contents to all registered log sinks and reset buffer (the memory is kept for the next message)
 	void _writeBufferToSinks( Level lvl )
 	{
-		auto text = _sbuffer().str();
-		_sbuffer().str( std::string{} );
+		LogBuffer& buffer = _sbuffer();
 		for( const auto& se : _sinks ) {
-			se->writeToLog( text, lvl );
+			se->writeToLog( buffer.view(), lvl );
 		}
+		buffer.clear();
 	}
 };
 
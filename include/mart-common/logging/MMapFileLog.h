@@ -0,0 +1,337 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_MMAP_FILE_LOG_H
+#define LIB_MART_COMMON_GUARD_LOGGING_MMAP_FILE_LOG_H
+/**
+ * MMapFileLog.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	log sink that writes into memory mapped, rotating segment files (POSIX only)
+ *
+ */
+
+#if !__has_include( <sys/mman.h> )
+#error "MMapFileLog is only available on POSIX systems"
+#endif
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Proprietary Library Includes */
+#include <im_str/im_str.hpp>
+
+/* Project Includes */
+#include "../port_layer.h"
+#include "ILogSink.h"
+#include "SinkConfigs.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+/**
+ * File sink that copies messages into a memory mapped, pre-sized segment file
+ *
+ * Writing a message reserves space by incrementing an atomic cursor and copies the text - there is no lock and
+ * no syscall involved, so the sink can be used from multiple threads concurrently (thread safe mode is disabled).
+ * When a segment is full, the next one is created (<fileName>.0, <fileName>.1, ...), the old one gets truncated
+ * to its actual content and, if maxSegments is set, the oldest segment file is deleted.
+ *
+ * Messages are not flushed per line. Instead the content is synced to disk (msync) when the last sync is longer
+ * ago than syncInterval, on flush() and when a segment is closed. As the file is mapped, the content is visible to
+ * other processes (and survives a crash of this process) right away.
+ * While a segment is in use, the part behind the written messages is filled with '\0'.
+ *
+ * Existing segment files with the same names are overwritten.
+ */
+class MMapFileLog final : public ILogSink {
+public:
+	explicit MMapFileLog( const MMapFileLogConfig_t& cfg )
+		: ILogSink( cfg.maxLogLvl )
+		, _fileName( cfg.fileName )
+		, _segmentSize( std::max( cfg.segmentSize, min_segment_size ) )
+		, _maxSegments( cfg.maxSegments )
+		, _syncInterval( cfg.syncInterval )
+	{
+		// synchronization happens via the atomic write cursor
+		this->enableThreadSafeMode( false );
+
+		std::lock_guard<std::mutex> lg( _rotationMx );
+		auto                        segment = _openSegment( 0 );
+		if( !segment ) {
+			throw std::system_error(
+				errno, std::generic_category(), "[MMapFileLog] Failed to create " + segmentFileName( 0 ) );
+		}
+		_current.store( segment.get(), std::memory_order_release );
+		_segments.push_back( std::move( segment ) );
+		_nextSync.store( _now() + _syncInterval.count(), std::memory_order_relaxed );
+	}
+
+	MMapFileLog( const MMapFileLog& ) = delete;
+	MMapFileLog& operator=( const MMapFileLog& ) = delete;
+
+	~MMapFileLog() override
+	{
+		if( Segment* seg = _current.load( std::memory_order_acquire ) ) {
+			_closeSegment( *seg, seg->committed.load( std::memory_order_acquire ) );
+		}
+	}
+
+	mba::im_zstr getName() const override { return _fileName; }
+
+	/// Name of the file the segment with the given index is written to
+	std::string segmentFileName( std::uint64_t index ) const
+	{
+		return std::string( std::string_view( _fileName ) ) + '.' + std::to_string( index );
+	}
+
+	/// Index of the segment that is currently written to
+	std::uint64_t currentSegmentIndex() const noexcept { return _lastIndex.load( std::memory_order_acquire ); }
+
+	/// Number of messages that have been discarded so far, because a new segment couldn't be created
+	std::uint64_t droppedMessageCount() const noexcept { return _drops.load( std::memory_order_relaxed ); }
+
+private:
+	static constexpr std::size_t min_segment_size = 4096;
+
+	struct Segment {
+		std::uint64_t            index = 0;
+		int                      fd    = -1;
+		char*                    data  = nullptr;
+		std::size_t              size  = 0;
+		std::atomic<std::size_t> cursor{0};    // end of the reserved space (may grow beyond size)
+		std::atomic<std::size_t> committed{0}; // number of bytes that have actually been copied
+	};
+
+	const mba::im_zstr              _fileName;
+	const std::size_t               _segmentSize;
+	const std::size_t               _maxSegments;
+	const std::chrono::milliseconds _syncInterval;
+
+	std::atomic<Segment*>      _current{nullptr};
+	std::atomic<std::size_t>   _activeWriters{0};
+	std::atomic<std::uint64_t> _lastIndex{0};
+	std::atomic<std::uint64_t> _drops{0};
+	std::atomic<std::int64_t>  _nextSync{0}; // in ms since the epoch of the steady_clock
+
+	// The current segment (last entry) and closed segments, which a writer might still access through a pointer it
+	// loaded before the rotation. The file of a segment gets unmapped and closed when the segment is full, the
+	// Segment object is destroyed once no other writer is active (see _releaseClosedSegments).
+	std::mutex                            _rotationMx;
+	std::vector<std::unique_ptr<Segment>> _segments;
+
+	static std::int64_t _now() noexcept
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+				   std::chrono::steady_clock::now().time_since_epoch() )
+			.count();
+	}
+
+	void _do_writeToLogImpl( std::string_view msg ) override
+	{
+		if( msg.empty() ) { return; }
+		_write( msg );
+		_syncIfDue();
+	}
+
+	// no flush per message - syncing happens based on time
+	void _do_writeToLog( std::string_view msg, Level ) override { _do_writeToLogImpl( msg ); }
+
+	void _do_flush() override
+	{
+		std::lock_guard<std::mutex> lg( _rotationMx );
+		_syncCurrent();
+		_releaseClosedSegments( 0 );
+	}
+
+	struct WriterGuard {
+		explicit WriterGuard( std::atomic<std::size_t>& cnt ) noexcept
+			: _cnt( cnt )
+		{
+			_cnt.fetch_add( 1, std::memory_order_seq_cst );
+		}
+		~WriterGuard() { _cnt.fetch_sub( 1, std::memory_order_release ); }
+		std::atomic<std::size_t>& _cnt;
+	};
+
+	void _write( std::string_view msg )
+	{
+		// Registering as writer before loading _current (both seq_cst) ensures, that a rotation either sees this
+		// writer or this writer sees the new segment
+		WriterGuard wg( _activeWriters );
+		while( true ) {
+			Segment* seg = _current.load( std::memory_order_seq_cst );
+			if( seg == nullptr ) {
+				// a previous rotation failed
+				if( !_rotate( nullptr, 0, msg.size() ) ) {
+					_drops.fetch_add( 1, std::memory_order_relaxed );
+					return;
+				}
+				continue;
+			}
+
+			const std::size_t pos = seg->cursor.fetch_add( msg.size(), std::memory_order_relaxed );
+			if( pos + msg.size() <= seg->size ) {
+				std::memcpy( seg->data + pos, msg.data(), msg.size() );
+				seg->committed.fetch_add( msg.size(), std::memory_order_release );
+				return;
+			}
+
+			if( pos <= seg->size ) {
+				// this is the only reservation that crosses the end of the segment -> pos is the end of the content
+				if( !_rotate( seg, pos, msg.size() ) ) {
+					_drops.fetch_add( 1, std::memory_order_relaxed );
+					return;
+				}
+			} else {
+				_waitForRotation( seg );
+			}
+		}
+	}
+
+	LIB_MART_COMMON_NO_INLINE void _waitForRotation( const Segment* seg )
+	{
+		while( _current.load( std::memory_order_acquire ) == seg ) {
+			std::this_thread::yield();
+		}
+	}
+
+	// Replaces old (if it is still the current segment) by a new segment that can hold at least requiredSize bytes
+	LIB_MART_COMMON_NO_INLINE bool _rotate( Segment* old, std::size_t contentSize, std::size_t requiredSize )
+	{
+		std::lock_guard<std::mutex> lg( _rotationMx );
+		if( _current.load( std::memory_order_relaxed ) != old ) { return true; }
+
+		std::uint64_t index = 0;
+		if( old != nullptr ) {
+			// wait until all writes into the old segment have completed
+			while( old->committed.load( std::memory_order_acquire ) != contentSize ) {
+				std::this_thread::yield();
+			}
+			_closeSegment( *old, contentSize );
+			index = old->index + 1;
+		} else {
+			index = _lastIndex.load( std::memory_order_relaxed ) + 1;
+		}
+
+		auto segment = _openSegment( index, requiredSize );
+		_lastIndex.store( index, std::memory_order_relaxed );
+		if( !segment ) {
+			_current.store( nullptr, std::memory_order_release );
+			return false;
+		}
+
+		if( _maxSegments != 0 && index >= _maxSegments ) {
+			std::remove( segmentFileName( index - _maxSegments ).c_str() );
+		}
+
+		_current.store( segment.get(), std::memory_order_seq_cst );
+		_segments.push_back( std::move( segment ) );
+		// the calling thread is a writer itself
+		_releaseClosedSegments( 1 );
+		return true;
+	}
+
+	// must only be called while holding _rotationMx and after _current has been updated
+	void _releaseClosedSegments( std::size_t ownWriters )
+	{
+		if( _segments.size() <= 1 || _activeWriters.load( std::memory_order_seq_cst ) != ownWriters ) { return; }
+		// Writers that start from now on load the current segment, so none can access a closed one anymore
+		const Segment* current = _current.load( std::memory_order_relaxed );
+		_segments.erase( std::remove_if( _segments.begin(),
+										 _segments.end(),
+										 [current]( const auto& seg ) { return seg.get() != current; } ),
+						 _segments.end() );
+	}
+
+	std::unique_ptr<Segment> _openSegment( std::uint64_t index, std::size_t requiredSize = 0 )
+	{
+		auto seg   = std::make_unique<Segment>();
+		seg->index = index;
+		seg->size  = std::max( _segmentSize, requiredSize );
+
+		const auto name = segmentFileName( index );
+		seg->fd         = ::open( name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+		if( seg->fd < 0 ) { return nullptr; }
+
+		if( ::ftruncate( seg->fd, static_cast<off_t>( seg->size ) ) != 0 ) {
+			::close( seg->fd );
+			return nullptr;
+		}
+
+		void* mem = ::mmap( nullptr, seg->size, PROT_READ | PROT_WRITE, MAP_SHARED, seg->fd, 0 );
+		if( mem == MAP_FAILED ) {
+			::close( seg->fd );
+			return nullptr;
+		}
+		seg->data = static_cast<char*>( mem );
+		return seg;
+	}
+
+	static void _closeSegment( Segment& seg, std::size_t contentSize )
+	{
+		if( seg.data == nullptr ) { return; }
+		if( contentSize != 0 ) { ::msync( seg.data, contentSize, MS_SYNC ); }
+		::munmap( seg.data, seg.size );
+		seg.data = nullptr;
+
+		// remove the unused, zero filled part at the end
+		(void)::ftruncate( seg.fd, static_cast<off_t>( contentSize ) );
+		::fdatasync( seg.fd );
+		::close( seg.fd );
+		seg.fd = -1;
+	}
+
+	void _syncIfDue()
+	{
+		const auto now = _now();
+		if( now < _nextSync.load( std::memory_order_relaxed ) ) { return; }
+
+		// if another thread is already syncing or rotating, there is no need to do it again
+		std::unique_lock<std::mutex> ul( _rotationMx, std::try_to_lock );
+		if( !ul.owns_lock() ) { return; }
+		_nextSync.store( now + _syncInterval.count(), std::memory_order_relaxed );
+		_syncCurrent();
+	}
+
+	// must only be called while holding _rotationMx
+	void _syncCurrent()
+	{
+		const Segment* seg = _current.load( std::memory_order_relaxed );
+		if( seg == nullptr ) { return; }
+		const std::size_t size = std::min( seg->committed.load( std::memory_order_acquire ), seg->size );
+		if( size != 0 ) { ::msync( seg->data, size, MS_SYNC ); }
+	}
+};
+
+inline std::shared_ptr<ILogSink> makeSink( const MMapFileLogConfig_t& cfg )
+{
+	return std::make_shared<MMapFileLog>( cfg );
+}
+
+} // namespace log
+} // namespace mart
+
+#endif
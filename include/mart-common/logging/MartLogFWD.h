@@ -44,6 +44,44 @@
 
 #define MART_DEFLOG ( ::mart::log::Logger::getDefaultLogger() )
 
+/**
+ * Same as ( LOGGER ).log( LVL, ... ), but the arguments (only strings and trivially copyable types)
+ * are just copied into a binary record and formatted later - see Logger::log_deferred
+ */
+#define MART_LOG_DEFERRED( LOGGER, LVL, ... )                                                                          \
+	do {                                                                                                               \
+		static constexpr ::mart::log::LogSite mart_log_site_{LVL, __FILE__, __LINE__};                                 \
+		( LOGGER ).log_deferred( mart_log_site_, __VA_ARGS__ );                                                        \
+	} while( false )
+
+/**
+ * Rate limited / sampled versions of ( LOGGER ).log( LVL, ... ) (see Logger::log_limited).
+ * Every call site has its own (static) state, which is shared by all loggers used at that site.
+ * The number of suppressed messages is reported periodically and before the next message that gets through.
+ *
+ * MART_LOG_RATE_LIMITED: at most BURST messages at once, refilled with MSGS_PER_SEC (token bucket)
+ * MART_LOG_EVERY_N:      the first and then every N-th message
+ * MART_LOG_FIRST_N:      only the first N messages
+ */
+#define MART_LOG_RATE_LIMITED( LOGGER, LVL, MSGS_PER_SEC, BURST, ... )                                                 \
+	do {                                                                                                               \
+		static constexpr ::mart::log::LogSite  mart_log_site_{LVL, __FILE__, __LINE__};                                \
+		static ::mart::log::TokenBucketLimiter mart_log_limiter_{MSGS_PER_SEC, BURST};                                 \
+		( LOGGER ).log_limited( mart_log_site_, mart_log_limiter_, __VA_ARGS__ );                                      \
+	} while( false )
+#define MART_LOG_EVERY_N( LOGGER, LVL, N, ... )                                                                        \
+	do {                                                                                                               \
+		static constexpr ::mart::log::LogSite mart_log_site_{LVL, __FILE__, __LINE__};                                 \
+		static ::mart::log::EveryNLimiter     mart_log_limiter_{N};                                                    \
+		( LOGGER ).log_limited( mart_log_site_, mart_log_limiter_, __VA_ARGS__ );                                      \
+	} while( false )
+#define MART_LOG_FIRST_N( LOGGER, LVL, N, ... )                                                                        \
+	do {                                                                                                               \
+		static constexpr ::mart::log::LogSite mart_log_site_{LVL, __FILE__, __LINE__};                                 \
+		static ::mart::log::FirstNLimiter     mart_log_limiter_{N};                                                    \
+		( LOGGER ).log_limited( mart_log_site_, mart_log_limiter_, __VA_ARGS__ );                                      \
+	} while( false )
+
 #define MART_LOG_ERROR( LOGGER, ... ) ( ( LOGGER ).log( mart::log::Level::ERROR, __VA_ARGS__ ) )
 #define MART_DEFLOG_ERROR( ... ) ( MART_DEFLOG.log( mart::log::Level::ERROR, __VA_ARGS__ ) )
 #define MART_LOG_ERROR_COND( COND, ... )                                                                               \
@@ -54,6 +92,14 @@
 	do {                                                                                                               \
 		if( COND ) { MART_LOG_IMPL_EXPAND( MART_DEFLOG_ERROR( __VA_ARGS__ ) ); }                                       \
 	} while( false )
+#define MART_LOG_ERROR_DEFERRED( LOGGER, ... )                                                                         \
+	MART_LOG_IMPL_EXPAND( MART_LOG_DEFERRED( LOGGER, mart::log::Level::ERROR, __VA_ARGS__ ) )
+#define MART_LOG_ERROR_RATE_LIMITED( LOGGER, MSGS_PER_SEC, BURST, ... )                                                \
+	MART_LOG_IMPL_EXPAND( MART_LOG_RATE_LIMITED( LOGGER, mart::log::Level::ERROR, MSGS_PER_SEC, BURST, __VA_ARGS__ ) )
+#define MART_LOG_ERROR_EVERY_N( LOGGER, N, ... )                                                                       \
+	MART_LOG_IMPL_EXPAND( MART_LOG_EVERY_N( LOGGER, mart::log::Level::ERROR, N, __VA_ARGS__ ) )
+#define MART_LOG_ERROR_FIRST_N( LOGGER, N, ... )                                                                       \
+	MART_LOG_IMPL_EXPAND( MART_LOG_FIRST_N( LOGGER, mart::log::Level::ERROR, N, __VA_ARGS__ ) )
 
 #if MART_LOG_MAX_LOG_LVL >= MART_LOG_LOG_LVL_STATUS
 #define MART_LOG_STATUS( LOGGER, ... ) ( ( LOGGER ).log( mart::log::Level::STATUS, __VA_ARGS__ ) )
@@ -67,12 +113,24 @@
 	do {                                                                                                               \
 		if( COND ) { MART_LOG_IMPL_EXPAND( MART_DEFLOG_STATUS( __VA_ARGS__ ) ); }                                      \
 	} while( false )
+#define MART_LOG_STATUS_DEFERRED( LOGGER, ... )                                                                        \
+	MART_LOG_IMPL_EXPAND( MART_LOG_DEFERRED( LOGGER, mart::log::Level::STATUS, __VA_ARGS__ ) )
+#define MART_LOG_STATUS_RATE_LIMITED( LOGGER, MSGS_PER_SEC, BURST, ... )                                               \
+	MART_LOG_IMPL_EXPAND( MART_LOG_RATE_LIMITED( LOGGER, mart::log::Level::STATUS, MSGS_PER_SEC, BURST, __VA_ARGS__ ) )
+#define MART_LOG_STATUS_EVERY_N( LOGGER, N, ... )                                                                      \
+	MART_LOG_IMPL_EXPAND( MART_LOG_EVERY_N( LOGGER, mart::log::Level::STATUS, N, __VA_ARGS__ ) )
+#define MART_LOG_STATUS_FIRST_N( LOGGER, N, ... )                                                                      \
+	MART_LOG_IMPL_EXPAND( MART_LOG_FIRST_N( LOGGER, mart::log::Level::STATUS, N, __VA_ARGS__ ) )
 #else
 #define MART_LOG_STATUS( LOGGER, ... ) (void)0
 #define MART_DEFLOG_STATUS( ... ) (void)0
 #define MART_LOG( ... ) (void)0
 #define MART_LOG_STATUS_COND( COND, ... ) (void)0
 #define MART_DEFLOG_STATUS_COND( COND, ... ) (void)0
+#define MART_LOG_STATUS_DEFERRED( LOGGER, ... ) (void)0
+#define MART_LOG_STATUS_RATE_LIMITED( LOGGER, MSGS_PER_SEC, BURST, ... ) (void)0
+#define MART_LOG_STATUS_EVERY_N( LOGGER, N, ... ) (void)0
+#define MART_LOG_STATUS_FIRST_N( LOGGER, N, ... ) (void)0
 #endif
 
 #if MART_LOG_MAX_LOG_LVL >= MART_LOG_LOG_LVL_DEBUG
@@ -86,11 +144,23 @@
 	do {                                                                                                               \
 		if( COND ) { MART_LOG_IMPL_EXPAND( MART_DEFLOG_DEBUG( __VA_ARGS__ ) ); }                                       \
 	} while( false )
+#define MART_LOG_DEBUG_DEFERRED( LOGGER, ... )                                                                         \
+	MART_LOG_IMPL_EXPAND( MART_LOG_DEFERRED( LOGGER, mart::log::Level::DEBUG, __VA_ARGS__ ) )
+#define MART_LOG_DEBUG_RATE_LIMITED( LOGGER, MSGS_PER_SEC, BURST, ... )                                                \
+	MART_LOG_IMPL_EXPAND( MART_LOG_RATE_LIMITED( LOGGER, mart::log::Level::DEBUG, MSGS_PER_SEC, BURST, __VA_ARGS__ ) )
+#define MART_LOG_DEBUG_EVERY_N( LOGGER, N, ... )                                                                       \
+	MART_LOG_IMPL_EXPAND( MART_LOG_EVERY_N( LOGGER, mart::log::Level::DEBUG, N, __VA_ARGS__ ) )
+#define MART_LOG_DEBUG_FIRST_N( LOGGER, N, ... )                                                                       \
+	MART_LOG_IMPL_EXPAND( MART_LOG_FIRST_N( LOGGER, mart::log::Level::DEBUG, N, __VA_ARGS__ ) )
 #else
 #define MART_LOG_DEBUG( LOGGER, ... ) (void)0
 #define MART_DEFLOG_DEBUG( ... ) (void)0
 #define MART_LOG_DEBUG_COND( COND, ... ) (void)0
 #define MART_DEFLOG_DEBUG_COND( COND, ... ) (void)0
+#define MART_LOG_DEBUG_DEFERRED( LOGGER, ... ) (void)0
+#define MART_LOG_DEBUG_RATE_LIMITED( LOGGER, MSGS_PER_SEC, BURST, ... ) (void)0
+#define MART_LOG_DEBUG_EVERY_N( LOGGER, N, ... ) (void)0
+#define MART_LOG_DEBUG_FIRST_N( LOGGER, N, ... ) (void)0
 #endif
 
 #if MART_LOG_MAX_LOG_LVL >= MART_LOG_LOG_LVL_TRACE
@@ -104,11 +174,23 @@
 	do {                                                                                                               \
 		if( COND ) { MART_LOG_IMPL_EXPAND( MART_DEFLOG_TRACE( __VA_ARGS__ ) ); }                                       \
 	} while( false )
+#define MART_LOG_TRACE_DEFERRED( LOGGER, ... )                                                                         \
+	MART_LOG_IMPL_EXPAND( MART_LOG_DEFERRED( LOGGER, mart::log::Level::TRACE, __VA_ARGS__ ) )
+#define MART_LOG_TRACE_RATE_LIMITED( LOGGER, MSGS_PER_SEC, BURST, ... )                                                \
+	MART_LOG_IMPL_EXPAND( MART_LOG_RATE_LIMITED( LOGGER, mart::log::Level::TRACE, MSGS_PER_SEC, BURST, __VA_ARGS__ ) )
+#define MART_LOG_TRACE_EVERY_N( LOGGER, N, ... )                                                                       \
+	MART_LOG_IMPL_EXPAND( MART_LOG_EVERY_N( LOGGER, mart::log::Level::TRACE, N, __VA_ARGS__ ) )
+#define MART_LOG_TRACE_FIRST_N( LOGGER, N, ... )                                                                       \
+	MART_LOG_IMPL_EXPAND( MART_LOG_FIRST_N( LOGGER, mart::log::Level::TRACE, N, __VA_ARGS__ ) )
 #else
 #define MART_LOG_TRACE( LOGGER, ... ) (void)0
 #define MART_DEFLOG_TRACE( ... ) (void)0
 #define MART_LOG_TRACE_COND( COND, ... ) (void)0
 #define MART_DEFLOG_TRACE_COND( COND, ... ) (void)0
+#define MART_LOG_TRACE_DEFERRED( LOGGER, ... ) (void)0
+#define MART_LOG_TRACE_RATE_LIMITED( LOGGER, MSGS_PER_SEC, BURST, ... ) (void)0
+#define MART_LOG_TRACE_EVERY_N( LOGGER, N, ... ) (void)0
+#define MART_LOG_TRACE_FIRST_N( LOGGER, N, ... ) (void)0
 #endif
 
 namespace mart {
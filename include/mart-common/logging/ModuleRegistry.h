@@ -0,0 +1,136 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_MODULE_REGISTRY_H
+#define LIB_MART_COMMON_GUARD_LOGGING_MODULE_REGISTRY_H
+/**
+ * ModuleRegistry.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Global registry of logging modules and their log levels
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/* Project Includes */
+#include "types.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+using ModuleId = std::uint32_t;
+
+/**
+ * Maps module names (as created by the Logger, e.g. "[app][net]") to a slot in a flat array of atomic log levels.
+ *
+ * Loggers resolve their id once (on construction / setName) and afterwards only perform a relaxed load
+ * on their slot, so changing the level of a module is O(1) and immediately affects every logger
+ * (including all copies) of that module.
+ *
+ * If all slots are in use, further modules share the overflow module (id 0, name "[overflow]").
+ */
+class ModuleRegistry {
+public:
+	static constexpr std::size_t max_module_cnt = 4096;
+	static constexpr ModuleId    overflow_id    = 0;
+
+	static ModuleRegistry& instance()
+	{
+		static ModuleRegistry registry;
+		return registry;
+	}
+
+	/**
+	 * Returns the id of module @p name, registering it with level @p initialLvl if it doesn't exist yet
+	 */
+	ModuleId resolve( std::string_view name, Level initialLvl = defaultLogLevel )
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		return _resolve( name, initialLvl );
+	}
+
+	std::optional<ModuleId> find( std::string_view name ) const
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		const auto                  it = _ids.find( name );
+		if( it == _ids.end() ) { return std::nullopt; }
+		return it->second;
+	}
+
+	std::atomic<Level>& levelSlot( ModuleId id ) noexcept { return _levels[id]; }
+
+	Level getLevel( ModuleId id ) const noexcept { return _levels[id].load( std::memory_order_relaxed ); }
+	void  setLevel( ModuleId id, Level lvl ) noexcept { _levels[id].store( lvl, std::memory_order_relaxed ); }
+
+	/**
+	 * Sets the level of module @p name and all its submodules (modules created via Logger::make_child),
+	 * registering the module, if it doesn't exist yet
+	 */
+	void setSubtreeLevel( std::string_view name, Level lvl )
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		_levels[_resolve( name, lvl )].store( lvl, std::memory_order_relaxed );
+		for( const auto& [moduleName, id] : _ids ) {
+			// children of "[a]" are named "[a][b]", so a plain prefix check doesn't match e.g. "[ab]"
+			if( moduleName.size() > name.size() && moduleName.substr( 0, name.size() ) == name
+				&& moduleName[name.size()] == '[' ) {
+				_levels[id].store( lvl, std::memory_order_relaxed );
+			}
+		}
+	}
+
+	std::size_t moduleCount() const
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		return _names.size();
+	}
+
+private:
+	ModuleRegistry()
+	{
+		for( auto& l : _levels ) {
+			l.store( defaultLogLevel, std::memory_order_relaxed );
+		}
+		_resolve( "[overflow]", defaultLogLevel );
+	}
+
+	ModuleId _resolve( std::string_view name, Level initialLvl )
+	{
+		const auto it = _ids.find( name );
+		if( it != _ids.end() ) { return it->second; }
+		if( _names.size() == max_module_cnt ) { return overflow_id; }
+
+		const auto id = static_cast<ModuleId>( _names.size() );
+		// deque doesn't invalidate references on push_back, so the map can key on views into it
+		_names.emplace_back( name );
+		_ids.emplace( _names.back(), id );
+		_levels[id].store( initialLvl, std::memory_order_relaxed );
+		return id;
+	}
+
+	mutable std::mutex                             _mx;
+	std::deque<std::string>                        _names;
+	std::unordered_map<std::string_view, ModuleId> _ids;
+	std::array<std::atomic<Level>, max_module_cnt> _levels;
+};
+
+} // namespace log
+} // namespace mart
+
+#endif
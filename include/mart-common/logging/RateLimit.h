@@ -0,0 +1,194 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_RATE_LIMIT_H
+#define LIB_MART_COMMON_GUARD_LOGGING_RATE_LIMIT_H
+/**
+ * RateLimit.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Per call site state for rate limited and sampled log statements (see MART_LOG_RATE_LIMITED & co)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+struct RateLimitResult {
+	bool          pass;       // the message should be logged
+	std::uint64_t suppressed; // number of suppressed messages that should be reported now (0: no summary)
+};
+
+constexpr std::chrono::seconds default_suppression_summary_interval{1};
+
+namespace detail {
+
+inline std::int64_t rateLimitNow() noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() )
+		.count();
+}
+
+// Counts suppressed messages and decides when they get reported
+class SuppressionCounter {
+public:
+	explicit SuppressionCounter( std::chrono::nanoseconds summaryInterval ) noexcept
+		: _summaryInterval( summaryInterval.count() )
+	{
+	}
+
+	// a message passes -> all messages suppressed so far are reported together with it
+	RateLimitResult pass() noexcept
+	{
+		if( _suppressed.load( std::memory_order_relaxed ) == 0 ) { return {true, 0}; }
+		_nextSummary.store( 0, std::memory_order_relaxed );
+		return {true, _suppressed.exchange( 0, std::memory_order_relaxed )};
+	}
+
+	// a message is suppressed -> the count is reported at most once per summary interval
+	RateLimitResult suppress( std::int64_t now ) noexcept
+	{
+		_suppressed.fetch_add( 1, std::memory_order_relaxed );
+
+		auto next = _nextSummary.load( std::memory_order_relaxed );
+		if( next == 0 ) {
+			// first suppressed message since the last summary
+			_nextSummary.compare_exchange_strong( next, now + _summaryInterval, std::memory_order_relaxed );
+			return {false, 0};
+		}
+		if( now < next ) { return {false, 0}; }
+		if( !_nextSummary.compare_exchange_strong( next, 0, std::memory_order_relaxed ) ) { return {false, 0}; }
+		return {false, _suppressed.exchange( 0, std::memory_order_relaxed )};
+	}
+
+private:
+	const std::int64_t         _summaryInterval;
+	std::atomic<std::uint64_t> _suppressed{0};
+	std::atomic<std::int64_t>  _nextSummary{0};
+};
+
+} // namespace detail
+
+/**
+ * Token bucket: Lets through up to @p burst messages at once, which are refilled at @p messagesPerSecond
+ *
+ * Implemented as generic cell rate algorithm, so the whole state is a single atomic time stamp.
+ * A burst of 0 is treated as 1. Rates that are not positive (or below one message per year) are clamped to one
+ * message per year, so such a limiter practically only lets through the initial burst.
+ */
+class TokenBucketLimiter {
+public:
+	TokenBucketLimiter( double                   messagesPerSecond,
+						std::uint32_t            burst           = 1,
+						std::chrono::nanoseconds summaryInterval = default_suppression_summary_interval ) noexcept
+		: _interval( _toInterval( messagesPerSecond ) )
+		, _tolerance( _toTolerance( _interval, burst ) )
+		, _suppressed( summaryInterval )
+	{
+	}
+
+	RateLimitResult check() noexcept
+	{
+		const auto now = detail::rateLimitNow();
+		auto       tat = _tat.load( std::memory_order_relaxed ); // theoretical arrival time
+		while( true ) {
+			const auto base = std::max( tat, now );
+			if( base - now > _tolerance ) { return _suppressed.suppress( now ); }
+			if( _tat.compare_exchange_weak( tat, base + _interval, std::memory_order_relaxed ) ) {
+				return _suppressed.pass();
+			}
+		}
+	}
+
+private:
+	static constexpr std::int64_t max_interval = std::int64_t{1'000'000'000} * 60 * 60 * 24 * 365;
+	// keeps the theoretical arrival time far away from overflowing
+	static constexpr std::int64_t max_tolerance = std::numeric_limits<std::int64_t>::max() / 4;
+
+	static std::int64_t _toInterval( double messagesPerSecond ) noexcept
+	{
+		// also catches NaN
+		if( !( messagesPerSecond * static_cast<double>( max_interval ) > 1e9 ) ) { return max_interval; }
+		return static_cast<std::int64_t>( 1e9 / messagesPerSecond );
+	}
+
+	static std::int64_t _toTolerance( std::int64_t interval, std::uint32_t burst ) noexcept
+	{
+		const std::int64_t extra = std::max<std::int64_t>( burst, 1 ) - 1;
+		if( interval != 0 && extra > max_tolerance / interval ) { return max_tolerance; }
+		return interval * extra;
+	}
+
+	const std::int64_t         _interval;
+	const std::int64_t         _tolerance;
+	std::atomic<std::int64_t>  _tat{0};
+	detail::SuppressionCounter _suppressed;
+};
+
+/**
+ * Sampling: Lets through the first and then every @p n -th message
+ */
+class EveryNLimiter {
+public:
+	explicit EveryNLimiter( std::uint64_t            n,
+							std::chrono::nanoseconds summaryInterval = default_suppression_summary_interval ) noexcept
+		: _n( std::max<std::uint64_t>( n, 1 ) )
+		, _suppressed( summaryInterval )
+	{
+	}
+
+	RateLimitResult check() noexcept
+	{
+		if( _count.fetch_add( 1, std::memory_order_relaxed ) % _n == 0 ) { return _suppressed.pass(); }
+		return _suppressed.suppress( detail::rateLimitNow() );
+	}
+
+private:
+	const std::uint64_t        _n;
+	std::atomic<std::uint64_t> _count{0};
+	detail::SuppressionCounter _suppressed;
+};
+
+/**
+ * Lets through the first @p n messages - afterwards only the number of suppressed messages is reported periodically
+ */
+class FirstNLimiter {
+public:
+	explicit FirstNLimiter( std::uint64_t            n,
+							std::chrono::nanoseconds summaryInterval = default_suppression_summary_interval ) noexcept
+		: _n( n )
+		, _suppressed( summaryInterval )
+	{
+	}
+
+	RateLimitResult check() noexcept
+	{
+		// avoid incrementing (and eventually overflowing) the counter forever
+		if( _count.load( std::memory_order_relaxed ) < _n && _count.fetch_add( 1, std::memory_order_relaxed ) < _n ) {
+			return _suppressed.pass();
+		}
+		return _suppressed.suppress( detail::rateLimitNow() );
+	}
+
+private:
+	const std::uint64_t        _n;
+	std::atomic<std::uint64_t> _count{0};
+	detail::SuppressionCounter _suppressed;
+};
+
+} // namespace log
+} // namespace mart
+
+#endif
@@ -17,20 +17,50 @@
 #include "types.h"
 
 #include <im_str/im_str.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
 namespace log {
 
+class ILogSink;
+
 struct FileLogConfig_t {
 	mba::im_zstr fileName;
 	Level        maxLogLvl;
 };
 
+struct MMapFileLogConfig_t {
+	mba::im_zstr              fileName; // segments are written to <fileName>.0, <fileName>.1, ...
+	Level                     maxLogLvl   = Level::TRACE;
+	std::size_t               segmentSize = 64 * 1024 * 1024;
+	std::size_t               maxSegments = 0; // older segment files get deleted (0: keep all)
+	std::chrono::milliseconds syncInterval{1000};
+};
+
 struct StdOutLogConfig_t {
 	Level maxLogLvl;
 };
 
+// What an AsyncSink does if the buffer of the logging thread is full
+enum class OverflowPolicy {
+	Drop,        // silently discard the message
+	Block,       // wait until the background thread made room
+	CountAndDrop // discard the message, but report the number of dropped messages in the log
+};
+
+struct AsyncSinkConfig_t {
+	std::vector<std::shared_ptr<ILogSink>> targets;
+	Level                                  maxLogLvl           = Level::TRACE;
+	std::size_t                            perThreadBufferSize = 64 * 1024;
+	OverflowPolicy                         overflowPolicy      = OverflowPolicy::CountAndDrop;
+	std::chrono::milliseconds              drainInterval{10};
+};
+
 } // namespace log
 } // namespace mart
 
@@ -0,0 +1,333 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_BUFFER_FORMATTER_H
+#define LIB_MART_COMMON_GUARD_LOGGING_BUFFER_FORMATTER_H
+/**
+ * buffer_formatter.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Formatting of log messages into a reusable char buffer without going through std::ostream
+ *
+ */
+
+/* ######## INCLUDES ######### */
+#include "types.h"
+
+/* Proprietary Library Includes */
+#include "../ArrayView.h"
+
+#include <im_str/im_str.hpp>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+/* Project Includes */
+#include "default_formatter.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+/**
+ * Character buffer a log message gets formatted into
+ *
+ * The memory is reused between messages, so once the buffer has grown to the size of the longest message,
+ * formatting doesn't allocate anymore.
+ * Types without a formatForLog( LogBuffer&, ... ) overload are written via stream(),
+ * which is a std::ostream that appends to the same buffer.
+ */
+class LogBuffer {
+public:
+	static constexpr std::size_t initial_capacity = 1024;
+
+	LogBuffer()
+	{
+		_buffer.reserve( initial_capacity );
+		_resetStream();
+	}
+	LogBuffer( const LogBuffer& ) = delete;
+	LogBuffer& operator=( const LogBuffer& ) = delete;
+
+	void append( std::string_view str ) { _buffer.append( str.data(), str.size() ); }
+	void append( char c ) { _buffer.push_back( c ); }
+	void append( std::size_t cnt, char c ) { _buffer.append( cnt, c ); }
+
+	std::string_view view() const noexcept { return _buffer; }
+	std::size_t      size() const noexcept { return _buffer.size(); }
+	bool             empty() const noexcept { return _buffer.empty(); }
+
+	/// Removes the content, but keeps the memory. Also resets the formatting state of stream()
+	void clear() noexcept
+	{
+		_buffer.clear();
+		_resetStream();
+	}
+
+	/// std::ostream that appends to this buffer (used for types that only provide an ostream based formatter)
+	std::ostream& stream() noexcept { return _stream; }
+
+	/// True if e.g. std::hex or std::setw has been written to stream() - following values then have to use it too
+	bool streamStateModified() const noexcept { return _streamStateModified; }
+
+	void updateStreamState() noexcept
+	{
+		_streamStateModified = _stream.flags() != _defaultFlags || _stream.width() != 0 || _stream.precision() != 6
+							   || _stream.fill() != ' ';
+	}
+
+private:
+	class StreamBuf final : public std::streambuf {
+	public:
+		explicit StreamBuf( std::string& target )
+			: _target( &target )
+		{
+		}
+
+	protected:
+		int_type overflow( int_type c ) override
+		{
+			if( !traits_type::eq_int_type( c, traits_type::eof() ) ) {
+				_target->push_back( traits_type::to_char_type( c ) );
+			}
+			return traits_type::not_eof( c );
+		}
+
+		std::streamsize xsputn( const char* s, std::streamsize n ) override
+		{
+			_target->append( s, static_cast<std::size_t>( n ) );
+			return n;
+		}
+
+	private:
+		std::string* _target;
+	};
+
+	std::string        _buffer;
+	StreamBuf          _streambuf{_buffer};
+	std::ostream       _stream{&_streambuf};
+	std::ios::fmtflags _defaultFlags{};
+	bool               _streamStateModified = false;
+
+	void _resetStream() noexcept
+	{
+		// With the ostream based formatter, the stream was left in std::left mode by the formatter for Level
+		_stream.flags( std::ios::dec | std::ios::skipws | std::ios::left );
+		_stream.width( 0 );
+		_stream.precision( 6 );
+		_stream.fill( ' ' );
+		_stream.clear();
+		_defaultFlags        = _stream.flags();
+		_streamStateModified = false;
+	}
+};
+
+namespace _impl_log {
+
+// clang-format off
+template<class T> struct is_fast_duration : std::false_type {};
+template<> struct is_fast_duration<std::chrono::nanoseconds>  : std::true_type {};
+template<> struct is_fast_duration<std::chrono::microseconds> : std::true_type {};
+template<> struct is_fast_duration<std::chrono::milliseconds> : std::true_type {};
+template<> struct is_fast_duration<std::chrono::seconds>      : std::true_type {};
+template<> struct is_fast_duration<std::chrono::minutes>      : std::true_type {};
+template<> struct is_fast_duration<std::chrono::hours>        : std::true_type {};
+
+constexpr std::string_view duration_suffix( std::chrono::nanoseconds )  { return "ns"; }
+constexpr std::string_view duration_suffix( std::chrono::microseconds ) { return "us"; }
+constexpr std::string_view duration_suffix( std::chrono::milliseconds ) { return "ms"; }
+constexpr std::string_view duration_suffix( std::chrono::seconds )      { return "s"; }
+constexpr std::string_view duration_suffix( std::chrono::minutes )      { return "min"; }
+constexpr std::string_view duration_suffix( std::chrono::hours )        { return "h"; }
+// clang-format on
+
+template<class T>
+constexpr bool is_fast_integral_v = std::is_integral_v<T> && !std::is_same_v<T, wchar_t>
+									&& !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+#if defined( __cpp_lib_to_chars )
+template<class T>
+constexpr bool is_fast_floating_point_v = std::is_floating_point_v<T>;
+#else
+template<class T>
+constexpr bool is_fast_floating_point_v = false;
+#endif
+
+// only types that don't have an ostream formatter of their own that would be bypassed
+template<class T>
+constexpr bool is_fast_string_v = std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>
+								  || std::is_same_v<T, const char*> || std::is_same_v<T, char*>
+								  || std::is_same_v<T, mba::im_str> || std::is_same_v<T, mba::im_zstr>
+								  || ( std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char> );
+
+template<class T>
+struct is_fast_time_point : std::false_type {};
+template<class Clock, class Dur>
+struct is_fast_time_point<std::chrono::time_point<Clock, Dur>> : is_fast_duration<Dur> {};
+template<class Dur>
+struct is_fast_time_point<std::chrono::time_point<std::chrono::system_clock, Dur>> : std::false_type {};
+template<>
+struct is_fast_time_point<std::chrono::system_clock::time_point> : std::true_type {};
+
+template<class T>
+constexpr bool is_fast_formattable_v
+	= is_fast_integral_v<T> || is_fast_floating_point_v<T> || is_fast_string_v<T> || is_fast_duration<T>::value
+	  || is_fast_time_point<T>::value || std::is_same_v<T, std::thread::id> || std::is_same_v<T, Level>
+	  || std::is_same_v<T, mart::ConstMemoryView>;
+
+template<class T>
+void appendInteger( LogBuffer& out, T value )
+{
+	char buffer[24];
+	auto res = std::to_chars( std::begin( buffer ), std::end( buffer ), value );
+	out.append( std::string_view( buffer, static_cast<std::size_t>( res.ptr - buffer ) ) );
+}
+
+// right aligned, like std::setw( width ) << std::setfill( fill ) << value with std::right
+template<class T>
+void appendPaddedInteger( LogBuffer& out, T value, std::size_t width, char fill )
+{
+	char       buffer[24];
+	const auto res  = std::to_chars( std::begin( buffer ), std::end( buffer ), value );
+	const auto size = static_cast<std::size_t>( res.ptr - buffer );
+	if( size < width ) { out.append( width - size, fill ); }
+	out.append( std::string_view( buffer, size ) );
+}
+
+inline void appendHexByte( LogBuffer& out, ByteType b )
+{
+	constexpr std::string_view digits = "0123456789abcdef";
+	out.append( digits[b >> 4] );
+	out.append( digits[b & 0xF] );
+}
+
+inline std::string_view currentThreadIdHex()
+{
+	thread_local const std::string id = [] {
+		std::ostringstream ss;
+		ss << std::hex << std::this_thread::get_id();
+		return ss.str();
+	}();
+	return id;
+}
+
+inline void printOneLine( LogBuffer& out, mart::ConstMemoryView mem, std::size_t fillto = 0 )
+{
+	constexpr std::size_t max_spaces = 149;
+
+	out.append( '[' );
+	for( ByteType b : mem ) {
+		out.append( ' ' );
+		appendHexByte( out, b );
+	}
+	if( fillto > mem.size() ) { out.append( std::min( ( fillto - mem.size() ) * 3, max_spaces ), ' ' ); }
+	out.append( " ]" );
+}
+
+// Same output as the corresponding defaultFormatForLog( std::ostream&, ... ) overloads
+template<class T>
+void fastFormat( LogBuffer& out, const T& value )
+{
+	if constexpr( std::is_same_v<T, bool> ) {
+		out.append( value ? '1' : '0' );
+	} else if constexpr( is_fast_integral_v<T> ) {
+		// char types are printed as numbers
+		if constexpr( sizeof( T ) == 1 ) {
+			appendInteger( out, static_cast<int>( value ) );
+		} else {
+			appendInteger( out, value );
+		}
+	} else if constexpr( is_fast_floating_point_v<T> ) {
+		char buffer[64];
+		auto res = std::to_chars( std::begin( buffer ), std::end( buffer ), value, std::chars_format::general, 6 );
+		out.append( std::string_view( buffer, static_cast<std::size_t>( res.ptr - buffer ) ) );
+	} else if constexpr( is_fast_string_v<T> ) {
+		out.append( std::string_view( value ) );
+	} else if constexpr( is_fast_duration<T>::value ) {
+		appendInteger( out, value.count() );
+		out.append( duration_suffix( value ) );
+	} else if constexpr( std::is_same_v<T, std::chrono::system_clock::time_point> ) {
+		using namespace std::chrono_literals;
+		const auto t = std::chrono::system_clock::to_time_t( value );
+		char       buffer[128];
+		const auto size = std::strftime( buffer, sizeof( buffer ), "(%Z) %F_%T-", std::gmtime( &t ) );
+		out.append( std::string_view( buffer, size ) );
+		appendPaddedInteger( out, value.time_since_epoch() / 1us % 1000000, 6, '0' );
+		out.append( "us" );
+	} else if constexpr( is_fast_time_point<T>::value ) {
+		fastFormat( out, value.time_since_epoch() );
+	} else if constexpr( std::is_same_v<T, std::thread::id> ) {
+		if( value == std::this_thread::get_id() ) {
+			out.append( "0x" );
+			out.append( currentThreadIdHex() );
+		} else {
+			ostream_flag_saver _( out.stream() );
+			out.stream() << "0x" << std::hex << value;
+		}
+	} else if constexpr( std::is_same_v<T, Level> ) {
+		const auto name = mart::log::to_string_view( value );
+		out.append( name );
+		if( name.size() < 6 ) { out.append( 6 - name.size(), ' ' ); }
+	} else if constexpr( std::is_same_v<T, mart::ConstMemoryView> ) {
+		constexpr std::size_t ElementsPerLine = 20;
+
+		mart::ConstMemoryView mem = value;
+		if( mem.size() <= ElementsPerLine ) {
+			printOneLine( out, mem );
+		} else {
+			while( !mem.empty() ) {
+				out.append( "\n\t" );
+				auto parts = mem.split( std::min( ElementsPerLine, mem.size() ) );
+				printOneLine( out, parts.first, ElementsPerLine );
+				mem = parts.second;
+			}
+			out.append( '\n' );
+		}
+	}
+}
+
+} // namespace _impl_log
+
+/**
+ * function template that is used for writing a parameter to a LogBuffer.
+ *
+ * Common types are formatted directly into the buffer (with the same result as the ostream based formatters).
+ * Everything else is forwarded to formatForLog( std::ostream&, value ), so existing overloads keep working.
+ * Can be overloaded for own data types.
+ */
+template<class T>
+inline void formatForLog( LogBuffer& out, const T& value )
+{
+	if constexpr( _impl_log::is_fast_formattable_v<T> ) {
+		if( !out.streamStateModified() ) {
+			_impl_log::fastFormat( out, value );
+			return;
+		}
+	}
+	formatForLog( out.stream(), value );
+	out.updateStreamState();
+}
+
+template<class... ARGS>
+inline void formatForLog( LogBuffer& out, const ARGS&... args )
+{
+	( formatForLog( out, args ), ... );
+}
+
+} // namespace log
+} // namespace mart
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_DEFERRED_FORMATTER_H
+#define LIB_MART_COMMON_GUARD_LOGGING_DEFERRED_FORMATTER_H
+/**
+ * deferred_formatter.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Binary log records whose arguments get formatted later (e.g. by the background thread of an AsyncSink)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+/* Proprietary Library Includes */
+#include "../ArrayView.h"
+#include "../MartTime.h"
+
+/* Project Includes */
+#include "buffer_formatter.h"
+#include "default_formatter.h"
+#include "types.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+/**
+ * Static description of a log statement (see MART_LOG_DEFERRED)
+ */
+struct LogSite {
+	Level       lvl;
+	const char* file;
+	int         line;
+};
+
+namespace detail {
+
+// Writes the part of a log line that precedes the actual message (shared by immediate and deferred formatting)
+inline void formatLinePrefix( LogBuffer&       out,
+							  Level            lvl,
+							  milliseconds     sinceStart,
+							  std::string_view loggingName,
+							  bool             withThreadId,
+							  std::thread::id  threadId,
+							  std::string_view spacer )
+{
+	formatForLog( out, lvl, " - At " );
+	// count is left aligned in a field of width 7, as the ostream based formatter used to do
+	const auto start = out.size();
+	formatForLog( out, sinceStart.count() );
+	if( out.size() - start < 7 ) { out.append( 7 - ( out.size() - start ), ' ' ); }
+	formatForLog( out, "ms - ", loggingName, ": " );
+
+	if( withThreadId ) { formatForLog( out, "[ThreadID: ", threadId, "]: ", spacer ); }
+}
+
+/*##### Encoding of the arguments #####*/
+// string like arguments and memory views are stored as length + content, everything else is copied bitwise
+
+template<class T>
+struct is_array_view : std::false_type {
+};
+
+template<class T>
+struct is_array_view<ArrayView<T>> : std::true_type {
+};
+
+template<class T>
+using deferred_storage_t = std::conditional_t<
+	std::is_convertible_v<const std::decay_t<T>&, std::string_view>,
+	std::string_view,
+	std::conditional_t<std::is_same_v<std::decay_t<T>, MemoryView>, ConstMemoryView, std::decay_t<T>>>;
+
+template<class T>
+constexpr std::size_t encoded_size( const T& ) noexcept
+{
+	// a view would only be copied as pointer + size, but the data it refers to might be gone, when the record gets formatted
+	static_assert( !is_array_view<T>::value,
+				   "Deferred logging only supports ConstMemoryView/MemoryView, but no other ArrayViews. "
+				   "Use Logger::log for other argument types." );
+	static_assert( std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+				   "Deferred logging only supports strings and trivially copyable, default constructible types. "
+				   "Use Logger::log for other argument types." );
+	return sizeof( T );
+}
+
+inline std::size_t encoded_size( std::string_view str ) noexcept
+{
+	return sizeof( std::uint32_t ) + str.size();
+}
+
+inline std::size_t encoded_size( ConstMemoryView mem ) noexcept
+{
+	return sizeof( std::uint32_t ) + mem.size();
+}
+
+template<class T>
+ByteType* encode( ByteType* out, const T& value ) noexcept
+{
+	std::memcpy( out, &value, sizeof( T ) );
+	return out + sizeof( T );
+}
+
+inline ByteType* encode( ByteType* out, std::string_view str ) noexcept
+{
+	const auto size = static_cast<std::uint32_t>( str.size() );
+	std::memcpy( out, &size, sizeof( size ) );
+	if( size != 0 ) { std::memcpy( out + sizeof( size ), str.data(), size ); }
+	return out + sizeof( size ) + size;
+}
+
+template<class T>
+const ByteType* decode( const ByteType* in, T& value ) noexcept
+{
+	std::memcpy( &value, in, sizeof( T ) );
+	return in + sizeof( T );
+}
+
+inline const ByteType* decode( const ByteType* in, std::string_view& str ) noexcept
+{
+	std::uint32_t size = 0;
+	std::memcpy( &size, in, sizeof( size ) );
+	str = std::string_view( reinterpret_cast<const char*>( in + sizeof( size ) ), size );
+	return in + sizeof( size ) + size;
+}
+
+inline ByteType* encode( ByteType* out, ConstMemoryView mem ) noexcept
+{
+	const auto size = static_cast<std::uint32_t>( mem.size() );
+	std::memcpy( out, &size, sizeof( size ) );
+	if( size != 0 ) { std::memcpy( out + sizeof( size ), mem.data(), size ); }
+	return out + sizeof( size ) + size;
+}
+
+// the view refers to the copy of the data in the record
+inline const ByteType* decode( const ByteType* in, ConstMemoryView& mem ) noexcept
+{
+	std::uint32_t size = 0;
+	std::memcpy( &size, in, sizeof( size ) );
+	mem = ConstMemoryView( in + sizeof( size ), size );
+	return in + sizeof( size ) + size;
+}
+
+template<class... Pending>
+struct ArgDecoder;
+
+template<>
+struct ArgDecoder<> {
+	template<class... Decoded>
+	static void format( LogBuffer& out, const ByteType*, const Decoded&... args )
+	{
+		formatForLog( out, args... );
+	}
+};
+
+template<class T, class... Rest>
+struct ArgDecoder<T, Rest...> {
+	template<class... Decoded>
+	static void format( LogBuffer& out, const ByteType* in, const Decoded&... args )
+	{
+		T value{};
+		in = decode( in, value );
+		ArgDecoder<Rest...>::format( out, in, args..., value );
+	}
+};
+
+using DeferredFormatFn = void ( * )( LogBuffer& out, const ByteType* args );
+
+template<class... Stored>
+void formatDeferredArgs( LogBuffer& out, const ByteType* args )
+{
+	ArgDecoder<Stored...>::format( out, args );
+}
+
+/*##### Record layout: [DeferredRecordHeader][logging name][encoded args...] #####*/
+
+struct DeferredRecordHeader {
+	DeferredFormatFn             format;
+	const LogSite*               site;
+	mart::copter_clock::duration sinceStart;
+	std::thread::id              threadId;
+	std::string_view             spacer; // always points to static storage
+	std::uint32_t                nameSize;
+	bool                         withThreadId;
+};
+static_assert( std::is_trivially_copyable_v<DeferredRecordHeader> );
+
+// Deferred records that would be bigger than this are formatted immediately
+constexpr std::size_t max_deferred_record_size = 4096;
+
+inline std::array<ByteType, max_deferred_record_size>& deferredRecordBuffer()
+{
+	thread_local std::array<ByteType, max_deferred_record_size> buffer;
+	return buffer;
+}
+
+template<class... ARGS>
+std::size_t deferredRecordSize( std::string_view loggingName, const ARGS&... args ) noexcept
+{
+	return sizeof( DeferredRecordHeader ) + loggingName.size()
+		   + ( std::size_t{0} + ... + encoded_size( static_cast<const deferred_storage_t<ARGS>&>( args ) ) );
+}
+
+/**
+ * Writes a deferred record into @p out, which must be at least deferredRecordSize(loggingName, args...) bytes big
+ */
+template<class... ARGS>
+void encodeDeferredRecord( ByteType* out, DeferredRecordHeader header, std::string_view loggingName, const ARGS&... args )
+{
+	header.format   = &formatDeferredArgs<deferred_storage_t<ARGS>...>;
+	header.nameSize = static_cast<std::uint32_t>( loggingName.size() );
+	out             = encode( out, header );
+	std::memcpy( out, loggingName.data(), loggingName.size() );
+	out += loggingName.size();
+	( ( out = encode( out, static_cast<const deferred_storage_t<ARGS>&>( args ) ) ), ... );
+}
+
+/**
+ * Produces the same text for a deferred record as Logger::log would have produced for the original arguments
+ */
+inline void formatDeferredRecord( LogBuffer& out, mart::ConstMemoryView record )
+{
+	DeferredRecordHeader header;
+	std::memcpy( &header, record.data(), sizeof( header ) );
+	const std::string_view loggingName( record.asConstCharPtr() + sizeof( header ), header.nameSize );
+
+	formatLinePrefix( out,
+					  header.site->lvl,
+					  std::chrono::duration_cast<milliseconds>( header.sinceStart ),
+					  loggingName,
+					  header.withThreadId,
+					  header.threadId,
+					  header.spacer );
+	header.format( out, record.data() + sizeof( header ) + header.nameSize );
+	out.append( '\n' );
+}
+
+} // namespace detail
+
+} // namespace log
+} // namespace mart
+
+#endif
@@ -0,0 +1,401 @@
+#ifndef LIB_MART_COMMON_GUARD_LOGGING_STRUCTURED_H
+#define LIB_MART_COMMON_GUARD_LOGGING_STRUCTURED_H
+/**
+ * structured.h (mart-common/logging)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Typed key/value fields for Logger::log_structured and the binary record format they are stored in
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Standard Library Includes */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+/* Proprietary Library Includes */
+#include "../ArrayView.h"
+#include "../enum/EnumHelpers.h"
+
+/* Project Includes */
+#include "buffer_formatter.h"
+#include "types.h"
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart {
+namespace log {
+
+/*
+ * Binary format of a structured record (all values in native byte order, no padding):
+ *
+ *   StructuredRecordHeader
+ *   name:     u16 length + characters (name of the logger)
+ *   message:  u16 length + characters
+ *   fieldCnt times:
+ *      u8 FieldType, u8 key length + characters, value
+ *
+ * Values: Int i64 | UInt u64 | Float f64 | Bool u8 | Duration i64 nanoseconds | String u16 length + characters
+ * Enums are stored as String (their name according to to_string_view).
+ * Text records (RecordKind::Text) have no fields and contain a formatted log line as message.
+ */
+
+enum class FieldType : std::uint8_t { Int = 1, UInt = 2, Float = 3, Bool = 4, Duration = 5, String = 6 };
+
+enum class RecordKind : std::uint8_t { Structured = 0, Text = 1 };
+
+struct StructuredRecordHeader {
+	std::uint16_t size; // of the whole record, including the header
+	Level         lvl;
+	RecordKind    kind;
+	std::uint16_t fieldCnt;
+	std::int64_t  timestamp; // nanoseconds since the epoch of the system_clock
+};
+
+constexpr std::size_t structured_record_header_size
+	= sizeof( std::uint16_t ) + 2 * sizeof( std::uint8_t ) + sizeof( std::uint16_t ) + sizeof( std::int64_t );
+
+// Structured records that would be bigger than this are only written as text
+constexpr std::size_t max_structured_record_size = 4096;
+
+/**
+ * A key/value pair for Logger::log_structured - create it with mart::log::field( "key", value )
+ */
+template<class T>
+struct Field {
+	std::string_view key;
+	T                value;
+};
+
+namespace detail {
+
+template<class T>
+using field_storage_t
+	= std::conditional_t<std::is_convertible_v<const std::decay_t<T>&, std::string_view>, std::string_view, std::decay_t<T>>;
+
+template<class T>
+struct is_duration : std::false_type {};
+template<class Rep, class Period>
+struct is_duration<std::chrono::duration<Rep, Period>> : std::true_type {};
+
+template<class T>
+constexpr FieldType field_type_of()
+{
+	if constexpr( std::is_same_v<T, bool> ) {
+		return FieldType::Bool;
+	} else if constexpr( std::is_integral_v<T> && std::is_signed_v<T> ) {
+		return FieldType::Int;
+	} else if constexpr( std::is_integral_v<T> ) {
+		return FieldType::UInt;
+	} else if constexpr( std::is_floating_point_v<T> ) {
+		return FieldType::Float;
+	} else if constexpr( is_duration<T>::value ) {
+		return FieldType::Duration;
+	} else {
+		static_assert( std::is_same_v<T, std::string_view> || std::is_enum_v<T>,
+					   "Structured log fields have to be integers, floating point numbers, bool, "
+					   "std::chrono::duration, strings or enums with a to_string_view overload" );
+		return FieldType::String;
+	}
+}
+
+template<class T>
+std::string_view enum_name( T value )
+{
+	using mart::to_string_view;
+	return to_string_view( value );
+}
+
+inline std::string_view clamp_size( std::string_view str, std::size_t max ) noexcept
+{
+	return str.substr( 0, std::min( str.size(), max ) );
+}
+
+constexpr std::size_t max_key_size    = 255;
+constexpr std::size_t max_string_size = 0xFFFF;
+
+template<class T>
+std::size_t encoded_field_size( const Field<T>& f ) noexcept
+{
+	const std::size_t prefix = 2 + clamp_size( f.key, max_key_size ).size();
+	constexpr auto    type   = field_type_of<T>();
+	if constexpr( type == FieldType::Bool ) {
+		return prefix + 1;
+	} else if constexpr( type == FieldType::String ) {
+		if constexpr( std::is_enum_v<T> ) {
+			return prefix + 2 + clamp_size( enum_name( f.value ), max_string_size ).size();
+		} else {
+			return prefix + 2 + clamp_size( f.value, max_string_size ).size();
+		}
+	} else {
+		return prefix + 8;
+	}
+}
+
+template<class T>
+ByteType* write_raw( ByteType* out, const T& value ) noexcept
+{
+	std::memcpy( out, &value, sizeof( T ) );
+	return out + sizeof( T );
+}
+
+inline ByteType* write_str16( ByteType* out, std::string_view str ) noexcept
+{
+	str = clamp_size( str, max_string_size );
+	out = write_raw( out, static_cast<std::uint16_t>( str.size() ) );
+	if( !str.empty() ) { std::memcpy( out, str.data(), str.size() ); }
+	return out + str.size();
+}
+
+template<class T>
+ByteType* encode_field( ByteType* out, const Field<T>& f ) noexcept
+{
+	constexpr auto   type = field_type_of<T>();
+	std::string_view key  = clamp_size( f.key, max_key_size );
+
+	out = write_raw( out, type );
+	out = write_raw( out, static_cast<std::uint8_t>( key.size() ) );
+	if( !key.empty() ) { std::memcpy( out, key.data(), key.size() ); }
+	out += key.size();
+
+	if constexpr( type == FieldType::Bool ) {
+		return write_raw( out, static_cast<std::uint8_t>( f.value ) );
+	} else if constexpr( type == FieldType::Int ) {
+		return write_raw( out, static_cast<std::int64_t>( f.value ) );
+	} else if constexpr( type == FieldType::UInt ) {
+		return write_raw( out, static_cast<std::uint64_t>( f.value ) );
+	} else if constexpr( type == FieldType::Float ) {
+		return write_raw( out, static_cast<double>( f.value ) );
+	} else if constexpr( type == FieldType::Duration ) {
+		return write_raw( out,
+						  static_cast<std::int64_t>(
+							  std::chrono::duration_cast<std::chrono::nanoseconds>( f.value ).count() ) );
+	} else if constexpr( std::is_enum_v<T> ) {
+		return write_str16( out, enum_name( f.value ) );
+	} else {
+		return write_str16( out, f.value );
+	}
+}
+
+inline ByteType* encode_record_header( ByteType* out, const StructuredRecordHeader& h ) noexcept
+{
+	out = write_raw( out, h.size );
+	out = write_raw( out, static_cast<std::uint8_t>( h.lvl ) );
+	out = write_raw( out, h.kind );
+	out = write_raw( out, h.fieldCnt );
+	return write_raw( out, h.timestamp );
+}
+
+inline std::array<ByteType, max_structured_record_size>& structuredRecordBuffer()
+{
+	thread_local std::array<ByteType, max_structured_record_size> buffer;
+	return buffer;
+}
+
+template<class... T>
+std::size_t structuredRecordSize( std::string_view name, std::string_view message, const Field<T>&... fields ) noexcept
+{
+	return structured_record_header_size + 2 + clamp_size( name, max_string_size ).size() + 2
+		   + clamp_size( message, max_string_size ).size() + ( std::size_t{0} + ... + encoded_field_size( fields ) );
+}
+
+inline std::int64_t structuredTimestamp() noexcept
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::system_clock::now().time_since_epoch() )
+		.count();
+}
+
+} // namespace detail
+
+template<class T>
+constexpr Field<detail::field_storage_t<T>> field( std::string_view key, const T& value )
+{
+	return {key, value};
+}
+
+// " key=value" when the record is written as text
+template<class T>
+inline void formatForLog( LogBuffer& out, const Field<T>& f )
+{
+	out.append( ' ' );
+	out.append( f.key );
+	out.append( '=' );
+	if constexpr( std::is_enum_v<T> ) {
+		out.append( detail::enum_name( f.value ) );
+	} else if constexpr( std::is_same_v<T, bool> ) {
+		out.append( f.value ? std::string_view( "true" ) : std::string_view( "false" ) );
+	} else {
+		formatForLog( out, f.value );
+	}
+}
+
+/**
+ * Writes a structured record into @p out, which must be at least structuredRecordSize(name, message, fields...) big.
+ * Returns the size of the record
+ */
+template<class... T>
+std::size_t encodeStructuredRecord( ByteType*        out,
+									Level            lvl,
+									RecordKind       kind,
+									std::int64_t     timestamp,
+									std::string_view name,
+									std::string_view message,
+									const Field<T>&... fields ) noexcept
+{
+	const auto size = detail::structuredRecordSize( name, message, fields... );
+
+	ByteType* pos = detail::encode_record_header(
+		out,
+		StructuredRecordHeader{
+			static_cast<std::uint16_t>( size ), lvl, kind, static_cast<std::uint16_t>( sizeof...( T ) ), timestamp} );
+	pos = detail::write_str16( pos, name );
+	pos = detail::write_str16( pos, message );
+	( ( pos = detail::encode_field( pos, fields ) ), ... );
+	return size;
+}
+
+/**
+ * Value of a field in a decoded structured record (only the member that corresponds to the field type is set)
+ */
+struct FieldValue {
+	std::int64_t             i = 0;
+	std::uint64_t            u = 0;
+	double                   f = 0;
+	bool                     b = false;
+	std::chrono::nanoseconds d{};
+	std::string_view         s;
+};
+
+/**
+ * Reads a structured record (e.g. in a log collector). The record must have been validated with isValid() first
+ */
+class StructuredRecordReader {
+public:
+	explicit StructuredRecordReader( mart::ConstMemoryView record ) noexcept
+		: _record( record )
+	{
+		if( record.size() < structured_record_header_size ) { return; }
+		const ByteType* pos = record.data();
+		pos                 = _read( pos, _header.size );
+		std::uint8_t lvl    = 0;
+		pos                 = _read( pos, lvl );
+		_header.lvl         = static_cast<Level>( lvl );
+		pos                 = _read( pos, _header.kind );
+		pos                 = _read( pos, _header.fieldCnt );
+		pos                 = _read( pos, _header.timestamp );
+		// the header itself is part of the record, so a smaller size can only come from a corrupted record
+		if( _header.size < structured_record_header_size || _header.size > record.size() ) { return; }
+
+		pos = _readStr( pos, _name );
+		if( pos == nullptr ) { return; }
+		pos = _readStr( pos, _message );
+		if( pos == nullptr ) { return; }
+		_fields = pos;
+		_valid  = true;
+	}
+
+	bool isValid() const noexcept { return _valid; }
+
+	std::size_t      size() const noexcept { return _header.size; }
+	Level            level() const noexcept { return _header.lvl; }
+	RecordKind       kind() const noexcept { return _header.kind; }
+	std::int64_t     timestamp() const noexcept { return _header.timestamp; }
+	std::string_view name() const noexcept { return _name; }
+	std::string_view message() const noexcept { return _message; }
+	std::size_t      fieldCount() const noexcept { return _header.fieldCnt; }
+
+	/**
+	 * Calls f( std::string_view key, FieldType type, const FieldValue& value ) for every field.
+	 * Returns false if the record is malformed
+	 */
+	template<class F>
+	bool forEachField( F&& f ) const
+	{
+		if( !_valid ) { return false; }
+		const ByteType* pos = _fields;
+		for( std::size_t i = 0; i < _header.fieldCnt; ++i ) {
+			if( _remaining( pos ) < 2 ) { return false; }
+			FieldType    type{};
+			std::uint8_t keySize = 0;
+			pos                  = _read( pos, type );
+			pos                  = _read( pos, keySize );
+			if( _remaining( pos ) < keySize ) { return false; }
+			const std::string_view key( reinterpret_cast<const char*>( pos ), keySize );
+			pos += keySize;
+
+			FieldValue value;
+			switch( type ) {
+				case FieldType::Bool: {
+					if( _remaining( pos ) < 1 ) { return false; }
+					std::uint8_t b = 0;
+					pos            = _read( pos, b );
+					value.b        = b != 0;
+				} break;
+				case FieldType::Int:
+				case FieldType::UInt:
+				case FieldType::Float:
+				case FieldType::Duration: {
+					if( _remaining( pos ) < 8 ) { return false; }
+					std::memcpy( &value.i, pos, 8 );
+					std::memcpy( &value.u, pos, 8 );
+					std::memcpy( &value.f, pos, 8 );
+					value.d = std::chrono::nanoseconds( value.i );
+					pos += 8;
+				} break;
+				case FieldType::String: {
+					pos = _readStr( pos, value.s );
+					if( pos == nullptr ) { return false; }
+				} break;
+				default: return false;
+			}
+			f( key, type, value );
+		}
+		return true;
+	}
+
+private:
+	mart::ConstMemoryView  _record;
+	StructuredRecordHeader _header{};
+	std::string_view       _name;
+	std::string_view       _message;
+	const ByteType*        _fields = nullptr;
+	bool                   _valid  = false;
+
+	template<class T>
+	static const ByteType* _read( const ByteType* in, T& value ) noexcept
+	{
+		std::memcpy( &value, in, sizeof( T ) );
+		return in + sizeof( T );
+	}
+
+	std::size_t _remaining( const ByteType* pos ) const noexcept
+	{
+		const auto consumed = static_cast<std::size_t>( pos - _record.data() );
+		return consumed < _header.size ? _header.size - consumed : 0;
+	}
+
+	const ByteType* _readStr( const ByteType* pos, std::string_view& str ) const noexcept
+	{
+		if( _remaining( pos ) < 2 ) { return nullptr; }
+		std::uint16_t size = 0;
+		pos                = _read( pos, size );
+		if( _remaining( pos ) < size ) { return nullptr; }
+		str = std::string_view( reinterpret_cast<const char*>( pos ), size );
+		return pos + size;
+	}
+};
+
+} // namespace log
+} // namespace mart
+
+#endif
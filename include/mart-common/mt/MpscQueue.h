@@ -0,0 +1,137 @@
+#ifndef LIB_MART_COMMON_GUARD_MT_MPSC_QUEUE_H
+#define LIB_MART_COMMON_GUARD_MT_MPSC_QUEUE_H
+/**
+ * MpscQueue.h (mart-common/mt)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@tum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author:	Michael Balszun <michael.balszun@tum.de>
+ * @brief:	Bounded, lock-free multi producer / single consumer queue
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace mart {
+namespace mt {
+
+/*
+ * Usage example:
+ *
+ * MpscQueue<std::string> queue( 1024 );
+ *
+ * void producer() { // any number of threads
+ * 	queue.try_push( []( std::string& slot ) { slot = "Hello"; } );
+ * }
+ *
+ * void consumer() { // only one thread at a time
+ * 	while( queue.try_pop( []( std::string& slot ) { std::cout << slot << std::endl; } ) ) {}
+ * }
+ */
+
+/**
+ * Threadsafe fifo with a fixed number of slots (multiple producers, one consumer at a time)
+ *
+ * The slots are allocated once and elements are filled and consumed in place,
+ * so e.g. a std::string element keeps its capacity and pushing doesn't allocate in the steady state.
+ * Based on Dmitry Vyukov's bounded MPMC queue (sequence number per slot).
+ *
+ * Does not provide an integrated way to efficiently wait for new content
+ */
+template<class T>
+class MpscQueue {
+	struct alignas( 64 ) Slot {
+		std::atomic<std::size_t> seq;
+		T                        value;
+	};
+
+	static constexpr std::size_t round_up_to_pow2( std::size_t s ) noexcept
+	{
+		std::size_t r = 2;
+		while( r < s ) {
+			r *= 2;
+		}
+		return r;
+	}
+
+public:
+	/**
+	 * @param capacity Number of slots. Rounded up to a power of 2
+	 */
+	explicit MpscQueue( std::size_t capacity )
+		: _capacity( round_up_to_pow2( capacity ) )
+		, _mask( _capacity - 1 )
+		, _slots( new Slot[_capacity] )
+	{
+		for( std::size_t i = 0; i < _capacity; ++i ) {
+			_slots[i].seq.store( i, std::memory_order_relaxed );
+		}
+	}
+
+	std::size_t capacity() const noexcept { return _capacity; }
+
+	/**
+	 * Calls @p fill with a reference to a free slot. Returns false (without calling fill) if the queue is full
+	 */
+	template<class F>
+	bool try_push( F&& fill )
+	{
+		std::size_t pos = _push_pos.load( std::memory_order_relaxed );
+		while( true ) {
+			Slot&      slot = _slots[pos & _mask];
+			const auto seq  = slot.seq.load( std::memory_order_acquire );
+			const auto diff = static_cast<std::ptrdiff_t>( seq ) - static_cast<std::ptrdiff_t>( pos );
+			if( diff == 0 ) {
+				if( _push_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+					fill( slot.value );
+					slot.seq.store( pos + 1, std::memory_order_release );
+					return true;
+				}
+			} else if( diff < 0 ) {
+				return false;
+			} else {
+				pos = _push_pos.load( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	/**
+	 * Calls @p consume with a reference to the oldest element. Returns false if there is no (completely pushed) element.
+	 * Must not be called concurrently
+	 */
+	template<class F>
+	bool try_pop( F&& consume )
+	{
+		Slot& slot = _slots[_pop_pos & _mask];
+		if( slot.seq.load( std::memory_order_acquire ) != _pop_pos + 1 ) { return false; }
+		consume( slot.value );
+		slot.seq.store( _pop_pos + _capacity, std::memory_order_release );
+		++_pop_pos;
+		return true;
+	}
+
+	/// Number of push operations that have been started so far (sequentially consistent load)
+	std::size_t push_count() const noexcept { return _push_pos.load(); }
+
+	/// Number of elements popped so far. Must only be called by the consumer
+	std::size_t pop_count() const noexcept { return _pop_pos; }
+
+private:
+	const std::size_t       _capacity;
+	const std::size_t       _mask;
+	std::unique_ptr<Slot[]> _slots;
+
+	alignas( 64 ) std::atomic<std::size_t> _push_pos{0};
+	alignas( 64 ) std::size_t _pop_pos = 0;
+};
+
+} // namespace mt
+} // namespace mart
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef LIB_MART_COMMON_GUARD_MT_SPSC_BYTE_RING_H
+#define LIB_MART_COMMON_GUARD_MT_SPSC_BYTE_RING_H
+/**
+ * SpscByteRing.h (mart-common/mt)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@tum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author:	Michael Balszun <michael.balszun@tum.de>
+ * @brief:	Lock-free single producer / single consumer ring buffer for variable sized records
+ *
+ */
+
+#include "../ArrayView.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace mart {
+namespace mt {
+
+/*
+ * Usage example:
+ *
+ * SpscByteRing ring( 4096 );
+ *
+ * void producer() {
+ * 	std::string_view msg = "Hello";
+ * 	if( mart::MemoryView mem = ring.try_reserve( msg.size() ); mem.data() ) {
+ * 		std::memcpy( mem.data(), msg.data(), msg.size() );
+ * 		ring.commit();
+ * 	}
+ * }
+ *
+ * void consumer() {
+ * 	while( true ) {
+ * 		mart::ConstMemoryView rec = ring.front();
+ * 		if( !rec.data() ) { break; }
+ * 		std::cout << std::string_view( reinterpret_cast<const char*>( rec.data() ), rec.size() );
+ * 		ring.pop();
+ * 	}
+ * }
+ */
+
+/**
+ * Threadsafe (one producer, one consumer) fifo of variable sized byte records
+ *
+ * The memory is allocated once during construction and never resized,
+ * so neither producer nor consumer ever allocate or block.
+ * Every record is stored contiguously and starts at an 8 byte aligned address.
+ *
+ * Does not provide an integrated way to efficiently wait for new content
+ */
+class SpscByteRing {
+	// Every record is prefixed by a header that contains the (unaligned) payload size.
+	// If a record doesn't fit into the remaining space at the end of the buffer,
+	// the rest of the buffer is filled with a padding record and the record is placed at the start.
+	struct alignas( 8 ) Header {
+		std::uint32_t size;
+		std::uint32_t is_padding;
+	};
+	static_assert( sizeof( Header ) == 8 );
+
+	static constexpr std::size_t alignment = alignof( Header );
+
+	static constexpr std::size_t aligned( std::size_t s ) noexcept { return ( s + alignment - 1 ) & ~( alignment - 1 ); }
+
+	static constexpr std::size_t round_up_to_pow2( std::size_t s ) noexcept
+	{
+		std::size_t r = 64;
+		while( r < s ) {
+			r *= 2;
+		}
+		return r;
+	}
+
+public:
+	/**
+	 * @param capacity Number of bytes available for records and their (8 byte) headers. Rounded up to a power of 2
+	 */
+	explicit SpscByteRing( std::size_t capacity )
+		: _capacity( round_up_to_pow2( capacity ) )
+		, _mask( _capacity - 1 )
+		, _data( new Header[_capacity / sizeof( Header )] )
+	{
+	}
+
+	std::size_t capacity() const noexcept { return _capacity; }
+
+	/// Maximal payload size of a single record
+	std::size_t max_record_size() const noexcept { return _capacity - sizeof( Header ); }
+
+	/*##### Producer side #####*/
+
+	/**
+	 * Reserves space for a record of size @p size
+	 *
+	 * Returns a MemoryView with data() == nullptr if there is not enough space available.
+	 * Otherwise the returned memory can be written to and the record gets visible to the consumer once commit is called.
+	 * Calling try_reserve again before commit replaces the previous reservation.
+	 */
+	mart::MemoryView try_reserve( std::size_t size ) noexcept
+	{
+		const std::size_t total = sizeof( Header ) + aligned( size );
+		if( total > _capacity ) { return {}; }
+
+		const std::size_t offset    = _head & _mask;
+		const std::size_t remaining = _capacity - offset;
+		const std::size_t padding   = remaining < total ? remaining : 0;
+
+		if( !_has_space( padding + total ) ) { return {}; }
+
+		if( padding != 0 ) {
+			_header_at( offset ) = Header{0, 1};
+			_head_reserved       = _head + padding;
+		} else {
+			_head_reserved = _head;
+		}
+		Header& h = _header_at( _head_reserved & _mask );
+		h         = Header{static_cast<std::uint32_t>( size ), 0};
+		_head_reserved += total;
+
+		return mart::MemoryView( _byte_ptr( ( _head_reserved - total ) & _mask ) + sizeof( Header ), size );
+	}
+
+	/// Makes the last reserved record visible to the consumer
+	void commit() noexcept
+	{
+		_head = _head_reserved;
+		_head_shared.store( _head, std::memory_order_release );
+	}
+
+	/// Convenience function that copies @p data into a new record. Returns false if there wasn't enough space
+	bool try_push( mart::ConstMemoryView data ) noexcept
+	{
+		auto mem = try_reserve( data.size() );
+		if( mem.data() == nullptr ) { return false; }
+		if( data.size() != 0 ) { std::memcpy( mem.data(), data.data(), data.size() ); }
+		commit();
+		return true;
+	}
+
+	/*##### Consumer side #####*/
+
+	/**
+	 * Returns the oldest record that hasn't been popped yet or a view with data() == nullptr if the buffer is empty
+	 */
+	mart::ConstMemoryView front() noexcept
+	{
+		if( !_update_readable() ) { return {}; }
+		const Header& h = _header_at( _tail & _mask );
+		return mart::ConstMemoryView( _byte_ptr( _tail & _mask ) + sizeof( Header ), h.size );
+	}
+
+	/// Removes the oldest record. Must only be called if the buffer is not empty
+	void pop() noexcept
+	{
+		const Header& h = _header_at( _tail & _mask );
+		_tail += sizeof( Header ) + aligned( h.size );
+		_tail_shared.store( _tail, std::memory_order_release );
+	}
+
+	/// Only a snapshot - must only be relied on from the consumer
+	bool empty() noexcept { return !_update_readable(); }
+
+private:
+	const std::size_t         _capacity;
+	const std::size_t         _mask;
+	std::unique_ptr<Header[]> _data;
+
+	// producer data
+	alignas( 64 ) std::size_t _head          = 0;
+	std::size_t               _head_reserved = 0;
+	std::size_t               _tail_cached   = 0;
+
+	// consumer data
+	alignas( 64 ) std::size_t _tail = 0;
+	std::size_t               _head_cached = 0;
+
+	// shared data
+	alignas( 64 ) std::atomic<std::size_t> _head_shared{0};
+	alignas( 64 ) std::atomic<std::size_t> _tail_shared{0};
+
+	mart::ByteType* _byte_ptr( std::size_t offset ) const noexcept
+	{
+		return reinterpret_cast<mart::ByteType*>( _data.get() ) + offset;
+	}
+	Header& _header_at( std::size_t offset ) const noexcept { return _data[offset / sizeof( Header )]; }
+
+	bool _has_space( std::size_t required ) noexcept
+	{
+		if( _capacity - ( _head - _tail_cached ) >= required ) { return true; }
+		_tail_cached = _tail_shared.load( std::memory_order_acquire );
+		return _capacity - ( _head - _tail_cached ) >= required;
+	}
+
+	// skips padding records and returns true, if there is a readable record
+	bool _update_readable() noexcept
+	{
+		while( true ) {
+			if( _tail == _head_cached ) {
+				_head_cached = _head_shared.load( std::memory_order_acquire );
+				if( _tail == _head_cached ) { return false; }
+			}
+			const Header& h = _header_at( _tail & _mask );
+			if( !h.is_padding ) { return true; }
+			_tail += _capacity - ( _tail & _mask );
+			_tail_shared.store( _tail, std::memory_order_release );
+		}
+	}
+};
+
+} // namespace mt
+} // namespace mart
+
+#endif
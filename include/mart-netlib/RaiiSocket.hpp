@@ -23,6 +23,7 @@
 #include <mart-common/ArrayView.h>
 
 /* Standard Library Includes */
+#include <array>
 #include <cerrno>
 #include <chrono>
 #include <cstring>
@@ -157,6 +158,59 @@ public:
 		}
 	}
 
+	// see port_layer::recvfrom_with_timestamp
+	RecvResult
+	recvfrom_with_timestamp( mart::MemoryView buffer, int flags, Sockaddr& src_addr, std::chrono::nanoseconds& timestamp )
+	{
+		auto res = port_layer::recvfrom_with_timestamp(
+			_handle, _detail_socket_::to_mutable_byte_range( buffer ), flags, src_addr, timestamp );
+		if( res.success() ) {
+			return {buffer.subview( 0, res.value() ), res};
+		} else {
+			return {mart::MemoryView{}, res};
+		}
+	}
+
+	// scatter / gather versions of send(to) / recv(from) (see port_layer::sendmsg / recvmsg).
+	// Return the total number of transferred bytes
+	ReturnValue<txrx_size_t>
+	sendmsg( mart::ArrayView<const mart::ConstMemoryView> data, int flags = 0, const Sockaddr* to = nullptr ) noexcept
+	{
+		if( data.size() > port_layer::max_iov_cnt ) {
+			return ReturnValue<txrx_size_t>( ErrorCode{ErrorCodeValues::InvalidArgument} );
+		}
+		std::array<byte_range, port_layer::max_iov_cnt> bufs{};
+		for( std::size_t i = 0; i < data.size(); ++i ) {
+			bufs[i] = _detail_socket_::to_byte_range( data[i] );
+		}
+		return port_layer::sendmsg( _handle, bufs.data(), data.size(), flags, to );
+	}
+
+	ReturnValue<txrx_size_t>
+	recvmsg( mart::ArrayView<const mart::MemoryView> buffers, int flags = 0, Sockaddr* from = nullptr ) noexcept
+	{
+		if( buffers.size() > port_layer::max_iov_cnt ) {
+			return ReturnValue<txrx_size_t>( ErrorCode{ErrorCodeValues::InvalidArgument} );
+		}
+		std::array<byte_range_mut, port_layer::max_iov_cnt> bufs{};
+		for( std::size_t i = 0; i < buffers.size(); ++i ) {
+			bufs[i] = _detail_socket_::to_mutable_byte_range( buffers[i] );
+		}
+		return port_layer::recvmsg( _handle, bufs.data(), buffers.size(), flags, from );
+	}
+
+	// batch versions of sendto / recvfrom (see port_layer::sendmmsg / recvmmsg). Return the number of transferred messages
+	ReturnValue<int> sendmmsg( port_layer::SendBatchEntry* msgs, std::size_t cnt, int flags = 0 ) noexcept
+	{
+		return port_layer::sendmmsg( _handle, msgs, cnt, flags );
+	}
+
+	ReturnValue<int>
+	recvmmsg( port_layer::RecvBatchEntry* msgs, std::size_t cnt, int flags = 0, bool dont_wait = false ) noexcept
+	{
+		return port_layer::recvmmsg( _handle, msgs, cnt, flags, dont_wait );
+	}
+
 	/* ###### connection related ############### */
 
 	auto bind( const Sockaddr& addr ) noexcept { return port_layer::bind( _handle, addr ); }
@@ -198,7 +252,8 @@ public:
 	template<class T>
 	ErrorCode getsockopt( SocketOptionLevel level, SocketOption optname, T& option_data ) const noexcept
 	{
-		return port_layer::getsockopt( _handle, level, optname, byte_range_from_pod( option_data ) );
+		auto opmem = byte_range_from_pod( option_data );
+		return port_layer::getsockopt( _handle, level, optname, opmem );
 	}
 
 	ErrorCode set_blocking( bool should_block ) noexcept
@@ -0,0 +1,614 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_ASYNC_H
+#define LIB_MART_COMMON_GUARD_NW_ASYNC_H
+/**
+ * async.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Asynchronous socket operations driven by mart::nw::Reactor
+ *			(completion handlers and - if available - c++20 coroutines)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "RaiiSocket.hpp"
+#include "port_layer.hpp"
+#include "reactor.hpp"
+#include "tcp.hpp"
+#include "udp.hpp"
+
+#include "detail/socket_base.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#if defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+#include <coroutine>
+#include <exception>
+#define MART_NETLIB_HAS_COROUTINES 1
+#else
+#define MART_NETLIB_HAS_COROUTINES 0
+#endif
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+/*
+ * Usage example (completion handlers):
+ *
+ * mart::nw::Reactor        reactor;
+ * udp::Socket              sock( local_ep, remote_ep );
+ * mart::nw::AsyncDgramSocket async( reactor, sock );
+ *
+ * async.async_recv( buffer, [&]( mart::nw::socks::ReturnValue<std::size_t> res ) { ... } );
+ * reactor.run();
+ *
+ * Usage example (c++20):
+ *
+ * mart::nw::DetachedTask echo( tcp::AsyncSocket& sock )
+ * {
+ * 	std::array<char, 1024> buffer;
+ * 	while( true ) {
+ * 		auto res = co_await sock.async_recv( mart::view_bytes_mutable( buffer ) );
+ * 		if( !res || res.value() == 0 ) { co_return; }
+ * 		co_await sock.async_send( mart::view_bytes( buffer ).subview( 0, res.value() ) );
+ * 	}
+ * }
+ */
+
+namespace mart::nw {
+
+namespace _detail_async_ {
+
+inline bool would_block( socks::ErrorCode ec ) noexcept
+{
+	using socks::ErrorCodeValues;
+	const auto v = ec.value();
+	return v == ErrorCodeValues::WouldBlock || v == ErrorCodeValues::TryAgain || v == ErrorCodeValues::InProgress;
+}
+
+template<class T>
+bool would_block( const socks::ReturnValue<T>& res ) noexcept
+{
+	return would_block( res.error_code() );
+}
+
+inline socks::ReturnValue<std::size_t> to_size_result( socks::ReturnValue<socks::txrx_size_t> res ) noexcept
+{
+	if( !res.success() ) { return socks::ReturnValue<std::size_t>( res.error_code() ); }
+	return socks::ReturnValue<std::size_t>( static_cast<std::size_t>( res.value() ) );
+}
+
+// result of a single accept attempt. The tcp::Socket is only created after the operation completed
+struct AcceptedHandle {
+	explicit AcceptedHandle( socks::ErrorCode ec ) noexcept
+		: handle( ec )
+	{
+	}
+	AcceptedHandle( socks::ReturnValue<socks::port_layer::handle_t> h, ip::tcp::endpoint ep ) noexcept
+		: handle( h )
+		, remote( ep )
+	{
+	}
+
+	socks::ReturnValue<socks::port_layer::handle_t> handle;
+	ip::tcp::endpoint                               remote{};
+};
+
+inline bool would_block( const AcceptedHandle& res ) noexcept
+{
+	return would_block( res.handle );
+}
+
+struct AcceptOp {
+	socks::RaiiSocket* sock;
+
+	AcceptedHandle operator()() const noexcept
+	{
+		socks::port_layer::SockaddrIn addr;
+
+		const auto res = socks::port_layer::accept( sock->get_handle(), addr );
+		return AcceptedHandle( res, res.success() ? ip::tcp::endpoint( addr ) : ip::tcp::endpoint{} );
+	}
+};
+
+} // namespace _detail_async_
+
+/**
+ * Registration of a single socket with a Reactor, which drives at most one pending read operation
+ * (recv, recvfrom, accept) and one pending write operation (send, sendto, connect).
+ *
+ * - The socket is switched to non-blocking mode.
+ * - start() tries the operation right away. Only if it would block, the socket gets registered with the reactor
+ *   and the operation is retried on a reactor thread whenever the socket becomes ready. So, if the operation can
+ *   complete immediately, the handler is called before start() returns.
+ * - Starting an operation while another one in the same direction is pending
+ *   completes with ErrorCodeValues::InvalidArgument.
+ * - Errors are passed to the handler. Nothing here throws (except for memory allocation failures).
+ * - Not thread safe: Operations have to be started from the thread executing the completion handlers
+ *   (or while the reactor isn't running) and the AsyncIo object has to outlive its pending operations.
+ *   Destroying it drops pending operations without calling their handlers.
+ *
+ * Normally used via AsyncDgramSocket, tcp::AsyncSocket and tcp::AsyncAcceptor.
+ */
+class AsyncIo {
+public:
+	enum class Direction { Read, Write };
+
+	AsyncIo( Reactor& reactor, socks::RaiiSocket& socket ) noexcept
+		: _reactor( reactor )
+		, _socket( socket )
+	{
+		_socket.set_blocking( false );
+	}
+	~AsyncIo()
+	{
+		if( _registered ) { _reactor.remove( _socket ); }
+	}
+
+	AsyncIo( const AsyncIo& ) = delete;
+	AsyncIo& operator=( const AsyncIo& ) = delete;
+
+	Reactor&           reactor() noexcept { return _reactor; }
+	socks::RaiiSocket& socket() noexcept { return _socket; }
+
+	bool is_pending( Direction dir ) const noexcept { return _pending[_idx( dir )] != nullptr; }
+
+	/**
+	 * Calls @p op until its result doesn't indicate WouldBlock / TryAgain / InProgress and
+	 * passes that result to @p handler.
+	 *
+	 * op() has to return an ErrorCode or a ReturnValue<T>
+	 */
+	template<class Op, class Handler>
+	void start( Direction dir, Op op, Handler handler )
+	{
+		using Result = decltype( op() );
+		if( is_pending( dir ) ) {
+			handler( Result( socks::ErrorCode{socks::ErrorCodeValues::InvalidArgument} ) );
+			return;
+		}
+
+		Result res = op();
+		if( !_detail_async_::would_block( res ) ) {
+			handler( std::move( res ) );
+			return;
+		}
+
+		const auto ec = _enqueue( dir, std::move( op ), std::move( handler ) );
+		if( !ec.success() ) { std::exchange( _pending[_idx( dir )], nullptr )->fail( ec ); }
+	}
+
+	/**
+	 * Like start, but doesn't try the operation before the socket signaled readiness.
+	 * Returns an error (and drops @p handler without calling it) if the operation couldn't be queued.
+	 */
+	template<class Op, class Handler>
+	socks::ErrorCode wait_and_retry( Direction dir, Op op, Handler handler )
+	{
+		if( is_pending( dir ) ) { return socks::ErrorCode{socks::ErrorCodeValues::InvalidArgument}; }
+
+		const auto ec = _enqueue( dir, std::move( op ), std::move( handler ) );
+		if( !ec.success() ) { _pending[_idx( dir )].reset(); }
+		return ec;
+	}
+
+private:
+	struct PendingOp {
+		virtual ~PendingOp()                     = default;
+		virtual bool try_complete()              = 0;
+		virtual void complete()                  = 0;
+		virtual void fail( socks::ErrorCode ec ) = 0;
+	};
+
+	template<class Op, class Handler>
+	struct PendingOpImpl final : PendingOp {
+		using Result = decltype( std::declval<Op&>()() );
+
+		PendingOpImpl( Op&& op, Handler&& handler )
+			: _op( std::move( op ) )
+			, _handler( std::move( handler ) )
+		{
+		}
+
+		bool try_complete() override
+		{
+			_result.emplace( _op() );
+			return !_detail_async_::would_block( *_result );
+		}
+		void complete() override { _handler( std::move( *_result ) ); }
+		void fail( socks::ErrorCode ec ) override { _handler( Result( ec ) ); }
+
+		Op                    _op;
+		Handler               _handler;
+		std::optional<Result> _result;
+	};
+
+	static constexpr std::size_t _idx( Direction dir ) noexcept { return dir == Direction::Read ? 0 : 1; }
+
+	template<class Op, class Handler>
+	socks::ErrorCode _enqueue( Direction dir, Op&& op, Handler&& handler )
+	{
+		_pending[_idx( dir )] = std::make_unique<PendingOpImpl<Op, Handler>>( std::move( op ), std::move( handler ) );
+		return _update_registration();
+	}
+
+	void _on_event( IoEvents events )
+	{
+		// errors and hang ups are reported by the operations themselves
+		const bool failure = has_any( events, IoEvents::Error | IoEvents::HangUp );
+
+		std::unique_ptr<PendingOp> done[2];
+		for( auto dir : {Direction::Read, Direction::Write} ) {
+			auto&      slot  = _pending[_idx( dir )];
+			const auto ready = dir == Direction::Read ? IoEvents::Readable : IoEvents::Writable;
+			if( slot && ( failure || has_any( events, ready ) ) && slot->try_complete() ) {
+				done[_idx( dir )] = std::move( slot );
+			}
+		}
+
+		// can't fail: modifying a registration from within its callback only stores the new interest
+		_update_registration();
+
+		// handlers might start new operations or destroy this object, so they have to be called last
+		for( auto& op : done ) {
+			if( op ) { op->complete(); }
+		}
+	}
+
+	socks::ErrorCode _update_registration()
+	{
+		const auto interest = ( _pending[0] ? IoEvents::Readable : IoEvents::None )
+							  | ( _pending[1] ? IoEvents::Writable : IoEvents::None );
+
+		if( interest == IoEvents::None ) {
+			// an idle socket would still report hang ups over and over again
+			if( _registered ) {
+				_reactor.remove( _socket );
+				_registered = false;
+			}
+			return socks::ErrorCode::Ok();
+		}
+
+		if( !_registered ) {
+			const auto ec = _reactor.try_add( _socket, interest, [this]( IoEvents events ) { _on_event( events ); } );
+			_registered   = ec.success();
+			_interest     = interest;
+			return ec;
+		}
+
+		if( interest == _interest ) { return socks::ErrorCode::Ok(); }
+		_interest = interest;
+		return _reactor.try_modify( _socket, interest );
+	}
+
+	Reactor&                   _reactor;
+	socks::RaiiSocket&         _socket;
+	std::unique_ptr<PendingOp> _pending[2];
+	IoEvents                   _interest   = IoEvents::None;
+	bool                       _registered = false;
+};
+
+#if MART_NETLIB_HAS_COROUTINES
+
+/**
+ * Minimal coroutine type for fire and forget coroutines: It starts executing immediately and
+ * frees its frame, when it finishes. Exceptions escaping the coroutine call std::terminate.
+ */
+struct DetachedTask {
+	struct promise_type {
+		DetachedTask       get_return_object() noexcept { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void               return_void() noexcept {}
+		void               unhandled_exception() noexcept { std::terminate(); }
+	};
+};
+
+/**
+ * Awaitable for a single operation on an AsyncIo. The coroutine is only suspended if the operation would block
+ * and is then resumed on the reactor thread that completed the operation.
+ */
+template<class Op>
+class IoAwaitable {
+public:
+	using result_type = decltype( std::declval<Op&>()() );
+
+	IoAwaitable( AsyncIo& io, AsyncIo::Direction dir, Op op )
+		: _io( io )
+		, _dir( dir )
+		, _op( std::move( op ) )
+	{
+	}
+
+	bool await_ready()
+	{
+		if( _io.is_pending( _dir ) ) {
+			_result.emplace( socks::ErrorCode{socks::ErrorCodeValues::InvalidArgument} );
+			return true;
+		}
+		_result.emplace( _op() );
+		return !_detail_async_::would_block( *_result );
+	}
+
+	bool await_suspend( std::coroutine_handle<> coro )
+	{
+		const auto ec = _io.wait_and_retry( _dir, std::move( _op ), [this, coro]( result_type res ) {
+			_result.emplace( std::move( res ) );
+			coro.resume();
+		} );
+		if( ec.success() ) { return true; }
+		_result.emplace( ec );
+		return false;
+	}
+
+	result_type await_resume() { return std::move( *_result ); }
+
+private:
+	AsyncIo&                   _io;
+	AsyncIo::Direction         _dir;
+	Op                         _op;
+	std::optional<result_type> _result;
+};
+
+#endif
+
+/**
+ * Asynchronous operations for a datagram socket (e.g. udp::Socket).
+ * Handlers are called with a socks::ReturnValue<std::size_t> containing the number of transferred bytes.
+ * Buffers (and the endpoint passed to async_recvfrom) have to stay valid until the operation completed.
+ */
+template<class EndpointT>
+class AsyncDgramSocket {
+public:
+	using socket_type = socks::detail::DgramSocket<EndpointT>;
+	using endpoint    = EndpointT;
+
+	AsyncDgramSocket( Reactor& reactor, socket_type& socket ) noexcept
+		: _socket( socket )
+		, _io( reactor, socket.as_raii_socket() )
+	{
+	}
+
+	socket_type& socket() noexcept { return _socket; }
+
+	template<class Handler>
+	void async_recv( mart::MemoryView buffer, Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Read, _recv_op( buffer ), std::forward<Handler>( handler ) );
+	}
+
+	template<class Handler>
+	void async_recvfrom( mart::MemoryView buffer, endpoint& from, Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Read, _recvfrom_op( buffer, from ), std::forward<Handler>( handler ) );
+	}
+
+	template<class Handler>
+	void async_send( mart::ConstMemoryView data, Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Write, _send_op( data ), std::forward<Handler>( handler ) );
+	}
+
+	template<class Handler>
+	void async_sendto( mart::ConstMemoryView data, endpoint to, Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Write, _sendto_op( data, to ), std::forward<Handler>( handler ) );
+	}
+
+#if MART_NETLIB_HAS_COROUTINES
+	auto async_recv( mart::MemoryView buffer ) { return IoAwaitable( _io, AsyncIo::Direction::Read, _recv_op( buffer ) ); }
+	auto async_recvfrom( mart::MemoryView buffer, endpoint& from )
+	{
+		return IoAwaitable( _io, AsyncIo::Direction::Read, _recvfrom_op( buffer, from ) );
+	}
+	auto async_send( mart::ConstMemoryView data )
+	{
+		return IoAwaitable( _io, AsyncIo::Direction::Write, _send_op( data ) );
+	}
+	auto async_sendto( mart::ConstMemoryView data, endpoint to )
+	{
+		return IoAwaitable( _io, AsyncIo::Direction::Write, _sendto_op( data, to ) );
+	}
+#endif
+
+private:
+	auto _recv_op( mart::MemoryView buffer )
+	{
+		return [sock = &_io.socket(), buffer] { return _detail_async_::to_size_result( sock->recv( buffer, 0 ).result ); };
+	}
+	auto _recvfrom_op( mart::MemoryView buffer, endpoint& from )
+	{
+		return [sock = &_io.socket(), buffer, from = &from] {
+			typename endpoint::abi_endpoint_type addr{};
+
+			const auto res = sock->recvfrom( buffer, 0, addr );
+			if( res.result.success() ) { *from = endpoint( addr ); }
+			return _detail_async_::to_size_result( res.result );
+		};
+	}
+	auto _send_op( mart::ConstMemoryView data )
+	{
+		return [sock = &_io.socket(), data] { return _detail_async_::to_size_result( sock->send( data, 0 ).result ); };
+	}
+	auto _sendto_op( mart::ConstMemoryView data, endpoint to )
+	{
+		return [sock = &_io.socket(), data, to] {
+			return _detail_async_::to_size_result( sock->sendto( data, 0, to.toSockAddr() ).result );
+		};
+	}
+
+	socket_type& _socket;
+	AsyncIo      _io;
+};
+
+template<class EndpointT>
+AsyncDgramSocket( Reactor&, socks::detail::DgramSocket<EndpointT>& ) -> AsyncDgramSocket<EndpointT>;
+
+namespace ip::udp {
+using AsyncSocket = AsyncDgramSocket<endpoint>;
+} // namespace ip::udp
+
+namespace ip::tcp {
+
+struct AcceptResult {
+	socks::ErrorCode error;
+	Socket           socket;
+};
+
+/**
+ * Asynchronous operations for a tcp::Socket.
+ * async_send / async_recv handlers are called with a socks::ReturnValue<std::size_t> containing the number of
+ * transferred bytes (which might be less than requested; 0 bytes received means the peer closed the connection).
+ * async_connect handlers are called with a socks::ErrorCode.
+ */
+class AsyncSocket {
+public:
+	AsyncSocket( Reactor& reactor, Socket& socket ) noexcept
+		: _socket( socket )
+		, _io( reactor, socket.as_raii_socket() )
+	{
+	}
+
+	Socket& socket() noexcept { return _socket; }
+
+	template<class Handler>
+	void async_connect( endpoint ep, Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Write, _connect_op( ep ), std::forward<Handler>( handler ) );
+	}
+
+	template<class Handler>
+	void async_send( mart::ConstMemoryView data, Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Write, _send_op( data ), std::forward<Handler>( handler ) );
+	}
+
+	template<class Handler>
+	void async_recv( mart::MemoryView buffer, Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Read, _recv_op( buffer ), std::forward<Handler>( handler ) );
+	}
+
+private:
+	// defined before the awaitable overloads, which need the deduced return types
+	auto _connect_op( endpoint ep )
+	{
+		// the first call starts the connect, subsequent calls (after the socket became writable) query the result
+		return [sock = &_socket, ep, started = false]() mutable {
+			auto& raii = sock->as_raii_socket();
+
+			socks::ErrorCode res = socks::ErrorCode::Ok();
+			if( !started ) {
+				started = true;
+				res     = raii.connect( ep.toSockAddr() );
+			} else {
+				int error = 0;
+				res       = raii.getsockopt( socks::SocketOptionLevel::Socket, socks::SocketOption::so_error, error );
+				if( res.success() && error != 0 ) { res = socks::ErrorCode{socks::ErrorCodeValues( error )}; }
+			}
+			if( res.success() ) {
+				const auto local = Socket::getSockAddress( raii );
+				sock->_ep_remote = ep;
+				sock->_ep_local  = local.ep;
+				res              = local.result;
+			}
+			return res;
+		};
+	}
+	auto _send_op( mart::ConstMemoryView data )
+	{
+		return [sock = &_socket.as_raii_socket(), data] {
+			return _detail_async_::to_size_result( sock->send( data, 0 ).result );
+		};
+	}
+	auto _recv_op( mart::MemoryView buffer )
+	{
+		return [sock = &_socket.as_raii_socket(), buffer] {
+			return _detail_async_::to_size_result( sock->recv( buffer, 0 ).result );
+		};
+	}
+
+public:
+#if MART_NETLIB_HAS_COROUTINES
+	auto async_connect( endpoint ep ) { return IoAwaitable( _io, AsyncIo::Direction::Write, _connect_op( ep ) ); }
+	auto async_send( mart::ConstMemoryView data )
+	{
+		return IoAwaitable( _io, AsyncIo::Direction::Write, _send_op( data ) );
+	}
+	auto async_recv( mart::MemoryView buffer ) { return IoAwaitable( _io, AsyncIo::Direction::Read, _recv_op( buffer ) ); }
+#endif
+
+private:
+	Socket& _socket;
+	AsyncIo _io;
+};
+
+/**
+ * Asynchronous accept for a listening tcp::Acceptor. Handlers are called with an AcceptResult
+ */
+class AsyncAcceptor {
+public:
+	AsyncAcceptor( Reactor& reactor, Acceptor& acceptor ) noexcept
+		: _acceptor( acceptor )
+		, _io( reactor, acceptor.getSocket() )
+	{
+	}
+
+	Acceptor& acceptor() noexcept { return _acceptor; }
+
+	template<class Handler>
+	void async_accept( Handler&& handler )
+	{
+		_io.start( AsyncIo::Direction::Read,
+				   _detail_async_::AcceptOp{&_acceptor.getSocket()},
+				   [handler = std::forward<Handler>( handler )]( _detail_async_::AcceptedHandle&& res ) mutable {
+					   handler( _to_accept_result( std::move( res ) ) );
+				   } );
+	}
+
+#if MART_NETLIB_HAS_COROUTINES
+	auto async_accept()
+	{
+		return AcceptAwaitable( _io, AsyncIo::Direction::Read, _detail_async_::AcceptOp{&_acceptor.getSocket()} );
+	}
+#endif
+
+private:
+#if MART_NETLIB_HAS_COROUTINES
+	struct AcceptAwaitable : IoAwaitable<_detail_async_::AcceptOp> {
+		using IoAwaitable<_detail_async_::AcceptOp>::IoAwaitable;
+		AcceptResult await_resume() { return _to_accept_result( IoAwaitable<_detail_async_::AcceptOp>::await_resume() ); }
+	};
+#endif
+
+
+	static AcceptResult _to_accept_result( _detail_async_::AcceptedHandle&& res )
+	{
+		if( !res.handle.success() ) { return AcceptResult{res.handle.error_code(), Socket( socks::RaiiSocket{}, {}, {} )}; }
+
+		socks::RaiiSocket sock( res.handle.value() );
+		const auto        local = Socket::getSockAddress( sock );
+		return AcceptResult{local.result, Socket( std::move( sock ), local.ep, res.remote )};
+	}
+
+	Acceptor& _acceptor;
+	AsyncIo   _io;
+};
+
+} // namespace ip::tcp
+
+} // namespace mart::nw
+
+#endif
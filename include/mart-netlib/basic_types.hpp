@@ -195,9 +195,26 @@ enum class TransportType {
 
 enum class Protocol { Default, Udp, Tcp };
 
-enum class SocketOptionLevel { Socket };
-
-enum class SocketOption { so_rcvtimeo, so_sndtimeo, so_reuseaddr };
+enum class SocketOptionLevel { Socket, Tcp };
+
+// Options that are not supported by a platform (e.g. so_reuseport on windows, most of the
+// latency related options are linux only) make setsockopt/getsockopt fail with InvalidArgument
+enum class SocketOption {
+	// SocketOptionLevel::Socket
+	so_rcvtimeo,
+	so_sndtimeo,
+	so_reuseaddr,
+	so_reuseport,
+	so_rcvbuf,
+	so_sndbuf,
+	so_error,
+	so_busy_poll,
+	so_priority,
+	so_timestampns,
+	// SocketOptionLevel::Tcp
+	tcp_nodelay,
+	tcp_quickack,
+};
 
 enum class Direction { Tx, Rx };
 
@@ -240,6 +257,8 @@ enum class ErrorCodeValues : int {
 	TryAgain        = EAGAIN,
 	InvalidArgument = EINVAL,
 	WouldBlock      = EWOULDBLOCK,
+	InProgress      = EINPROGRESS, // non-blocking connect
+	MessageSize     = EMSGSIZE,    // datagram could not be sent in one piece
 	Timeout         = 10060,     // Windows
 	WsaeConnReset   = 0x00002746 // Windows WSAECONNRESET ECONNRESET
 };
@@ -18,6 +18,7 @@
 /* ######## INCLUDES ######### */
 /* Project Includes */
 #include <mart-netlib/RaiiSocket.hpp>
+#include <mart-netlib/packet_pool.hpp>
 #include <mart-netlib/port_layer.hpp>
 
 /* Proprietary Library Includes */
@@ -68,15 +69,48 @@ public:
 	std::chrono::microseconds get_tx_timeout() const;
 	std::chrono::microseconds get_rx_timeout() const;
 
-	inline bool try_set_blocking( bool should_block )       noexcept { return _socket.set_blocking( should_block ).success(); }
+	/* The try_ functions return true on success. The overloads taking an ErrorCode also report why they failed */
+	inline bool try_set_blocking( bool should_block )                         noexcept { return _socket.set_blocking( should_block ).success(); }
+	inline bool try_set_blocking( bool should_block, ErrorCode& error )       noexcept { error = _socket.set_blocking( should_block ); return error.success(); }
 	       void set_blocking( bool should_block );
-	inline bool is_blocking()                         const noexcept { return _socket.is_blocking(); }
-	inline bool is_valid()                            const noexcept { return _socket.is_valid(); }
-
-	inline bool try_close() noexcept { return _socket.close().success(); }
-	void close();
+	inline bool is_blocking()                                           const noexcept { return _socket.is_blocking(); }
+	inline bool is_valid()                                              const noexcept { return _socket.is_valid(); }
+
+	inline bool try_close()                   noexcept { return _socket.close().success(); }
+	inline bool try_close( ErrorCode& error ) noexcept { error = _socket.close(); return error.success(); }
+	       void close();
+
+	/* ###### latency / throughput tuning ######
+	 * Options that are not supported by the platform or socket type fail with ErrorCodeValues::InvalidArgument
+	 */
+	// disables Nagle's algorithm (tcp only)
+	inline ErrorCode try_set_tcp_nodelay( bool enable )                      noexcept { return _set_option( SocketOptionLevel::Tcp,    SocketOption::tcp_nodelay,    enable ); }
+	// acks are sent immediately instead of being delayed (tcp, linux only - the kernel may reset this flag at any time)
+	inline ErrorCode try_set_tcp_quickack( bool enable )                     noexcept { return _set_option( SocketOptionLevel::Tcp,    SocketOption::tcp_quickack,   enable ); }
+	// blocking receives busy poll the device queue for up to @p duration before sleeping (linux only)
+	inline ErrorCode try_set_busy_poll( std::chrono::microseconds duration ) noexcept { return _set_option( SocketOptionLevel::Socket, SocketOption::so_busy_poll,   static_cast<int>( duration.count() ) ); }
+	inline ErrorCode try_set_rx_buffer_size( int bytes )                     noexcept { return _set_option( SocketOptionLevel::Socket, SocketOption::so_rcvbuf,      bytes ); }
+	inline ErrorCode try_set_tx_buffer_size( int bytes )                     noexcept { return _set_option( SocketOptionLevel::Socket, SocketOption::so_sndbuf,      bytes ); }
+	// priority of outgoing packets (linux only, values above 6 require CAP_NET_ADMIN)
+	inline ErrorCode try_set_priority( int priority )                        noexcept { return _set_option( SocketOptionLevel::Socket, SocketOption::so_priority,    priority ); }
+	// the kernel records the receive time of each datagram (see DgramSocket::recvfrom_timestamped, linux only)
+	inline ErrorCode try_set_rx_timestamps( bool enable )                    noexcept { return _set_option( SocketOptionLevel::Socket, SocketOption::so_timestampns, enable ); }
+
+	void set_tcp_nodelay( bool enable );
+	void set_tcp_quickack( bool enable );
+	void set_busy_poll( std::chrono::microseconds duration );
+	void set_rx_buffer_size( int bytes );
+	void set_tx_buffer_size( int bytes );
+	void set_priority( int priority );
+	void set_rx_timestamps( bool enable );
 
 	// clang-format on
+protected:
+	ErrorCode _set_option( SocketOptionLevel level, SocketOption option, int value ) noexcept
+	{
+		return _socket.setsockopt( level, option, value );
+	}
+
 protected:
 	nw::socks::RaiiSocket _socket;
 };
@@ -106,6 +140,12 @@ public:
 		auto r = _socket.send( data, 0 );
 		return r.result.success();
 	}
+	bool try_send( mart::ConstMemoryView data, ErrorCode& error ) noexcept
+	{
+		auto r = _socket.send( data, 0 );
+		error  = r.result.error_code();
+		return error.success();
+	}
 	void send( mart::ConstMemoryView data );
 
 	mart::MemoryView try_recv( mart::MemoryView buffer ) noexcept { return _socket.recv( buffer, 0 ).received_data; }
@@ -135,15 +175,25 @@ public:
 	void             connect( endpoint ep );
 
 	bool try_sendto( mart::ConstMemoryView data, endpoint ep ) noexcept
+	{
+		ErrorCode error = ErrorCode::Ok();
+		return try_sendto( data, ep, error );
+	}
+	bool try_sendto( mart::ConstMemoryView data, endpoint ep, ErrorCode& error ) noexcept
 	{
 		auto ret = _socket.sendto( data, 0, ep.toSockAddr() );
-		return _txWasSuccess( data, ret );
+		error    = _tx_result( data.size(), ret.result );
+		return error.success();
+	}
+	bool try_sendto_default( mart::ConstMemoryView data ) noexcept
+	{
+		assert( _ep_remote.valid() );
+		return try_sendto( data, _ep_remote );
 	}
-	bool try_sendto_default( mart::ConstMemoryView data )
+	bool try_sendto_default( mart::ConstMemoryView data, ErrorCode& error ) noexcept
 	{
 		assert( _ep_remote.valid() );
-		auto ret = _socket.sendto( data, 0, _ep_remote.toSockAddr() );
-		return _txWasSuccess( data, ret );
+		return try_sendto( data, _ep_remote, error );
 	}
 	void sendto( mart::ConstMemoryView data, endpoint ep );
 
@@ -153,9 +203,27 @@ public:
 		sendto( data, _ep_remote );
 	}
 
+	/**
+	 * Sends all buffers as a single datagram (e.g. a header and a payload) without copying
+	 * them into a temporary buffer. At most socks::port_layer::max_iov_cnt buffers are supported.
+	 */
+	bool try_sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep ) noexcept
+	{
+		ErrorCode error = ErrorCode::Ok();
+		return try_sendto( data, ep, error );
+	}
+	bool try_sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep, ErrorCode& error ) noexcept
+	{
+		const auto addr = ep.toSockAddr();
+		error           = _tx_result( _total_size( data ), _socket.sendmsg( data, 0, &addr ) );
+		return error.success();
+	}
+	void sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep );
+
 	struct RecvfromResult {
 		mart::MemoryView data;
 		endpoint         remote_address;
+		ErrorCode        error = ErrorCode::Ok();
 	};
 	RecvfromResult try_recvfrom( mart::MemoryView buffer ) noexcept
 	{
@@ -164,10 +232,93 @@ public:
 
 		auto res = _socket.recvfrom( buffer, 0, addr );
 
-		return { res.received_data, endpoint( addr ) };
+		return { res.received_data, endpoint( addr ), res.result.error_code() };
 	}
 	RecvfromResult recvfrom( mart::MemoryView buffer );
 
+	// system_clock time point with nanosecond resolution
+	using Timestamp = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>;
+
+	struct TimestampedRecvfromResult {
+		mart::MemoryView data;
+		endpoint         remote_address;
+		Timestamp        rx_time; // when the kernel received the datagram (epoch, if not available)
+		ErrorCode        error = ErrorCode::Ok();
+	};
+
+	/**
+	 * Like recvfrom, but also returns the time at which the datagram was received by the kernel,
+	 * which (unlike a timestamp taken after recvfrom returns) doesn't include scheduling delays.
+	 * Requires set_rx_timestamps( true ) and is only supported on linux.
+	 */
+	TimestampedRecvfromResult try_recvfrom_timestamped( mart::MemoryView buffer ) noexcept
+	{
+		using abiep = typename EndpointT::abi_endpoint_type;
+		abiep addr{};
+
+		std::chrono::nanoseconds ts{ 0 };
+		auto                     res = _socket.recvfrom_with_timestamp( buffer, 0, addr, ts );
+
+		return { res.received_data, endpoint( addr ), Timestamp( ts ), res.result.error_code() };
+	}
+	TimestampedRecvfromResult recvfrom_timestamped( mart::MemoryView buffer );
+
+	struct PooledRecvfromResult {
+		Packet    packet; // empty, if nothing was received
+		endpoint  remote_address;
+		ErrorCode error = ErrorCode::Ok();
+	};
+
+	/**
+	 * Receives a datagram into a buffer taken from @p pool, so the payload can be handed to
+	 * other threads without copying it. Datagrams bigger than pool.buffer_size() are truncated.
+	 * If the pool is exhausted, try_recvfrom returns an empty packet with error ENOBUFS, recvfrom throws.
+	 */
+	PooledRecvfromResult try_recvfrom( PacketPool& pool ) noexcept;
+	PooledRecvfromResult recvfrom( PacketPool& pool );
+
+	struct ScatterRecvfromResult {
+		std::size_t size; // total number of received bytes (0 if nothing was received)
+		endpoint    remote_address;
+		ErrorCode   error = ErrorCode::Ok();
+	};
+
+	// Receives a datagram that is split across @p buffers (filled in order)
+	ScatterRecvfromResult try_recvfrom( mart::ArrayView<const mart::MemoryView> buffers ) noexcept
+	{
+		using abiep = typename EndpointT::abi_endpoint_type;
+		abiep addr{};
+
+		const auto res = _socket.recvmsg( buffers, 0, &addr );
+		if( !res ) { return { 0, {}, res.error_code() }; }
+		return { static_cast<std::size_t>( res.value() ), endpoint( addr ) };
+	}
+	ScatterRecvfromResult recvfrom( mart::ArrayView<const mart::MemoryView> buffers );
+
+	struct SendBatchEntry {
+		mart::ConstMemoryView data;
+		endpoint              remote_address;
+	};
+
+	struct RecvBatchEntry {
+		mart::MemoryView buffer;         // where the datagram is stored
+		mart::MemoryView data;           // received part of buffer (set by recv_batch)
+		endpoint         remote_address; // set by recv_batch
+	};
+
+	/**
+	 * Sends all datagrams in @p msgs with as few system calls as possible (sendmmsg on linux).
+	 * Returns the number of datagrams that were sent (an error only if not even the first one could be sent)
+	 */
+	socks::ReturnValue<std::size_t> send_batch( mart::ArrayView<const SendBatchEntry> msgs ) noexcept;
+
+	/**
+	 * Receives up to msgs.size() datagrams with as few system calls as possible (recvmmsg on linux).
+	 * A blocking socket only waits for the first datagram.
+	 * Returns the number of received datagrams (an error only if nothing could be received)
+	 */
+	socks::ReturnValue<std::size_t> recv_batch( mart::ArrayView<RecvBatchEntry> msgs ) noexcept;
+
 	void clearRxBuff();
 
 	auto close()
@@ -187,9 +338,20 @@ public:
 	void set_default_remote_endpoint( endpoint ep ) noexcept { _ep_remote = std::move( ep ); }
 
 private:
-	static inline bool _txWasSuccess( mart::ConstMemoryView data, const mart::nw::socks::RaiiSocket::SendResult& ret )
+	// With datagrams, sending only part of the data is an error too
+	static ErrorCode _tx_result( std::size_t size, ReturnValue<txrx_size_t> ret ) noexcept
+	{
+		if( !ret ) { return ret.error_code(); }
+		if( static_cast<std::size_t>( ret.value() ) != size ) { return ErrorCode{ ErrorCodeValues::MessageSize }; }
+		return ErrorCode::Ok();
+	}
+	static std::size_t _total_size( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
 	{
-		return ret.result.success() && mart::narrow<nw::socks::txrx_size_t>( data.size() ) == ret.result.value();
+		std::size_t size = 0;
+		for( const auto& d : data ) {
+			size += d.size();
+		}
+		return size;
 	}
 	endpoint _ep_local{};
 	endpoint _ep_remote{};
@@ -0,0 +1,161 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_IO_QUEUE_H
+#define LIB_MART_COMMON_GUARD_NW_IO_QUEUE_H
+/**
+ * io_queue.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Completion based socket operation queue (io_uring with epoll fallback)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "RaiiSocket.hpp"
+#include "port_layer.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+/*
+ * Usage example:
+ *
+ * mart::nw::IoQueue queue;
+ * queue.register_socket( sock.as_raii_socket() );
+ * queue.register_buffers( buffers );
+ *
+ * for( std::size_t i = 0; i < buffers.size(); ++i ) {
+ * 	queue.recv( sock.as_raii_socket(), buffers[i], i );
+ * }
+ *
+ * std::array<IoQueue::Completion, 32> completions;
+ * while( true ) {
+ * 	const auto cnt = queue.reap( completions, 100ms );
+ * 	for( const auto& c : mart::view_elements( completions ).subview( 0, cnt ) ) {
+ * 		... process buffers[c.user_data] ...
+ * 		queue.recv( sock.as_raii_socket(), buffers[c.user_data], c.user_data );
+ * 	}
+ * }
+ */
+
+/**
+ * Queue of asynchronous recv / send / accept operations, whose results are collected in batches.
+ *
+ * Operations are only queued by recv(), send() and accept(). They are handed to the kernel by submit()
+ * (or reap()), which - with the io_uring backend - submits all queued operations with a single system call.
+ * reap() collects the results of finished operations.
+ *
+ * - Backend::IoUring: Sockets registered via register_socket() are used as fixed files and
+ *   receives into memory registered via register_buffers() use the registered buffers (IORING_OP_READ_FIXED).
+ *   Sends always use IORING_OP_SEND, because writes to a socket could raise SIGPIPE.
+ * - Backend::Epoll: Used, if the library was built without io_uring support (cmake option MART_NETLIB_USE_IO_URING),
+ *   if the kernel doesn't support io_uring or if it was requested explicitly. Operations are executed (non-blocking)
+ *   when epoll reports the socket as ready. register_socket / register_buffers have no effect.
+ *
+ * Only the epoll backend guarantees, that operations on the same socket and in the same direction complete in
+ * the order they were queued, so don't queue more than one send per stream socket at a time.
+ * Buffers have to stay valid and sockets open until the operation completed.
+ *
+ * An IoQueue is not thread safe. Errors during setup throw mart::nw::generic_nw_error.
+ * Requires linux.
+ */
+class IoQueue {
+public:
+	using handle_t = socks::port_layer::handle_t;
+	using UserData = std::uint64_t;
+
+	enum class Backend { IoUring, Epoll };
+
+	struct Completion {
+		UserData                        user_data;
+		socks::ReturnValue<std::size_t> result;   // number of transferred bytes (0 for accept)
+		handle_t                        accepted; // accepted connection (only for accept)
+	};
+
+	static constexpr std::size_t default_queue_depth = 256;
+	static constexpr std::size_t max_fixed_files     = 64;
+
+	explicit IoQueue( std::size_t queue_depth = default_queue_depth, Backend preferred = Backend::IoUring );
+	~IoQueue();
+
+	IoQueue( const IoQueue& ) = delete;
+	IoQueue& operator=( const IoQueue& ) = delete;
+
+	Backend backend() const noexcept;
+
+	// true if this library was built with io_uring support and the kernel supports it
+	static bool is_io_uring_supported() noexcept;
+
+	/* ###### registration ###### */
+	// Returns false if the socket couldn't be registered (e.g. all max_fixed_files slots are in use)
+	bool register_socket( handle_t handle ) noexcept;
+	bool register_socket( const socks::RaiiSocket& socket ) noexcept { return register_socket( socket.get_handle() ); }
+
+	// Has to be called before the socket is closed. No operation on the socket may be pending
+	bool unregister_socket( handle_t handle ) noexcept;
+	bool unregister_socket( const socks::RaiiSocket& socket ) noexcept
+	{
+		return unregister_socket( socket.get_handle() );
+	}
+
+	// Registers memory that is used as receive buffer. Can only be called once (until unregister_buffers is called)
+	socks::ErrorCode register_buffers( mart::ArrayView<const mart::MemoryView> buffers ) noexcept;
+	socks::ErrorCode unregister_buffers() noexcept;
+
+	/* ###### operations ###### */
+	// Return false if the queue is full (call reap() and try again)
+	bool recv( handle_t handle, mart::MemoryView buffer, UserData user_data ) noexcept;
+	bool recv( const socks::RaiiSocket& socket, mart::MemoryView buffer, UserData user_data ) noexcept
+	{
+		return recv( socket.get_handle(), buffer, user_data );
+	}
+
+	bool send( handle_t handle, mart::ConstMemoryView data, UserData user_data ) noexcept;
+	bool send( const socks::RaiiSocket& socket, mart::ConstMemoryView data, UserData user_data ) noexcept
+	{
+		return send( socket.get_handle(), data, user_data );
+	}
+
+	bool accept( handle_t handle, UserData user_data ) noexcept;
+	bool accept( const socks::RaiiSocket& socket, UserData user_data ) noexcept
+	{
+		return accept( socket.get_handle(), user_data );
+	}
+
+	// Hands all queued operations to the kernel and returns their number
+	socks::ReturnValue<std::size_t> submit() noexcept;
+
+	/**
+	 * Submits queued operations and stores the results of up to out.size() finished operations in @p out.
+	 * Waits up to @p max_wait for the first result, if none is available yet.
+	 * Returns the number of results
+	 */
+	std::size_t reap( mart::ArrayView<Completion> out, std::chrono::milliseconds max_wait = std::chrono::milliseconds( 0 ) );
+
+	// Number of operations that were queued but didn't complete yet
+	std::size_t in_flight() const noexcept;
+
+private:
+	struct Impl;
+	struct UringImpl;
+	struct EpollImpl;
+	std::unique_ptr<Impl> _impl;
+};
+
+} // namespace mart::nw
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_LOG_SINK_H
+#define LIB_MART_COMMON_GUARD_NW_LOG_SINK_H
+/**
+ * log_sink.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Log sink that sends structured records in batches over a udp or unix domain datagram socket
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "detail/socket_base.hpp"
+
+/* Proprietary Library Includes */
+#include <im_str/im_str.hpp>
+#include <mart-common/ArrayView.h>
+#include <mart-common/logging/ILogSink.h>
+#include <mart-common/logging/structured.h>
+
+/* Standard Library Includes */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::log {
+
+/*
+ * Datagram format:
+ *
+ *   DatagramHeader: u32 magic ('MLOG'), u16 version, u16 record count
+ *   records: see mart-common/logging/structured.h
+ *
+ * Messages that are written as text (e.g. from Logger::log) are sent as RecordKind::Text records
+ */
+constexpr std::uint32_t datagram_magic       = 0x474F4C4D; // "MLOG" in little endian
+constexpr std::uint16_t datagram_version     = 1;
+constexpr std::size_t   datagram_header_size = 8;
+constexpr std::size_t   max_datagram_size    = 65507; // max udp payload
+
+template<class EndpointT>
+struct DatagramLogSinkConfig_t {
+	EndpointT                 target;
+	mart::log::Level          maxLogLvl       = mart::log::Level::TRACE;
+	std::size_t               maxDatagramSize = 1400; // records are batched until a datagram would exceed this size
+	std::chrono::milliseconds maxDelay{100};          // a batch is sent with the first message after this time
+};
+
+/**
+ * Batches structured records (Logger::log_structured) and text messages into datagrams.
+ *
+ * A datagram is sent, when the next record doesn't fit anymore, when an ERROR message is logged,
+ * when the sink is flushed or when a record is written and the oldest record in the batch is older than maxDelay
+ * (there is no background thread that would send a batch on its own).
+ * Records that are bigger than maxDatagramSize are sent in a datagram of their own.
+ *
+ * SocketT is mart::nw::ip::udp::Socket or mart::nw::un::Socket
+ */
+template<class SocketT>
+class DatagramLogSink final : public mart::log::ILogSink {
+public:
+	using endpoint = typename SocketT::endpoint;
+	using Config   = DatagramLogSinkConfig_t<endpoint>;
+
+	explicit DatagramLogSink( const Config& cfg )
+		: ILogSink( cfg.maxLogLvl )
+		, _target( cfg.target )
+		, _maxDatagramSize( std::clamp( cfg.maxDatagramSize, datagram_header_size + 64, max_datagram_size ) )
+		, _maxDelay( cfg.maxDelay )
+	{
+		_datagram.reserve( _maxDatagramSize );
+		_datagram.resize( datagram_header_size );
+	}
+
+	~DatagramLogSink() override { _send(); }
+
+	mba::im_zstr getName() const override { return mba::im_zstr( "DatagramLogSink" ); }
+
+	const endpoint& target() const noexcept { return _target; }
+
+	// Number of datagrams (not records) that couldn't be sent
+	std::uint64_t failedSendCount() const noexcept { return _failedSends; }
+
+private:
+	SocketT                               _socket{};
+	endpoint                              _target;
+	std::size_t                           _maxDatagramSize;
+	std::chrono::steady_clock::duration   _maxDelay;
+	std::vector<mart::ByteType>           _datagram;
+	std::vector<mart::ByteType>           _textRecord;
+	std::uint16_t                         _recordCnt = 0;
+	std::chrono::steady_clock::time_point _oldestRecord{};
+	std::uint64_t                         _failedSends = 0;
+
+	bool _do_writeStructuredToLog( mart::ConstMemoryView record, mart::log::Level lvl ) override
+	{
+		_append( record, lvl );
+		return true;
+	}
+
+	void _do_writeToLog( std::string_view msg, mart::log::Level lvl ) override
+	{
+		if( !msg.empty() && msg.back() == '\n' ) { msg.remove_suffix( 1 ); }
+
+		// text records are truncated to what fits into a single datagram
+		const std::size_t maxMsgSize
+			= _maxDatagramSize - datagram_header_size - mart::log::detail::structuredRecordSize( {}, {} );
+		msg = msg.substr( 0, std::min( msg.size(), maxMsgSize ) );
+
+		_textRecord.resize( mart::log::detail::structuredRecordSize( {}, msg ) );
+		const auto size = mart::log::encodeStructuredRecord(
+			_textRecord.data(), lvl, mart::log::RecordKind::Text, mart::log::detail::structuredTimestamp(), {}, msg );
+		_append( mart::ConstMemoryView( _textRecord.data(), size ), lvl );
+	}
+
+	void _do_writeToLogImpl( std::string_view msg ) override { _do_writeToLog( msg, mart::log::Level::TRACE ); }
+
+	void _do_flush() override { _send(); }
+
+	void _append( mart::ConstMemoryView record, mart::log::Level lvl )
+	{
+		const auto now = std::chrono::steady_clock::now();
+		if( _datagram.size() + record.size() > _maxDatagramSize ) { _send(); }
+		if( _recordCnt == 0 ) { _oldestRecord = now; }
+
+		_datagram.insert( _datagram.end(), record.begin(), record.end() );
+		++_recordCnt;
+
+		if( lvl == mart::log::Level::ERROR || now - _oldestRecord >= _maxDelay || _recordCnt == 0xFFFF ) { _send(); }
+	}
+
+	void _send()
+	{
+		if( _recordCnt == 0 ) { return; }
+
+		mart::ByteType* pos = _datagram.data();
+		std::memcpy( pos, &datagram_magic, sizeof( datagram_magic ) );
+		std::memcpy( pos + 4, &datagram_version, sizeof( datagram_version ) );
+		std::memcpy( pos + 6, &_recordCnt, sizeof( _recordCnt ) );
+
+		if( !_socket.try_sendto( mart::ConstMemoryView( _datagram.data(), _datagram.size() ), _target ) ) {
+			++_failedSends;
+		}
+		_datagram.resize( datagram_header_size );
+		_recordCnt = 0;
+	}
+};
+
+/**
+ * Calls f( mart::ConstMemoryView record ) for every record in a datagram that was sent by a DatagramLogSink
+ * (use mart::log::StructuredRecordReader to decode them). Returns false if the datagram is malformed
+ */
+template<class F>
+bool forEachRecord( mart::ConstMemoryView datagram, F&& f )
+{
+	if( datagram.size() < datagram_header_size ) { return false; }
+
+	std::uint32_t magic   = 0;
+	std::uint16_t version = 0;
+	std::uint16_t cnt     = 0;
+	std::memcpy( &magic, datagram.data(), sizeof( magic ) );
+	std::memcpy( &version, datagram.data() + 4, sizeof( version ) );
+	std::memcpy( &cnt, datagram.data() + 6, sizeof( cnt ) );
+	if( magic != datagram_magic || version != datagram_version ) { return false; }
+
+	auto rest = datagram.subview( datagram_header_size );
+	for( std::uint16_t i = 0; i < cnt; ++i ) {
+		std::uint16_t size = 0;
+		if( rest.size() < mart::log::structured_record_header_size ) { return false; }
+		std::memcpy( &size, rest.data(), sizeof( size ) );
+		if( size < mart::log::structured_record_header_size || size > rest.size() ) { return false; }
+		f( rest.subview( 0, size ) );
+		rest = rest.subview( size );
+	}
+	return true;
+}
+
+template<class EndpointT>
+std::shared_ptr<mart::log::ILogSink> makeSink( const DatagramLogSinkConfig_t<EndpointT>& cfg )
+{
+	return std::make_shared<DatagramLogSink<mart::nw::socks::detail::DgramSocket<EndpointT>>>( cfg );
+}
+
+} // namespace mart::nw::log
+
+#endif
@@ -14,9 +14,15 @@
  *
  */
 
-#include <exception>
+#include "basic_types.hpp"
+
 #include <im_str/im_str.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+
 namespace mart::nw {
 
 struct nw_error : std::exception {
@@ -34,10 +40,62 @@ struct generic_nw_error_base : nw_error {
 	mba::im_zstr _message;
 };
 
-struct generic_nw_error final : generic_nw_error_base {
+struct generic_nw_error : generic_nw_error_base {
 	using generic_nw_error_base::generic_nw_error_base;
 };
 
+enum class socket_op {
+	create,
+	bind,
+	connect,
+	listen,
+	send,
+	recv,
+	get_local_address,
+	set_tx_timeout,
+	set_rx_timeout,
+	get_tx_timeout,
+	get_rx_timeout,
+	set_blocking,
+	set_option,
+	close,
+};
+
+/*
+ * Error thrown by the high level sockets, if an operation on the socket fails.
+ * Only the operation, the error code and the (native) address are stored. The message
+ * is formatted when what() is called for the first time, so throwing doesn't require any
+ * additional memory allocations. what() can be called concurrently (e.g. on an exception_ptr
+ * that has been passed to multiple threads).
+ */
+struct socket_error final : generic_nw_error {
+	socket_error( socket_op op, socks::ErrorCode error ) noexcept;
+	socket_error( socket_op op, socks::ErrorCode error, const socks::Sockaddr& addr ) noexcept;
+
+	socket_error( const socket_error& other ) noexcept;
+	socket_error& operator=( const socket_error& other ) noexcept;
+
+	const char* what() const noexcept override;
+
+	socket_op        op() const noexcept { return _op; }
+	socks::ErrorCode error_code() const noexcept { return _error; }
+
+private:
+	socket_op        _op;
+	socks::ErrorCode _error;
+
+	// large enough for any native address (sockaddr_storage)
+	alignas( std::max_align_t ) std::array<unsigned char, 128> _addr{};
+	std::size_t _addr_size = 0;
+
+	enum class MessageState { empty, rendering, ready };
+
+	mutable std::array<char, 256>     _message{};
+	mutable std::atomic<MessageState> _message_state{ MessageState::empty };
+
+	void _render_message() const noexcept;
+};
+
 struct invalid_address_string final : generic_nw_error_base {
 	using generic_nw_error_base::generic_nw_error_base;
 };
@@ -0,0 +1,232 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_PACKET_POOL_H
+#define LIB_MART_COMMON_GUARD_NW_PACKET_POOL_H
+/**
+ * packet_pool.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Pool of fixed size, ref counted receive buffers
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+class PacketPool;
+
+namespace _detail_packet_pool_ {
+
+struct Slot {
+	std::atomic_int            ref_cnt{0};
+	std::atomic<std::uint32_t> next_free{0};
+	std::size_t                size = 0;
+	PacketPool*                pool = nullptr;
+	mart::ByteType*            data = nullptr;
+};
+
+} // namespace _detail_packet_pool_
+
+/**
+ * Ref counted handle to a buffer from a PacketPool (similar to a std::shared_ptr).
+ *
+ * Copies share the same buffer, which returns to its pool when the last handle is destroyed.
+ * Handles can be passed to and destroyed on any thread (the ref count is atomic),
+ * but - as with std::shared_ptr - a single handle object must not be modified concurrently.
+ * The content should not be modified anymore after the handle has been shared.
+ */
+class Packet {
+public:
+	constexpr Packet() noexcept = default;
+
+	Packet( const Packet& other ) noexcept
+		: _slot( other._slot )
+	{
+		if( _slot ) { _slot->ref_cnt.fetch_add( 1, std::memory_order_relaxed ); }
+	}
+	Packet( Packet&& other ) noexcept
+		: _slot( std::exchange( other._slot, nullptr ) )
+	{
+	}
+
+	Packet& operator=( const Packet& other ) noexcept
+	{
+		// inc before dec to protect against dropping in self assignment
+		if( other._slot ) { other._slot->ref_cnt.fetch_add( 1, std::memory_order_relaxed ); }
+		_decref();
+		_slot = other._slot;
+		return *this;
+	}
+	Packet& operator=( Packet&& other ) noexcept
+	{
+		if( this != &other ) {
+			_decref();
+			_slot = std::exchange( other._slot, nullptr );
+		}
+		return *this;
+	}
+
+	~Packet() { _decref(); }
+
+	// returns the buffer to the pool (if this was the last handle)
+	void reset() noexcept
+	{
+		_decref();
+		_slot = nullptr;
+	}
+
+	explicit operator bool() const noexcept { return _slot != nullptr; }
+
+	// valid part of the buffer (e.g. the received datagram)
+	mart::ConstMemoryView data() const noexcept
+	{
+		return _slot ? mart::ConstMemoryView( _slot->data, _slot->size ) : mart::ConstMemoryView{};
+	}
+	std::size_t size() const noexcept { return _slot ? _slot->size : 0; }
+
+	// the complete underlying buffer (capacity() bytes)
+	mart::MemoryView buffer() noexcept
+	{
+		return _slot ? mart::MemoryView( _slot->data, capacity() ) : mart::MemoryView{};
+	}
+	std::size_t capacity() const noexcept;
+
+	// Sets the size of the valid part of the buffer. new_size must not be bigger than capacity()
+	void set_size( std::size_t new_size ) noexcept
+	{
+		assert( _slot && new_size <= capacity() );
+		_slot->size = new_size;
+	}
+
+	int use_count() const noexcept { return _slot ? _slot->ref_cnt.load( std::memory_order_relaxed ) : 0; }
+
+private:
+	friend class PacketPool;
+	explicit Packet( _detail_packet_pool_::Slot& slot ) noexcept
+		: _slot( &slot )
+	{
+	}
+
+	inline void _decref() noexcept;
+
+	_detail_packet_pool_::Slot* _slot = nullptr;
+};
+
+/**
+ * Fixed number of equally sized buffers that are allocated as one slab at construction.
+ *
+ * try_acquire() and returning a Packet to the pool never allocate and are lock free,
+ * so packets can be received on one thread and released on another.
+ * The pool has to outlive all packets acquired from it.
+ */
+class PacketPool {
+public:
+	static constexpr std::size_t default_buffer_size = 2048;
+
+	explicit PacketPool( std::size_t buffer_cnt, std::size_t buffer_size = default_buffer_size )
+		: _buffer_size( buffer_size )
+		, _buffer_cnt( buffer_cnt )
+		, _slots( std::make_unique<_detail_packet_pool_::Slot[]>( buffer_cnt ) )
+		, _storage( std::make_unique<mart::ByteType[]>( buffer_cnt * buffer_size ) )
+	{
+		assert( buffer_cnt < npos );
+		for( std::size_t i = 0; i < buffer_cnt; ++i ) {
+			auto& slot = _slots[i];
+			slot.pool  = this;
+			slot.data  = _storage.get() + i * buffer_size;
+			slot.next_free.store( i + 1 < buffer_cnt ? static_cast<std::uint32_t>( i + 1 ) : npos,
+								  std::memory_order_relaxed );
+		}
+		_free_head.store( buffer_cnt > 0 ? 0 : npos, std::memory_order_relaxed );
+		_available.store( buffer_cnt, std::memory_order_relaxed );
+	}
+
+	PacketPool( const PacketPool& ) = delete;
+	PacketPool& operator=( const PacketPool& ) = delete;
+
+	~PacketPool() { assert( available() == _buffer_cnt && "All packets have to be returned before the pool is destroyed" ); }
+
+	// returns an empty handle if all buffers are in use
+	Packet try_acquire() noexcept
+	{
+		std::uint64_t head = _free_head.load( std::memory_order_acquire );
+		while( true ) {
+			const auto idx = static_cast<std::uint32_t>( head );
+			if( idx == npos ) { return Packet{}; }
+
+			auto&               slot     = _slots[idx];
+			const std::uint64_t new_head = _next_tag( head ) | slot.next_free.load( std::memory_order_relaxed );
+			if( _free_head.compare_exchange_weak( head, new_head, std::memory_order_acquire ) ) {
+				_available.fetch_sub( 1, std::memory_order_relaxed );
+				slot.size = 0;
+				slot.ref_cnt.store( 1, std::memory_order_relaxed );
+				return Packet( slot );
+			}
+		}
+	}
+
+	std::size_t buffer_size() const noexcept { return _buffer_size; }
+	std::size_t capacity() const noexcept { return _buffer_cnt; }
+
+	// number of buffers that are currently not in use (only a snapshot if other threads are active)
+	std::size_t available() const noexcept { return _available.load( std::memory_order_relaxed ); }
+
+private:
+	friend class Packet;
+
+	static constexpr std::uint32_t npos = static_cast<std::uint32_t>( -1 );
+
+	// The free list head consists of the index of the first free slot (lower 32 bit) and a tag
+	// that is incremented on every change (upper 32 bit) to prevent the ABA problem
+	static std::uint64_t _next_tag( std::uint64_t head ) noexcept
+	{
+		return ( ( head >> 32 ) + 1 ) << 32;
+	}
+
+	void _release( _detail_packet_pool_::Slot& slot ) noexcept
+	{
+		const auto    idx  = static_cast<std::uint32_t>( &slot - _slots.get() );
+		std::uint64_t head = _free_head.load( std::memory_order_relaxed );
+		do {
+			slot.next_free.store( static_cast<std::uint32_t>( head ), std::memory_order_relaxed );
+		} while( !_free_head.compare_exchange_weak( head, _next_tag( head ) | idx, std::memory_order_release ) );
+		_available.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	std::size_t                                   _buffer_size;
+	std::size_t                                   _buffer_cnt;
+	std::unique_ptr<_detail_packet_pool_::Slot[]> _slots;
+	std::unique_ptr<mart::ByteType[]>              _storage;
+	std::atomic<std::uint64_t>                    _free_head{npos};
+	std::atomic<std::size_t>                      _available{0};
+};
+
+inline std::size_t Packet::capacity() const noexcept
+{
+	return _slot ? _slot->pool->buffer_size() : 0;
+}
+
+inline void Packet::_decref() noexcept
+{
+	if( _slot && _slot->ref_cnt.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) { _slot->pool->_release( *_slot ); }
+}
+
+} // namespace mart::nw
+
+#endif
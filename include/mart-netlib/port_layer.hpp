@@ -75,6 +75,42 @@ ReturnValue<txrx_size_t> sendto( handle_t handle, byte_range buf, int flags, con
 ReturnValue<txrx_size_t> recv( handle_t handle, byte_range_mut buf, int flags ) noexcept;
 ReturnValue<txrx_size_t> recvfrom( handle_t handle, byte_range_mut buf, int flags, Sockaddr& from ) noexcept;
 
+// Like recvfrom, but also returns the time at which the kernel received the data (nanoseconds since the unix epoch).
+// Requires SocketOption::so_timestampns (linux only). timestamp is set to zero, if it is not available.
+ReturnValue<txrx_size_t> recvfrom_with_timestamp(
+	handle_t handle, byte_range_mut buf, int flags, Sockaddr& from, std::chrono::nanoseconds& timestamp ) noexcept;
+
+// Scatter / gather versions of send(to) / recv(from) (sendmsg / recvmsg, WSASendTo / WSARecvFrom on windows):
+// All cnt buffers are transferred with a single system call. to / from may be nullptr (connected sockets).
+// Returns the total number of transferred bytes. More than max_iov_cnt buffers are rejected with InvalidArgument.
+constexpr std::size_t max_iov_cnt = 64;
+
+ReturnValue<txrx_size_t>
+sendmsg( handle_t handle, const byte_range* bufs, std::size_t cnt, int flags, const Sockaddr* to ) noexcept;
+ReturnValue<txrx_size_t>
+recvmsg( handle_t handle, const byte_range_mut* bufs, std::size_t cnt, int flags, Sockaddr* from ) noexcept;
+
+// Message descriptors for sendmmsg / recvmmsg
+struct SendBatchEntry {
+	byte_range      data;
+	const Sockaddr* to;   // nullptr for connected sockets
+	txrx_size_t     sent; // set by sendmmsg
+};
+
+struct RecvBatchEntry {
+	byte_range_mut buffer;
+	Sockaddr*      from;     // may be nullptr. Its valid data range is updated like in recvfrom
+	txrx_size_t    received; // set by recvmmsg
+};
+
+// Transfer up to cnt datagrams with as few system calls as possible (sendmmsg / recvmmsg on linux,
+// a loop over sendto / recvfrom on other platforms) and return the number of transferred messages.
+// An error is only returned if not even the first message could be transferred.
+// recvmmsg only waits (on a blocking socket) until the first message arrives, or not at all if dont_wait is set.
+ReturnValue<int> sendmmsg( handle_t handle, SendBatchEntry* msgs, std::size_t cnt, int flags ) noexcept;
+ReturnValue<int>
+recvmmsg( handle_t handle, RecvBatchEntry* msgs, std::size_t cnt, int flags, bool dont_wait = false ) noexcept;
+
 ErrorCode setsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, byte_range data ) noexcept;
 ErrorCode getsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, byte_range_mut& buffer ) noexcept;
 
@@ -0,0 +1,154 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_REACTOR_H
+#define LIB_MART_COMMON_GUARD_NW_REACTOR_H
+/**
+ * reactor.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Event loop that dispatches socket readiness and timer callbacks (epoll based)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "RaiiSocket.hpp"
+#include "port_layer.hpp"
+
+/* Standard Library Includes */
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+enum class IoEvents : std::uint32_t {
+	None     = 0,
+	Readable = 1 << 0,
+	Writable = 1 << 1,
+	Error    = 1 << 2, // always reported, doesn't need to be requested
+	HangUp   = 1 << 3, // always reported, doesn't need to be requested
+};
+
+constexpr IoEvents operator|( IoEvents l, IoEvents r ) noexcept
+{
+	return static_cast<IoEvents>( static_cast<std::uint32_t>( l ) | static_cast<std::uint32_t>( r ) );
+}
+
+constexpr IoEvents operator&( IoEvents l, IoEvents r ) noexcept
+{
+	return static_cast<IoEvents>( static_cast<std::uint32_t>( l ) & static_cast<std::uint32_t>( r ) );
+}
+
+constexpr bool has_any( IoEvents events, IoEvents mask ) noexcept
+{
+	return ( events & mask ) != IoEvents::None;
+}
+
+/*
+ * Usage example:
+ *
+ * mart::nw::Reactor reactor;
+ * udp::Socket       sock;
+ * sock.bind( ep );
+ * sock.set_blocking( false );
+ *
+ * reactor.add( sock.as_raii_socket(), IoEvents::Readable, [&]( IoEvents ) {
+ * 	while( sock.try_recv( buffer ).isValid() ) { ... }
+ * } );
+ * reactor.add_timer( 1s, [&] { reactor.stop(); } );
+ * reactor.run();
+ */
+
+/**
+ * Waits for readiness events on registered socket handles and for timers and calls the associated callbacks.
+ *
+ * - Any number of threads can call run() / run_once() at the same time. The callback of a single handle
+ *   is never executed concurrently with itself (the handle is re-armed after the callback returned).
+ * - Events are level triggered: If a callback doesn't consume all data, it gets called again.
+ * - All functions can be called from within callbacks and from other threads.
+ *   After remove() returned, the callback of that handle won't be started anymore
+ *   (but a call that is already running on a different thread might still be in progress).
+ * - Sockets stay owned by the caller and have to be removed from the reactor before they are closed.
+ *
+ * Requires epoll (linux). Errors during setup throw mart::nw::generic_nw_error.
+ */
+class Reactor {
+public:
+	using handle_t      = mart::nw::socks::port_layer::handle_t;
+	using IoCallback    = std::function<void( IoEvents )>;
+	using TimerCallback = std::function<void()>;
+	using Clock         = std::chrono::steady_clock;
+	using TimerId       = std::uint64_t;
+
+	Reactor();
+	~Reactor();
+
+	Reactor( const Reactor& ) = delete;
+	Reactor& operator=( const Reactor& ) = delete;
+
+	/* ###### sockets ###### */
+	void add( handle_t handle, IoEvents interest, IoCallback callback );
+	void add( const socks::RaiiSocket& socket, IoEvents interest, IoCallback callback )
+	{
+		add( socket.get_handle(), interest, std::move( callback ) );
+	}
+
+	void modify( handle_t handle, IoEvents interest );
+	void modify( const socks::RaiiSocket& socket, IoEvents interest ) { modify( socket.get_handle(), interest ); }
+
+	// non-throwing versions of add / modify
+	socks::ErrorCode try_add( handle_t handle, IoEvents interest, IoCallback callback ) noexcept;
+	socks::ErrorCode try_add( const socks::RaiiSocket& socket, IoEvents interest, IoCallback callback ) noexcept
+	{
+		return try_add( socket.get_handle(), interest, std::move( callback ) );
+	}
+
+	socks::ErrorCode try_modify( handle_t handle, IoEvents interest ) noexcept;
+	socks::ErrorCode try_modify( const socks::RaiiSocket& socket, IoEvents interest ) noexcept
+	{
+		return try_modify( socket.get_handle(), interest );
+	}
+
+	// Returns false if the handle wasn't registered
+	bool remove( handle_t handle ) noexcept;
+	bool remove( const socks::RaiiSocket& socket ) noexcept { return remove( socket.get_handle() ); }
+
+	/* ###### timers ###### */
+	// Calls @p callback after @p delay and then every @p period (if period is not zero) until it gets canceled
+	TimerId add_timer( Clock::duration delay, TimerCallback callback, Clock::duration period = Clock::duration::zero() );
+
+	// Returns false if the timer doesn't exist (anymore)
+	bool cancel_timer( TimerId id ) noexcept;
+
+	/* ###### event loop ###### */
+	/**
+	 * Waits up to @p max_wait for events (or until stop() was called) and dispatches them.
+	 * Returns the number of callbacks that were executed
+	 */
+	std::size_t run_once( std::chrono::milliseconds max_wait );
+
+	// Dispatches events until stop() is called
+	void run();
+
+	// Makes all current and future calls to run() return. Can be called from any thread
+	void stop() noexcept;
+	bool is_stopped() const noexcept;
+
+	// Number of registered handles
+	std::size_t size() const;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> _impl;
+};
+
+} // namespace mart::nw
+
+#endif
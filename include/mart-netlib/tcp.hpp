@@ -27,6 +27,8 @@
 #include <mart-common/ArrayView.h>
 
 /* Standard Library Includes */
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <optional>
@@ -62,6 +64,7 @@ inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
 	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
 }
 
+// Not used by the sockets anymore (they throw socket_error, which formats its message lazily).
 template<class... Elements>
 mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
 {
@@ -76,6 +79,8 @@ mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::Error
 using endpoint = ip::basic_endpoint_v4<mart::nw::ip::TransportProtocol::Tcp>;
 
 class Acceptor;
+class AsyncSocket;
+class AsyncAcceptor;
 class Socket : public mart::nw::socks::detail::HighLevelSocketBase {
 public:
 	Socket()
@@ -105,29 +110,30 @@ public:
 	}
 	void connect( endpoint ep )
 	{
-		auto result = _socket.connect( ep.toSockAddr() );
-		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Could not connect socket to address ", ep.toStringEx() ) );
-		}
+		const auto addr   = ep.toSockAddr();
+		auto       result = _socket.connect( addr );
+		if( !result.success() ) { throw socket_error( socket_op::connect, result, addr ); }
 		_ep_remote = ep;
 
 		auto t_ep = getSockAddress( _socket );
-		if( !t_ep.result.success() ) {
-			throw generic_nw_error(
-				make_error_message_with_appended_last_errno( t_ep.result, "Could not get port of connected socket " ) );
-		}
+		if( !t_ep.result.success() ) { throw socket_error( socket_op::get_local_address, t_ep.result ); }
 		_ep_local = t_ep.ep;
 	}
 
-	bool try_connect( endpoint ep )
+	bool try_connect( endpoint ep ) noexcept
+	{
+		socks::ErrorCode error = socks::ErrorCode::Ok();
+		return try_connect( ep, error );
+	}
+	bool try_connect( endpoint ep, socks::ErrorCode& error ) noexcept
 	{
-		auto result = _socket.connect( ep.toSockAddr() );
-		if( !result.success() ) { return false; }
+		error = _socket.connect( ep.toSockAddr() );
+		if( !error.success() ) { return false; }
 		_ep_remote = ep;
 
 		auto t_ep = getSockAddress( _socket );
-		if( !t_ep.result.success() ) { return false; }
+		error     = t_ep.result;
+		if( !error.success() ) { return false; }
 		_ep_local = t_ep.ep;
 		return true;
 	}
@@ -135,11 +141,9 @@ public:
 	void bind( endpoint ep )
 	{
 		assert( _socket.is_valid() );
-		auto result = _socket.bind( ep.toSockAddr_in() );
-		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Could not bind tcp socket to address ", ep.toStringEx() ) );
-		}
+		const auto addr   = ep.toSockAddr_in();
+		auto       result = _socket.bind( addr );
+		if( !result.success() ) { throw socket_error( socket_op::bind, result, addr ); }
 
 		_ep_local = ep;
 	}
@@ -147,14 +151,56 @@ public:
 	{
 		while( !data.empty() ) {
 			const auto res = _socket.send( data, 0 );
-			if( !_txWasSuccess( data, res ) ) {
-				throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
-					res.result.error_code(), "Failed to send data. Details:  " ) );
-			}
+			if( !res.result ) { throw socket_error( socket_op::send, res.result.error_code() ); }
 			data = res.remaining_data;
 		}
 	}
 
+	/**
+	 * Sends all buffers as if they were one contiguous block (e.g. a header and a payload)
+	 * without copying them into a temporary buffer. Partial sends are continued until everything is sent.
+	 * At most socks::port_layer::max_iov_cnt buffers are supported.
+	 */
+	void send( mart::ArrayView<const mart::ConstMemoryView> data )
+	{
+		const auto res = try_send_all( data );
+		if( !res ) { throw socket_error( socket_op::send, res ); }
+	}
+
+	// Same as send, but reports errors via the return value. Data might have been partially sent on failure
+	socks::ErrorCode try_send_all( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
+	{
+		if( data.size() > socks::port_layer::max_iov_cnt ) {
+			return socks::ErrorCode{ socks::ErrorCodeValues::InvalidArgument };
+		}
+		std::array<mart::ConstMemoryView, socks::port_layer::max_iov_cnt> remaining{};
+		std::copy( data.begin(), data.end(), remaining.begin() );
+
+		auto pending = mart::ArrayView<mart::ConstMemoryView>( remaining ).subview( 0, data.size() );
+		while( !pending.empty() ) {
+			const auto res = _socket.sendmsg( pending );
+			if( !res.success() ) { return res.error_code(); }
+			// skip everything that has been sent
+			auto sent = static_cast<std::size_t>( res.value() );
+			while( !pending.empty() && sent >= pending[0].size() ) {
+				sent -= pending[0].size();
+				pending = pending.subview( 1 );
+			}
+			if( !pending.empty() ) { pending[0] = pending[0].subview( sent ); }
+		}
+		return socks::ErrorCode::Ok();
+	}
+
+	// Single send call (partial sends are not continued). Returns the number of sent bytes
+	socks::ReturnValue<std::size_t> try_send( mart::ConstMemoryView data ) noexcept
+	{
+		return _to_size_result( _socket.send( data, 0 ).result );
+	}
+	socks::ReturnValue<std::size_t> try_send( mart::ArrayView<const mart::ConstMemoryView> data ) noexcept
+	{
+		return _to_size_result( _socket.sendmsg( data ) );
+	}
+
 	template<class T, T... Vals>
 	bool is_none_of( T v )
 	{
@@ -170,12 +216,36 @@ public:
 						  ErrorCodeValues::WouldBlock,
 						  ErrorCodeValues::TryAgain,
 						  ErrorCodeValues::Timeout>( res.result.error_code().value() ) ) {
-			throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
-				res.result.error_code(), "Failed to receive data. Details:  " ) );
+			throw socket_error( socket_op::recv, res.result.error_code() );
 		}
 		return res.received_data;
 	}
 
+	// Single recv call. Returns the number of received bytes (0 if the connection was closed by the peer)
+	socks::ReturnValue<std::size_t> try_recv( mart::MemoryView buffer ) noexcept
+	{
+		return _to_size_result( _socket.recv( buffer, 0 ).result );
+	}
+	socks::ReturnValue<std::size_t> try_recv( mart::ArrayView<const mart::MemoryView> buffers ) noexcept
+	{
+		return _to_size_result( _socket.recvmsg( buffers ) );
+	}
+
+	// Receives into multiple buffers (filled in order) with a single call. Returns the total number of received bytes
+	std::size_t recv( mart::ArrayView<const mart::MemoryView> buffers )
+	{
+		using mart::nw::socks::ErrorCodeValues;
+		const auto res = _socket.recvmsg( buffers );
+		if( !res
+			&& is_none_of<ErrorCodeValues,
+						  ErrorCodeValues::WouldBlock,
+						  ErrorCodeValues::TryAgain,
+						  ErrorCodeValues::Timeout>( res.error_code().value() ) ) {
+			throw socket_error( socket_op::recv, res.error_code() );
+		}
+		return res ? static_cast<std::size_t>( res.value() ) : 0;
+	}
+
 	const endpoint& get_local_endpoint() const { return _ep_local; }
 	const endpoint& get_remote_endpoint() const { return _ep_remote; }
 
@@ -200,9 +270,10 @@ private:
 		return ret;
 	}
 
-	static inline bool _txWasSuccess( mart::ConstMemoryView data, const mart::nw::socks::RaiiSocket::SendResult& ret )
+	static socks::ReturnValue<std::size_t> _to_size_result( socks::ReturnValue<socks::txrx_size_t> res ) noexcept
 	{
-		return ret.result.success() && mart::narrow<nw::socks::txrx_size_t>( data.size() ) == ret.result.value();
+		if( !res ) { return socks::ReturnValue<std::size_t>( res.error_code() ); }
+		return socks::ReturnValue<std::size_t>( static_cast<std::size_t>( res.value() ) );
 	}
 
 	Socket( net::socks::RaiiSocket&& sock, endpoint local, endpoint remote )
@@ -213,6 +284,8 @@ private:
 	}
 
 	friend Acceptor;
+	friend AsyncSocket;
+	friend AsyncAcceptor;
 	endpoint _ep_local{};
 	endpoint _ep_remote{};
 };
@@ -232,11 +305,7 @@ public:
 		: _socket_handle( socks::Domain::Inet, socks::TransportType::Stream )
 	{
 		if( !_socket_handle.is_valid() ) {
-			// TODO: The creation of this exception message seems to be pretty costly in terms of binary size - have to
-			// investigate NOTE: Preliminary tests suggest, that the dynamic memory allocation for the message text
-			// could be the main problem, but that is just a possibility
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				mart::nw::socks::port_layer::get_last_socket_error(), "Could not create tcp acceptor." ) );
+			throw socket_error( socket_op::create, mart::nw::socks::port_layer::get_last_socket_error() );
 		}
 	}
 
@@ -268,22 +337,25 @@ public:
 	{
 		assert( _state == State::open );
 
-		auto result = _socket_handle.bind( ep.toSockAddr_in() );
-		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Could not bind tcp acceptor to address ", ep.toStringEx() ) );
-		}
+		const auto addr   = ep.toSockAddr_in();
+		auto       result = _socket_handle.bind( addr );
+		if( !result.success() ) { throw socket_error( socket_op::bind, result, addr ); }
 
 		_ep_local = ep;
 		_state    = State::bound;
 	}
 
-	bool try_bind( endpoint ep )
+	bool try_bind( endpoint ep ) noexcept
+	{
+		socks::ErrorCode error = socks::ErrorCode::Ok();
+		return try_bind( ep, error );
+	}
+	bool try_bind( endpoint ep, socks::ErrorCode& error ) noexcept
 	{
 		assert( _state == State::open );
 
-		auto result = _socket_handle.bind( ep.toSockAddr_in() );
-		if( !result.success() ) { return false; }
+		error = _socket_handle.bind( ep.toSockAddr_in() );
+		if( !error.success() ) { return false; }
 
 		_ep_local = ep;
 		_state    = State::bound;
@@ -295,19 +367,21 @@ public:
 		assert( _state == State::bound );
 
 		auto result = _socket_handle.listen( backlog );
-		if( !result.success() ) {
-			throw generic_nw_error( make_error_message_with_appended_last_errno(
-				result, "Tcp acceptor could not start to listen on address ", _ep_local.toStringEx() ) );
-		}
+		if( !result.success() ) { throw socket_error( socket_op::listen, result, _ep_local.toSockAddr_in() ); }
 		_state = State::listening;
 	}
 
-	bool try_listen( int backlog = 10 )
+	bool try_listen( int backlog = 10 ) noexcept
+	{
+		socks::ErrorCode error = socks::ErrorCode::Ok();
+		return try_listen( backlog, error );
+	}
+	bool try_listen( int backlog, socks::ErrorCode& error ) noexcept
 	{
 		assert( _state == State::bound );
 
-		auto result = _socket_handle.listen( backlog );
-		if( !result.success() ) { return false; }
+		error = _socket_handle.listen( backlog );
+		if( !error.success() ) { return false; }
 		_state = State::listening;
 		return true;
 	}
@@ -331,6 +405,30 @@ public:
 		}
 	}
 
+	struct AcceptResult {
+		Socket           socket; // invalid, if no connection was accepted
+		socks::ErrorCode error = socks::ErrorCode::Ok();
+	};
+
+	// Like try_accept, but reports why no connection was accepted (e.g. WouldBlock, if none is pending)
+	AcceptResult try_accept_with_error() noexcept
+	{
+		assert( _state == State::listening );
+		const auto res = _socket_handle.set_blocking( false );
+		if( !res.success() ) { return { Socket( socks::RaiiSocket{}, {}, {} ), res }; }
+		return _accept();
+	}
+
+	// Waits up to @p timeout for a connection (error is Timeout, WouldBlock or TryAgain, if none arrived)
+	AcceptResult try_accept_with_error( std::chrono::microseconds timeout ) noexcept
+	{
+		assert( _state == State::listening );
+		auto res = socks::port_layer::set_timeout( _socket_handle.get_handle(), socks::Direction::Rx, timeout );
+		if( res.success() ) { res = _socket_handle.set_blocking( true ); }
+		if( !res.success() ) { return { Socket( socks::RaiiSocket{}, {}, {} ), res }; }
+		return _accept();
+	}
+
 	Socket accept( std::chrono::microseconds timeout = std::chrono::hours( 300 ) )
 	{
 		_socket_handle.set_blocking( true );
@@ -353,6 +451,19 @@ public:
 	endpoint getLocalEndpoint() const { return _ep_local; }
 
 private:
+	AcceptResult _accept() noexcept
+	{
+		mart::net::socks::port_layer::SockaddrIn addr;
+
+		const auto handle = socks::port_layer::accept( _socket_handle.get_handle(), addr );
+		if( !handle ) { return { Socket( socks::RaiiSocket{}, {}, {} ), handle.error_code() }; }
+
+		socks::RaiiSocket sock( handle.value() );
+		auto              res = Socket::getSockAddress( sock );
+		if( !res.result.success() ) { return { Socket( socks::RaiiSocket{}, {}, {} ), res.result }; }
+		return { Socket( std::move( sock ), res.ep, endpoint( addr ) ) };
+	}
+
 	nw::socks::RaiiSocket _socket_handle;
 	endpoint              _ep_local{};
 	State                 _state = State::open;
@@ -0,0 +1,144 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_TCP_FRAMED_STREAM_HPP
+#define LIB_MART_COMMON_GUARD_NW_TCP_FRAMED_STREAM_HPP
+/**
+ * tcp_framed_stream.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020 Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Buffered, message based communication on top of a tcp stream
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "tcp.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <cstddef>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::tcp {
+
+enum class Framing {
+	LengthPrefix, // each frame starts with its length (big endian, not including the prefix itself)
+	Delimiter,    // each frame ends with a delimiter byte (that is not part of the frame and must not appear in it)
+};
+
+struct FramedStreamConfig {
+	Framing framing = Framing::LengthPrefix;
+
+	std::size_t    length_prefix_size = 4; // 1, 2, 4 or 8 bytes
+	mart::ByteType delimiter          = '\n';
+
+	// bigger frames are treated as a protocol error (ErrorCodeValues::MessageSize)
+	std::size_t max_frame_size = 1 << 20;
+
+	// initial size of the receive buffer (grows up to what is needed to store max_frame_size)
+	std::size_t rx_buffer_size = 64 * 1024;
+	// frames are collected until this much data is buffered, then everything is sent with a single call
+	std::size_t tx_buffer_size = 64 * 1024;
+};
+
+/**
+ * Message based wrapper around a connected tcp::Socket
+ *
+ * Read side: Each recv call reads as much data as fits into the receive buffer, so a single system call
+ * usually delivers many small frames. Frames are parsed in place and returned as views into the buffer,
+ * which stay valid until the next call to a read function. Consumed space is reclaimed by moving the
+ * remaining (partial) frame to the front of the buffer, so frames are always contiguous.
+ *
+ * Write side: Frames (including their prefix / delimiter) are collected in a send buffer, which is only
+ * written to the socket when it is full or when flush() is called (explicit corking instead of relying on
+ * Nagle's algorithm). Frames that don't fit into the send buffer are sent together with the buffered data
+ * in a single gather call without copying them.
+ *
+ * The write side expects a blocking socket. The destructor does NOT flush pending frames.
+ * If sending fails, an unknown part of the data might have been sent already, so the peer can't find the
+ * start of the next frame anymore. All further writes fail with the same error (see tx_error()).
+ */
+class FramedStream {
+public:
+	struct ReadResult {
+		// invalid (data() == nullptr), if no complete frame is available; may be empty for valid frames
+		mart::ConstMemoryView frame;
+		socks::ErrorCode      error = socks::ErrorCode::Ok();
+		// true, if the peer closed the connection
+		bool closed = false;
+	};
+
+	explicit FramedStream( Socket&& socket, const FramedStreamConfig& config = {} );
+
+	FramedStream( FramedStream&& ) noexcept = default;
+	FramedStream& operator=( FramedStream&& ) noexcept = default;
+
+	/* ###### read side ###### */
+	// Returns the next frame, if one is already buffered. Never calls recv
+	mart::ConstMemoryView next_buffered_frame() noexcept;
+
+	/**
+	 * Returns the next frame and calls recv (only once), if none is buffered.
+	 * Timeouts (or would block on non-blocking sockets) are not reported as errors,
+	 * but result in an invalid frame.
+	 */
+	ReadResult try_read_frame() noexcept;
+
+	/**
+	 * Same as try_read_frame, but throws on errors.
+	 * Returns an invalid frame on timeout or when the connection was closed.
+	 */
+	mart::ConstMemoryView read_frame();
+
+	// number of bytes received but not yet returned as part of a frame
+	std::size_t buffered_rx_bytes() const noexcept { return _rx_end - _rx_begin; }
+
+	/* ###### write side ###### */
+	// Payloads that contain the delimiter (Framing::Delimiter) are rejected with ErrorCodeValues::InvalidArgument
+	socks::ErrorCode try_write_frame( mart::ConstMemoryView payload ) noexcept;
+	socks::ErrorCode try_write_frame( mart::ArrayView<const mart::ConstMemoryView> payload_parts ) noexcept;
+	void             write_frame( mart::ConstMemoryView payload );
+	void             write_frame( mart::ArrayView<const mart::ConstMemoryView> payload_parts );
+
+	// Writes all buffered frames to the socket
+	socks::ErrorCode try_flush() noexcept;
+	void             flush();
+
+	std::size_t buffered_tx_bytes() const noexcept { return _tx.size(); }
+
+	// the error that broke the write side (ErrorCode::Ok() if sending never failed)
+	socks::ErrorCode tx_error() const noexcept { return _tx_error; }
+
+	/* ###### misc ###### */
+	const Socket& socket() const noexcept { return _socket; }
+	Socket&       socket() noexcept { return _socket; }
+
+	const FramedStreamConfig& config() const noexcept { return _config; }
+
+private:
+	mart::ConstMemoryView _parse_frame( socks::ErrorCode& error ) noexcept;
+	socks::ErrorCode      _make_room_for_rx( std::size_t frame_size ) noexcept;
+	std::size_t           _write_prefix( std::size_t frame_size, mart::ByteType* dst ) const noexcept;
+
+	Socket             _socket;
+	FramedStreamConfig _config;
+
+	std::vector<mart::ByteType> _rx;
+	std::size_t                 _rx_begin = 0; // start of the first not yet returned frame
+	std::size_t                 _rx_end   = 0; // end of the received data
+	std::size_t                 _rx_scan  = 0; // data before this position doesn't contain a delimiter
+
+	std::vector<mart::ByteType> _tx;
+	socks::ErrorCode            _tx_error = socks::ErrorCode::Ok();
+};
+
+} // namespace mart::nw::ip::tcp
+
+#endif
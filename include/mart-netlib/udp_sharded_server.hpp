@@ -0,0 +1,107 @@
+#ifndef LIB_MART_COMMON_GUARD_NW_UDP_SHARDED_SERVER_H
+#define LIB_MART_COMMON_GUARD_NW_UDP_SHARDED_SERVER_H
+/**
+ * udp_sharded_server.hpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	Multi-threaded udp server that shards incoming datagrams over multiple sockets (SO_REUSEPORT)
+ *
+ */
+
+/* ######## INCLUDES ######### */
+/* Project Includes */
+#include "udp.hpp"
+
+/* Proprietary Library Includes */
+#include <mart-common/ArrayView.h>
+
+/* Standard Library Includes */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw::ip::udp {
+
+struct ShardedServerConfig {
+	endpoint local;
+
+	// number of sockets / receive threads (0: one per core)
+	unsigned int shard_cnt = 0;
+	// pin the receive thread of shard i to core i (modulo the number of cores, linux only)
+	bool pin_threads = true;
+
+	// maximal number of datagrams that are received with a single call and passed to the handler at once
+	std::size_t batch_size = 32;
+	// bigger datagrams get truncated
+	std::size_t max_datagram_size = 2048;
+	// SO_RCVBUF of each socket (0: os default)
+	int rx_buffer_size = 0;
+
+	// how long it can take until a receive thread notices that the server has been stopped
+	std::chrono::milliseconds stop_latency{ 100 };
+};
+
+/**
+ * Binds shard_cnt udp sockets to the same local endpoint (SO_REUSEPORT), so the os distributes
+ * incoming datagrams over them, and runs a dedicated receive thread for each socket.
+ *
+ * Each thread receives datagrams in batches (recvmmsg on linux) and passes them to the handler.
+ * The handler is called concurrently from all receive threads (the shard index identifies the thread)
+ * and the received data is only valid until it returns. The handler must not throw.
+ *
+ * On linux, datagrams from one remote endpoint always go to the same shard. On platforms without
+ * SO_REUSEPORT, only a single shard is supported.
+ * Errors during setup throw mart::nw::socket_error. If receiving fails with anything other than a timeout,
+ * the receive thread of that shard reports the error to the (optional) error handler and terminates.
+ */
+class ShardedServer {
+public:
+	using Batch        = mart::ArrayView<const Socket::RecvBatchEntry>;
+	using Handler      = std::function<void( std::size_t shard, Batch datagrams )>;
+	using ErrorHandler = std::function<void( std::size_t shard, socks::ErrorCode error )>;
+
+	ShardedServer( const ShardedServerConfig& config, Handler handler, ErrorHandler error_handler = {} );
+	~ShardedServer();
+
+	ShardedServer( const ShardedServer& ) = delete;
+	ShardedServer& operator=( const ShardedServer& ) = delete;
+
+	// Stops and joins all receive threads. Called by the destructor
+	void stop() noexcept;
+
+	std::size_t shard_count() const noexcept { return _shards.size(); }
+
+	// The actual endpoint, if config.local used port 0
+	const endpoint& get_local_endpoint() const noexcept { return _ep_local; }
+
+private:
+	struct Shard {
+		Socket                              socket;
+		std::vector<mart::ByteType>         buffer;
+		std::vector<Socket::RecvBatchEntry> batch;
+		std::thread                         thread;
+	};
+
+	void _receive_loop( std::size_t shard_idx );
+
+	Handler                             _handler;
+	ErrorHandler                        _error_handler;
+	endpoint                            _ep_local;
+	std::vector<std::unique_ptr<Shard>> _shards;
+	std::atomic_bool                    _stop{ false };
+};
+
+} // namespace mart::nw::ip::udp
+
+#endif
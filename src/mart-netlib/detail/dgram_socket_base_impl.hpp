@@ -26,20 +26,15 @@
 #include <mart-common/ArrayView.h>
 #include <mart-common/utils.h>
 
-#include <im_str/im_str.hpp>
-
 /* Standard Library Includes */
 #include <chrono>
 #include <string_view>
 
 #include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cstring>
 
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
-
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 namespace mart {
@@ -47,40 +42,6 @@ namespace nw {
 namespace socks {
 namespace detail {
 
-namespace {
-
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
-{
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
-
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
-}
-
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
-{
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
-}
-
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
-{
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
-}
-
-} // namespace
-
 template<class EndpointT>
 DgramSocket<EndpointT>::DgramSocket( EndpointT local, EndpointT remote )
 	: DgramSocket()
@@ -93,11 +54,9 @@ DgramSocket<EndpointT>::DgramSocket( EndpointT local, EndpointT remote )
 template<class EndpointT>
 void DgramSocket<EndpointT>::connect( endpoint ep )
 {
-	auto result = _socket.connect( ep.toSockAddr() );
-	if( !result.success() ) {
-		throw generic_nw_error( make_error_message_with_appended_last_errno(
-			result, "Could not connect datagram socket to address \"", ep.toStringEx(), "\"" ) );
-	}
+	const auto addr   = ep.toSockAddr();
+	auto       result = _socket.connect( addr );
+	if( !result.success() ) { throw socket_error( socket_op::connect, result, addr ); }
 
 	_ep_remote = ep;
 }
@@ -105,11 +64,9 @@ void DgramSocket<EndpointT>::connect( endpoint ep )
 template<class EndpointT>
 void DgramSocket<EndpointT>::bind( endpoint ep )
 {
-	auto result = _socket.bind( ep.toSockAddr() );
-	if( !result.success() ) {
-		throw generic_nw_error( make_error_message_with_appended_last_errno(
-			result, "Could not bind datagram socket to address \"", ep.toStringEx(), "\"" ) );
-	}
+	const auto addr   = ep.toSockAddr();
+	auto       result = _socket.bind( addr );
+	if( !result.success() ) { throw socket_error( socket_op::bind, result, addr ); }
 
 	_ep_local = ep;
 }
@@ -135,13 +92,18 @@ socks::ErrorCode DgramSocket<EndpointT>::try_connect( endpoint ep ) noexcept
 template<class EndpointT>
 void DgramSocket<EndpointT>::sendto( mart::ConstMemoryView data, endpoint ep )
 {
-	const auto res = _socket.sendto( data, 0, ep.toSockAddr() );
-	if( !_txWasSuccess( data, res ) ) {
-		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
-			res.result.error_code(), "Failed to send data to ", ep.toString(), ". Details:  " ) );
-	}
+	const auto addr = ep.toSockAddr();
+	const auto res  = _tx_result( data.size(), _socket.sendto( data, 0, addr ).result );
+	if( !res ) { throw socket_error( socket_op::send, res, addr ); }
 }
 
+template<class EndpointT>
+void DgramSocket<EndpointT>::sendto( mart::ArrayView<const mart::ConstMemoryView> data, endpoint ep )
+{
+	const auto addr = ep.toSockAddr();
+	const auto res  = _tx_result( _total_size( data ), _socket.sendmsg( data, 0, &addr ) );
+	if( !res ) { throw socket_error( socket_op::send, res, addr ); }
+}
 
 namespace {
 template<class T, T... Vals>
@@ -165,11 +127,165 @@ typename DgramSocket<EndpointT>::RecvfromResult DgramSocket<EndpointT>::recvfrom
 					  ErrorCodeValues::TryAgain,
 					  ErrorCodeValues::Timeout,
 					  ErrorCodeValues::WsaeConnReset>( res.result.error_code().value() ) ) {
-		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
-			res.result.error_code(), "Failed to receive data. Details:  " ) );
+		throw socket_error( socket_op::recv, res.result.error_code() );
 	}
 
-	return { res.received_data, EndpointT( addr ) };
+	return { res.received_data, EndpointT( addr ), res.result.error_code() };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::TimestampedRecvfromResult
+DgramSocket<EndpointT>::recvfrom_timestamped( mart::MemoryView buffer )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr addr{};
+
+	std::chrono::nanoseconds ts{ 0 };
+	auto                     res = _socket.recvfrom_with_timestamp( buffer, 0, addr, ts );
+	if( !res.result
+		&& is_none_of<ErrorCodeValues,
+					  ErrorCodeValues::WouldBlock,
+					  ErrorCodeValues::TryAgain,
+					  ErrorCodeValues::Timeout,
+					  ErrorCodeValues::WsaeConnReset>( res.result.error_code().value() ) ) {
+		throw socket_error( socket_op::recv, res.result.error_code() );
+	}
+
+	return { res.received_data, EndpointT( addr ), Timestamp( ts ), res.result.error_code() };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::ScatterRecvfromResult
+DgramSocket<EndpointT>::recvfrom( mart::ArrayView<const mart::MemoryView> buffers )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr addr{};
+
+	const auto res = _socket.recvmsg( buffers, 0, &addr );
+	if( !res ) {
+		if( is_none_of<ErrorCodeValues,
+					   ErrorCodeValues::WouldBlock,
+					   ErrorCodeValues::TryAgain,
+					   ErrorCodeValues::Timeout,
+					   ErrorCodeValues::WsaeConnReset>( res.error_code().value() ) ) {
+			throw socket_error( socket_op::recv, res.error_code() );
+		}
+		return { 0, {}, res.error_code() };
+	}
+	return { static_cast<std::size_t>( res.value() ), EndpointT( addr ) };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::PooledRecvfromResult DgramSocket<EndpointT>::try_recvfrom( PacketPool& pool ) noexcept
+{
+	using mart::nw::socks::ErrorCodeValues;
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr addr{};
+
+	auto packet = pool.try_acquire();
+	if( !packet ) { return {{}, {}, ErrorCode{static_cast<ErrorCodeValues>( ENOBUFS )}}; }
+
+	const auto res = _socket.recvfrom( packet.buffer(), 0, addr );
+	if( !res.result ) { return {{}, {}, res.result.error_code()}; }
+
+	packet.set_size( res.received_data.size() );
+	return { std::move( packet ), EndpointT( addr ) };
+}
+
+template<class EndpointT>
+typename DgramSocket<EndpointT>::PooledRecvfromResult DgramSocket<EndpointT>::recvfrom( PacketPool& pool )
+{
+	using mart::nw::socks::ErrorCodeValues;
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+	abi_addr addr{};
+
+	auto packet = pool.try_acquire();
+	if( !packet ) { throw nw::generic_nw_error( "Failed to receive data: Packet pool is exhausted" ); }
+
+	const auto res = _socket.recvfrom( packet.buffer(), 0, addr );
+	if( !res.result ) {
+		if( is_none_of<ErrorCodeValues,
+					   ErrorCodeValues::WouldBlock,
+					   ErrorCodeValues::TryAgain,
+					   ErrorCodeValues::Timeout,
+					   ErrorCodeValues::WsaeConnReset>( res.result.error_code().value() ) ) {
+			throw socket_error( socket_op::recv, res.result.error_code() );
+		}
+		return {{}, {}, res.result.error_code()};
+	}
+
+	packet.set_size( res.received_data.size() );
+	return { std::move( packet ), EndpointT( addr ) };
+}
+
+namespace {
+// number of messages that are handed to the port layer at once (address storage lives on the stack)
+constexpr std::size_t batch_chunk_size = 32;
+} // namespace
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t>
+DgramSocket<EndpointT>::send_batch( mart::ArrayView<const SendBatchEntry> msgs ) noexcept
+{
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+
+	std::array<abi_addr, batch_chunk_size>                   addrs{};
+	std::array<port_layer::SendBatchEntry, batch_chunk_size> entries{};
+
+	std::size_t done = 0;
+	while( done < msgs.size() ) {
+		const std::size_t n = std::min( msgs.size() - done, batch_chunk_size );
+		for( std::size_t i = 0; i < n; ++i ) {
+			addrs[i]   = msgs[done + i].remote_address.toSockAddr();
+			entries[i] = port_layer::SendBatchEntry{
+				socks::_detail_socket_::to_byte_range( msgs[done + i].data ), &addrs[i], 0};
+		}
+
+		const auto res = _socket.sendmmsg( entries.data(), n );
+		if( !res ) {
+			if( done == 0 ) { return socks::ReturnValue<std::size_t>( res.error_code() ); }
+			break;
+		}
+		done += static_cast<std::size_t>( res.value() );
+		if( static_cast<std::size_t>( res.value() ) < n ) { break; }
+	}
+	return socks::ReturnValue<std::size_t>( done );
+}
+
+template<class EndpointT>
+socks::ReturnValue<std::size_t> DgramSocket<EndpointT>::recv_batch( mart::ArrayView<RecvBatchEntry> msgs ) noexcept
+{
+	using abi_addr = typename EndpointT::abi_endpoint_type;
+
+	std::array<abi_addr, batch_chunk_size>                   addrs{};
+	std::array<port_layer::RecvBatchEntry, batch_chunk_size> entries{};
+
+	std::size_t done = 0;
+	while( done < msgs.size() ) {
+		const std::size_t n = std::min( msgs.size() - done, batch_chunk_size );
+		for( std::size_t i = 0; i < n; ++i ) {
+			addrs[i]   = abi_addr{};
+			entries[i] = port_layer::RecvBatchEntry{
+				socks::_detail_socket_::to_mutable_byte_range( msgs[done + i].buffer ), &addrs[i], 0};
+		}
+
+		// only the first chunk may block
+		const auto res = _socket.recvmmsg( entries.data(), n, 0, done != 0 );
+		if( !res ) {
+			if( done == 0 ) { return socks::ReturnValue<std::size_t>( res.error_code() ); }
+			break;
+		}
+		for( int i = 0; i < res.value(); ++i ) {
+			auto& msg          = msgs[done + i];
+			msg.data           = msg.buffer.subview( 0, static_cast<std::size_t>( entries[i].received ) );
+			msg.remote_address = EndpointT( addrs[i] );
+		}
+		done += static_cast<std::size_t>( res.value() );
+		if( static_cast<std::size_t>( res.value() ) < n ) { break; }
+	}
+	return socks::ReturnValue<std::size_t>( done );
 }
 
 namespace {
@@ -26,19 +26,8 @@
 #include <mart-common/ArrayView.h>
 #include <mart-common/utils.h>
 
-#include <im_str/im_str.hpp>
-
 /* Standard Library Includes */
 #include <chrono>
-#include <string_view>
-
-#include <algorithm>
-#include <cerrno>
-#include <cstring>
-
-#if __has_include( <charconv> )
-#include <charconv>
-#endif
 
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
@@ -48,106 +37,88 @@ namespace socks {
 namespace detail {
 
 namespace {
+ErrorCode last_error() noexcept
+{
+	return mart::nw::socks::port_layer::get_last_socket_error();
+}
+} // namespace
 
-inline std::string_view errno_nr_as_string( mart::nw::socks::ErrorCode error, mart::ArrayView<char> buffer )
+void HighLevelSocketBase::set_tx_timeout( std::chrono::microseconds timeout )
 {
-#if __has_include( <charconv> )
-	auto res = std::to_chars( buffer.begin(), buffer.end(), error.raw_value() );
-	return { buffer.begin(), static_cast<std::string_view::size_type>( res.ptr - buffer.begin() ) };
-#else
-	auto res = std::to_string( error.raw_value() );
-	auto n   = std::min( res.size(), buffer.size() );
+	if( !try_set_tx_timeout( timeout ) ) { throw socket_error( socket_op::set_tx_timeout, last_error() ); }
+}
 
-	std::copy_n( res.begin(), n, buffer.begin() );
-	return { buffer.begin(), n };
-#endif
+void HighLevelSocketBase::set_rx_timeout( std::chrono::microseconds timeout )
+{
+	if( !try_set_rx_timeout( timeout ) ) { throw socket_error( socket_op::set_rx_timeout, last_error() ); }
 }
 
-inline std::string_view errno_nr_as_string( mart::ArrayView<char> buffer )
+std::chrono::microseconds HighLevelSocketBase::get_tx_timeout() const
 {
-	return errno_nr_as_string( mart::nw::socks::port_layer::get_last_socket_error(), buffer );
+	auto t = _socket.get_tx_timeout();
+	if( t == RaiiSocket::invalid_timeout_v ) { throw socket_error( socket_op::get_tx_timeout, last_error() ); }
+	return t;
 }
 
-template<class... Elements>
-mba::im_zstr make_error_message_with_appended_last_errno( mart::nw::socks::ErrorCode error, Elements&&... elements )
+std::chrono::microseconds HighLevelSocketBase::get_rx_timeout() const
 {
-	std::array<char, 24> errno_buffer{};
-	return mba::concat( std::string_view( elements )...,
-						"| Error Code:",
-						errno_nr_as_string( error, errno_buffer ),
-						" Error Msg: ",
-						socks::to_text_rep( error ) );
+	auto t = _socket.get_rx_timeout();
+	if( t == RaiiSocket::invalid_timeout_v ) { throw socket_error( socket_op::get_rx_timeout, last_error() ); }
+	return t;
 }
 
-} // namespace
+void HighLevelSocketBase::set_blocking( bool should_block )
+{
+	ErrorCode error = ErrorCode::Ok();
+	if( !try_set_blocking( should_block, error ) ) { throw socket_error( socket_op::set_blocking, error ); }
+}
+
+
+void HighLevelSocketBase::close() {
+	ErrorCode error = ErrorCode::Ok();
+	if( !try_close( error ) ) { throw socket_error( socket_op::close, error ); }
+}
 
-// TODO: look for more efficient solution
-std::string to_string( std::chrono::microseconds timeout )
+namespace {
+void throw_on_option_error( ErrorCode res )
 {
-	return std::to_string( timeout.count() ) + "us";
+	if( !res ) { throw socket_error( socket_op::set_option, res ); }
 }
+} // namespace
 
-void HighLevelSocketBase::set_tx_timeout( std::chrono::microseconds timeout )
+void HighLevelSocketBase::set_tcp_nodelay( bool enable )
 {
-	if( !try_set_tx_timeout( timeout ) ) {
-		throw generic_nw_error(
-			make_error_message_with_appended_last_errno( mart::nw::socks::port_layer::get_last_socket_error(),
-														 "Could  not set tx_timeout to ",
-														 to_string( timeout ),
-														 " on socket" ) );
-	}
+	throw_on_option_error( try_set_tcp_nodelay( enable ) );
 }
 
-void HighLevelSocketBase::set_rx_timeout( std::chrono::microseconds timeout )
+void HighLevelSocketBase::set_tcp_quickack( bool enable )
 {
-	if( !try_set_rx_timeout( timeout ) ) {
-		throw generic_nw_error(
-			make_error_message_with_appended_last_errno( mart::nw::socks::port_layer::get_last_socket_error(),
-														 "Could not set rx_timeout to ",
-														 to_string( timeout ),
-														 " on socket" ) );
-	}
+	throw_on_option_error( try_set_tcp_quickack( enable ) );
 }
 
-std::chrono::microseconds HighLevelSocketBase::get_tx_timeout() const
+void HighLevelSocketBase::set_busy_poll( std::chrono::microseconds duration )
 {
-	auto t = _socket.get_tx_timeout();
-	if( t == RaiiSocket::invalid_timeout_v ) {
-		throw generic_nw_error(
-			make_error_message_with_appended_last_errno( mart::nw::socks::port_layer::get_last_socket_error(),
-														 "Could not determine tx_timeout on socket" ) );
-	}
-	return t;
+	throw_on_option_error( try_set_busy_poll( duration ) );
 }
 
-std::chrono::microseconds HighLevelSocketBase::get_rx_timeout() const
+void HighLevelSocketBase::set_rx_buffer_size( int bytes )
 {
-	auto t = _socket.get_rx_timeout();
-	if( t == RaiiSocket::invalid_timeout_v ) {
-		throw generic_nw_error(
-			make_error_message_with_appended_last_errno( mart::nw::socks::port_layer::get_last_socket_error(),
-														 "Could not determine rx_timeout on socket" ) );
-	}
-	return t;
+	throw_on_option_error( try_set_rx_buffer_size( bytes ) );
 }
 
-void HighLevelSocketBase::set_blocking( bool should_block )
+void HighLevelSocketBase::set_tx_buffer_size( int bytes )
 {
-	if( !try_set_blocking( should_block ) ) {
-		throw generic_nw_error(
-			make_error_message_with_appended_last_errno( mart::nw::socks::port_layer::get_last_socket_error(),
-														 "Could not switch blocking mode to ",
-														 ( should_block ? "true" : "false"),
-														 " on socket" ) );
-	}
+	throw_on_option_error( try_set_tx_buffer_size( bytes ) );
 }
 
+void HighLevelSocketBase::set_priority( int priority )
+{
+	throw_on_option_error( try_set_priority( priority ) );
+}
 
-void HighLevelSocketBase::close() {
-	if( !try_close() ) {
-		throw generic_nw_error( make_error_message_with_appended_last_errno(
-			mart::nw::socks::port_layer::get_last_socket_error(), "Could not close socket" ) );
-	}
+void HighLevelSocketBase::set_rx_timestamps( bool enable )
+{
+	throw_on_option_error( try_set_rx_timestamps( enable ) );
 }
 
 template<class T, T... Vals>
@@ -175,18 +146,14 @@ DgramSocketBase::DgramSocketBase( mart::nw::socks::Domain domain )
 	: HighLevelSocketBase( domain, socks::TransportType::Datagram )
 {
 	if( !is_valid() ) {
-		throw generic_nw_error( make_error_message_with_appended_last_errno(
-			mart::nw::socks::port_layer::get_last_socket_error(), "Could not create socket." ) );
+		throw socket_error( socket_op::create, last_error() );
 	}
 }
 
 void DgramSocketBase::send( mart::ConstMemoryView data )
 {
-	const auto res = _socket.send( data, 0 );
-	if( !res.result ) {
-		throw nw::generic_nw_error(
-			make_error_message_with_appended_last_errno( res.result.error_code(), "Failed to send data. Details:  " ) );
-	}
+	ErrorCode error = ErrorCode::Ok();
+	if( !try_send( data, error ) ) { throw socket_error( socket_op::send, error ); }
 }
 
 mart::MemoryView DgramSocketBase::recv( mart::MemoryView buffer )
@@ -199,8 +166,7 @@ mart::MemoryView DgramSocketBase::recv( mart::MemoryView buffer )
 					  ErrorCodeValues::TryAgain,
 					  ErrorCodeValues::Timeout,
 					  ErrorCodeValues::WsaeConnReset>( res.result.error_code().value() ) ) {
-		throw nw::generic_nw_error( make_error_message_with_appended_last_errno(
-			res.result.error_code(), "Failed to receive data. Details:  " ) );
+		throw socket_error( socket_op::recv, res.result.error_code() );
 	}
 	return res.received_data;
 }
@@ -0,0 +1,693 @@
+#include <mart-netlib/io_queue.hpp>
+
+/**
+ * io_queue.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	io_uring and epoll based implementations of mart::nw::IoQueue
+ *
+ */
+
+/* ######## INCLUDES ######### */
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <im_str/im_str.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if MART_NETLIB_USE_IO_URING
+#include <csignal>
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+namespace {
+
+using handle_t   = IoQueue::handle_t;
+using UserData   = IoQueue::UserData;
+using Completion = IoQueue::Completion;
+
+mba::im_zstr make_errno_message( std::string_view msg, int error )
+{
+	return mba::concat( msg, " Error Msg: ", std::string_view( std::strerror( error ) ) );
+}
+
+socks::ErrorCode errno_to_error_code( int error ) noexcept
+{
+	return socks::ErrorCode{socks::ErrorCodeValues( error )};
+}
+
+enum class OpType { Recv, Send, Accept };
+
+// @p res follows the kernel convention: result or negative errno
+Completion make_completion( OpType type, UserData user_data, int res ) noexcept
+{
+	if( res < 0 ) {
+		return {user_data, socks::ReturnValue<std::size_t>( errno_to_error_code( -res ) ), handle_t::Invalid};
+	}
+	if( type == OpType::Accept ) {
+		return {user_data, socks::ReturnValue<std::size_t>( std::size_t( 0 ) ), static_cast<handle_t>( res )};
+	}
+	return {user_data, socks::ReturnValue<std::size_t>( static_cast<std::size_t>( res ) ), handle_t::Invalid};
+}
+
+} // namespace
+
+struct IoQueue::Impl {
+	explicit Impl( std::size_t max_in_flight )
+		: max_in_flight( max_in_flight )
+	{
+	}
+	virtual ~Impl() = default;
+
+	virtual Backend backend() const noexcept = 0;
+
+	virtual bool             register_socket( int fd ) noexcept                                           = 0;
+	virtual bool             unregister_socket( int fd ) noexcept                                         = 0;
+	virtual socks::ErrorCode register_buffers( mart::ArrayView<const mart::MemoryView> buffers ) noexcept = 0;
+	virtual socks::ErrorCode unregister_buffers() noexcept                                                = 0;
+
+	virtual bool queue( OpType type, int fd, void* data, std::size_t len, UserData user_data ) noexcept = 0;
+
+	virtual socks::ReturnValue<std::size_t> submit() noexcept                                                  = 0;
+	virtual std::size_t                     reap( mart::ArrayView<Completion> out, std::chrono::milliseconds max_wait ) = 0;
+
+	std::size_t max_in_flight;
+	std::size_t in_flight = 0;
+};
+
+/* ################################################################################ */
+/* ############# io_uring ######################################################### */
+
+#if MART_NETLIB_USE_IO_URING
+
+namespace {
+
+int sys_io_uring_setup( unsigned entries, ::io_uring_params* params ) noexcept
+{
+	return static_cast<int>( ::syscall( __NR_io_uring_setup, entries, params ) );
+}
+
+int sys_io_uring_enter( int fd, unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, std::size_t argsz ) noexcept
+{
+	return static_cast<int>( ::syscall( __NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz ) );
+}
+
+int sys_io_uring_register( int fd, unsigned opcode, const void* arg, unsigned nr_args ) noexcept
+{
+	return static_cast<int>( ::syscall( __NR_io_uring_register, fd, opcode, arg, nr_args ) );
+}
+
+template<class T>
+T* ring_ptr( void* base, std::uint32_t offset ) noexcept
+{
+	return reinterpret_cast<T*>( static_cast<char*>( base ) + offset );
+}
+
+} // namespace
+
+struct IoQueue::UringImpl final : IoQueue::Impl {
+	// Returns nullptr if the kernel doesn't support (all required features of) io_uring
+	static std::unique_ptr<UringImpl> try_create( std::size_t queue_depth ) noexcept
+	{
+		::io_uring_params params{};
+
+		const int fd = sys_io_uring_setup( static_cast<unsigned>( queue_depth ), &params );
+		if( fd < 0 ) { return nullptr; }
+
+		// IORING_FEAT_EXT_ARG (linux 5.11) is needed for waiting with a timeout and implies IORING_FEAT_SINGLE_MMAP
+		if( !( params.features & IORING_FEAT_EXT_ARG ) ) {
+			::close( fd );
+			return nullptr;
+		}
+
+		const std::size_t sq_ring_size = params.sq_off.array + params.sq_entries * sizeof( std::uint32_t );
+		const std::size_t cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof( ::io_uring_cqe );
+		const std::size_t ring_size    = std::max( sq_ring_size, cq_ring_size );
+		const std::size_t sqes_size    = params.sq_entries * sizeof( ::io_uring_sqe );
+
+		void* ring = ::mmap( nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING );
+		if( ring == MAP_FAILED ) {
+			::close( fd );
+			return nullptr;
+		}
+		void* sqes = ::mmap( nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES );
+		if( sqes == MAP_FAILED ) {
+			::munmap( ring, ring_size );
+			::close( fd );
+			return nullptr;
+		}
+
+		return std::unique_ptr<UringImpl>( new UringImpl( fd, params, ring, ring_size, sqes, sqes_size ) );
+	}
+
+	~UringImpl() override
+	{
+		::munmap( _sqes, _sqes_size );
+		::munmap( _ring, _ring_size );
+		::close( _ring_fd );
+	}
+
+	Backend backend() const noexcept override { return Backend::IoUring; }
+
+	bool register_socket( int fd ) noexcept override
+	{
+		if( !_files_registered ) { return false; }
+		if( _fixed_slots.count( fd ) ) { return true; }
+
+		const auto it = std::find( _fixed_files.begin(), _fixed_files.end(), -1 );
+		if( it == _fixed_files.end() ) { return false; }
+		const auto slot = static_cast<std::uint32_t>( it - _fixed_files.begin() );
+
+		if( !_update_fixed_file( slot, fd ) ) { return false; }
+		*it = fd;
+		_fixed_slots.emplace( fd, slot );
+		return true;
+	}
+
+	bool unregister_socket( int fd ) noexcept override
+	{
+		const auto it = _fixed_slots.find( fd );
+		if( it == _fixed_slots.end() ) { return false; }
+
+		_update_fixed_file( it->second, -1 );
+		_fixed_files[it->second] = -1;
+		_fixed_slots.erase( it );
+		return true;
+	}
+
+	socks::ErrorCode register_buffers( mart::ArrayView<const mart::MemoryView> buffers ) noexcept override
+	{
+		if( !_buffers.empty() ) { return errno_to_error_code( EBUSY ); }
+
+		std::vector<::iovec> iovs;
+		iovs.reserve( buffers.size() );
+		for( const auto& b : buffers ) {
+			iovs.push_back( ::iovec{b.data(), b.size()} );
+		}
+		if( sys_io_uring_register(
+				_ring_fd, IORING_REGISTER_BUFFERS, iovs.data(), static_cast<unsigned>( iovs.size() ) )
+			< 0 ) {
+			return errno_to_error_code( errno );
+		}
+		_buffers = std::move( iovs );
+		return socks::ErrorCode::Ok();
+	}
+
+	socks::ErrorCode unregister_buffers() noexcept override
+	{
+		if( _buffers.empty() ) { return socks::ErrorCode::Ok(); }
+		if( sys_io_uring_register( _ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0 ) < 0 ) {
+			return errno_to_error_code( errno );
+		}
+		_buffers.clear();
+		return socks::ErrorCode::Ok();
+	}
+
+	bool queue( OpType type, int fd, void* data, std::size_t len, UserData user_data ) noexcept override
+	{
+		if( in_flight == max_in_flight ) { return false; }
+
+		// the submission ring is full, if the kernel didn't consume the entries yet
+		const std::uint32_t head = __atomic_load_n( _sq_head, __ATOMIC_ACQUIRE );
+		if( _sqe_tail - head >= _sq_entries ) { return false; }
+
+		const std::uint32_t idx = _sqe_tail & *_sq_mask;
+		::io_uring_sqe&     sqe = _sqes[idx];
+		std::memset( &sqe, 0, sizeof( sqe ) );
+
+		const auto fixed = _fixed_slots.find( fd );
+		if( fixed != _fixed_slots.end() ) {
+			sqe.fd    = static_cast<std::int32_t>( fixed->second );
+			sqe.flags = IOSQE_FIXED_FILE;
+		} else {
+			sqe.fd = fd;
+		}
+
+		switch( type ) {
+			case OpType::Recv: {
+				const int buf_idx = _find_registered_buffer( data, len );
+				if( buf_idx >= 0 ) {
+					// on a socket, a read is the same as a recv without flags
+					sqe.opcode    = IORING_OP_READ_FIXED;
+					sqe.buf_index = static_cast<std::uint16_t>( buf_idx );
+				} else {
+					sqe.opcode = IORING_OP_RECV;
+				}
+				sqe.addr = reinterpret_cast<std::uint64_t>( data );
+				sqe.len  = static_cast<std::uint32_t>( len );
+				break;
+			}
+			case OpType::Send:
+				sqe.opcode    = IORING_OP_SEND;
+				sqe.addr      = reinterpret_cast<std::uint64_t>( data );
+				sqe.len       = static_cast<std::uint32_t>( len );
+				sqe.msg_flags = MSG_NOSIGNAL;
+				break;
+			case OpType::Accept:
+				sqe.opcode       = IORING_OP_ACCEPT;
+				sqe.accept_flags = SOCK_CLOEXEC;
+				break;
+		}
+
+		// the kernel only hands back the user data, so we store the operation type next to the user's value
+		const auto slot = _free_op_slots.back();
+		_free_op_slots.pop_back();
+		_op_slots[slot] = OpSlot{type, user_data};
+		sqe.user_data   = slot;
+
+		_sq_array[idx] = idx;
+		++_sqe_tail;
+		++in_flight;
+		return true;
+	}
+
+	socks::ReturnValue<std::size_t> submit() noexcept override
+	{
+		const auto to_submit = _publish_sqes();
+		if( to_submit == 0 ) { return socks::ReturnValue<std::size_t>( std::size_t( 0 ) ); }
+
+		const int ret = sys_io_uring_enter( _ring_fd, to_submit, 0, 0, nullptr, 0 );
+		if( ret < 0 ) { return socks::ReturnValue<std::size_t>( errno_to_error_code( errno ) ); }
+		return socks::ReturnValue<std::size_t>( static_cast<std::size_t>( ret ) );
+	}
+
+	std::size_t reap( mart::ArrayView<Completion> out, std::chrono::milliseconds max_wait ) override
+	{
+		const auto  to_submit = _publish_sqes();
+		std::size_t cnt       = _collect( out );
+
+		if( cnt == 0 && in_flight != 0 && max_wait.count() > 0 ) {
+			::__kernel_timespec ts{};
+			ts.tv_sec  = max_wait.count() / 1000;
+			ts.tv_nsec = ( max_wait.count() % 1000 ) * 1000000;
+
+			::io_uring_getevents_arg arg{};
+			arg.sigmask_sz = _NSIG / 8;
+			arg.ts         = reinterpret_cast<std::uint64_t>( &ts );
+
+			const int ret = sys_io_uring_enter(
+				_ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof( arg ) );
+			if( ret < 0 && errno != ETIME && errno != EINTR ) {
+				throw generic_nw_error( make_errno_message( "Waiting for io_uring completions failed.", errno ) );
+			}
+		} else if( to_submit != 0 ) {
+			if( sys_io_uring_enter( _ring_fd, to_submit, 0, 0, nullptr, 0 ) < 0 && errno != EINTR ) {
+				throw generic_nw_error( make_errno_message( "Submitting io_uring operations failed.", errno ) );
+			}
+		}
+
+		return cnt + _collect( out.subview( cnt ) );
+	}
+
+private:
+	struct OpSlot {
+		OpType   type;
+		UserData user_data;
+	};
+
+	UringImpl( int fd, const ::io_uring_params& params, void* ring, std::size_t ring_size, void* sqes, std::size_t sqes_size )
+		: Impl( params.cq_entries ) // never have more operations in flight than fit into the completion queue
+		, _ring_fd( fd )
+		, _ring( ring )
+		, _ring_size( ring_size )
+		, _sqes( static_cast<::io_uring_sqe*>( sqes ) )
+		, _sqes_size( sqes_size )
+		, _sq_entries( params.sq_entries )
+		, _sq_head( ring_ptr<std::uint32_t>( ring, params.sq_off.head ) )
+		, _sq_tail( ring_ptr<std::uint32_t>( ring, params.sq_off.tail ) )
+		, _sq_mask( ring_ptr<std::uint32_t>( ring, params.sq_off.ring_mask ) )
+		, _sq_array( ring_ptr<std::uint32_t>( ring, params.sq_off.array ) )
+		, _cq_head( ring_ptr<std::uint32_t>( ring, params.cq_off.head ) )
+		, _cq_tail( ring_ptr<std::uint32_t>( ring, params.cq_off.tail ) )
+		, _cq_mask( ring_ptr<std::uint32_t>( ring, params.cq_off.ring_mask ) )
+		, _cqes( ring_ptr<::io_uring_cqe>( ring, params.cq_off.cqes ) )
+		, _sqe_tail( *_sq_tail )
+		, _op_slots( params.cq_entries )
+	{
+		_free_op_slots.reserve( params.cq_entries );
+		for( std::uint32_t i = params.cq_entries; i > 0; --i ) {
+			_free_op_slots.push_back( i - 1 );
+		}
+
+		// sparse table (-1 entries), sockets are added with IORING_REGISTER_FILES_UPDATE
+		_fixed_files.assign( max_fixed_files, -1 );
+		_files_registered = sys_io_uring_register(
+								_ring_fd, IORING_REGISTER_FILES, _fixed_files.data(), static_cast<unsigned>( _fixed_files.size() ) )
+							>= 0;
+	}
+
+	bool _update_fixed_file( std::uint32_t slot, int fd ) noexcept
+	{
+		::io_uring_files_update update{};
+		update.offset = slot;
+		update.fds    = reinterpret_cast<std::uint64_t>( &fd );
+		return sys_io_uring_register( _ring_fd, IORING_REGISTER_FILES_UPDATE, &update, 1 ) == 1;
+	}
+
+	int _find_registered_buffer( const void* data, std::size_t len ) const noexcept
+	{
+		const auto* const begin = static_cast<const char*>( data );
+		for( std::size_t i = 0; i < _buffers.size(); ++i ) {
+			const auto* const buf_begin = static_cast<const char*>( _buffers[i].iov_base );
+			if( begin >= buf_begin && begin + len <= buf_begin + _buffers[i].iov_len ) { return static_cast<int>( i ); }
+		}
+		return -1;
+	}
+
+	// makes queued entries visible to the kernel and returns the number of entries it didn't consume yet
+	std::uint32_t _publish_sqes() noexcept
+	{
+		__atomic_store_n( _sq_tail, _sqe_tail, __ATOMIC_RELEASE );
+		return _sqe_tail - __atomic_load_n( _sq_head, __ATOMIC_ACQUIRE );
+	}
+
+	std::size_t _collect( mart::ArrayView<Completion> out ) noexcept
+	{
+		std::uint32_t       head = *_cq_head;
+		const std::uint32_t tail = __atomic_load_n( _cq_tail, __ATOMIC_ACQUIRE );
+
+		std::size_t cnt = 0;
+		while( head != tail && cnt < out.size() ) {
+			const ::io_uring_cqe& cqe  = _cqes[head & *_cq_mask];
+			const auto            slot = static_cast<std::uint32_t>( cqe.user_data );
+
+			out[cnt++] = make_completion( _op_slots[slot].type, _op_slots[slot].user_data, cqe.res );
+			_free_op_slots.push_back( slot );
+			++head;
+		}
+		__atomic_store_n( _cq_head, head, __ATOMIC_RELEASE );
+
+		in_flight -= cnt;
+		return cnt;
+	}
+
+	int             _ring_fd;
+	void*           _ring;
+	std::size_t     _ring_size;
+	::io_uring_sqe* _sqes;
+	std::size_t     _sqes_size;
+
+	std::uint32_t   _sq_entries;
+	std::uint32_t*  _sq_head;
+	std::uint32_t*  _sq_tail;
+	std::uint32_t*  _sq_mask;
+	std::uint32_t*  _sq_array;
+	std::uint32_t*  _cq_head;
+	std::uint32_t*  _cq_tail;
+	std::uint32_t*  _cq_mask;
+	::io_uring_cqe* _cqes;
+
+	std::uint32_t _sqe_tail; // tail of the submission queue including entries that are not published yet
+
+	std::vector<OpSlot>        _op_slots;
+	std::vector<std::uint32_t> _free_op_slots;
+
+	bool                                   _files_registered = false;
+	std::vector<int>                       _fixed_files;
+	std::unordered_map<int, std::uint32_t> _fixed_slots;
+	std::vector<::iovec>                   _buffers;
+};
+
+#endif // MART_NETLIB_USE_IO_URING
+
+/* ################################################################################ */
+/* ############# epoll ############################################################ */
+
+struct IoQueue::EpollImpl final : IoQueue::Impl {
+	explicit EpollImpl( std::size_t queue_depth )
+		: Impl( 2 * queue_depth ) // same ratio as the io_uring submission / completion queue
+		, _queue_depth( queue_depth )
+	{
+		_epoll_fd = ::epoll_create1( EPOLL_CLOEXEC );
+		if( _epoll_fd < 0 ) { throw generic_nw_error( make_errno_message( "Could not create epoll instance.", errno ) ); }
+	}
+
+	~EpollImpl() override { ::close( _epoll_fd ); }
+
+	Backend backend() const noexcept override { return Backend::Epoll; }
+
+	bool             register_socket( int ) noexcept override { return true; }
+	bool             unregister_socket( int ) noexcept override { return true; }
+	socks::ErrorCode register_buffers( mart::ArrayView<const mart::MemoryView> ) noexcept override
+	{
+		return socks::ErrorCode::Ok();
+	}
+	socks::ErrorCode unregister_buffers() noexcept override { return socks::ErrorCode::Ok(); }
+
+	bool queue( OpType type, int fd, void* data, std::size_t len, UserData user_data ) noexcept override
+	{
+		if( in_flight == max_in_flight || _queued.size() == _queue_depth ) { return false; }
+		_queued.push_back( QueuedOp{fd, Op{type, data, len, user_data}} );
+		++in_flight;
+		return true;
+	}
+
+	socks::ReturnValue<std::size_t> submit() noexcept override
+	{
+		const auto cnt = _queued.size();
+		for( const auto& q : _queued ) {
+			auto& state = _fds[q.fd];
+			( q.op.type == OpType::Send ? state.writes : state.reads ).push_back( q.op );
+		}
+		for( const auto& q : _queued ) {
+			_update_interest( q.fd );
+		}
+		_queued.clear();
+		return socks::ReturnValue<std::size_t>( cnt );
+	}
+
+	std::size_t reap( mart::ArrayView<Completion> out, std::chrono::milliseconds max_wait ) override
+	{
+		submit();
+
+		std::size_t cnt = 0;
+		while( cnt < out.size() && !_done.empty() ) {
+			out[cnt++] = _done.front();
+			_done.pop_front();
+		}
+		if( cnt == out.size() || _fds.empty() ) {
+			in_flight -= cnt;
+			return cnt;
+		}
+
+		std::array<::epoll_event, 64> events{};
+
+		const int timeout = cnt != 0 ? 0 : static_cast<int>( max_wait.count() );
+		const int n       = ::epoll_wait( _epoll_fd, events.data(), static_cast<int>( events.size() ), timeout );
+		if( n < 0 && errno != EINTR ) {
+			throw generic_nw_error( make_errno_message( "Waiting for socket events failed.", errno ) );
+		}
+
+		for( int i = 0; i < n; ++i ) {
+			const int  fd = events[i].data.fd;
+			const auto ev = events[i].events;
+
+			auto it = _fds.find( fd );
+			if( it == _fds.end() ) { continue; }
+
+			const bool failure = ev & ( EPOLLERR | EPOLLHUP );
+			if( failure || ( ev & EPOLLIN ) ) { _execute( fd, it->second.reads ); }
+			if( failure || ( ev & EPOLLOUT ) ) { _execute( fd, it->second.writes ); }
+			_update_interest( fd );
+		}
+
+		while( cnt < out.size() && !_done.empty() ) {
+			out[cnt++] = _done.front();
+			_done.pop_front();
+		}
+		in_flight -= cnt;
+		return cnt;
+	}
+
+private:
+	struct Op {
+		OpType      type;
+		void*       data;
+		std::size_t len;
+		UserData    user_data;
+	};
+	struct QueuedOp {
+		int fd;
+		Op  op;
+	};
+	struct FdState {
+		std::deque<Op> reads; // recv and accept
+		std::deque<Op> writes;
+		bool           registered = false;
+	};
+
+	static int _perform( int fd, const Op& op ) noexcept
+	{
+		long ret = -1;
+		switch( op.type ) {
+			case OpType::Recv: ret = ::recv( fd, op.data, op.len, MSG_DONTWAIT ); break;
+			case OpType::Send: ret = ::send( fd, op.data, op.len, MSG_DONTWAIT | MSG_NOSIGNAL ); break;
+			case OpType::Accept: ret = ::accept4( fd, nullptr, nullptr, SOCK_CLOEXEC ); break;
+		}
+		return ret < 0 ? -errno : static_cast<int>( ret );
+	}
+
+	// executes operations in order until one would block
+	void _execute( int fd, std::deque<Op>& ops )
+	{
+		while( !ops.empty() ) {
+			const int res = _perform( fd, ops.front() );
+			if( res == -EAGAIN || res == -EWOULDBLOCK ) { return; }
+			_done.push_back( make_completion( ops.front().type, ops.front().user_data, res ) );
+			ops.pop_front();
+		}
+	}
+
+	void _update_interest( int fd )
+	{
+		auto it = _fds.find( fd );
+		if( it == _fds.end() ) { return; }
+		auto& state = it->second;
+
+		std::uint32_t events = 0;
+		if( !state.reads.empty() ) { events |= EPOLLIN; }
+		if( !state.writes.empty() ) { events |= EPOLLOUT; }
+
+		if( events == 0 ) {
+			if( state.registered ) { ::epoll_ctl( _epoll_fd, EPOLL_CTL_DEL, fd, nullptr ); }
+			_fds.erase( it );
+			return;
+		}
+
+		::epoll_event ev{};
+		ev.events  = events | EPOLLONESHOT;
+		ev.data.fd = fd;
+		if( ::epoll_ctl( _epoll_fd, state.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev ) == 0 ) {
+			state.registered = true;
+			return;
+		}
+
+		// e.g. invalid handle -> fail all operations on that handle
+		const int error = errno;
+		for( auto* ops : {&state.reads, &state.writes} ) {
+			for( const auto& op : *ops ) {
+				_done.push_back( make_completion( op.type, op.user_data, -error ) );
+			}
+		}
+		_fds.erase( it );
+	}
+
+	int                              _epoll_fd = -1;
+	std::size_t                      _queue_depth;
+	std::vector<QueuedOp>            _queued;
+	std::unordered_map<int, FdState> _fds;
+	std::deque<Completion>           _done;
+};
+
+/* ################################################################################ */
+/* ############# IoQueue ########################################################## */
+
+IoQueue::IoQueue( std::size_t queue_depth, Backend preferred )
+{
+	if( queue_depth == 0 ) { queue_depth = 1; }
+#if MART_NETLIB_USE_IO_URING
+	if( preferred == Backend::IoUring ) { _impl = UringImpl::try_create( queue_depth ); }
+#else
+	(void)preferred;
+#endif
+	if( !_impl ) { _impl = std::make_unique<EpollImpl>( queue_depth ); }
+}
+
+IoQueue::~IoQueue() = default;
+
+IoQueue::Backend IoQueue::backend() const noexcept
+{
+	return _impl->backend();
+}
+
+bool IoQueue::is_io_uring_supported() noexcept
+{
+#if MART_NETLIB_USE_IO_URING
+	static const bool supported = UringImpl::try_create( 1 ) != nullptr;
+	return supported;
+#else
+	return false;
+#endif
+}
+
+bool IoQueue::register_socket( handle_t handle ) noexcept
+{
+	return _impl->register_socket( socks::port_layer::to_native( handle ) );
+}
+
+bool IoQueue::unregister_socket( handle_t handle ) noexcept
+{
+	return _impl->unregister_socket( socks::port_layer::to_native( handle ) );
+}
+
+socks::ErrorCode IoQueue::register_buffers( mart::ArrayView<const mart::MemoryView> buffers ) noexcept
+{
+	return _impl->register_buffers( buffers );
+}
+
+socks::ErrorCode IoQueue::unregister_buffers() noexcept
+{
+	return _impl->unregister_buffers();
+}
+
+bool IoQueue::recv( handle_t handle, mart::MemoryView buffer, UserData user_data ) noexcept
+{
+	return _impl->queue( OpType::Recv, socks::port_layer::to_native( handle ), buffer.data(), buffer.size(), user_data );
+}
+
+bool IoQueue::send( handle_t handle, mart::ConstMemoryView data, UserData user_data ) noexcept
+{
+	// the data is only read
+	return _impl->queue( OpType::Send,
+						 socks::port_layer::to_native( handle ),
+						 const_cast<void*>( static_cast<const void*>( data.data() ) ),
+						 data.size(),
+						 user_data );
+}
+
+bool IoQueue::accept( handle_t handle, UserData user_data ) noexcept
+{
+	return _impl->queue( OpType::Accept, socks::port_layer::to_native( handle ), nullptr, 0, user_data );
+}
+
+socks::ReturnValue<std::size_t> IoQueue::submit() noexcept
+{
+	return _impl->submit();
+}
+
+std::size_t IoQueue::reap( mart::ArrayView<Completion> out, std::chrono::milliseconds max_wait )
+{
+	return _impl->reap( out, max_wait );
+}
+
+std::size_t IoQueue::in_flight() const noexcept
+{
+	return _impl->in_flight;
+}
+
+} // namespace mart::nw
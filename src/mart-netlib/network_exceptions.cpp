@@ -0,0 +1,149 @@
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <mart-netlib/RaiiSocket.hpp>
+#include <mart-netlib/port_layer.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+namespace mart::nw {
+
+namespace {
+
+std::string_view to_text( socket_op op, bool has_address ) noexcept
+{
+	switch( op ) {
+		case socket_op::create: return "Could not create socket";
+		case socket_op::bind: return "Could not bind socket to address ";
+		case socket_op::connect: return "Could not connect socket to address ";
+		case socket_op::listen: return has_address ? "Could not listen on address " : "Could not listen on socket";
+		case socket_op::send: return has_address ? "Failed to send data to " : "Failed to send data";
+		case socket_op::recv: return "Failed to receive data";
+		case socket_op::get_local_address: return "Could not determine local address of socket";
+		case socket_op::set_tx_timeout: return "Could not set tx_timeout on socket";
+		case socket_op::set_rx_timeout: return "Could not set rx_timeout on socket";
+		case socket_op::get_tx_timeout: return "Could not determine tx_timeout on socket";
+		case socket_op::get_rx_timeout: return "Could not determine rx_timeout on socket";
+		case socket_op::set_blocking: return "Could not switch blocking mode on socket";
+		case socket_op::set_option: return "Could not set socket option";
+		case socket_op::close: return "Could not close socket";
+	}
+	return "Socket operation failed";
+}
+
+// appends text to a fixed size, zero terminated buffer and silently truncates it if it gets too long
+struct MessageWriter {
+	char* pos;
+	char* end; // last character in the buffer (reserved for the terminating zero)
+
+	void append( std::string_view text ) noexcept
+	{
+		const auto n = std::min( text.size(), static_cast<std::size_t>( end - pos ) );
+		std::copy_n( text.data(), n, pos );
+		pos += n;
+		*pos = '\0';
+	}
+
+	void append( int value ) noexcept
+	{
+		const auto res = std::to_chars( pos, end, value );
+		if( res.ec == std::errc{} ) { pos = res.ptr; }
+		*pos = '\0';
+	}
+};
+
+} // namespace
+
+socket_error::socket_error( socket_op op, socks::ErrorCode error ) noexcept
+	: generic_nw_error( mba::im_zstr{} )
+	, _op( op )
+	, _error( error )
+{
+}
+
+socket_error::socket_error( socket_op op, socks::ErrorCode error, const socks::Sockaddr& addr ) noexcept
+	: socket_error( op, error )
+{
+	if( addr.is_valid() ) {
+		_addr_size = std::min( addr.size(), _addr.size() );
+		std::memcpy( _addr.data(), addr.to_native_ptr(), _addr_size );
+	}
+}
+
+socket_error::socket_error( const socket_error& other ) noexcept
+	: generic_nw_error( other )
+	, _op( other._op )
+	, _error( other._error )
+	, _addr( other._addr )
+	, _addr_size( other._addr_size )
+{
+	// a message that is still being rendered by another thread is just rendered again
+	if( other._message_state.load( std::memory_order_acquire ) == MessageState::ready ) {
+		_message = other._message;
+		_message_state.store( MessageState::ready, std::memory_order_relaxed );
+	}
+}
+
+socket_error& socket_error::operator=( const socket_error& other ) noexcept
+{
+	if( this == &other ) { return *this; }
+	generic_nw_error::operator=( other );
+	_op        = other._op;
+	_error     = other._error;
+	_addr      = other._addr;
+	_addr_size = other._addr_size;
+	if( other._message_state.load( std::memory_order_acquire ) == MessageState::ready ) {
+		_message = other._message;
+		_message_state.store( MessageState::ready, std::memory_order_release );
+	} else {
+		_message_state.store( MessageState::empty, std::memory_order_relaxed );
+	}
+	return *this;
+}
+
+const char* socket_error::what() const noexcept
+{
+	auto state = _message_state.load( std::memory_order_acquire );
+	if( state == MessageState::empty
+		&& _message_state.compare_exchange_strong( state, MessageState::rendering, std::memory_order_acquire ) ) {
+		_render_message();
+		_message_state.store( MessageState::ready, std::memory_order_release );
+		return _message.data();
+	}
+
+	// another thread is rendering the message right now (which doesn't take long)
+	while( _message_state.load( std::memory_order_acquire ) != MessageState::ready ) {
+		std::this_thread::yield();
+	}
+	return _message.data();
+}
+
+void socket_error::_render_message() const noexcept
+{
+	MessageWriter w{ _message.data(), _message.data() + _message.size() - 1 };
+	w.append( to_text( _op, _addr_size != 0 ) );
+
+	if( _addr_size != 0 ) {
+		// a native address (even sockaddr_un) can't result in a longer string
+		std::array<char, 128> addr_buffer{};
+		try {
+			const char* addr_str = socks::port_layer::inet_net_to_pres(
+				reinterpret_cast<const ::sockaddr*>( _addr.data() ), addr_buffer.data(), addr_buffer.size() - 1 );
+			w.append( "\"" );
+			w.append( addr_str ? std::string_view( addr_str ) : std::string_view( "<unknown>" ) );
+			w.append( "\"" );
+		} catch( ... ) {
+			w.append( "<unknown>" );
+		}
+	}
+
+	w.append( " | Error Code:" );
+	w.append( _error.raw_value() );
+	w.append( " Error Msg: " );
+	w.append( socks::to_text_rep( _error ) );
+}
+
+} // namespace mart::nw
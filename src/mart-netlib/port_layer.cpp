@@ -51,11 +51,18 @@
 #include <cerrno>
 #include <fcntl.h>
 #include <netdb.h> //addrinfo
+#include <netinet/in.h>
+#include <netinet/tcp.h> // TCP_NODELAY
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h> // iovec
 #include <sys/un.h>
 #include <unistd.h> //close
 #endif
+
+#if defined( __linux__ ) && defined( MSG_WAITFORONE )
+#define MART_NETLIB_PORT_LAYER_HAS_MMSG 1
+#endif
 /* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
 
 #ifdef __has_cpp_attribute
@@ -333,6 +340,7 @@ int to_native( SocketOptionLevel level )
 {
 	switch( level ) {
 		case mart::nw::socks::SocketOptionLevel::Socket: return SOL_SOCKET; break;
+		case mart::nw::socks::SocketOptionLevel::Tcp: return IPPROTO_TCP; break;
 	}
 	assert( false );
 	return static_cast<int>( level );
@@ -344,6 +352,35 @@ int to_native( SocketOption option )
 		case mart::nw::socks::SocketOption::so_rcvtimeo: return SO_RCVTIMEO; break;
 		case mart::nw::socks::SocketOption::so_sndtimeo: return SO_SNDTIMEO; break;
 		case mart::nw::socks::SocketOption::so_reuseaddr: return SO_REUSEADDR; break;
+#ifdef SO_REUSEPORT
+		case mart::nw::socks::SocketOption::so_reuseport: return SO_REUSEPORT; break;
+#else
+		case mart::nw::socks::SocketOption::so_reuseport: return -1; break;
+#endif
+		case mart::nw::socks::SocketOption::so_rcvbuf: return SO_RCVBUF; break;
+		case mart::nw::socks::SocketOption::so_sndbuf: return SO_SNDBUF; break;
+		case mart::nw::socks::SocketOption::so_error: return SO_ERROR; break;
+#if defined( SO_BUSY_POLL )
+		case mart::nw::socks::SocketOption::so_busy_poll: return SO_BUSY_POLL; break;
+#else
+		case mart::nw::socks::SocketOption::so_busy_poll: return -1; break;
+#endif
+#if defined( SO_PRIORITY )
+		case mart::nw::socks::SocketOption::so_priority: return SO_PRIORITY; break;
+#else
+		case mart::nw::socks::SocketOption::so_priority: return -1; break;
+#endif
+#if defined( SO_TIMESTAMPNS )
+		case mart::nw::socks::SocketOption::so_timestampns: return SO_TIMESTAMPNS; break;
+#else
+		case mart::nw::socks::SocketOption::so_timestampns: return -1; break;
+#endif
+		case mart::nw::socks::SocketOption::tcp_nodelay: return TCP_NODELAY; break;
+#if defined( TCP_QUICKACK )
+		case mart::nw::socks::SocketOption::tcp_quickack: return TCP_QUICKACK; break;
+#else
+		case mart::nw::socks::SocketOption::tcp_quickack: return -1; break;
+#endif
 	}
 	assert( false );
 	return static_cast<int>( option );
@@ -353,6 +390,7 @@ int to_native( SocketOption option )
 
 ErrorCode setsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, const byte_range data ) noexcept
 {
+	if( to_native( optname ) == -1 ) { return ErrorCode{ ErrorCodeValues::InvalidArgument }; }
 	return get_appropriate_error_code( ::setsockopt( to_native( handle ),
 													 to_native( level ),
 													 to_native( optname ),
@@ -362,6 +400,8 @@ ErrorCode setsockopt( handle_t handle, SocketOptionLevel level, SocketOption opt
 
 ErrorCode getsockopt( handle_t handle, SocketOptionLevel level, SocketOption optname, byte_range_mut& data ) noexcept
 {
+	if( to_native( optname ) == -1 ) { return ErrorCode{ ErrorCodeValues::InvalidArgument }; }
+
 	auto len = to_native_addr_len( data.size() );
 
 	const auto ret
@@ -481,6 +521,258 @@ ReturnValue<txrx_size_t> recvfrom( handle_t handle, byte_range_mut buf, int flag
 	return make_return_value( txrx_size_t{ -1 }, ret );
 }
 
+ReturnValue<txrx_size_t> recvfrom_with_timestamp(
+	handle_t handle, byte_range_mut buf, int flags, Sockaddr& from, std::chrono::nanoseconds& timestamp ) noexcept
+{
+	timestamp = std::chrono::nanoseconds{ 0 };
+#if defined( SCM_TIMESTAMPNS ) && !defined( MBA_UTILS_USE_WINSOCKS )
+	::iovec iov{};
+	iov.iov_base = buf.data();
+	iov.iov_len  = buf.size();
+
+	union {
+		char           buffer[CMSG_SPACE( sizeof( ::timespec ) )];
+		::cmsghdr      align;
+	} control{};
+
+	::msghdr hdr{};
+	hdr.msg_iov        = &iov;
+	hdr.msg_iovlen     = 1;
+	hdr.msg_name       = from.to_native_ptr();
+	hdr.msg_namelen    = to_native_addr_len( from.size() );
+	hdr.msg_control    = control.buffer;
+	hdr.msg_controllen = sizeof( control.buffer );
+
+	const auto ret = ::recvmsg( to_native( handle ), &hdr, flags );
+	if( ret < 0 ) { return make_return_value( txrx_size_t{ -1 }, ret ); }
+
+	from.set_valid_data_range( hdr.msg_namelen );
+	for( ::cmsghdr* cmsg = CMSG_FIRSTHDR( &hdr ); cmsg != nullptr; cmsg = CMSG_NXTHDR( &hdr, cmsg ) ) {
+		if( cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS ) {
+			::timespec ts{};
+			std::memcpy( &ts, CMSG_DATA( cmsg ), sizeof( ts ) );
+			timestamp = std::chrono::seconds( ts.tv_sec ) + std::chrono::nanoseconds( ts.tv_nsec );
+		}
+	}
+	return make_return_value( txrx_size_t{ -1 }, ret );
+#else
+	return recvfrom( handle, buf, flags, from );
+#endif
+}
+
+ReturnValue<txrx_size_t>
+sendmsg( handle_t handle, const byte_range* bufs, std::size_t cnt, int flags, const Sockaddr* to ) noexcept
+{
+	if( cnt > max_iov_cnt || ( to && is_invalid_destination_address( *to ) ) ) {
+		return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } };
+	}
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+	::WSABUF wsa_bufs[max_iov_cnt];
+	for( std::size_t i = 0; i < cnt; ++i ) {
+		wsa_bufs[i].buf = const_cast<char*>( bufs[i].char_ptr() );
+		wsa_bufs[i].len = narrow_cast<ULONG>( bufs[i].size() );
+	}
+
+	DWORD     sent = 0;
+	const int ret  = ::WSASendTo( to_native( handle ),
+                                 wsa_bufs,
+                                 narrow_cast<DWORD>( cnt ),
+                                 &sent,
+                                 narrow_cast<DWORD>( flags ),
+                                 to ? to->to_native_ptr() : nullptr,
+                                 to ? to_native_addr_len( to->size() ) : 0,
+                                 nullptr,
+                                 nullptr );
+	if( ret != 0 ) { return ReturnValue<txrx_size_t>( get_last_socket_error() ); }
+	return ReturnValue<txrx_size_t>( narrow_cast<txrx_size_t>( sent ) );
+#else
+	::iovec iovs[max_iov_cnt];
+	for( std::size_t i = 0; i < cnt; ++i ) {
+		iovs[i].iov_base = const_cast<unsigned char*>( bufs[i].data() );
+		iovs[i].iov_len  = bufs[i].size();
+	}
+
+	::msghdr hdr{};
+	hdr.msg_iov    = iovs;
+	hdr.msg_iovlen = cnt;
+	if( to ) {
+		hdr.msg_name    = const_cast<::sockaddr*>( to->to_native_ptr() );
+		hdr.msg_namelen = to_native_addr_len( to->size() );
+	}
+	return make_return_value( txrx_size_t{ -1 }, ::sendmsg( to_native( handle ), &hdr, flags | MSG_NOSIGNAL ) );
+#endif // MBA_UTILS_USE_WINSOCKS
+}
+
+ReturnValue<txrx_size_t>
+recvmsg( handle_t handle, const byte_range_mut* bufs, std::size_t cnt, int flags, Sockaddr* from ) noexcept
+{
+	if( cnt > max_iov_cnt ) { return ReturnValue<txrx_size_t>{ ErrorCode{ ErrorCodeValues::InvalidArgument } }; }
+
+#ifdef MBA_UTILS_USE_WINSOCKS
+	::WSABUF wsa_bufs[max_iov_cnt];
+	for( std::size_t i = 0; i < cnt; ++i ) {
+		wsa_bufs[i].buf = bufs[i].char_ptr();
+		wsa_bufs[i].len = narrow_cast<ULONG>( bufs[i].size() );
+	}
+
+	DWORD         received  = 0;
+	DWORD         wsa_flags = narrow_cast<DWORD>( flags );
+	address_len_t from_len  = from ? to_native_addr_len( from->size() ) : 0;
+	const int     ret       = ::WSARecvFrom( to_native( handle ),
+                                   wsa_bufs,
+                                   narrow_cast<DWORD>( cnt ),
+                                   &received,
+                                   &wsa_flags,
+                                   from ? from->to_native_ptr() : nullptr,
+                                   from ? &from_len : nullptr,
+                                   nullptr,
+                                   nullptr );
+	if( ret != 0 ) { return ReturnValue<txrx_size_t>( get_last_socket_error() ); }
+	if( from ) { from->set_valid_data_range( from_len ); }
+	return ReturnValue<txrx_size_t>( narrow_cast<txrx_size_t>( received ) );
+#else
+	::iovec iovs[max_iov_cnt];
+	for( std::size_t i = 0; i < cnt; ++i ) {
+		iovs[i].iov_base = bufs[i].data();
+		iovs[i].iov_len  = bufs[i].size();
+	}
+
+	::msghdr hdr{};
+	hdr.msg_iov    = iovs;
+	hdr.msg_iovlen = cnt;
+	if( from ) {
+		hdr.msg_name    = from->to_native_ptr();
+		hdr.msg_namelen = to_native_addr_len( from->size() );
+	}
+	const auto ret = ::recvmsg( to_native( handle ), &hdr, flags );
+	if( from && ret >= 0 ) { from->set_valid_data_range( hdr.msg_namelen ); }
+	return make_return_value( txrx_size_t{ -1 }, ret );
+#endif // MBA_UTILS_USE_WINSOCKS
+}
+
+namespace {
+#ifdef MART_NETLIB_PORT_LAYER_HAS_MMSG
+// number of messages that are passed to the kernel per system call (the headers live on the stack)
+constexpr std::size_t mmsg_chunk_size = 32;
+#endif
+} // namespace
+
+ReturnValue<int> sendmmsg( handle_t handle, SendBatchEntry* msgs, std::size_t cnt, int flags ) noexcept
+{
+	std::size_t done = 0;
+#ifdef MART_NETLIB_PORT_LAYER_HAS_MMSG
+	::mmsghdr hdrs[mmsg_chunk_size];
+	::iovec   iovs[mmsg_chunk_size];
+	while( done < cnt ) {
+		const std::size_t n = cnt - done < mmsg_chunk_size ? cnt - done : mmsg_chunk_size;
+
+		// the kernel would stop at an invalid address anyway, but see sendto for why we check it manually
+		std::size_t valid = 0;
+		for( ; valid < n; ++valid ) {
+			const SendBatchEntry& m = msgs[done + valid];
+			if( m.to && is_invalid_destination_address( *m.to ) ) { break; }
+
+			iovs[valid].iov_base = const_cast<unsigned char*>( m.data.data() );
+			iovs[valid].iov_len  = m.data.size();
+			hdrs[valid]          = ::mmsghdr{};
+
+			hdrs[valid].msg_hdr.msg_iov    = &iovs[valid];
+			hdrs[valid].msg_hdr.msg_iovlen = 1;
+			if( m.to ) {
+				hdrs[valid].msg_hdr.msg_name    = const_cast<::sockaddr*>( m.to->to_native_ptr() );
+				hdrs[valid].msg_hdr.msg_namelen = to_native_addr_len( m.to->size() );
+			}
+		}
+		if( valid == 0 ) {
+			if( done == 0 ) { return ReturnValue<int>{ ErrorCode{ ErrorCodeValues::InvalidArgument } }; }
+			break;
+		}
+
+		const int ret = ::sendmmsg( to_native( handle ), hdrs, static_cast<unsigned int>( valid ), flags | MSG_NOSIGNAL );
+		if( ret < 0 ) {
+			if( done == 0 ) { return ReturnValue<int>( get_last_socket_error() ); }
+			break;
+		}
+		for( int i = 0; i < ret; ++i ) {
+			msgs[done + i].sent = narrow_cast<txrx_size_t>( hdrs[i].msg_len );
+		}
+		done += static_cast<std::size_t>( ret );
+		if( static_cast<std::size_t>( ret ) < n ) { break; }
+	}
+#else
+	for( ; done < cnt; ++done ) {
+		SendBatchEntry& m   = msgs[done];
+		const auto      res = m.to ? sendto( handle, m.data, flags, *m.to ) : send( handle, m.data, flags );
+		if( !res ) {
+			if( done == 0 ) { return ReturnValue<int>( res.error_code() ); }
+			break;
+		}
+		m.sent = res.value();
+	}
+#endif
+	return ReturnValue<int>( narrow_cast<int>( done ) );
+}
+
+ReturnValue<int> recvmmsg( handle_t handle, RecvBatchEntry* msgs, std::size_t cnt, int flags, bool dont_wait ) noexcept
+{
+	std::size_t done = 0;
+#ifdef MART_NETLIB_PORT_LAYER_HAS_MMSG
+	::mmsghdr hdrs[mmsg_chunk_size];
+	::iovec   iovs[mmsg_chunk_size];
+	while( done < cnt ) {
+		const std::size_t n = cnt - done < mmsg_chunk_size ? cnt - done : mmsg_chunk_size;
+		for( std::size_t i = 0; i < n; ++i ) {
+			RecvBatchEntry& m = msgs[done + i];
+
+			iovs[i].iov_base = m.buffer.data();
+			iovs[i].iov_len  = m.buffer.size();
+			hdrs[i]          = ::mmsghdr{};
+
+			hdrs[i].msg_hdr.msg_iov    = &iovs[i];
+			hdrs[i].msg_hdr.msg_iovlen = 1;
+			if( m.from ) {
+				hdrs[i].msg_hdr.msg_name    = m.from->to_native_ptr();
+				hdrs[i].msg_hdr.msg_namelen = to_native_addr_len( m.from->size() );
+			}
+		}
+
+		// Only wait for the very first message
+		const int chunk_flags = done == 0 && !dont_wait ? flags | MSG_WAITFORONE : flags | MSG_DONTWAIT;
+		const int ret = ::recvmmsg( to_native( handle ), hdrs, static_cast<unsigned int>( n ), chunk_flags, nullptr );
+		if( ret < 0 ) {
+			if( done == 0 ) { return ReturnValue<int>( get_last_socket_error() ); }
+			break;
+		}
+		for( int i = 0; i < ret; ++i ) {
+			RecvBatchEntry& m = msgs[done + i];
+			m.received        = narrow_cast<txrx_size_t>( hdrs[i].msg_len );
+			if( m.from ) { m.from->set_valid_data_range( hdrs[i].msg_hdr.msg_namelen ); }
+		}
+		done += static_cast<std::size_t>( ret );
+		if( static_cast<std::size_t>( ret ) < n ) { break; }
+	}
+#else
+	for( ; done < cnt; ++done ) {
+		RecvBatchEntry& m = msgs[done];
+#ifdef MSG_DONTWAIT
+		const int msg_flags = done == 0 && !dont_wait ? flags : flags | MSG_DONTWAIT;
+#else
+		// no way to receive without blocking on a blocking socket
+		if( done == 1 || dont_wait ) { break; }
+		const int msg_flags = flags;
+#endif
+		const auto res = m.from ? recvfrom( handle, m.buffer, msg_flags, *m.from ) : recv( handle, m.buffer, msg_flags );
+		if( !res ) {
+			if( done == 0 ) { return ReturnValue<int>( res.error_code() ); }
+			break;
+		}
+		m.received = res.value();
+	}
+#endif
+	return ReturnValue<int>( narrow_cast<int>( done ) );
+}
+
 // implementation details for timeout related functions
 // Todo: move into general utilities
 namespace {
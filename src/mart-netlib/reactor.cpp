@@ -0,0 +1,361 @@
+#include <mart-netlib/reactor.hpp>
+
+/**
+ * reactor.cpp (mart-netlib)
+ *
+ * Copyright (C) 2020: Michael Balszun <michael.balszun@mytum.de>
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See either the LICENSE file in the library's root
+ * directory or http://opensource.org/licenses/MIT for details.
+ *
+ * @author: Michael Balszun <michael.balszun@mytum.de>
+ * @brief:	epoll based implementation of mart::nw::Reactor
+ *
+ */
+
+/* ######## INCLUDES ######### */
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <im_str/im_str.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+/* ~~~~~~~~ INCLUDES ~~~~~~~~~ */
+
+namespace mart::nw {
+
+namespace {
+
+constexpr int max_events_per_wait = 64;
+
+// upper bound for a single epoll_wait, so a blocked thread periodically re-checks its state
+constexpr std::chrono::milliseconds max_epoll_wait = std::chrono::hours( 1 );
+
+mba::im_zstr make_errno_message( std::string_view msg, int error )
+{
+	return mba::concat( msg, " Error Msg: ", std::string_view( std::strerror( error ) ) );
+}
+
+std::uint32_t to_epoll_events( IoEvents interest )
+{
+	std::uint32_t ret = EPOLLONESHOT;
+	if( has_any( interest, IoEvents::Readable ) ) { ret |= EPOLLIN; }
+	if( has_any( interest, IoEvents::Writable ) ) { ret |= EPOLLOUT; }
+	return ret;
+}
+
+IoEvents from_epoll_events( std::uint32_t events )
+{
+	IoEvents ret = IoEvents::None;
+	if( events & EPOLLIN ) { ret = ret | IoEvents::Readable; }
+	if( events & EPOLLOUT ) { ret = ret | IoEvents::Writable; }
+	if( events & EPOLLERR ) { ret = ret | IoEvents::Error; }
+	if( events & ( EPOLLHUP | EPOLLRDHUP ) ) { ret = ret | IoEvents::HangUp; }
+	return ret;
+}
+
+struct Registration {
+	int                 fd;
+	Reactor::IoCallback callback;
+	IoEvents            interest;
+	bool                removed     = false;
+	bool                dispatching = false;
+};
+
+struct Timer {
+	Reactor::TimerCallback callback;
+	Reactor::Clock::duration period;
+};
+
+struct TimerEntry {
+	Reactor::Clock::time_point due;
+	Reactor::TimerId           id;
+
+	friend bool operator>( const TimerEntry& l, const TimerEntry& r ) { return l.due > r.due; }
+};
+
+} // namespace
+
+struct Reactor::Impl {
+	int epoll_fd = -1;
+	int wake_fd  = -1;
+
+	mutable std::mutex                                     mx;
+	std::unordered_map<int, std::shared_ptr<Registration>> registrations;
+
+	std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timer_queue;
+	std::unordered_map<TimerId, std::shared_ptr<Timer>>                                timers;
+	TimerId                                                                            next_timer_id = 1;
+
+	std::atomic<bool> stopped{false};
+
+	void wake() noexcept
+	{
+		const std::uint64_t one = 1;
+		[[maybe_unused]] auto r = ::write( wake_fd, &one, sizeof( one ) );
+	}
+
+	void drain_wake_fd() noexcept
+	{
+		std::uint64_t cnt = 0;
+		[[maybe_unused]] auto r = ::read( wake_fd, &cnt, sizeof( cnt ) );
+	}
+
+	// Executes all due timers and returns how many were executed
+	std::size_t run_due_timers()
+	{
+		std::size_t cnt = 0;
+		while( true ) {
+			std::shared_ptr<Timer> timer;
+			TimerEntry             entry{};
+			{
+				std::lock_guard<std::mutex> lg( mx );
+				if( timer_queue.empty() || timer_queue.top().due > Clock::now() ) { break; }
+				entry = timer_queue.top();
+				timer_queue.pop();
+				auto it = timers.find( entry.id );
+				if( it == timers.end() ) { continue; } // canceled
+				timer = it->second;
+				if( timer->period == Clock::duration::zero() ) { timers.erase( it ); }
+			}
+
+			timer->callback();
+			++cnt;
+
+			if( timer->period != Clock::duration::zero() ) {
+				std::lock_guard<std::mutex> lg( mx );
+				// only reschedule after the callback returned, so a periodic timer never runs concurrently
+				if( timers.count( entry.id ) ) { timer_queue.push( TimerEntry{entry.due + timer->period, entry.id} ); }
+			}
+		}
+		return cnt;
+	}
+
+	std::chrono::milliseconds time_until_next_timer( std::chrono::milliseconds max_wait ) const
+	{
+		std::lock_guard<std::mutex> lg( mx );
+		if( timer_queue.empty() ) { return max_wait; }
+		const auto remaining = timer_queue.top().due - Clock::now();
+		if( remaining <= Clock::duration::zero() ) { return std::chrono::milliseconds( 0 ); }
+		// round up, so we don't wake up before the timer is due
+		return std::min( max_wait, std::chrono::ceil<std::chrono::milliseconds>( remaining ) );
+	}
+
+	bool dispatch( int fd, std::uint32_t events )
+	{
+		std::shared_ptr<Registration> reg;
+		{
+			std::lock_guard<std::mutex> lg( mx );
+			auto                        it = registrations.find( fd );
+			if( it == registrations.end() ) { return false; }
+			reg = it->second;
+			// try_modify can re-arm the handle after epoll disabled it for this event, but before we got here,
+			// so a second thread might receive another event for the same handle. Only one of them may run the
+			// callback. Dropping the other event is fine, because the running dispatch re-arms the handle
+			// afterwards and events are level triggered.
+			if( reg->dispatching ) { return false; }
+			reg->dispatching = true;
+		}
+
+		reg->callback( from_epoll_events( events ) );
+
+		std::lock_guard<std::mutex> lg( mx );
+		reg->dispatching = false;
+		if( !reg->removed ) {
+			// EPOLLONESHOT disabled the handle -> re-arm it
+			::epoll_event ev{};
+			ev.events  = to_epoll_events( reg->interest );
+			ev.data.fd = fd;
+			::epoll_ctl( epoll_fd, EPOLL_CTL_MOD, fd, &ev );
+		}
+		return true;
+	}
+};
+
+Reactor::Reactor()
+	: _impl( std::make_unique<Impl>() )
+{
+	_impl->epoll_fd = ::epoll_create1( EPOLL_CLOEXEC );
+	if( _impl->epoll_fd < 0 ) { throw generic_nw_error( make_errno_message( "Could not create epoll instance.", errno ) ); }
+
+	_impl->wake_fd = ::eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+	if( _impl->wake_fd < 0 ) {
+		const int error = errno;
+		::close( _impl->epoll_fd );
+		throw generic_nw_error( make_errno_message( "Could not create eventfd for reactor.", error ) );
+	}
+
+	// level triggered and not one shot, so a stop request wakes up all threads
+	::epoll_event ev{};
+	ev.events  = EPOLLIN;
+	ev.data.fd = _impl->wake_fd;
+	if( ::epoll_ctl( _impl->epoll_fd, EPOLL_CTL_ADD, _impl->wake_fd, &ev ) != 0 ) {
+		const int error = errno;
+		::close( _impl->wake_fd );
+		::close( _impl->epoll_fd );
+		throw generic_nw_error( make_errno_message( "Could not register eventfd with epoll.", error ) );
+	}
+}
+
+Reactor::~Reactor()
+{
+	::close( _impl->wake_fd );
+	::close( _impl->epoll_fd );
+}
+
+void Reactor::add( handle_t handle, IoEvents interest, IoCallback callback )
+{
+	const auto res = try_add( handle, interest, std::move( callback ) );
+	if( res.raw_value() == EEXIST ) { throw generic_nw_error( "Socket handle is already registered with the reactor." ); }
+	if( !res.success() ) {
+		throw generic_nw_error( make_errno_message( "Could not register socket handle with the reactor.", res.raw_value() ) );
+	}
+}
+
+socks::ErrorCode Reactor::try_add( handle_t handle, IoEvents interest, IoCallback callback ) noexcept
+{
+	const int fd = socks::port_layer::to_native( handle );
+
+	std::lock_guard<std::mutex> lg( _impl->mx );
+	if( _impl->registrations.count( fd ) ) { return socks::ErrorCode{socks::ErrorCodeValues( EEXIST )}; }
+
+	::epoll_event ev{};
+	ev.events  = to_epoll_events( interest );
+	ev.data.fd = fd;
+	if( ::epoll_ctl( _impl->epoll_fd, EPOLL_CTL_ADD, fd, &ev ) != 0 ) {
+		return socks::ErrorCode{socks::ErrorCodeValues( errno )};
+	}
+	_impl->registrations.emplace( fd, std::make_shared<Registration>( Registration{fd, std::move( callback ), interest} ) );
+	return socks::ErrorCode::Ok();
+}
+
+void Reactor::modify( handle_t handle, IoEvents interest )
+{
+	const auto res = try_modify( handle, interest );
+	if( res.raw_value() == ENOENT ) { throw generic_nw_error( "Socket handle is not registered with the reactor." ); }
+	if( !res.success() ) {
+		throw generic_nw_error( make_errno_message( "Could not modify socket handle registration.", res.raw_value() ) );
+	}
+}
+
+socks::ErrorCode Reactor::try_modify( handle_t handle, IoEvents interest ) noexcept
+{
+	const int fd = socks::port_layer::to_native( handle );
+
+	std::lock_guard<std::mutex> lg( _impl->mx );
+	auto                        it = _impl->registrations.find( fd );
+	if( it == _impl->registrations.end() ) { return socks::ErrorCode{socks::ErrorCodeValues( ENOENT )}; }
+
+	auto& reg    = *it->second;
+	reg.interest = interest;
+	// a running callback re-arms the handle with the new interest when it is done
+	if( reg.dispatching ) { return socks::ErrorCode::Ok(); }
+
+	::epoll_event ev{};
+	ev.events  = to_epoll_events( interest );
+	ev.data.fd = fd;
+	if( ::epoll_ctl( _impl->epoll_fd, EPOLL_CTL_MOD, fd, &ev ) != 0 ) {
+		return socks::ErrorCode{socks::ErrorCodeValues( errno )};
+	}
+	return socks::ErrorCode::Ok();
+}
+
+bool Reactor::remove( handle_t handle ) noexcept
+{
+	const int fd = socks::port_layer::to_native( handle );
+
+	std::lock_guard<std::mutex> lg( _impl->mx );
+	auto                        it = _impl->registrations.find( fd );
+	if( it == _impl->registrations.end() ) { return false; }
+
+	it->second->removed = true;
+	_impl->registrations.erase( it );
+	::epoll_ctl( _impl->epoll_fd, EPOLL_CTL_DEL, fd, nullptr );
+	return true;
+}
+
+Reactor::TimerId Reactor::add_timer( Clock::duration delay, TimerCallback callback, Clock::duration period )
+{
+	TimerId id{};
+	{
+		std::lock_guard<std::mutex> lg( _impl->mx );
+		id = _impl->next_timer_id++;
+		_impl->timers.emplace( id, std::make_shared<Timer>( Timer{std::move( callback ), period} ) );
+		_impl->timer_queue.push( TimerEntry{Clock::now() + delay, id} );
+	}
+	// threads that are currently waiting have to recompute their timeout
+	_impl->wake();
+	return id;
+}
+
+bool Reactor::cancel_timer( TimerId id ) noexcept
+{
+	std::lock_guard<std::mutex> lg( _impl->mx );
+	// the entry in the timer queue is skipped when it becomes due
+	return _impl->timers.erase( id ) != 0;
+}
+
+std::size_t Reactor::run_once( std::chrono::milliseconds max_wait )
+{
+	std::size_t cnt = _impl->run_due_timers();
+
+	const auto timeout = cnt != 0 || is_stopped() ? std::chrono::milliseconds( 0 )
+												  : _impl->time_until_next_timer( std::min( max_wait, max_epoll_wait ) );
+
+	std::array<::epoll_event, max_events_per_wait> events{};
+
+	const int n = ::epoll_wait( _impl->epoll_fd, events.data(), max_events_per_wait, static_cast<int>( timeout.count() ) );
+	if( n < 0 ) {
+		if( errno == EINTR ) { return cnt; }
+		throw generic_nw_error( make_errno_message( "Waiting for socket events failed.", errno ) );
+	}
+
+	for( int i = 0; i < n; ++i ) {
+		if( events[i].data.fd == _impl->wake_fd ) {
+			if( !is_stopped() ) { _impl->drain_wake_fd(); }
+			continue;
+		}
+		cnt += _impl->dispatch( events[i].data.fd, events[i].events );
+	}
+
+	return cnt + _impl->run_due_timers();
+}
+
+void Reactor::run()
+{
+	while( !is_stopped() ) {
+		run_once( max_epoll_wait );
+	}
+}
+
+void Reactor::stop() noexcept
+{
+	_impl->stopped = true;
+	_impl->wake();
+}
+
+bool Reactor::is_stopped() const noexcept
+{
+	return _impl->stopped;
+}
+
+std::size_t Reactor::size() const
+{
+	std::lock_guard<std::mutex> lg( _impl->mx );
+	return _impl->registrations.size();
+}
+
+} // namespace mart::nw
@@ -0,0 +1,264 @@
+#include <mart-netlib/tcp_framed_stream.hpp>
+
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <new>
+
+namespace mart::nw::ip::tcp {
+
+namespace {
+
+using mart::nw::socks::ErrorCode;
+using mart::nw::socks::ErrorCodeValues;
+
+bool is_timeout( ErrorCode error ) noexcept
+{
+	const auto v = error.value();
+	return v == ErrorCodeValues::WouldBlock || v == ErrorCodeValues::TryAgain || v == ErrorCodeValues::Timeout;
+}
+
+std::size_t max_size_for_prefix( std::size_t prefix_size ) noexcept
+{
+	return prefix_size >= sizeof( std::size_t ) ? std::numeric_limits<std::size_t>::max()
+												: ( std::size_t{ 1 } << ( 8 * prefix_size ) ) - 1;
+}
+
+// prefix (or delimiter) + payload
+std::size_t overhead( const FramedStreamConfig& cfg ) noexcept
+{
+	return cfg.framing == Framing::LengthPrefix ? cfg.length_prefix_size : 1;
+}
+
+} // namespace
+
+FramedStream::FramedStream( Socket&& socket, const FramedStreamConfig& config )
+	: _socket( std::move( socket ) )
+	, _config( config )
+{
+	if( _config.framing == Framing::LengthPrefix ) {
+		const auto p = _config.length_prefix_size;
+		if( p != 1 && p != 2 && p != 4 && p != 8 ) {
+			throw generic_nw_error( "FramedStream: length_prefix_size has to be 1, 2, 4 or 8" );
+		}
+		_config.max_frame_size = std::min( _config.max_frame_size, max_size_for_prefix( p ) );
+	}
+
+	_rx.resize( std::max( _config.rx_buffer_size, overhead( _config ) + 1 ) );
+	_tx.reserve( _config.tx_buffer_size );
+}
+
+/* ###### read side ###### */
+
+mart::ConstMemoryView FramedStream::_parse_frame( socks::ErrorCode& error ) noexcept
+{
+	const mart::ByteType* const data = _rx.data();
+
+	if( _config.framing == Framing::LengthPrefix ) {
+		const auto p = _config.length_prefix_size;
+		if( _rx_end - _rx_begin < p ) { return {}; }
+
+		std::size_t frame_size = 0;
+		for( std::size_t i = 0; i < p; ++i ) {
+			frame_size = ( frame_size << 8 ) | data[_rx_begin + i];
+		}
+		if( frame_size > _config.max_frame_size ) {
+			error = ErrorCode{ ErrorCodeValues::MessageSize };
+			return {};
+		}
+		if( _rx_end - _rx_begin - p < frame_size ) { return {}; }
+
+		const mart::ConstMemoryView frame( data + _rx_begin + p, frame_size );
+		_rx_begin += p + frame_size;
+		return frame;
+	}
+
+	const auto scan_start = std::max( _rx_scan, _rx_begin );
+	const auto* delim
+		= static_cast<const mart::ByteType*>( std::memchr( data + scan_start, _config.delimiter, _rx_end - scan_start ) );
+	if( delim == nullptr ) {
+		_rx_scan = _rx_end;
+		if( _rx_end - _rx_begin > _config.max_frame_size ) { error = ErrorCode{ ErrorCodeValues::MessageSize }; }
+		return {};
+	}
+
+	const auto                  end = static_cast<std::size_t>( delim - data );
+	const mart::ConstMemoryView frame( data + _rx_begin, end - _rx_begin );
+	_rx_begin = end + 1;
+	_rx_scan  = _rx_begin;
+	return frame;
+}
+
+mart::ConstMemoryView FramedStream::next_buffered_frame() noexcept
+{
+	socks::ErrorCode error = ErrorCode::Ok();
+	return _parse_frame( error );
+}
+
+socks::ErrorCode FramedStream::_make_room_for_rx( std::size_t frame_size ) noexcept
+{
+	const std::size_t buffered = _rx_end - _rx_begin;
+
+	// reclaim consumed space (only the partial frame at the end of the buffer has to be moved)
+	if( buffered == 0 ) {
+		_rx_begin = _rx_end = _rx_scan = 0;
+	} else if( _rx_begin != 0 && ( _rx.size() - _rx_end < _rx.size() / 2 || _rx_begin + frame_size > _rx.size() ) ) {
+		std::memmove( _rx.data(), _rx.data() + _rx_begin, buffered );
+		_rx_scan -= std::min( _rx_scan, _rx_begin );
+		_rx_begin = 0;
+		_rx_end   = buffered;
+	}
+
+	// the buffer has to be able to hold at least a complete frame and one more byte
+	const std::size_t required = std::max( frame_size, buffered ) + 1;
+	if( _rx.size() - _rx_begin < required ) {
+		try {
+			_rx.resize( std::max( _rx.size() * 2, _rx_begin + required ) );
+		} catch( const std::bad_alloc& ) {
+			return ErrorCode{ static_cast<ErrorCodeValues>( ENOMEM ) };
+		}
+	}
+	return ErrorCode::Ok();
+}
+
+FramedStream::ReadResult FramedStream::try_read_frame() noexcept
+{
+	ReadResult ret;
+
+	ret.frame = _parse_frame( ret.error );
+	if( ret.frame.isValid() || !ret.error ) { return ret; }
+
+	// size of the (partial) frame at the front of the buffer, if known
+	std::size_t frame_size = 0;
+	if( _config.framing == Framing::LengthPrefix && buffered_rx_bytes() >= _config.length_prefix_size ) {
+		for( std::size_t i = 0; i < _config.length_prefix_size; ++i ) {
+			frame_size = ( frame_size << 8 ) | _rx[_rx_begin + i];
+		}
+		frame_size += _config.length_prefix_size;
+	}
+
+	ret.error = _make_room_for_rx( frame_size );
+	if( !ret.error ) { return ret; }
+
+	const auto res = _socket.try_recv( mart::MemoryView( _rx.data() + _rx_end, _rx.size() - _rx_end ) );
+	if( !res ) {
+		if( !is_timeout( res.error_code() ) ) { ret.error = res.error_code(); }
+		return ret;
+	}
+	if( res.value() == 0 ) {
+		ret.closed = true;
+		return ret;
+	}
+
+	_rx_end += res.value();
+	ret.frame = _parse_frame( ret.error );
+	return ret;
+}
+
+mart::ConstMemoryView FramedStream::read_frame()
+{
+	const auto res = try_read_frame();
+	if( !res.error ) { throw socket_error( socket_op::recv, res.error ); }
+	return res.frame;
+}
+
+/* ###### write side ###### */
+
+std::size_t FramedStream::_write_prefix( std::size_t frame_size, mart::ByteType* dst ) const noexcept
+{
+	const auto p = _config.length_prefix_size;
+	for( std::size_t i = 0; i < p; ++i ) {
+		dst[p - 1 - i] = static_cast<mart::ByteType>( frame_size >> ( 8 * i ) );
+	}
+	return p;
+}
+
+socks::ErrorCode FramedStream::try_write_frame( mart::ConstMemoryView payload ) noexcept
+{
+	return try_write_frame( mart::ArrayView<const mart::ConstMemoryView>( &payload, 1 ) );
+}
+
+socks::ErrorCode FramedStream::try_write_frame( mart::ArrayView<const mart::ConstMemoryView> payload_parts ) noexcept
+{
+	if( !_tx_error ) { return _tx_error; }
+
+	std::size_t frame_size = 0;
+	for( const auto& part : payload_parts ) {
+		frame_size += part.size();
+		// the receiver would split the frame at the delimiter
+		if( _config.framing == Framing::Delimiter && part.size() != 0
+			&& std::memchr( part.data(), _config.delimiter, part.size() ) != nullptr ) {
+			return ErrorCode{ ErrorCodeValues::InvalidArgument };
+		}
+	}
+	if( frame_size > _config.max_frame_size ) { return ErrorCode{ ErrorCodeValues::MessageSize }; }
+
+	std::array<mart::ByteType, 8> prefix{};
+	const std::size_t             prefix_size
+		= _config.framing == Framing::LengthPrefix ? _write_prefix( frame_size, prefix.data() ) : 0;
+	const std::size_t suffix_size = _config.framing == Framing::Delimiter ? 1 : 0;
+
+	if( _tx.size() + prefix_size + frame_size + suffix_size <= _config.tx_buffer_size ) {
+		// small frame: just collect it (doesn't allocate, because tx_buffer_size was reserved)
+		_tx.insert( _tx.end(), prefix.begin(), prefix.begin() + prefix_size );
+		for( const auto& part : payload_parts ) {
+			_tx.insert( _tx.end(), part.begin(), part.end() );
+		}
+		if( suffix_size ) { _tx.push_back( _config.delimiter ); }
+		return ErrorCode::Ok();
+	}
+
+	// send everything that is buffered together with the new frame in a single gather call
+	if( payload_parts.size() + 3 > socks::port_layer::max_iov_cnt ) {
+		return ErrorCode{ ErrorCodeValues::InvalidArgument };
+	}
+	std::array<mart::ConstMemoryView, socks::port_layer::max_iov_cnt> parts{};
+	std::size_t                                                        cnt = 0;
+
+	parts[cnt++] = mart::ConstMemoryView( _tx.data(), _tx.size() );
+	parts[cnt++] = mart::ConstMemoryView( prefix.data(), prefix_size );
+	for( const auto& part : payload_parts ) {
+		parts[cnt++] = part;
+	}
+	parts[cnt++] = mart::ConstMemoryView( &_config.delimiter, suffix_size );
+
+	const auto res = _socket.try_send_all( mart::ArrayView<const mart::ConstMemoryView>( parts.data(), cnt ) );
+	_tx.clear();
+	_tx_error = res;
+	return res;
+}
+
+void FramedStream::write_frame( mart::ConstMemoryView payload )
+{
+	const auto res = try_write_frame( payload );
+	if( !res ) { throw socket_error( socket_op::send, res ); }
+}
+
+void FramedStream::write_frame( mart::ArrayView<const mart::ConstMemoryView> payload_parts )
+{
+	const auto res = try_write_frame( payload_parts );
+	if( !res ) { throw socket_error( socket_op::send, res ); }
+}
+
+socks::ErrorCode FramedStream::try_flush() noexcept
+{
+	if( _tx.empty() || !_tx_error ) { return _tx_error; }
+
+	const mart::ConstMemoryView data( _tx.data(), _tx.size() );
+	const auto                  res = _socket.try_send_all( mart::ArrayView<const mart::ConstMemoryView>( &data, 1 ) );
+	_tx.clear();
+	_tx_error = res;
+	return res;
+}
+
+void FramedStream::flush()
+{
+	const auto res = try_flush();
+	if( !res ) { throw socket_error( socket_op::send, res ); }
+}
+
+} // namespace mart::nw::ip::tcp
@@ -0,0 +1,128 @@
+#include <mart-netlib/udp_sharded_server.hpp>
+
+#include <mart-netlib/network_exceptions.hpp>
+
+#include <algorithm>
+#include <cerrno>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace mart::nw::ip::udp {
+
+namespace {
+
+void pin_to_core( std::thread& thread, unsigned int core ) noexcept
+{
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO( &set );
+	CPU_SET( core, &set );
+	// pinning is just an optimization - ignore failures (e.g. restricted cpu set in a container)
+	(void)::pthread_setaffinity_np( thread.native_handle(), sizeof( set ), &set );
+#else
+	(void)thread;
+	(void)core;
+#endif
+}
+
+void set_option( Socket& socket, socks::SocketOption option, int value )
+{
+	const auto res = socket.as_raii_socket().setsockopt( socks::SocketOptionLevel::Socket, option, value );
+	if( !res ) { throw socket_error( socket_op::set_option, res ); }
+}
+
+// errors after which receiving can simply be retried
+bool is_transient( socks::ErrorCode error ) noexcept
+{
+	const auto v = error.value();
+	return v == socks::ErrorCodeValues::WouldBlock || v == socks::ErrorCodeValues::TryAgain
+		   || v == socks::ErrorCodeValues::Timeout || error.raw_value() == EINTR;
+}
+
+} // namespace
+
+ShardedServer::ShardedServer( const ShardedServerConfig& config, Handler handler, ErrorHandler error_handler )
+	: _handler( std::move( handler ) )
+	, _error_handler( std::move( error_handler ) )
+	, _ep_local( config.local )
+{
+	const unsigned int core_cnt   = std::max( std::thread::hardware_concurrency(), 1u );
+	const unsigned int shard_cnt  = config.shard_cnt == 0 ? core_cnt : config.shard_cnt;
+	const std::size_t  batch_size = std::max<std::size_t>( config.batch_size, 1 );
+
+	for( unsigned int i = 0; i < shard_cnt; ++i ) {
+		auto shard = std::make_unique<Shard>();
+
+		if( shard_cnt > 1 ) { set_option( shard->socket, socks::SocketOption::so_reuseport, 1 ); }
+		if( config.rx_buffer_size > 0 ) {
+			set_option( shard->socket, socks::SocketOption::so_rcvbuf, config.rx_buffer_size );
+		}
+		shard->socket.set_rx_timeout( config.stop_latency );
+		shard->socket.bind( _ep_local );
+
+		if( _ep_local.port.inHostOrder() == 0 ) {
+			// all other sockets have to bind to the port that was chosen by the os for the first one
+			socks::port_layer::SockaddrIn addr;
+			const auto                    res = shard->socket.as_raii_socket().getsockname( addr );
+			if( !res ) { throw socket_error( socket_op::get_local_address, res ); }
+			_ep_local = endpoint( addr );
+		}
+
+		shard->buffer.resize( batch_size * config.max_datagram_size );
+		for( std::size_t m = 0; m < batch_size; ++m ) {
+			shard->batch.push_back(
+				{ mart::MemoryView( shard->buffer.data() + m * config.max_datagram_size, config.max_datagram_size ),
+				  {},
+				  {} } );
+		}
+		_shards.push_back( std::move( shard ) );
+	}
+
+	try {
+		for( std::size_t i = 0; i < _shards.size(); ++i ) {
+			_shards[i]->thread = std::thread( [this, i] { _receive_loop( i ); } );
+			if( config.pin_threads ) { pin_to_core( _shards[i]->thread, static_cast<unsigned int>( i % core_cnt ) ); }
+		}
+	} catch( ... ) {
+		// the destructor doesn't run, if the constructor throws
+		stop();
+		throw;
+	}
+}
+
+ShardedServer::~ShardedServer()
+{
+	stop();
+}
+
+void ShardedServer::stop() noexcept
+{
+	_stop.store( true, std::memory_order_relaxed );
+	for( auto& shard : _shards ) {
+		if( shard->thread.joinable() ) { shard->thread.join(); }
+	}
+}
+
+void ShardedServer::_receive_loop( std::size_t shard_idx )
+{
+	Shard& shard = *_shards[shard_idx];
+
+	while( !_stop.load( std::memory_order_relaxed ) ) {
+		// blocks until the first datagram arrives or the rx timeout expires
+		const auto res = shard.socket.recv_batch( shard.batch );
+		if( !res ) {
+			if( is_transient( res.error_code() ) ) { continue; }
+			// anything else won't go away by retrying (and would make this loop spin)
+			if( _error_handler ) { _error_handler( shard_idx, res.error_code() ); }
+			return;
+		}
+		if( res.value() == 0 ) { continue; }
+
+		_handler( shard_idx, Batch( shard.batch ).subview( 0, res.value() ) );
+	}
+}
+
+} // namespace mart::nw::ip::udp
@@ -0,0 +1,253 @@
+/*
+ * Latency and throughput benchmark for the logging subsystem
+ *
+ * Usage: benchmark_mart-logging [--iterations=N] [--threads=1,2,4] [--sinks=null,file,stdout] [--format=csv|json]
+ *                               [--out=<file>]
+ *
+ * Every combination of sink, thread count, argument mix and level (enabled / disabled) is run.
+ * Each thread performs N calls of Logger::log and measures the time of every single call.
+ * One line per combination is written to --out (default: stdout, unless the stdout sink is benchmarked,
+ * then logging_benchmark.csv / .json). The stdout sink writes to the real stdout, so redirect it for meaningful results.
+ */
+#include <mart-common/logging/Logger.h>
+#include <mart-common/logging/Sinks.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace mart::log;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class NullSink final : public ILogSink {
+public:
+	mba::im_zstr getName() const override { return mba::im_zstr( "NULL" ); }
+
+private:
+	void _do_writeToLogImpl( std::string_view ) override {}
+	void _do_flush() override {}
+};
+
+enum class ArgMix { String, Ints, Durations, HexDump, Mixed };
+
+constexpr std::array<ArgMix, 5> all_arg_mixes{ArgMix::String, ArgMix::Ints, ArgMix::Durations, ArgMix::HexDump, ArgMix::Mixed};
+
+std::string_view to_string( ArgMix mix )
+{
+	switch( mix ) {
+		case ArgMix::String: return "string";
+		case ArgMix::Ints: return "ints";
+		case ArgMix::Durations: return "durations";
+		case ArgMix::HexDump: return "hexdump";
+		case ArgMix::Mixed: return "mixed";
+	}
+	return "";
+}
+
+const std::array<std::uint8_t, 32> hex_data{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+											0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15,
+											0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+
+void log_once( Logger& logger, Level lvl, ArgMix mix, int i )
+{
+	using namespace std::chrono_literals;
+	switch( mix ) {
+		case ArgMix::String: logger.log( lvl, "Connection to ", std::string_view( "server.example.com" ), " established" ); break;
+		case ArgMix::Ints: logger.log( lvl, "Values: ", i, " ", i * 3, " ", -i ); break;
+		case ArgMix::Durations: logger.log( lvl, "Elapsed: ", std::chrono::milliseconds( i ), " / ", 250us ); break;
+		case ArgMix::HexDump: logger.log( lvl, "Packet: ", mart::ConstMemoryView( hex_data.data(), hex_data.size() ) ); break;
+		case ArgMix::Mixed:
+			logger.log( lvl, "Request ", i, " to ", std::string_view( "/index.html" ), " took ", std::chrono::microseconds( i ), " ", 0.25 );
+			break;
+	}
+}
+
+struct Config {
+	int                      iterations = 100000;
+	std::vector<int>         threads    = {1, 2, 4};
+	std::vector<std::string> sinks      = {"null", "file", "stdout"};
+	std::string              format     = "csv";
+	std::string              out;
+};
+
+struct Result {
+	std::string_view sink;
+	int              threads;
+	ArgMix           mix;
+	bool             enabled;
+	std::size_t      calls;
+	std::int64_t     p50_ns;
+	std::int64_t     p99_ns;
+	std::int64_t     p999_ns;
+	std::int64_t     max_ns;
+	double           msgs_per_sec;
+};
+
+std::shared_ptr<ILogSink> make_sink( std::string_view name )
+{
+	if( name == "null" ) { return std::make_shared<NullSink>(); }
+	if( name == "file" ) { return makeSink( FileLogConfig_t{mba::im_zstr( "benchmark_logging.log" ), Level::TRACE} ); }
+	if( name == "stdout" ) { return makeSink( StdOutLogConfig_t{Level::TRACE} ); }
+	return nullptr;
+}
+
+Result run( std::string_view sinkName, const std::shared_ptr<ILogSink>& sink, int threadCnt, ArgMix mix, bool enabled, int iterations )
+{
+	// the level of the logger is STATUS, so DEBUG messages are filtered out by the level check
+	const Level lvl = enabled ? Level::STATUS : Level::DEBUG;
+
+	Logger                                 logger( "bench", sink, Level::STATUS );
+	std::vector<std::vector<std::int64_t>> samples( threadCnt, std::vector<std::int64_t>( iterations ) );
+	std::vector<std::thread>               threads;
+
+	const auto start = Clock::now();
+	for( int t = 0; t < threadCnt; ++t ) {
+		threads.emplace_back( [&, t] {
+			Logger local = logger; // Logger instances must not be shared between threads
+			auto&  times = samples[t];
+			for( int i = 0; i < iterations; ++i ) {
+				const auto s = Clock::now();
+				log_once( local, lvl, mix, i );
+				times[i] = std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - s ).count();
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	const auto duration = Clock::now() - start;
+	sink->flush();
+
+	std::vector<std::int64_t> all;
+	all.reserve( static_cast<std::size_t>( threadCnt ) * iterations );
+	for( const auto& s : samples ) {
+		all.insert( all.end(), s.begin(), s.end() );
+	}
+	std::sort( all.begin(), all.end() );
+
+	const auto percentile = [&]( double p ) {
+		const auto idx = static_cast<std::size_t>( p * static_cast<double>( all.size() - 1 ) );
+		return all[idx];
+	};
+	const double secs = std::chrono::duration<double>( duration ).count();
+
+	return Result{sinkName,
+				  threadCnt,
+				  mix,
+				  enabled,
+				  all.size(),
+				  percentile( 0.5 ),
+				  percentile( 0.99 ),
+				  percentile( 0.999 ),
+				  all.back(),
+				  static_cast<double>( all.size() ) / secs};
+}
+
+void write_header( std::ostream& out, const Config& cfg )
+{
+	if( cfg.format == "csv" ) {
+		out << "sink,threads,args,level,calls,p50_ns,p99_ns,p999_ns,max_ns,msgs_per_sec\n";
+	}
+}
+
+void write_result( std::ostream& out, const Config& cfg, const Result& r )
+{
+	const char* level = r.enabled ? "enabled" : "disabled";
+	if( cfg.format == "json" ) {
+		out << R"({"sink":")" << r.sink << R"(","threads":)" << r.threads << R"(,"args":")" << to_string( r.mix )
+			<< R"(","level":")" << level << R"(","calls":)" << r.calls << R"(,"p50_ns":)" << r.p50_ns
+			<< R"(,"p99_ns":)" << r.p99_ns << R"(,"p999_ns":)" << r.p999_ns << R"(,"max_ns":)" << r.max_ns
+			<< R"(,"msgs_per_sec":)" << static_cast<std::int64_t>( r.msgs_per_sec ) << "}\n";
+	} else {
+		out << r.sink << ',' << r.threads << ',' << to_string( r.mix ) << ',' << level << ',' << r.calls << ','
+			<< r.p50_ns << ',' << r.p99_ns << ',' << r.p999_ns << ',' << r.max_ns << ','
+			<< static_cast<std::int64_t>( r.msgs_per_sec ) << '\n';
+	}
+	out.flush();
+}
+
+template<class F>
+void for_each_item( std::string_view list, F&& f )
+{
+	while( !list.empty() ) {
+		const auto pos = list.find( ',' );
+		f( list.substr( 0, pos ) );
+		list = pos == std::string_view::npos ? std::string_view{} : list.substr( pos + 1 );
+	}
+}
+
+bool parse_args( int argc, char** argv, Config& cfg )
+{
+	for( int i = 1; i < argc; ++i ) {
+		const std::string_view arg( argv[i] );
+		const auto             pos = arg.find( '=' );
+		if( pos == std::string_view::npos ) { return false; }
+		const auto key   = arg.substr( 0, pos );
+		const auto value = arg.substr( pos + 1 );
+
+		if( key == "--iterations" ) {
+			cfg.iterations = std::stoi( std::string( value ) );
+		} else if( key == "--threads" ) {
+			cfg.threads.clear();
+			for_each_item( value, [&]( std::string_view v ) { cfg.threads.push_back( std::stoi( std::string( v ) ) ); } );
+		} else if( key == "--sinks" ) {
+			cfg.sinks.clear();
+			for_each_item( value, [&]( std::string_view v ) { cfg.sinks.emplace_back( v ); } );
+		} else if( key == "--format" ) {
+			cfg.format = std::string( value );
+		} else if( key == "--out" ) {
+			cfg.out = std::string( value );
+		} else {
+			return false;
+		}
+	}
+	return cfg.iterations > 0 && ( cfg.format == "csv" || cfg.format == "json" );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	Config cfg;
+	if( !parse_args( argc, argv, cfg ) ) {
+		std::cerr << "Usage: " << argv[0]
+				  << " [--iterations=N] [--threads=1,2,4] [--sinks=null,file,stdout] [--format=csv|json] [--out=<file>]\n";
+		return 1;
+	}
+
+	const bool uses_stdout = std::find( cfg.sinks.begin(), cfg.sinks.end(), "stdout" ) != cfg.sinks.end();
+	if( cfg.out.empty() && uses_stdout ) { cfg.out = "logging_benchmark." + cfg.format; }
+
+	std::ofstream file;
+	if( !cfg.out.empty() ) { file.open( cfg.out ); }
+	std::ostream& out = cfg.out.empty() ? std::cout : file;
+
+	write_header( out, cfg );
+	for( const auto& sinkName : cfg.sinks ) {
+		auto sink = make_sink( sinkName );
+		if( !sink ) {
+			std::cerr << "Unknown sink: " << sinkName << '\n';
+			return 1;
+		}
+		for( int threads : cfg.threads ) {
+			for( ArgMix mix : all_arg_mixes ) {
+				for( bool enabled : {true, false} ) {
+					write_result( out, cfg, run( sinkName, sink, threads, mix, enabled, cfg.iterations ) );
+				}
+			}
+		}
+	}
+	std::remove( "benchmark_logging.log" );
+}
@@ -0,0 +1,49 @@
+#ifndef LIB_MART_COMMON_GUARD_TESTS_LOG_MEMORY_SINK_H
+#define LIB_MART_COMMON_GUARD_TESTS_LOG_MEMORY_SINK_H
+
+#include <mart-common/logging/ILogSink.h>
+
+#include <im_str/im_str.hpp>
+
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace mart_test {
+
+// Sink that stores everything written to it in a string
+class MemorySink final : public mart::log::ILogSink {
+public:
+	std::string content() const
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		return _content;
+	}
+	int flush_count() const
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		return _flushes;
+	}
+
+	mba::im_zstr getName() const override { return mba::im_zstr( "MEM" ); }
+
+private:
+	mutable std::mutex _mx;
+	std::string        _content;
+	int                _flushes = 0;
+
+	void _do_writeToLogImpl( std::string_view msg ) override
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		_content.append( msg );
+	}
+	void _do_flush() override
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		++_flushes;
+	}
+};
+
+} // namespace mart_test
+
+#endif
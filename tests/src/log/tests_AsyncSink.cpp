@@ -0,0 +1,212 @@
+#include <mart-common/logging/AsyncSink.h>
+
+#include "memory_sink.h"
+
+#include <mart-common/logging/Logger.h>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mart::log;
+
+namespace {
+
+// sink that blocks the writing thread until it gets opened
+class GateSink final : public ILogSink {
+public:
+	void open()
+	{
+		{
+			std::lock_guard<std::mutex> lg( _mx );
+			_open = true;
+		}
+		_cv.notify_all();
+	}
+	std::string content()
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		return _content;
+	}
+	mba::im_zstr getName() const override { return mba::im_zstr( "GATE" ); }
+
+private:
+	std::mutex              _mx;
+	std::condition_variable _cv;
+	bool                    _open = false;
+	std::string             _content;
+
+	void _do_writeToLogImpl( std::string_view msg ) override
+	{
+		std::unique_lock<std::mutex> ul( _mx );
+		_cv.wait( ul, [this] { return _open; } );
+		_content.append( msg );
+	}
+	void _do_flush() override {}
+};
+
+// sink that takes a while for each write and only counts the lines
+class SlowSink final : public ILogSink {
+public:
+	std::size_t lines()
+	{
+		std::lock_guard<std::mutex> lg( _mx );
+		return _lines;
+	}
+	mba::im_zstr getName() const override { return mba::im_zstr( "SLOW" ); }
+
+private:
+	std::mutex  _mx;
+	std::size_t _lines = 0;
+
+	void _do_writeToLogImpl( std::string_view msg ) override
+	{
+		std::this_thread::sleep_for( std::chrono::microseconds( 20 ) );
+		std::lock_guard<std::mutex> lg( _mx );
+		_lines += static_cast<std::size_t>( std::count( msg.begin(), msg.end(), '\n' ) );
+	}
+	void _do_flush() override {}
+};
+
+} // namespace
+
+TEST_CASE( "AsyncSink_forwards_messages_to_targets", "[log][AsyncSink]" )
+{
+	auto mem1 = std::make_shared<mart_test::MemorySink>();
+	auto mem2 = std::make_shared<mart_test::MemorySink>();
+	mem2->maxlvl = Level::STATUS;
+
+	auto sink = makeSink( AsyncSinkConfig_t{{mem1, mem2}} );
+	CHECK( sink->getName() == "Async(MEM,MEM)" );
+
+	sink->writeToLog( "Hello\n", Level::STATUS );
+	sink->writeToLog( "World\n", Level::DEBUG );
+	sink->writeToLog( "!\n", Level::ERROR );
+	sink->flush();
+
+	CHECK( mem1->content() == "Hello\nWorld\n!\n" );
+	CHECK( mem2->content() == "Hello\n!\n" );
+	CHECK( mem1->flush_count() > 0 );
+}
+
+TEST_CASE( "AsyncSink_writes_pending_messages_on_destruction", "[log][AsyncSink]" )
+{
+	auto mem = std::make_shared<mart_test::MemorySink>();
+	{
+		Logger logger( "async", makeSink( AsyncSinkConfig_t{{mem}} ), Level::TRACE );
+		for( int i = 0; i < 100; ++i ) {
+			logger.log( Level::DEBUG, "Msg ", i );
+		}
+	}
+	const auto content = mem->content();
+	CHECK( std::count( content.begin(), content.end(), '\n' ) == 100 );
+	CHECK( content.find( "Msg 99\n" ) != std::string::npos );
+}
+
+TEST_CASE( "AsyncSink_counts_and_reports_dropped_messages", "[log][AsyncSink]" )
+{
+	auto gate = std::make_shared<GateSink>();
+
+	AsyncSinkConfig_t cfg{{gate}};
+	cfg.perThreadBufferSize = 256;
+	cfg.overflowPolicy      = OverflowPolicy::CountAndDrop;
+	cfg.drainInterval       = std::chrono::milliseconds( 1 );
+	auto sink               = std::make_shared<AsyncSink>( cfg );
+
+	// the first message blocks the drain thread inside the target
+	sink->writeToLog( "first\n", Level::STATUS );
+	while( sink->droppedMessageCount() == 0 ) {
+		sink->writeToLog( "0123456789012345678901234567890123456789\n", Level::STATUS );
+	}
+	const auto dropped = sink->droppedMessageCount();
+	gate->open();
+	sink->flush();
+
+	CHECK( dropped > 0 );
+	CHECK( gate->content().find( "[AsyncSink] Dropped " ) != std::string::npos );
+}
+
+TEST_CASE( "AsyncSink_blocking_policy_doesnt_lose_messages", "[log][AsyncSink]" )
+{
+	constexpr int thread_cnt = 4;
+	constexpr int msg_cnt    = 2000;
+
+	auto mem = std::make_shared<mart_test::MemorySink>();
+
+	AsyncSinkConfig_t cfg{{mem}};
+	cfg.perThreadBufferSize = 512;
+	cfg.overflowPolicy      = OverflowPolicy::Block;
+	auto sink               = std::make_shared<AsyncSink>( cfg );
+
+	std::vector<std::thread> threads;
+	for( int t = 0; t < thread_cnt; ++t ) {
+		threads.emplace_back( [&, t] {
+			const std::string msg = "Thread " + std::to_string( t ) + '\n';
+			for( int i = 0; i < msg_cnt; ++i ) {
+				sink->writeToLog( msg, Level::DEBUG );
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	sink->flush();
+
+	const auto content = mem->content();
+	CHECK( sink->droppedMessageCount() == 0 );
+	CHECK( std::count( content.begin(), content.end(), '\n' ) == thread_cnt * msg_cnt );
+}
+
+TEST_CASE( "AsyncSink_blocked_producer_wakes_up_the_drain_thread", "[log][AsyncSink]" )
+{
+	constexpr int msg_cnt = 1000;
+
+	auto mem = std::make_shared<mart_test::MemorySink>();
+
+	AsyncSinkConfig_t cfg{{mem}};
+	cfg.perThreadBufferSize = 512;
+	cfg.overflowPolicy      = OverflowPolicy::Block;
+	cfg.drainInterval       = std::chrono::seconds( 30 );
+	auto sink               = std::make_shared<AsyncSink>( cfg );
+
+	// without waking up the drain thread, each full buffer would stall the producer for a whole drain interval
+	const auto start = std::chrono::steady_clock::now();
+	for( int i = 0; i < msg_cnt; ++i ) {
+		sink->writeToLog( "Some message that fills the buffer\n", Level::DEBUG );
+	}
+	CHECK( std::chrono::steady_clock::now() - start < std::chrono::seconds( 5 ) );
+
+	sink->flush();
+	const auto content = mem->content();
+	CHECK( std::count( content.begin(), content.end(), '\n' ) == msg_cnt );
+}
+
+TEST_CASE( "AsyncSink_blocked_producers_are_not_lost_with_a_slow_sink", "[log][AsyncSink]" )
+{
+	constexpr int msg_cnt = 5000;
+
+	auto slow = std::make_shared<SlowSink>();
+
+	AsyncSinkConfig_t cfg{{slow}};
+	cfg.perThreadBufferSize = 128;
+	cfg.overflowPolicy      = OverflowPolicy::Block;
+	// a lost wakeup isn't hidden by the periodic drain
+	cfg.drainInterval = std::chrono::seconds( 3600 );
+	auto sink         = std::make_shared<AsyncSink>( cfg );
+
+	// The producer blocks over and over again, at random points of a drain pass: Alternating levels make the
+	// drain thread write each message separately (and slowly), while it pops the buffer
+	for( int i = 0; i < msg_cnt; ++i ) {
+		sink->writeToLog( "msg\n", i % 2 ? Level::DEBUG : Level::STATUS );
+	}
+	sink->flush();
+
+	CHECK( sink->droppedMessageCount() == 0 );
+	CHECK( slow->lines() == std::size_t{msg_cnt} );
+}
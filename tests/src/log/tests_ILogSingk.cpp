@@ -1 +1,112 @@
-#include <mart-common/logging/ILogSink.h>
\ No newline at end of file
+#include <mart-common/logging/ILogSink.h>
+
+#include <catch2/catch.hpp>
+
+#include <im_str/im_str.hpp>
+
+#include <atomic>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Records all messages and detects concurrent calls of the implementation functions
+class CheckingSink final : public mart::log::ILogSink {
+public:
+	using ILogSink::ILogSink;
+
+	std::vector<std::string> messages;
+	int                      flushes               = 0;
+	bool                     concurrent_call_found = false;
+
+	mba::im_zstr getName() const override { return mba::im_zstr( "CHECK" ); }
+
+private:
+	std::atomic<int> _active{0};
+
+	struct CallGuard {
+		CheckingSink* sink;
+		explicit CallGuard( CheckingSink* s )
+			: sink( s )
+		{
+			if( sink->_active.fetch_add( 1 ) != 0 ) { sink->concurrent_call_found = true; }
+		}
+		~CallGuard() { sink->_active.fetch_sub( 1 ); }
+	};
+
+	void _do_writeToLogImpl( std::string_view msg ) override
+	{
+		CallGuard _( this );
+		messages.emplace_back( msg );
+	}
+	void _do_flush() override
+	{
+		CallGuard _( this );
+		++flushes;
+	}
+};
+
+} // namespace
+
+TEST_CASE( "ILogSink_lock_free_mode_writes_all_messages_from_one_thread_at_a_time", "[log][ILogSink]" )
+{
+	constexpr int thread_cnt      = 8;
+	constexpr int msgs_per_thread = 5000;
+
+	CheckingSink sink;
+	// small queue, so the full queue case is exercised too
+	sink.setThreadSafety( mart::log::ThreadSafety::LockFree, 16 );
+	CHECK( sink.isInThreadSafeMode() );
+
+	std::vector<std::thread> threads;
+	for( int t = 0; t < thread_cnt; ++t ) {
+		threads.emplace_back( [&, t] {
+			for( int i = 0; i < msgs_per_thread; ++i ) {
+				sink.writeToLog( std::to_string( t ) + ' ' + std::to_string( i ), mart::log::Level::DEBUG );
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	sink.flush();
+
+	CHECK( !sink.concurrent_call_found );
+	REQUIRE( sink.messages.size() == static_cast<std::size_t>( thread_cnt * msgs_per_thread ) );
+
+	// messages from the same thread keep their order
+	std::map<int, int> next;
+	for( const auto& m : sink.messages ) {
+		std::istringstream ss( m );
+		int                t = 0;
+		int                i = 0;
+		ss >> t >> i;
+		CHECK( i == next[t]++ );
+	}
+}
+
+TEST_CASE( "ILogSink_lock_free_mode_preserves_flush_and_level_semantics", "[log][ILogSink]" )
+{
+	CheckingSink sink( mart::log::Level::STATUS );
+	sink.setThreadSafety( mart::log::ThreadSafety::LockFree );
+
+	sink.writeToLog( "debug", mart::log::Level::DEBUG );
+	CHECK( sink.messages.empty() );
+
+	sink.writeToLog( "status", mart::log::Level::STATUS );
+	REQUIRE( sink.messages.size() == 1 );
+	CHECK( sink.messages[0] == "status" );
+	// STATUS and ERROR messages still flush the sink
+	CHECK( sink.flushes == 1 );
+
+	sink.flush();
+	CHECK( sink.flushes == 2 );
+
+	sink.setThreadSafety( mart::log::ThreadSafety::None );
+	CHECK( !sink.isInThreadSafeMode() );
+	sink.writeToLog( "error", mart::log::Level::ERROR );
+	CHECK( sink.messages.size() == 2 );
+}
@@ -1 +1,127 @@
-#include <mart-common/logging/Logger.h>
\ No newline at end of file
+#include <mart-common/logging/Logger.h>
+
+#include "memory_sink.h"
+
+#include <mart-common/logging/AsyncSink.h>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+using namespace mart::log;
+
+namespace {
+
+// removes the time stamp (" - At     12ms - ") from all lines
+std::string strip_time( std::string str )
+{
+	std::string::size_type pos = 0;
+	while( ( pos = str.find( " - At ", pos ) ) != std::string::npos ) {
+		const auto end = str.find( "ms - ", pos );
+		str.erase( pos, end + 5 - pos );
+		++pos;
+	}
+	return str;
+}
+
+template<class... ARGS>
+void log_both_ways( Logger& logger, ARGS... args )
+{
+	logger.log( Level::STATUS, args... );
+	MART_LOG_DEFERRED( logger, Level::STATUS, args... );
+}
+
+void log_deferred_and_immediate( Logger& logger )
+{
+	const std::string str = "std::string";
+	const char*       ptr = "char ptr";
+
+	log_both_ways( logger, "Hello World" );
+	log_both_ways( logger, "Int: ", 5, " Double: ", 3.25, " Char: ", 'c', " Bool: ", true );
+	log_both_ways( logger, std::chrono::milliseconds( 10 ), ' ', std::chrono::seconds( 3 ), ' ', str, ' ', ptr );
+	log_both_ways( logger, -1ll, 42u, 1e-20f, "", Level::DEBUG );
+	log_both_ways( logger );
+}
+
+void check_pairs_are_equal( const std::string& content )
+{
+	std::string::size_type pos = 0;
+	int                    cnt = 0;
+	while( pos < content.size() ) {
+		const auto end1 = content.find( '\n', pos );
+		const auto end2 = content.find( '\n', end1 + 1 );
+		REQUIRE( end2 != std::string::npos );
+		CHECK( content.substr( pos, end1 - pos ) == content.substr( end1 + 1, end2 - end1 - 1 ) );
+		pos = end2 + 1;
+		++cnt;
+	}
+	CHECK( cnt == 5 );
+}
+
+} // namespace
+
+TEST_CASE( "Logger_deferred_logging_produces_same_output_as_immediate_logging", "[log][Logger]" )
+{
+	auto mem = std::make_shared<mart_test::MemorySink>();
+
+	Logger logger( "deferred", mem, Level::STATUS );
+	log_deferred_and_immediate( logger );
+
+	check_pairs_are_equal( strip_time( mem->content() ) );
+}
+
+TEST_CASE( "Logger_deferred_logging_through_AsyncSink_produces_same_output", "[log][Logger]" )
+{
+	auto mem  = std::make_shared<mart_test::MemorySink>();
+	auto sink = makeSink( AsyncSinkConfig_t{{mem}} );
+
+	Logger logger( "deferred_async", sink, Level::TRACE );
+	logger.bumpIndentLevel();
+	log_deferred_and_immediate( logger );
+	sink->flush();
+
+	const auto content = strip_time( mem->content() );
+	CHECK( content.find( "[ThreadID: " ) != std::string::npos );
+	check_pairs_are_equal( content );
+}
+
+TEST_CASE( "Logger_deferred_logging_respects_log_level", "[log][Logger]" )
+{
+	auto   mem = std::make_shared<mart_test::MemorySink>();
+	Logger logger( "deferred", mem, Level::STATUS );
+
+	MART_LOG_DEFERRED( logger, Level::DEBUG, "Not logged" );
+	MART_LOG_ERROR_DEFERRED( logger, "Logged" );
+
+	CHECK( mem->content().find( "Not logged" ) == std::string::npos );
+	CHECK( mem->content().find( "Logged" ) != std::string::npos );
+}
+
+TEST_CASE( "Logger_deferred_logging_copies_the_content_of_memory_views", "[log][Logger]" )
+{
+	std::uint8_t                data[4] = {0xde, 0xad, 0xbe, 0xef};
+	const mart::ConstMemoryView mem( data, sizeof( data ) );
+
+	mart::log::LogSite site{Level::STATUS, __FILE__, __LINE__};
+
+	std::array<mart::ByteType, 256> record{};
+	const auto                      size = detail::deferredRecordSize( "deferred", mem );
+	REQUIRE( size <= record.size() );
+	detail::DeferredRecordHeader header{};
+	header.site = &site;
+	detail::encodeDeferredRecord( record.data(), header, "deferred", mem );
+
+	LogBuffer expected;
+	formatForLog( expected, mem );
+
+	// the record must not refer to the original data
+	data[0] = 0;
+	data[3] = 0;
+
+	LogBuffer text;
+	detail::formatDeferredRecord( text, mart::ConstMemoryView( record.data(), size ) );
+	CHECK( text.view().find( expected.view() ) != std::string_view::npos );
+}
@@ -0,0 +1,175 @@
+#if __has_include( <sys/mman.h> )
+
+#include <mart-common/logging/MMapFileLog.h>
+
+#include <mart-common/logging/Logger.h>
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string read_file( const std::string& name )
+{
+	std::ifstream file( name, std::ios::binary );
+	return std::string( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+}
+
+bool file_exists( const std::string& name )
+{
+	return std::ifstream( name ).good();
+}
+
+std::string segment_name( const mart::log::MMapFileLogConfig_t& cfg, std::uint64_t index )
+{
+	return std::string( cfg.fileName.c_str() ) + '.' + std::to_string( index );
+}
+
+void remove_segments( const mart::log::MMapFileLogConfig_t& cfg, std::uint64_t count )
+{
+	for( std::uint64_t i = 0; i < count; ++i ) {
+		std::remove( segment_name( cfg, i ).c_str() );
+	}
+}
+
+} // namespace
+
+TEST_CASE( "MMapFileLog_writes_messages_to_file", "[log][MMapFileLog]" )
+{
+	mart::log::MMapFileLogConfig_t cfg;
+	cfg.fileName    = mba::im_zstr( "mart_test_mmap_simple.log" );
+	cfg.segmentSize = 64 * 1024;
+
+	const std::string segment = segment_name( cfg, 0 );
+	{
+		mart::log::MMapFileLog sink( cfg );
+		CHECK( sink.segmentFileName( 0 ) == segment );
+
+		sink.writeToLog( "Hello\n", mart::log::Level::STATUS );
+		sink.writeToLog( "World\n", mart::log::Level::TRACE );
+		sink.flush();
+
+		// visible before the sink is closed (remaining part of the segment is zero filled)
+		const auto content = read_file( segment );
+		CHECK( content.size() == cfg.segmentSize );
+		CHECK( content.compare( 0, 12, "Hello\nWorld\n" ) == 0 );
+		CHECK( content[12] == '\0' );
+	}
+	// file is truncated to the actual content on close
+	CHECK( read_file( segment ) == "Hello\nWorld\n" );
+	std::remove( segment.c_str() );
+}
+
+TEST_CASE( "MMapFileLog_rotates_segments", "[log][MMapFileLog]" )
+{
+	constexpr int thread_cnt      = 4;
+	constexpr int msgs_per_thread = 2000;
+
+	mart::log::MMapFileLogConfig_t cfg;
+	cfg.fileName    = mba::im_zstr( "mart_test_mmap_rotate.log" );
+	cfg.segmentSize = 4096;
+
+	std::uint64_t segment_cnt = 0;
+	std::string   content;
+	{
+		auto sink = std::make_shared<mart::log::MMapFileLog>( cfg );
+
+		std::vector<std::thread> threads;
+		for( int t = 0; t < thread_cnt; ++t ) {
+			threads.emplace_back( [&, t] {
+				mart::log::Logger logger( "T" + std::to_string( t ), sink, mart::log::Level::STATUS );
+				for( int i = 0; i < msgs_per_thread; ++i ) {
+					logger.log( mart::log::Level::STATUS, "Msg ", i );
+				}
+			} );
+		}
+		for( auto& t : threads ) {
+			t.join();
+		}
+		segment_cnt = sink->currentSegmentIndex() + 1;
+		CHECK( segment_cnt > 1 );
+		CHECK( sink->droppedMessageCount() == 0 );
+
+		sink.reset();
+
+		// every segment ends with a complete line
+		for( std::uint64_t i = 0; i < segment_cnt; ++i ) {
+			const auto segment = read_file( segment_name( cfg, i ) );
+			REQUIRE( !segment.empty() );
+			CHECK( segment.size() <= cfg.segmentSize );
+			CHECK( segment.back() == '\n' );
+			content += segment;
+		}
+	}
+
+	// every message is contained exactly once and messages from the same thread keep their order
+	std::map<std::string, int> next_msg;
+	std::istringstream         lines( content );
+	std::string                line;
+	int                        line_cnt = 0;
+	while( std::getline( lines, line ) ) {
+		++line_cnt;
+		const auto name_start = line.find( '[' );
+		const auto name_end   = line.find( ']' );
+		const auto msg_start  = line.find( "Msg " );
+		REQUIRE( name_start != std::string::npos );
+		REQUIRE( msg_start != std::string::npos );
+		const auto name = line.substr( name_start, name_end - name_start );
+		CHECK( std::stoi( line.substr( msg_start + 4 ) ) == next_msg[name]++ );
+	}
+	CHECK( line_cnt == thread_cnt * msgs_per_thread );
+
+	remove_segments( cfg, segment_cnt );
+}
+
+TEST_CASE( "MMapFileLog_deletes_old_segments", "[log][MMapFileLog]" )
+{
+	mart::log::MMapFileLogConfig_t cfg;
+	cfg.fileName    = mba::im_zstr( "mart_test_mmap_max.log" );
+	cfg.segmentSize = 4096;
+	cfg.maxSegments = 2;
+
+	const std::string line = std::string( 1023, 'x' ) + '\n';
+	{
+		mart::log::MMapFileLog sink( cfg );
+		while( sink.currentSegmentIndex() < 4 ) {
+			sink.writeToLog( line, mart::log::Level::STATUS );
+		}
+
+		CHECK( !file_exists( segment_name( cfg, 0 ) ) );
+		CHECK( !file_exists( segment_name( cfg, 1 ) ) );
+		CHECK( !file_exists( segment_name( cfg, 2 ) ) );
+		CHECK( read_file( segment_name( cfg, 3 ) ) == line + line + line + line );
+		CHECK( file_exists( segment_name( cfg, 4 ) ) );
+	}
+	remove_segments( cfg, 5 );
+}
+
+TEST_CASE( "MMapFileLog_accepts_messages_bigger_than_a_segment", "[log][MMapFileLog]" )
+{
+	mart::log::MMapFileLogConfig_t cfg;
+	cfg.fileName    = mba::im_zstr( "mart_test_mmap_big.log" );
+	cfg.segmentSize = 4096;
+
+	const std::string big( 10000, 'b' );
+	{
+		mart::log::MMapFileLog sink( cfg );
+		sink.writeToLog( "small\n", mart::log::Level::STATUS );
+		sink.writeToLog( big, mart::log::Level::STATUS );
+		sink.writeToLog( "small\n", mart::log::Level::STATUS );
+	}
+	CHECK( read_file( segment_name( cfg, 0 ) ) == "small\n" );
+	CHECK( read_file( segment_name( cfg, 1 ) ) == big );
+	CHECK( read_file( segment_name( cfg, 2 ) ) == "small\n" );
+	remove_segments( cfg, 3 );
+}
+
+#endif
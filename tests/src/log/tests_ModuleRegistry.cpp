@@ -0,0 +1,72 @@
+#include <mart-common/logging/ModuleRegistry.h>
+
+#include <mart-common/logging/Logger.h>
+
+#include "memory_sink.h"
+
+#include <catch2/catch.hpp>
+
+using namespace mart::log;
+
+TEST_CASE( "ModuleRegistry_resolves_names_to_stable_ids", "[log][ModuleRegistry]" )
+{
+	auto& registry = ModuleRegistry::instance();
+
+	const auto id = registry.resolve( "[mr_test_a]", Level::DEBUG );
+	CHECK( id != ModuleRegistry::overflow_id );
+	CHECK( registry.resolve( "[mr_test_a]", Level::ERROR ) == id );
+	CHECK( registry.find( "[mr_test_a]" ) == id );
+	CHECK( !registry.find( "[mr_test_unknown]" ) );
+
+	// an existing module keeps its level
+	CHECK( registry.getLevel( id ) == Level::DEBUG );
+	registry.setLevel( id, Level::TRACE );
+	CHECK( registry.levelSlot( id ).load() == Level::TRACE );
+}
+
+TEST_CASE( "ModuleRegistry_level_changes_are_visible_in_all_copies", "[log][ModuleRegistry]" )
+{
+	auto   sink = std::make_shared<mart_test::MemorySink>();
+	Logger logger( "mr_copies", sink, Level::STATUS );
+	Logger copy = logger;
+	Logger same_name( "mr_copies", Level::STATUS );
+
+	CHECK( logger.getModuleId() == copy.getModuleId() );
+	CHECK( logger.getModuleId() == same_name.getModuleId() );
+
+	copy.log( Level::DEBUG, "hidden" );
+	CHECK( sink->content().empty() );
+
+	ModuleRegistry::instance().setLevel( logger.getModuleId(), Level::DEBUG );
+	CHECK( same_name.getLogLevel() == Level::DEBUG );
+	copy.log( Level::DEBUG, "visible" );
+	CHECK( sink->content().find( "visible" ) != std::string::npos );
+
+	// creating another logger for the module doesn't reset the level that has been configured
+	Logger late( "mr_copies", Level::ERROR );
+	CHECK( late.getLogLevel() == Level::DEBUG );
+	CHECK( logger.getLogLevel() == Level::DEBUG );
+}
+
+TEST_CASE( "ModuleRegistry_subtree_level_applies_to_children_only", "[log][ModuleRegistry]" )
+{
+	Logger parent( "mr_tree", Level::STATUS );
+	Logger child      = parent.make_child( "child" );
+	Logger grandchild = child.make_child( "grandchild" );
+	Logger sibling( "mr_tree2", Level::STATUS );
+
+	// children inherit the level of the parent on creation
+	CHECK( child.getLogLevel() == Level::STATUS );
+	CHECK( child.getModuleId() != parent.getModuleId() );
+
+	child.setSubtreeLogLevel( Level::TRACE );
+	CHECK( parent.getLogLevel() == Level::STATUS );
+	CHECK( child.getLogLevel() == Level::TRACE );
+	CHECK( grandchild.getLogLevel() == Level::TRACE );
+
+	parent.setSubtreeLogLevel( Level::ERROR );
+	CHECK( parent.getLogLevel() == Level::ERROR );
+	CHECK( child.getLogLevel() == Level::ERROR );
+	CHECK( grandchild.getLogLevel() == Level::ERROR );
+	CHECK( sibling.getLogLevel() == Level::STATUS );
+}
@@ -0,0 +1,150 @@
+#include <mart-common/logging/RateLimit.h>
+
+#include <mart-common/logging/Logger.h>
+
+#include "memory_sink.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+using namespace mart::log;
+
+namespace {
+
+int count_occurrences( const std::string& str, const std::string& pattern )
+{
+	int                    cnt = 0;
+	std::string::size_type pos = 0;
+	while( ( pos = str.find( pattern, pos ) ) != std::string::npos ) {
+		++cnt;
+		pos += pattern.size();
+	}
+	return cnt;
+}
+
+} // namespace
+
+TEST_CASE( "RateLimit_every_n_passes_every_nth_message", "[log][RateLimit]" )
+{
+	EveryNLimiter limiter( 3 );
+
+	int passed = 0;
+	for( int i = 0; i < 10; ++i ) {
+		const auto res = limiter.check();
+		CHECK( res.pass == ( i % 3 == 0 ) );
+		if( res.pass ) {
+			// messages suppressed since the last one are reported along with the next one that gets through
+			CHECK( res.suppressed == ( i == 0 ? 0u : 2u ) );
+			++passed;
+		}
+	}
+	CHECK( passed == 4 );
+}
+
+TEST_CASE( "RateLimit_first_n_reports_suppressed_messages_periodically", "[log][RateLimit]" )
+{
+	using namespace std::chrono_literals;
+
+	FirstNLimiter limiter( 2, 0ns );
+	CHECK( limiter.check().pass );
+	CHECK( limiter.check().pass );
+
+	// first suppressed message starts the summary interval
+	auto res = limiter.check();
+	CHECK( !res.pass );
+	CHECK( res.suppressed == 0 );
+
+	res = limiter.check();
+	CHECK( !res.pass );
+	CHECK( res.suppressed == 2 );
+
+	FirstNLimiter slow_limiter( 1, 1h );
+	CHECK( slow_limiter.check().pass );
+	for( int i = 0; i < 100; ++i ) {
+		res = slow_limiter.check();
+		CHECK( !res.pass );
+		CHECK( res.suppressed == 0 );
+	}
+}
+
+TEST_CASE( "RateLimit_token_bucket_limits_burst", "[log][RateLimit]" )
+{
+	// one token per hour -> only the burst gets through during the test
+	TokenBucketLimiter limiter( 1.0 / 3600, 3 );
+
+	int passed = 0;
+	for( int i = 0; i < 100; ++i ) {
+		passed += limiter.check().pass;
+	}
+	CHECK( passed == 3 );
+
+	// high rate -> everything gets through
+	TokenBucketLimiter fast_limiter( 1e12, 1 );
+	passed = 0;
+	for( int i = 0; i < 100; ++i ) {
+		passed += fast_limiter.check().pass;
+	}
+	CHECK( passed == 100 );
+}
+
+TEST_CASE( "RateLimit_token_bucket_clamps_invalid_parameters", "[log][RateLimit]" )
+{
+	// rates that are not positive only let through the burst
+	for( const double rate : {0.0, -5.0, std::numeric_limits<double>::quiet_NaN(), 1e-30} ) {
+		for( const std::uint32_t burst : {0u, 1u, 4u, std::numeric_limits<std::uint32_t>::max()} ) {
+			TokenBucketLimiter limiter( rate, burst );
+			int                passed = 0;
+			for( int i = 0; i < 10; ++i ) {
+				passed += limiter.check().pass;
+			}
+			CHECK( passed == static_cast<int>( std::clamp<std::uint32_t>( burst, 1, 10 ) ) );
+		}
+	}
+}
+
+TEST_CASE( "RateLimit_macros_limit_messages_per_call_site", "[log][RateLimit]" )
+{
+	auto   sink = std::make_shared<mart_test::MemorySink>();
+	Logger logger( "rl", sink, Level::STATUS );
+
+	for( int i = 0; i < 10; ++i ) {
+		MART_LOG_ERROR_EVERY_N( logger, 5, "every_n ", i );
+		MART_LOG_STATUS_FIRST_N( logger, 3, "first_n ", i );
+		MART_LOG_ERROR_RATE_LIMITED( logger, 1.0 / 3600, 2, "rate_limited ", i );
+	}
+
+	const auto content = sink->content();
+	CHECK( count_occurrences( content, "every_n " ) == 2 );
+	CHECK( count_occurrences( content, "every_n 5\n" ) == 1 );
+	CHECK( count_occurrences( content, "first_n " ) == 3 );
+	CHECK( count_occurrences( content, "first_n 2\n" ) == 1 );
+	CHECK( count_occurrences( content, "rate_limited " ) == 2 );
+	CHECK( count_occurrences( content, "Suppressed 4 messages from " __FILE__ ":" ) == 1 );
+}
+
+TEST_CASE( "RateLimit_state_is_not_touched_for_disabled_levels", "[log][RateLimit]" )
+{
+	auto   sink = std::make_shared<mart_test::MemorySink>();
+	Logger logger( "rl_disabled", sink, Level::ERROR );
+
+	const auto log_first_two = [&]( int i ) { MART_LOG_STATUS_FIRST_N( logger, 2, "msg ", i ); };
+
+	for( int i = 0; i < 5; ++i ) {
+		log_first_two( i );
+	}
+	CHECK( sink->content().empty() );
+
+	logger.setLogLevel( Level::STATUS );
+	for( int i = 5; i < 10; ++i ) {
+		log_first_two( i );
+	}
+	const auto content = sink->content();
+	CHECK( count_occurrences( content, "msg 5\n" ) == 1 );
+	CHECK( count_occurrences( content, "msg 6\n" ) == 1 );
+	CHECK( count_occurrences( content, "msg " ) == 2 );
+}
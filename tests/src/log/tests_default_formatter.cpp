@@ -1 +1,168 @@
-#include <mart-common/logging/default_formatter.h>
\ No newline at end of file
+#include <mart-common/logging/default_formatter.h>
+
+#include <mart-common/logging/Logger.h>
+#include <mart-common/logging/buffer_formatter.h>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+
+/*##### Allocation counting (only active for the thread that enabled it) #####*/
+
+namespace {
+thread_local bool        count_allocations = false;
+thread_local std::size_t allocation_count  = 0;
+
+void* counting_alloc( std::size_t size )
+{
+	if( count_allocations ) { ++allocation_count; }
+	if( void* p = std::malloc( size == 0 ? 1 : size ) ) { return p; }
+	throw std::bad_alloc{};
+}
+} // namespace
+
+void* operator new( std::size_t size )
+{
+	return counting_alloc( size );
+}
+void* operator new[]( std::size_t size )
+{
+	return counting_alloc( size );
+}
+void operator delete( void* p ) noexcept
+{
+	std::free( p );
+}
+void operator delete[]( void* p ) noexcept
+{
+	std::free( p );
+}
+void operator delete( void* p, std::size_t ) noexcept
+{
+	std::free( p );
+}
+void operator delete[]( void* p, std::size_t ) noexcept
+{
+	std::free( p );
+}
+
+namespace {
+
+struct Point {
+	int x;
+	int y;
+};
+
+// only has an ostream formatter
+std::ostream& operator<<( std::ostream& out, const Point& p )
+{
+	return out << "P{" << p.x << ',' << p.y << '}';
+}
+
+class NullSink final : public mart::log::ILogSink {
+public:
+	std::size_t bytes = 0;
+
+	mba::im_zstr getName() const override { return mba::im_zstr( "NULL" ); }
+
+private:
+	void _do_writeToLogImpl( std::string_view msg ) override { bytes += msg.size(); }
+	void _do_flush() override {}
+};
+
+template<class... ARGS>
+std::string format_with_stream( const ARGS&... args )
+{
+	std::ostringstream ss;
+	mart::log::formatForLog( ss, args... );
+	return ss.str();
+}
+
+template<class... ARGS>
+std::string format_with_buffer( const ARGS&... args )
+{
+	mart::log::LogBuffer buffer;
+	mart::log::formatForLog( buffer, args... );
+	return std::string( buffer.view() );
+}
+
+} // namespace
+
+TEST_CASE( "LogBuffer_produces_same_output_as_ostream", "[log][formatter]" )
+{
+	using namespace std::chrono_literals;
+
+	const unsigned char bytes[] = "abcdefghijklmnopqrstuvwxyz";
+
+	CHECK( format_with_buffer( 0, -5, 42u, -2147483648ll, 18446744073709551615ull )
+		   == format_with_stream( 0, -5, 42u, -2147483648ll, 18446744073709551615ull ) );
+	CHECK( format_with_buffer( 'a', (signed char)-3, (unsigned char)200, true, false )
+		   == format_with_stream( 'a', (signed char)-3, (unsigned char)200, true, false ) );
+	CHECK( format_with_buffer( 0.1, 1.23456789e8, 1e300, -0.0, 1.0f / 3.0f, 100.0 )
+		   == format_with_stream( 0.1, 1.23456789e8, 1e300, -0.0, 1.0f / 3.0f, 100.0 ) );
+	CHECK( format_with_buffer( "lit", std::string_view( "sv" ), std::string( "str" ), mba::im_str( "im" ) )
+		   == format_with_stream( "lit", std::string_view( "sv" ), std::string( "str" ), mba::im_str( "im" ) ) );
+	CHECK( format_with_buffer( 5ns, -6us, 7ms, 8s, 9min, 10h ) == format_with_stream( 5ns, -6us, 7ms, 8s, 9min, 10h ) );
+	CHECK( format_with_buffer( std::chrono::system_clock::time_point( 1234567890123456us ) )
+		   == format_with_stream( std::chrono::system_clock::time_point( 1234567890123456us ) ) );
+	CHECK( format_with_buffer( std::chrono::steady_clock::time_point( 12ms ) )
+		   == format_with_stream( std::chrono::steady_clock::time_point( 12ms ) ) );
+	CHECK( format_with_buffer( std::this_thread::get_id() ) == format_with_stream( std::this_thread::get_id() ) );
+	CHECK( format_with_buffer( mart::ConstMemoryView( bytes, 3 ) )
+		   == format_with_stream( mart::ConstMemoryView( bytes, 3 ) ) );
+	CHECK( format_with_buffer( mart::ConstMemoryView( bytes, 26 ) )
+		   == format_with_stream( mart::ConstMemoryView( bytes, 26 ) ) );
+	CHECK( format_with_buffer( Point{1, 2}, " ", Point{3, 4} ) == format_with_stream( Point{1, 2}, " ", Point{3, 4} ) );
+
+	// manipulators affect the remaining arguments of the same message
+	CHECK( format_with_buffer( std::hex, 255, " ", std::setw( 4 ), 10, "|", 3.5 ) == "ff a   |3.5" );
+}
+
+TEST_CASE( "LogBuffer_resets_stream_state_on_clear", "[log][formatter]" )
+{
+	mart::log::LogBuffer buffer;
+	mart::log::formatForLog( buffer, std::hex, 255 );
+	CHECK( buffer.view() == "ff" );
+	buffer.clear();
+	CHECK( buffer.empty() );
+	mart::log::formatForLog( buffer, 255 );
+	CHECK( buffer.view() == "255" );
+}
+
+TEST_CASE( "Logger_does_not_allocate_in_steady_state", "[log][formatter]" )
+{
+	using namespace std::chrono_literals;
+
+	auto sink = std::make_shared<NullSink>();
+
+	mart::log::Logger logger( "alloc", sink, mart::log::Level::TRACE );
+
+	const std::string str          = "a std::string argument";
+	const auto        log_messages = [&] {
+		logger.log( mart::log::Level::STATUS, "Hello World" );
+		logger.log( mart::log::Level::DEBUG, "Int: ", 42, " Double: ", 3.1415, " Duration: ", 500ms );
+		logger.log( mart::log::Level::TRACE, str, ' ', -7ll, ' ', true, ' ', mart::log::Level::ERROR );
+		logger.log( mart::log::Level::ERROR, "Point: ", Point{1, 2}, std::hex, " hex: ", 255 );
+		MART_LOG_DEFERRED( logger, mart::log::Level::STATUS, "deferred ", 5, " ", 2.5 );
+	};
+
+	// first messages may allocate (thread local buffers, cached thread id)
+	log_messages();
+	log_messages();
+
+	count_allocations = true;
+	allocation_count  = 0;
+	for( int i = 0; i < 100; ++i ) {
+		log_messages();
+	}
+	count_allocations = false;
+
+	CHECK( allocation_count == 0 );
+	CHECK( sink->bytes > 0 );
+}
@@ -0,0 +1,132 @@
+#include <mart-common/logging/structured.h>
+
+#include <mart-common/logging/Logger.h>
+
+#include "memory_sink.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mart::log;
+using namespace std::chrono_literals;
+
+namespace {
+
+enum class Color { Red, Green };
+
+constexpr std::string_view mart_to_string_v_impl( Color c )
+{
+	return c == Color::Red ? "Red" : "Green";
+}
+
+// Stores the structured records written to it
+class RecordSink final : public ILogSink {
+public:
+	std::vector<std::vector<mart::ByteType>> records;
+	std::string                              text;
+
+	mba::im_zstr getName() const override { return mba::im_zstr( "RECORD" ); }
+
+private:
+	bool _do_writeStructuredToLog( mart::ConstMemoryView record, Level ) override
+	{
+		records.emplace_back( record.begin(), record.end() );
+		return true;
+	}
+	void _do_writeToLogImpl( std::string_view msg ) override { text.append( msg ); }
+	void _do_flush() override {}
+};
+
+} // namespace
+
+TEST_CASE( "structured_record_roundtrip", "[log][structured]" )
+{
+	auto   sink = std::make_shared<RecordSink>();
+	Logger logger( "st", sink, Level::STATUS );
+
+	const std::string path = "/index.html";
+	logger.log_structured( Level::STATUS,
+						   "request",
+						   field( "id", 42 ),
+						   field( "bytes", 7u ),
+						   field( "ratio", 0.5 ),
+						   field( "ok", true ),
+						   field( "duration", 3ms ),
+						   field( "path", path ),
+						   field( "color", Color::Green ) );
+	logger.log_structured( Level::DEBUG, "disabled", field( "id", 1 ) );
+
+	CHECK( sink->text.empty() );
+	REQUIRE( sink->records.size() == 1 );
+
+	const auto&            raw = sink->records[0];
+	StructuredRecordReader reader( mart::ConstMemoryView( raw.data(), raw.size() ) );
+	REQUIRE( reader.isValid() );
+	CHECK( reader.size() == raw.size() );
+	CHECK( reader.level() == Level::STATUS );
+	CHECK( reader.kind() == RecordKind::Structured );
+	CHECK( reader.name() == "[st]" );
+	CHECK( reader.message() == "request" );
+	CHECK( reader.fieldCount() == 7 );
+	CHECK( reader.timestamp() > 0 );
+
+	std::vector<std::string> keys;
+	const bool               ok = reader.forEachField( [&]( std::string_view key, FieldType type, const FieldValue& v ) {
+        keys.emplace_back( key );
+        if( key == "id" ) {
+            CHECK( type == FieldType::Int );
+            CHECK( v.i == 42 );
+        } else if( key == "bytes" ) {
+            CHECK( type == FieldType::UInt );
+            CHECK( v.u == 7 );
+        } else if( key == "ratio" ) {
+            CHECK( type == FieldType::Float );
+            CHECK( v.f == 0.5 );
+        } else if( key == "ok" ) {
+            CHECK( type == FieldType::Bool );
+            CHECK( v.b );
+        } else if( key == "duration" ) {
+            CHECK( type == FieldType::Duration );
+            CHECK( v.d == 3ms );
+        } else if( key == "path" ) {
+            CHECK( type == FieldType::String );
+            CHECK( v.s == path );
+        } else if( key == "color" ) {
+            CHECK( type == FieldType::String );
+            CHECK( v.s == "Green" );
+        }
+    } );
+	CHECK( ok );
+	CHECK( keys == std::vector<std::string>{"id", "bytes", "ratio", "ok", "duration", "path", "color"} );
+
+	// truncated records are detected
+	StructuredRecordReader truncated( mart::ConstMemoryView( raw.data(), raw.size() - 1 ) );
+	CHECK( !truncated.isValid() );
+
+	// as are sizes that don't even cover the header or the strings
+	for( const std::uint16_t size : {std::uint16_t{0}, std::uint16_t{5}, std::uint16_t{structured_record_header_size + 1}} ) {
+		auto corrupted = raw;
+		std::memcpy( corrupted.data(), &size, sizeof( size ) );
+		StructuredRecordReader r( mart::ConstMemoryView( corrupted.data(), corrupted.size() ) );
+		CHECK( !r.isValid() );
+		CHECK( !r.forEachField( []( auto&&... ) {} ) );
+	}
+}
+
+TEST_CASE( "structured_record_is_formatted_for_text_sinks", "[log][structured]" )
+{
+	auto   sink = std::make_shared<mart_test::MemorySink>();
+	Logger logger( "st", sink, Level::STATUS );
+
+	logger.log_structured(
+		Level::STATUS, "request", field( "id", 42 ), field( "ok", false ), field( "color", Color::Red ) );
+
+	const auto content = sink->content();
+	CHECK( content.find( "[st]" ) != std::string::npos );
+	CHECK( content.find( "request id=42 ok=false color=Red\n" ) != std::string::npos );
+}
@@ -0,0 +1,65 @@
+#include <mart-common/mt/MpscQueue.h>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE( "MpscQueue_returns_elements_in_fifo_order", "[mt][MpscQueue]" )
+{
+	mart::mt::MpscQueue<std::string> queue( 3 );
+	CHECK( queue.capacity() == 4 );
+
+	for( int i = 0; i < 4; ++i ) {
+		CHECK( queue.try_push( [&]( std::string& s ) { s = std::to_string( i ); } ) );
+	}
+	CHECK( !queue.try_push( []( std::string& ) { FAIL( "must not be called if the queue is full" ); } ) );
+	CHECK( queue.push_count() == 4 );
+
+	for( int i = 0; i < 4; ++i ) {
+		std::string value;
+		CHECK( queue.try_pop( [&]( std::string& s ) { value = s; } ) );
+		CHECK( value == std::to_string( i ) );
+	}
+	CHECK( !queue.try_pop( []( std::string& ) {} ) );
+	CHECK( queue.pop_count() == 4 );
+}
+
+TEST_CASE( "MpscQueue_transfers_all_elements_from_multiple_producers", "[mt][MpscQueue]" )
+{
+	constexpr int producer_cnt = 4;
+	constexpr int elements     = 5000;
+
+	mart::mt::MpscQueue<int> queue( 256 );
+
+	std::vector<std::thread> producers;
+	for( int p = 0; p < producer_cnt; ++p ) {
+		producers.emplace_back( [&, p] {
+			for( int i = 0; i < elements; ++i ) {
+				while( !queue.try_push( [&]( int& e ) { e = p * elements + i; } ) ) {
+					std::this_thread::yield();
+				}
+			}
+		} );
+	}
+
+	std::vector<int> last( producer_cnt, -1 );
+	int              received = 0;
+	bool             in_order = true;
+	while( received < producer_cnt * elements ) {
+		const bool popped = queue.try_pop( [&]( int& e ) {
+			const int p = e / elements;
+			const int i = e % elements;
+			in_order &= i == last[p] + 1;
+			last[p] = i;
+			++received;
+		} );
+		if( !popped ) { std::this_thread::yield(); }
+	}
+	for( auto& p : producers ) {
+		p.join();
+	}
+	CHECK( in_order );
+	CHECK( !queue.try_pop( []( int& ) {} ) );
+}
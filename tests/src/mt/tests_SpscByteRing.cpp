@@ -0,0 +1,108 @@
+#include <mart-common/mt/SpscByteRing.h>
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+bool push( mart::mt::SpscByteRing& ring, std::string_view str )
+{
+	return ring.try_push( mart::ConstMemoryView( reinterpret_cast<const mart::ByteType*>( str.data() ), str.size() ) );
+}
+
+std::string pop( mart::mt::SpscByteRing& ring )
+{
+	auto rec = ring.front();
+	if( rec.data() == nullptr ) { return "<empty>"; }
+	std::string ret( rec.asConstCharPtr(), rec.size() );
+	ring.pop();
+	return ret;
+}
+
+} // namespace
+
+TEST_CASE( "SpscByteRing_returns_records_in_fifo_order", "[mt][SpscByteRing]" )
+{
+	mart::mt::SpscByteRing ring( 256 );
+	CHECK( ring.empty() );
+	CHECK( push( ring, "Hello" ) );
+	CHECK( push( ring, "" ) );
+	CHECK( push( ring, "World!" ) );
+	CHECK( !ring.empty() );
+
+	CHECK( pop( ring ) == "Hello" );
+	CHECK( pop( ring ) == "" );
+	CHECK( pop( ring ) == "World!" );
+	CHECK( ring.empty() );
+	CHECK( pop( ring ) == "<empty>" );
+}
+
+TEST_CASE( "SpscByteRing_rejects_records_if_full", "[mt][SpscByteRing]" )
+{
+	mart::mt::SpscByteRing ring( 64 );
+	REQUIRE( ring.capacity() == 64 );
+
+	const std::string too_big( ring.max_record_size() + 1, 'x' );
+	CHECK( !push( ring, too_big ) );
+
+	// header(8) + payload(24) = 32 bytes per record
+	const std::string rec( 20, 'a' );
+	CHECK( push( ring, rec ) );
+	CHECK( push( ring, rec ) );
+	CHECK( !push( ring, rec ) );
+
+	CHECK( pop( ring ) == rec );
+	CHECK( push( ring, rec ) );
+}
+
+TEST_CASE( "SpscByteRing_wraps_around", "[mt][SpscByteRing]" )
+{
+	mart::mt::SpscByteRing ring( 128 );
+	for( int i = 0; i < 1000; ++i ) {
+		const std::string msg( static_cast<std::size_t>( i % 37 ), static_cast<char>( 'a' + i % 26 ) );
+		REQUIRE( push( ring, msg ) );
+		if( i % 2 == 0 ) { REQUIRE( push( ring, "x" ) ); }
+		CHECK( pop( ring ) == msg );
+		if( i % 2 == 0 ) { CHECK( pop( ring ) == "x" ); }
+	}
+	CHECK( ring.empty() );
+}
+
+TEST_CASE( "SpscByteRing_transfers_all_records_between_threads", "[mt][SpscByteRing]" )
+{
+	constexpr int          cnt = 100'000;
+	mart::mt::SpscByteRing ring( 1024 );
+
+	std::thread producer( [&] {
+		for( int i = 0; i < cnt; ++i ) {
+			auto mem = ring.try_reserve( sizeof( i ) + static_cast<std::size_t>( i % 13 ) );
+			while( mem.data() == nullptr ) {
+				std::this_thread::yield();
+				mem = ring.try_reserve( sizeof( i ) + static_cast<std::size_t>( i % 13 ) );
+			}
+			std::memcpy( mem.data(), &i, sizeof( i ) );
+			ring.commit();
+		}
+	} );
+
+	bool in_order = true;
+	for( int i = 0; i < cnt; ) {
+		auto rec = ring.front();
+		if( rec.data() == nullptr ) {
+			std::this_thread::yield();
+			continue;
+		}
+		int v = -1;
+		std::memcpy( &v, rec.data(), sizeof( v ) );
+		in_order = in_order && v == i && rec.size() == sizeof( i ) + static_cast<std::size_t>( i % 13 );
+		ring.pop();
+		++i;
+	}
+	producer.join();
+	CHECK( in_order );
+	CHECK( ring.empty() );
+}
@@ -0,0 +1,656 @@
+/*
+ * Throughput and latency benchmark for mart-netlib sockets over loopback (udp, tcp) and unix domain sockets
+ *
+ * Usage: benchmark_mart-netlib [--iterations=N] [--sizes=16,256,1400] [--threads=1,2] [--batch=1,32]
+ *                              [--transports=udp,tcp,unix] [--modes=throughput,rtt] [--format=csv|json]
+ *                              [--out=<file>]
+ *
+ * throughput: Each of --threads sender threads sends N messages to its own receiver thread as fast as possible.
+ *             Datagrams that are dropped by the kernel are reported as lost.
+ *             With --batch > 1, datagram sockets use send_batch / recv_batch and tcp sockets send --batch
+ *             messages with a single gather call.
+ * rtt:        Each of --threads client threads sends N messages to its own echo thread and waits for the reply
+ *             before sending the next one. The round trip time of every message is measured (--batch is ignored).
+ *
+ * Every result also contains the number of socket calls issued by the benchmark per message (both sides)
+ * and the cpu time and context switches of the whole process during the run (getrusage, not on windows).
+ * unix domain sockets are only available if the library was built with MART_NETLIB_BUILD_UNIX_DOMAIN_SOCKET.
+ */
+#include <mart-netlib/network_exceptions.hpp>
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+#ifdef MART_NETLIB_BENCHMARK_UNIX_DOMAIN_SOCKETS
+#include <mart-netlib/unix.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <sys/resource.h>
+#define MART_NETLIB_BENCHMARK_HAS_RUSAGE
+#endif
+
+using namespace mart::nw;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Mode { Throughput, Rtt };
+
+std::string_view to_string( Mode mode )
+{
+	return mode == Mode::Throughput ? "throughput" : "rtt";
+}
+
+struct Config {
+	int                      iterations = 20000;
+	std::vector<std::size_t> sizes      = {16, 256, 1400};
+	std::vector<int>         threads    = {1, 2};
+	std::vector<std::size_t> batches    = {1, 32};
+#ifdef MART_NETLIB_BENCHMARK_UNIX_DOMAIN_SOCKETS
+	std::vector<std::string> transports = {"udp", "tcp", "unix"};
+#else
+	std::vector<std::string> transports = {"udp", "tcp"};
+#endif
+	std::vector<Mode> modes  = {Mode::Throughput, Mode::Rtt};
+	std::string       format = "csv";
+	std::string       out;
+};
+
+struct Params {
+	std::string_view transport;
+	Mode             mode;
+	std::size_t      size;
+	int              threads;
+	std::size_t      batch;
+	int              iterations;
+};
+
+// collected separately by each thread pair
+struct PairStats {
+	std::size_t               received = 0; // messages (throughput) or completed round trips (rtt)
+	std::size_t               calls    = 0; // socket calls issued by both threads
+	Clock::time_point         last_rx{};
+	std::vector<std::int64_t> rtts_ns;
+};
+
+struct Usage {
+	double user_ms      = 0;
+	double sys_ms       = 0;
+	long   vol_switches = 0;
+	long   inv_switches = 0;
+};
+
+Usage get_usage()
+{
+	Usage u;
+#ifdef MART_NETLIB_BENCHMARK_HAS_RUSAGE
+	::rusage ru{};
+	::getrusage( RUSAGE_SELF, &ru );
+	u.user_ms      = static_cast<double>( ru.ru_utime.tv_sec ) * 1e3 + static_cast<double>( ru.ru_utime.tv_usec ) / 1e3;
+	u.sys_ms       = static_cast<double>( ru.ru_stime.tv_sec ) * 1e3 + static_cast<double>( ru.ru_stime.tv_usec ) / 1e3;
+	u.vol_switches = ru.ru_nvcsw;
+	u.inv_switches = ru.ru_nivcsw;
+#endif
+	return u;
+}
+
+Usage operator-( const Usage& l, const Usage& r )
+{
+	return {l.user_ms - r.user_ms, l.sys_ms - r.sys_ms, l.vol_switches - r.vol_switches, l.inv_switches - r.inv_switches};
+}
+
+struct Result {
+	Params       params;
+	std::size_t  sent;
+	std::size_t  received;
+	double       msgs_per_sec;
+	double       mbytes_per_sec;
+	std::int64_t rtt_p50_ns;
+	std::int64_t rtt_p99_ns;
+	std::int64_t rtt_p999_ns;
+	std::int64_t rtt_max_ns;
+	double       calls_per_msg;
+	Usage        usage;
+};
+
+Result make_result( const Params& p, std::vector<PairStats>& stats, Clock::time_point start, Clock::time_point end, Usage usage )
+{
+	Result r{};
+	r.params = p;
+	r.sent   = static_cast<std::size_t>( p.iterations ) * static_cast<std::size_t>( p.threads );
+	r.usage  = usage;
+
+	std::size_t               calls = 0;
+	std::vector<std::int64_t> rtts;
+	for( auto& s : stats ) {
+		r.received += s.received;
+		calls += s.calls;
+		rtts.insert( rtts.end(), s.rtts_ns.begin(), s.rtts_ns.end() );
+		// don't include the time receivers spent waiting for lost datagrams
+		if( p.mode == Mode::Throughput && s.received > 0 ) { end = std::max( end, s.last_rx ); }
+	}
+
+	const double secs = std::chrono::duration<double>( end - start ).count();
+	r.msgs_per_sec    = secs > 0 ? static_cast<double>( r.received ) / secs : 0;
+	r.mbytes_per_sec  = r.msgs_per_sec * static_cast<double>( p.size ) / 1e6;
+	r.calls_per_msg   = r.received > 0 ? static_cast<double>( calls ) / static_cast<double>( r.received ) : 0;
+
+	if( !rtts.empty() ) {
+		std::sort( rtts.begin(), rtts.end() );
+		const auto percentile = [&]( double q ) {
+			return rtts[static_cast<std::size_t>( q * static_cast<double>( rtts.size() - 1 ) )];
+		};
+		r.rtt_p50_ns  = percentile( 0.5 );
+		r.rtt_p99_ns  = percentile( 0.99 );
+		r.rtt_p999_ns = percentile( 0.999 );
+		r.rtt_max_ns  = rtts.back();
+	}
+	return r;
+}
+
+std::int64_t ns_since( Clock::time_point t )
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - t ).count();
+}
+
+/* ###### datagram sockets (udp and unix) ###### */
+
+template<class SocketT>
+struct DgramPair {
+	using endpoint = typename SocketT::endpoint;
+
+	SocketT  a; // sender / client
+	SocketT  b; // receiver / echo
+	endpoint ep_a;
+	endpoint ep_b;
+};
+
+ip::udp::endpoint bind_to_free_port( ip::udp::Socket& socket )
+{
+	socket.bind( ip::udp::endpoint{ip::address_local_host, ip::port_nr{0}} );
+	socks::port_layer::SockaddrIn addr;
+	const auto                    res = socket.as_raii_socket().getsockname( addr );
+	if( !res ) { throw socket_error( socket_op::get_local_address, res ); }
+	return ip::udp::endpoint( addr );
+}
+
+DgramPair<ip::udp::Socket> make_udp_pair( int )
+{
+	DgramPair<ip::udp::Socket> p;
+	p.ep_a = bind_to_free_port( p.a );
+	p.ep_b = bind_to_free_port( p.b );
+	return p;
+}
+
+#ifdef MART_NETLIB_BENCHMARK_UNIX_DOMAIN_SOCKETS
+un::endpoint bind_to_temp_path( un::Socket& socket, int idx, std::string_view suffix )
+{
+	const auto path = std::filesystem::temp_directory_path()
+					  / ( "mart_netlib_bench_" + std::to_string( idx ) + std::string( suffix ) );
+	std::filesystem::remove( path );
+	const un::endpoint ep( path );
+	socket.bind( ep );
+	return ep;
+}
+
+DgramPair<un::Socket> make_unix_pair( int idx )
+{
+	DgramPair<un::Socket> p;
+	p.ep_a = bind_to_temp_path( p.a, idx, "_a" );
+	p.ep_b = bind_to_temp_path( p.b, idx, "_b" );
+	return p;
+}
+#endif
+
+template<class SocketT>
+void dgram_send( DgramPair<SocketT>& pair, const Params& p, PairStats& stats )
+{
+	using Entry = typename SocketT::SendBatchEntry;
+
+	const std::vector<mart::ByteType> payload( p.size, mart::ByteType{0x5a} );
+	const mart::ConstMemoryView       data( payload.data(), payload.size() );
+	const std::vector<Entry>          batch( p.batch, Entry{data, pair.ep_b} );
+
+	std::size_t sent = 0;
+	while( sent < static_cast<std::size_t>( p.iterations ) ) {
+		++stats.calls;
+		if( p.batch > 1 ) {
+			const auto cnt = std::min( p.batch, static_cast<std::size_t>( p.iterations ) - sent );
+			const auto res = pair.a.send_batch( mart::ArrayView<const Entry>( batch.data(), cnt ) );
+			// datagrams that could not be sent count as lost
+			sent += res ? std::max<std::size_t>( res.value(), 1 ) : 1;
+		} else {
+			(void)pair.a.try_sendto( data, pair.ep_b );
+			++sent;
+		}
+	}
+}
+
+template<class SocketT>
+void dgram_receive( DgramPair<SocketT>& pair, const Params& p, const std::atomic_bool& sender_done, PairStats& stats )
+{
+	using Entry = typename SocketT::RecvBatchEntry;
+
+	const std::size_t           buffer_size = std::max<std::size_t>( p.size, 1 );
+	std::vector<mart::ByteType> buffer( buffer_size * p.batch );
+	std::vector<Entry>          batch;
+	for( std::size_t i = 0; i < p.batch; ++i ) {
+		batch.push_back( {mart::MemoryView( buffer.data() + i * buffer_size, buffer_size ), {}, {}} );
+	}
+
+	while( stats.received < static_cast<std::size_t>( p.iterations ) ) {
+		++stats.calls;
+		std::size_t cnt = 0;
+		if( p.batch > 1 ) {
+			const auto res = pair.b.recv_batch( batch );
+			cnt            = res ? res.value() : 0;
+		} else {
+			cnt = pair.b.try_recvfrom( batch[0].buffer ).data.isValid() ? 1 : 0;
+		}
+
+		if( cnt == 0 ) {
+			// timeout: the remaining datagrams were dropped
+			if( sender_done.load() ) { break; }
+			continue;
+		}
+		stats.received += cnt;
+		stats.last_rx = Clock::now();
+	}
+}
+
+template<class SocketT>
+void dgram_client( DgramPair<SocketT>& pair, const Params& p, PairStats& stats )
+{
+	std::vector<mart::ByteType> payload( std::max<std::size_t>( p.size, 1 ), mart::ByteType{0x5a} );
+	const mart::MemoryView      data( payload.data(), p.size );
+	stats.rtts_ns.reserve( p.iterations );
+
+	for( int i = 0; i < p.iterations; ++i ) {
+		const auto start = Clock::now();
+		(void)pair.a.try_sendto( data, pair.ep_b );
+		const auto res = pair.a.try_recvfrom( mart::MemoryView( payload.data(), payload.size() ) );
+		stats.calls += 2;
+		if( res.data.isValid() ) {
+			stats.rtts_ns.push_back( ns_since( start ) );
+			++stats.received;
+		}
+	}
+}
+
+template<class SocketT>
+void dgram_echo( DgramPair<SocketT>& pair, const Params& p, const std::atomic_bool& stop, PairStats& stats )
+{
+	std::vector<mart::ByteType> buffer( std::max<std::size_t>( p.size, 1 ) );
+	while( !stop.load() ) {
+		const auto res = pair.b.try_recvfrom( mart::MemoryView( buffer.data(), buffer.size() ) );
+		++stats.calls;
+		if( !res.data.isValid() ) { continue; }
+		(void)pair.b.try_sendto( res.data, res.remote_address );
+		++stats.calls;
+	}
+}
+
+template<class SocketT, class MakePair>
+Result run_dgram( const Params& p, MakePair make_pair )
+{
+	std::vector<DgramPair<SocketT>> pairs;
+	for( int i = 0; i < p.threads; ++i ) {
+		pairs.push_back( make_pair( i ) );
+		auto& pair = pairs.back();
+		// best effort - avoid drops due to small default buffers
+		(void)pair.b.try_set_rx_buffer_size( 4 << 20 );
+		(void)pair.a.try_set_rx_buffer_size( 4 << 20 );
+		pair.a.set_rx_timeout( 1s );
+		pair.b.set_rx_timeout( 200ms );
+	}
+
+	std::vector<PairStats>   stats( p.threads );
+	std::vector<PairStats>   peer_stats( p.threads );
+	std::vector<std::thread> threads;
+	std::atomic_bool         done{false};
+
+	const auto usage_start = get_usage();
+	const auto start       = Clock::now();
+	for( int i = 0; i < p.threads; ++i ) {
+		if( p.mode == Mode::Throughput ) {
+			threads.emplace_back( [&, i] { dgram_receive( pairs[i], p, done, stats[i] ); } );
+		} else {
+			threads.emplace_back( [&, i] { dgram_echo( pairs[i], p, done, peer_stats[i] ); } );
+		}
+	}
+	{
+		std::vector<std::thread> senders;
+		for( int i = 0; i < p.threads; ++i ) {
+			if( p.mode == Mode::Throughput ) {
+				senders.emplace_back( [&, i] { dgram_send( pairs[i], p, peer_stats[i] ); } );
+			} else {
+				senders.emplace_back( [&, i] { dgram_client( pairs[i], p, stats[i] ); } );
+			}
+		}
+		for( auto& t : senders ) {
+			t.join();
+		}
+	}
+	const auto end = Clock::now();
+	done.store( true );
+	for( auto& t : threads ) {
+		t.join();
+	}
+	const auto usage = get_usage() - usage_start;
+
+	for( int i = 0; i < p.threads; ++i ) {
+		stats[i].calls += peer_stats[i].calls;
+	}
+	return make_result( p, stats, start, end, usage );
+}
+
+/* ###### tcp ###### */
+
+struct TcpPair {
+	ip::tcp::Socket a; // sender / client
+	ip::tcp::Socket b; // receiver / echo
+};
+
+TcpPair make_tcp_pair()
+{
+	ip::tcp::Acceptor acceptor( ip::tcp::endpoint{ip::address_local_host, ip::port_nr{0}} );
+
+	socks::port_layer::SockaddrIn addr;
+	const auto                    res = acceptor.getSocket().getsockname( addr );
+	if( !res ) { throw socket_error( socket_op::get_local_address, res ); }
+
+	TcpPair p;
+	p.a.connect( ip::tcp::endpoint( addr ) );
+	p.b = acceptor.accept( 1s );
+	if( !p.b.is_valid() ) { throw generic_nw_error( "benchmark: could not accept tcp connection" ); }
+
+	p.a.set_tcp_nodelay( true );
+	p.b.set_tcp_nodelay( true );
+	return p;
+}
+
+void tcp_send( TcpPair& pair, const Params& p, PairStats& stats )
+{
+	const std::vector<mart::ByteType>        payload( p.size, mart::ByteType{0x5a} );
+	const std::vector<mart::ConstMemoryView> batch( p.batch, mart::ConstMemoryView( payload.data(), payload.size() ) );
+
+	std::size_t sent = 0;
+	while( sent < static_cast<std::size_t>( p.iterations ) ) {
+		const auto cnt = std::min( p.batch, static_cast<std::size_t>( p.iterations ) - sent );
+		++stats.calls;
+		if( !pair.a.try_send_all( mart::ArrayView<const mart::ConstMemoryView>( batch.data(), cnt ) ) ) { return; }
+		sent += cnt;
+	}
+}
+
+void tcp_receive( TcpPair& pair, const Params& p, PairStats& stats )
+{
+	std::vector<mart::ByteType> buffer( 64 * 1024 );
+	const std::size_t           total    = static_cast<std::size_t>( p.iterations ) * p.size;
+	std::size_t                 received = 0;
+
+	while( received < total ) {
+		++stats.calls;
+		const auto res = pair.b.try_recv( mart::MemoryView( buffer.data(), buffer.size() ) );
+		if( !res || res.value() == 0 ) { break; }
+		received += res.value();
+		stats.last_rx = Clock::now();
+	}
+	stats.received = received / p.size;
+}
+
+bool tcp_recv_exactly( ip::tcp::Socket& socket, mart::MemoryView buffer, PairStats& stats )
+{
+	std::size_t received = 0;
+	while( received < buffer.size() ) {
+		++stats.calls;
+		const auto res = socket.try_recv( buffer.subview( received ) );
+		if( !res || res.value() == 0 ) { return false; }
+		received += res.value();
+	}
+	return true;
+}
+
+void tcp_client( TcpPair& pair, const Params& p, PairStats& stats )
+{
+	std::vector<mart::ByteType> payload( p.size, mart::ByteType{0x5a} );
+	const mart::MemoryView      data( payload.data(), payload.size() );
+	stats.rtts_ns.reserve( p.iterations );
+
+	for( int i = 0; i < p.iterations; ++i ) {
+		const auto start = Clock::now();
+		++stats.calls;
+		const mart::ConstMemoryView tx_data = data;
+		if( !pair.a.try_send_all( mart::ArrayView<const mart::ConstMemoryView>( &tx_data, 1 ) ) ) { break; }
+		if( !tcp_recv_exactly( pair.a, data, stats ) ) { break; }
+		stats.rtts_ns.push_back( ns_since( start ) );
+		++stats.received;
+	}
+	// lets the echo thread terminate
+	pair.a.close();
+}
+
+void tcp_echo( TcpPair& pair, const Params& p, PairStats& stats )
+{
+	std::vector<mart::ByteType> buffer( p.size );
+	while( true ) {
+		++stats.calls;
+		const auto res = pair.b.try_recv( mart::MemoryView( buffer.data(), buffer.size() ) );
+		if( !res || res.value() == 0 ) { return; }
+
+		const mart::ConstMemoryView data( buffer.data(), res.value() );
+		++stats.calls;
+		if( !pair.b.try_send_all( mart::ArrayView<const mart::ConstMemoryView>( &data, 1 ) ) ) { return; }
+	}
+}
+
+Result run_tcp( const Params& p )
+{
+	std::vector<TcpPair> pairs;
+	for( int i = 0; i < p.threads; ++i ) {
+		pairs.push_back( make_tcp_pair() );
+		pairs.back().a.set_rx_timeout( 1s );
+		pairs.back().b.set_rx_timeout( 1s );
+	}
+
+	std::vector<PairStats>   stats( p.threads );
+	std::vector<PairStats>   peer_stats( p.threads );
+	std::vector<std::thread> threads;
+
+	const auto usage_start = get_usage();
+	const auto start       = Clock::now();
+	for( int i = 0; i < p.threads; ++i ) {
+		if( p.mode == Mode::Throughput ) {
+			threads.emplace_back( [&, i] { tcp_receive( pairs[i], p, stats[i] ); } );
+			threads.emplace_back( [&, i] { tcp_send( pairs[i], p, peer_stats[i] ); } );
+		} else {
+			threads.emplace_back( [&, i] { tcp_echo( pairs[i], p, peer_stats[i] ); } );
+			threads.emplace_back( [&, i] { tcp_client( pairs[i], p, stats[i] ); } );
+		}
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	const auto end   = Clock::now();
+	const auto usage = get_usage() - usage_start;
+
+	for( int i = 0; i < p.threads; ++i ) {
+		stats[i].calls += peer_stats[i].calls;
+	}
+	return make_result( p, stats, start, end, usage );
+}
+
+/* ###### driver ###### */
+
+bool run( const Params& p, Result& result )
+{
+	if( p.transport == "udp" ) {
+		result = run_dgram<ip::udp::Socket>( p, make_udp_pair );
+		return true;
+	}
+	if( p.transport == "tcp" ) {
+		result = run_tcp( p );
+		return true;
+	}
+#ifdef MART_NETLIB_BENCHMARK_UNIX_DOMAIN_SOCKETS
+	if( p.transport == "unix" ) {
+		result = run_dgram<un::Socket>( p, make_unix_pair );
+		for( int i = 0; i < p.threads; ++i ) {
+			for( const char* suffix : {"_a", "_b"} ) {
+				std::filesystem::remove( std::filesystem::temp_directory_path()
+										 / ( "mart_netlib_bench_" + std::to_string( i ) + suffix ) );
+			}
+		}
+		return true;
+	}
+#endif
+	return false;
+}
+
+void write_header( std::ostream& out, const Config& cfg )
+{
+	if( cfg.format == "csv" ) {
+		out << "transport,mode,size,threads,batch,sent,received,msgs_per_sec,mbytes_per_sec,rtt_p50_ns,rtt_p99_ns,"
+			   "rtt_p999_ns,rtt_max_ns,calls_per_msg,user_ms,sys_ms,vol_ctx_switches,invol_ctx_switches\n";
+	}
+}
+
+void write_result( std::ostream& out, const Config& cfg, const Result& r )
+{
+	const auto& p = r.params;
+	if( cfg.format == "json" ) {
+		out << R"({"transport":")" << p.transport << R"(","mode":")" << to_string( p.mode ) << R"(","size":)" << p.size
+			<< R"(,"threads":)" << p.threads << R"(,"batch":)" << p.batch << R"(,"sent":)" << r.sent
+			<< R"(,"received":)" << r.received << R"(,"msgs_per_sec":)" << static_cast<std::int64_t>( r.msgs_per_sec )
+			<< R"(,"mbytes_per_sec":)" << r.mbytes_per_sec << R"(,"rtt_p50_ns":)" << r.rtt_p50_ns
+			<< R"(,"rtt_p99_ns":)" << r.rtt_p99_ns << R"(,"rtt_p999_ns":)" << r.rtt_p999_ns << R"(,"rtt_max_ns":)"
+			<< r.rtt_max_ns << R"(,"calls_per_msg":)" << r.calls_per_msg << R"(,"user_ms":)" << r.usage.user_ms
+			<< R"(,"sys_ms":)" << r.usage.sys_ms << R"(,"vol_ctx_switches":)" << r.usage.vol_switches
+			<< R"(,"invol_ctx_switches":)" << r.usage.inv_switches << "}\n";
+	} else {
+		out << p.transport << ',' << to_string( p.mode ) << ',' << p.size << ',' << p.threads << ',' << p.batch << ','
+			<< r.sent << ',' << r.received << ',' << static_cast<std::int64_t>( r.msgs_per_sec ) << ','
+			<< r.mbytes_per_sec << ',' << r.rtt_p50_ns << ',' << r.rtt_p99_ns << ',' << r.rtt_p999_ns << ','
+			<< r.rtt_max_ns << ',' << r.calls_per_msg << ',' << r.usage.user_ms << ',' << r.usage.sys_ms << ','
+			<< r.usage.vol_switches << ',' << r.usage.inv_switches << '\n';
+	}
+	out.flush();
+}
+
+template<class F>
+void for_each_item( std::string_view list, F&& f )
+{
+	while( !list.empty() ) {
+		const auto pos = list.find( ',' );
+		f( list.substr( 0, pos ) );
+		list = pos == std::string_view::npos ? std::string_view{} : list.substr( pos + 1 );
+	}
+}
+
+bool parse_args( int argc, char** argv, Config& cfg )
+{
+	for( int i = 1; i < argc; ++i ) {
+		const std::string_view arg( argv[i] );
+		const auto             pos = arg.find( '=' );
+		if( pos == std::string_view::npos ) { return false; }
+		const auto key   = arg.substr( 0, pos );
+		const auto value = arg.substr( pos + 1 );
+
+		if( key == "--iterations" ) {
+			cfg.iterations = std::stoi( std::string( value ) );
+		} else if( key == "--sizes" ) {
+			cfg.sizes.clear();
+			for_each_item( value, [&]( std::string_view v ) { cfg.sizes.push_back( std::stoul( std::string( v ) ) ); } );
+		} else if( key == "--threads" ) {
+			cfg.threads.clear();
+			for_each_item( value, [&]( std::string_view v ) { cfg.threads.push_back( std::stoi( std::string( v ) ) ); } );
+		} else if( key == "--batch" ) {
+			cfg.batches.clear();
+			for_each_item( value, [&]( std::string_view v ) { cfg.batches.push_back( std::stoul( std::string( v ) ) ); } );
+		} else if( key == "--transports" ) {
+			cfg.transports.clear();
+			for_each_item( value, [&]( std::string_view v ) { cfg.transports.emplace_back( v ); } );
+		} else if( key == "--modes" ) {
+			cfg.modes.clear();
+			bool valid = true;
+			for_each_item( value, [&]( std::string_view v ) {
+				if( v == "throughput" ) {
+					cfg.modes.push_back( Mode::Throughput );
+				} else if( v == "rtt" ) {
+					cfg.modes.push_back( Mode::Rtt );
+				} else {
+					valid = false;
+				}
+			} );
+			if( !valid ) { return false; }
+		} else if( key == "--format" ) {
+			cfg.format = std::string( value );
+		} else if( key == "--out" ) {
+			cfg.out = std::string( value );
+		} else {
+			return false;
+		}
+	}
+	const auto positive = []( auto v ) { return v > 0; };
+	return cfg.iterations > 0 && std::all_of( cfg.sizes.begin(), cfg.sizes.end(), positive )
+		   && std::all_of( cfg.threads.begin(), cfg.threads.end(), positive )
+		   && std::all_of( cfg.batches.begin(), cfg.batches.end(), positive )
+		   && ( cfg.format == "csv" || cfg.format == "json" );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+	Config cfg;
+	if( !parse_args( argc, argv, cfg ) ) {
+		std::cerr << "Usage: " << argv[0]
+				  << " [--iterations=N] [--sizes=16,256,1400] [--threads=1,2] [--batch=1,32]"
+					 " [--transports=udp,tcp,unix] [--modes=throughput,rtt] [--format=csv|json] [--out=<file>]\n";
+		return 1;
+	}
+
+	std::ofstream file;
+	if( !cfg.out.empty() ) { file.open( cfg.out ); }
+	std::ostream& out = cfg.out.empty() ? std::cout : file;
+
+	write_header( out, cfg );
+	try {
+		for( const auto& transport : cfg.transports ) {
+			for( Mode mode : cfg.modes ) {
+				for( std::size_t size : cfg.sizes ) {
+					for( int threads : cfg.threads ) {
+						for( std::size_t batch : cfg.batches ) {
+							// round trips can't be batched
+							if( mode == Mode::Rtt && batch != cfg.batches.front() ) { continue; }
+
+							const Params p{transport, mode, size, threads, mode == Mode::Rtt ? 1 : batch, cfg.iterations};
+							Result       result{};
+							if( !run( p, result ) ) {
+								std::cerr << "Unknown transport: " << transport << '\n';
+								return 1;
+							}
+							write_result( out, cfg, result );
+						}
+					}
+				}
+			}
+		}
+	} catch( const std::exception& e ) {
+		std::cerr << "Benchmark failed: " << e.what() << '\n';
+		return 1;
+	}
+}
@@ -0,0 +1,155 @@
+#include <mart-netlib/async.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+template<class Pred>
+bool run_until( mart::nw::Reactor& reactor, Pred pred )
+{
+	const auto deadline = std::chrono::steady_clock::now() + 2s;
+	while( !pred() && std::chrono::steady_clock::now() < deadline ) {
+		reactor.run_once( 20ms );
+	}
+	return pred();
+}
+
+} // namespace
+
+TEST_CASE( "async_udp_recvfrom_completes_when_data_arrives", "[net][async]" )
+{
+	using namespace mart::nw::ip;
+	using mart::nw::socks::ReturnValue;
+
+	mart::nw::Reactor reactor;
+
+	udp::Socket receiver;
+	receiver.bind( udp::endpoint{address_local_host, port_nr{3470}} );
+	udp::Socket sender;
+	sender.bind( udp::endpoint{address_local_host, port_nr{3471}} );
+
+	udp::AsyncSocket async_receiver( reactor, receiver );
+	udp::AsyncSocket async_sender( reactor, sender );
+
+	int                                     rx_value = 0;
+	udp::endpoint                           from{};
+	std::optional<ReturnValue<std::size_t>> rx_result;
+	async_receiver.async_recvfrom( mart::view_bytes_mutable( rx_value ), from, [&]( ReturnValue<std::size_t> res ) {
+		rx_result = res;
+	} );
+	// nothing to receive yet -> the operation waits in the reactor
+	CHECK( !rx_result );
+	CHECK( reactor.size() == 1 );
+
+	// only one pending read operation per socket
+	std::optional<ReturnValue<std::size_t>> second_result;
+	async_receiver.async_recv( mart::view_bytes_mutable( rx_value ), [&]( ReturnValue<std::size_t> res ) {
+		second_result = res;
+	} );
+	REQUIRE( second_result );
+	CHECK( second_result->error_code().value() == mart::nw::socks::ErrorCodeValues::InvalidArgument );
+
+	const int                               tx_value = 42;
+	std::optional<ReturnValue<std::size_t>> tx_result;
+	async_sender.async_sendto( mart::view_bytes( tx_value ),
+							   receiver.get_local_endpoint(),
+							   [&]( ReturnValue<std::size_t> res ) { tx_result = res; } );
+	// sending doesn't block -> completes immediately
+	REQUIRE( tx_result );
+	CHECK( tx_result->success() );
+	CHECK( tx_result->value() == sizeof( tx_value ) );
+
+	REQUIRE( run_until( reactor, [&] { return rx_result.has_value(); } ) );
+	CHECK( rx_result->success() );
+	CHECK( rx_result->value() == sizeof( rx_value ) );
+	CHECK( rx_value == tx_value );
+	CHECK( from == sender.get_local_endpoint() );
+
+	// idle sockets are not registered
+	CHECK( reactor.size() == 0 );
+}
+
+TEST_CASE( "async_tcp_accept_connect_and_exchange", "[net][async]" )
+{
+	using namespace mart::nw::ip;
+	using mart::nw::socks::ErrorCode;
+	using mart::nw::socks::ReturnValue;
+
+	mart::nw::Reactor reactor;
+
+	tcp::Acceptor      acceptor( tcp::endpoint{address_local_host, port_nr{3472}} );
+	tcp::AsyncAcceptor async_acceptor( reactor, acceptor );
+
+	std::optional<tcp::Socket>              server;
+	std::unique_ptr<tcp::AsyncSocket>       async_server;
+	std::array<char, 16>                    server_buffer{};
+	std::optional<ReturnValue<std::size_t>> server_rx;
+
+	async_acceptor.async_accept( [&]( tcp::AcceptResult res ) {
+		REQUIRE( res.error.success() );
+		server.emplace( std::move( res.socket ) );
+		async_server = std::make_unique<tcp::AsyncSocket>( reactor, *server );
+		async_server->async_recv( mart::view_bytes_mutable( server_buffer ), [&]( ReturnValue<std::size_t> rx ) {
+			server_rx = rx;
+		} );
+	} );
+
+	tcp::Socket      client;
+	tcp::AsyncSocket async_client( reactor, client );
+
+	std::optional<ErrorCode> connect_result;
+	async_client.async_connect( acceptor.getLocalEndpoint(), [&]( ErrorCode ec ) { connect_result = ec; } );
+
+	REQUIRE( run_until( reactor, [&] { return connect_result.has_value() && async_server; } ) );
+	CHECK( connect_result->success() );
+	CHECK( client.get_remote_endpoint() == acceptor.getLocalEndpoint() );
+	CHECK( server->get_remote_endpoint() == client.get_local_endpoint() );
+
+	constexpr std::string_view              msg = "Hello";
+	std::optional<ReturnValue<std::size_t>> client_tx;
+	async_client.async_send( mart::ArrayView<const char>( msg.data(), msg.size() ).asBytes(),
+							 [&]( ReturnValue<std::size_t> tx ) { client_tx = tx; } );
+	REQUIRE( client_tx );
+	CHECK( client_tx->value() == msg.size() );
+
+	REQUIRE( run_until( reactor, [&] { return server_rx.has_value(); } ) );
+	REQUIRE( server_rx->success() );
+	CHECK( std::string_view( server_buffer.data(), server_rx->value() ) == msg );
+
+	// peer closes the connection -> 0 bytes received
+	server_rx.reset();
+	async_server->async_recv( mart::view_bytes_mutable( server_buffer ), [&]( ReturnValue<std::size_t> rx ) {
+		server_rx = rx;
+	} );
+	client.close();
+	REQUIRE( run_until( reactor, [&] { return server_rx.has_value(); } ) );
+	CHECK( server_rx->success() );
+	CHECK( server_rx->value() == 0 );
+}
+
+TEST_CASE( "async_tcp_connect_reports_errors", "[net][async]" )
+{
+	using namespace mart::nw::ip;
+	using mart::nw::socks::ErrorCode;
+
+	mart::nw::Reactor reactor;
+
+	tcp::Socket      client;
+	tcp::AsyncSocket async_client( reactor, client );
+
+	// nobody listens on that port
+	std::optional<ErrorCode> connect_result;
+	async_client.async_connect( tcp::endpoint{address_local_host, port_nr{3473}},
+								[&]( ErrorCode ec ) { connect_result = ec; } );
+
+	REQUIRE( run_until( reactor, [&] { return connect_result.has_value(); } ) );
+	CHECK( !connect_result->success() );
+}
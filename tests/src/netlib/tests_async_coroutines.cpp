@@ -0,0 +1,114 @@
+#include <mart-netlib/async.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <string_view>
+
+#if MART_NETLIB_HAS_COROUTINES
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using namespace mart::nw::ip;
+
+mart::nw::DetachedTask echo_once( tcp::AsyncAcceptor& acceptor, mart::nw::Reactor& reactor, bool& done )
+{
+	auto accepted = co_await acceptor.async_accept();
+	REQUIRE( accepted.error.success() );
+
+	tcp::AsyncSocket     sock( reactor, accepted.socket );
+	std::array<char, 16> buffer{};
+
+	auto rx = co_await sock.async_recv( mart::view_bytes_mutable( buffer ) );
+	REQUIRE( rx.success() );
+	auto tx = co_await sock.async_send( mart::view_bytes( buffer ).subview( 0, rx.value() ) );
+	CHECK( tx.success() );
+
+	// wait until the client closed the connection (so the server port doesn't end up in TIME_WAIT)
+	rx = co_await sock.async_recv( mart::view_bytes_mutable( buffer ) );
+	CHECK( rx.success() );
+	CHECK( rx.value() == 0 );
+	done = true;
+}
+
+mart::nw::DetachedTask
+client( tcp::AsyncSocket& sock, tcp::endpoint server, std::array<char, 16>& buffer, std::size_t& received )
+{
+	auto ec = co_await sock.async_connect( server );
+	REQUIRE( ec.success() );
+
+	constexpr std::string_view msg = "Ping";
+	co_await sock.async_send( mart::ArrayView<const char>( msg.data(), msg.size() ).asBytes() );
+
+	auto rx = co_await sock.async_recv( mart::view_bytes_mutable( buffer ) );
+	REQUIRE( rx.success() );
+	received = rx.value();
+	co_return;
+}
+
+} // namespace
+
+TEST_CASE( "async_coroutine_tcp_echo", "[net][async]" )
+{
+	mart::nw::Reactor reactor;
+
+	tcp::Acceptor      acceptor( tcp::endpoint{address_local_host, port_nr{3474}} );
+	tcp::AsyncAcceptor async_acceptor( reactor, acceptor );
+
+	bool server_done = false;
+	echo_once( async_acceptor, reactor, server_done );
+
+	tcp::Socket          sock;
+	tcp::AsyncSocket     async_sock( reactor, sock );
+	std::array<char, 16> buffer{};
+	std::size_t          received = 0;
+	client( async_sock, acceptor.getLocalEndpoint(), buffer, received );
+
+	const auto deadline = std::chrono::steady_clock::now() + 2s;
+	while( received == 0 && std::chrono::steady_clock::now() < deadline ) {
+		reactor.run_once( 20ms );
+	}
+	CHECK( std::string_view( buffer.data(), received ) == "Ping" );
+
+	sock.close();
+	while( !server_done && std::chrono::steady_clock::now() < deadline ) {
+		reactor.run_once( 20ms );
+	}
+	CHECK( server_done );
+}
+
+TEST_CASE( "async_coroutine_udp_recvfrom", "[net][async]" )
+{
+	mart::nw::Reactor reactor;
+
+	udp::Socket receiver;
+	receiver.bind( udp::endpoint{address_local_host, port_nr{3475}} );
+	udp::AsyncSocket async_receiver( reactor, receiver );
+
+	int           value = 0;
+	udp::endpoint from{};
+	bool          done = false;
+
+	[]( udp::AsyncSocket& sock, int& value, udp::endpoint& from, bool& done ) -> mart::nw::DetachedTask {
+		auto res = co_await sock.async_recvfrom( mart::view_bytes_mutable( value ), from );
+		CHECK( res.success() );
+		done = true;
+	}( async_receiver, value, from, done );
+	CHECK( !done );
+
+	udp::Socket sender;
+	sender.bind( udp::endpoint{address_local_host, port_nr{3476}} );
+	sender.sendto( mart::view_bytes( 5 ), receiver.get_local_endpoint() );
+
+	const auto deadline = std::chrono::steady_clock::now() + 2s;
+	while( !done && std::chrono::steady_clock::now() < deadline ) {
+		reactor.run_once( 20ms );
+	}
+	CHECK( done );
+	CHECK( value == 5 );
+	CHECK( from == sender.get_local_endpoint() );
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include <mart-netlib/io_queue.hpp>
+
+#include <mart-netlib/tcp.hpp>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+using namespace std::chrono_literals;
+using mart::nw::IoQueue;
+
+namespace {
+
+// reaps until @p cnt completions were collected or the deadline expired
+std::vector<IoQueue::Completion> reap_n( IoQueue& queue, std::size_t cnt )
+{
+	std::vector<IoQueue::Completion>    ret;
+	std::array<IoQueue::Completion, 8> buffer{};
+
+	const auto deadline = std::chrono::steady_clock::now() + 2s;
+	while( ret.size() < cnt && std::chrono::steady_clock::now() < deadline ) {
+		const auto n = queue.reap( buffer, 20ms );
+		ret.insert( ret.end(), buffer.begin(), buffer.begin() + n );
+	}
+	return ret;
+}
+
+} // namespace
+
+TEST_CASE( "io_queue_uses_io_uring_if_supported", "[net][io_queue]" )
+{
+	IoQueue default_queue;
+	CHECK( ( default_queue.backend() == IoQueue::Backend::IoUring ) == IoQueue::is_io_uring_supported() );
+
+	IoQueue epoll_queue( 16, IoQueue::Backend::Epoll );
+	CHECK( epoll_queue.backend() == IoQueue::Backend::Epoll );
+}
+
+TEST_CASE( "io_queue_udp_batch_receive_into_registered_buffers", "[net][io_queue]" )
+{
+	using namespace mart::nw::ip;
+
+	const auto backend = GENERATE( IoQueue::Backend::IoUring, IoQueue::Backend::Epoll );
+	IoQueue    queue( 16, backend );
+
+	udp::Socket receiver;
+	receiver.bind( udp::endpoint{address_local_host, port_nr{3480}} );
+	udp::Socket sender;
+	sender.bind( udp::endpoint{address_local_host, port_nr{3481}} );
+	sender.connect( receiver.get_local_endpoint() );
+
+	constexpr std::size_t                 msg_cnt = 8;
+	std::array<std::uint32_t, msg_cnt>    storage{};
+	const std::array<mart::MemoryView, 1> registered{mart::view_bytes_mutable( storage )};
+	CHECK( queue.register_socket( receiver.as_raii_socket() ) );
+	CHECK( queue.register_buffers( registered ).success() );
+
+	for( std::size_t i = 0; i < msg_cnt; ++i ) {
+		CHECK( queue.recv( receiver.as_raii_socket(), mart::view_bytes_mutable( storage[i] ), i ) );
+	}
+	CHECK( queue.submit().value() == msg_cnt );
+	CHECK( queue.in_flight() == msg_cnt );
+
+	// sends through the queue as well
+	std::array<std::uint32_t, msg_cnt> values{};
+	for( std::size_t i = 0; i < msg_cnt; ++i ) {
+		values[i] = static_cast<std::uint32_t>( 100 + i );
+		CHECK( queue.send( sender.as_raii_socket(), mart::view_bytes( values[i] ), 1000 + i ) );
+	}
+
+	const auto completions = reap_n( queue, 2 * msg_cnt );
+	REQUIRE( completions.size() == 2 * msg_cnt );
+	CHECK( queue.in_flight() == 0 );
+
+	std::vector<std::uint32_t> received;
+	for( const auto& c : completions ) {
+		REQUIRE( c.result.success() );
+		CHECK( c.result.value() == sizeof( std::uint32_t ) );
+		if( c.user_data < msg_cnt ) { received.push_back( storage[c.user_data] ); }
+	}
+	std::sort( received.begin(), received.end() );
+	CHECK( received == std::vector<std::uint32_t>( values.begin(), values.end() ) );
+
+	CHECK( queue.unregister_buffers().success() );
+	CHECK( queue.unregister_socket( receiver.as_raii_socket() ) );
+}
+
+TEST_CASE( "io_queue_tcp_accept_send_recv", "[net][io_queue]" )
+{
+	using namespace mart::nw::ip;
+
+	const auto backend = GENERATE( IoQueue::Backend::IoUring, IoQueue::Backend::Epoll );
+	IoQueue    queue( 16, backend );
+
+	const port_nr port{static_cast<std::uint16_t>( backend == IoQueue::Backend::IoUring ? 3482 : 3483 )};
+	tcp::Acceptor acceptor( tcp::endpoint{address_local_host, port} );
+
+	CHECK( queue.accept( acceptor.getSocket(), 1 ) );
+	CHECK( queue.submit().success() );
+
+	tcp::Socket client;
+	client.connect( acceptor.getLocalEndpoint() );
+
+	auto accepted = reap_n( queue, 1 );
+	REQUIRE( accepted.size() == 1 );
+	REQUIRE( accepted[0].result.success() );
+	CHECK( accepted[0].user_data == 1 );
+	mart::nw::socks::RaiiSocket server( accepted[0].accepted );
+	REQUIRE( server.is_valid() );
+
+	std::array<char, 16> buffer{};
+	CHECK( queue.recv( server, mart::view_bytes_mutable( buffer ), 2 ) );
+
+	constexpr std::string_view msg = "Hello";
+	CHECK( queue.send( client.as_raii_socket(), mart::ArrayView<const char>( msg.data(), msg.size() ).asBytes(), 3 ) );
+
+	auto transfers = reap_n( queue, 2 );
+	REQUIRE( transfers.size() == 2 );
+	for( const auto& c : transfers ) {
+		REQUIRE( c.result.success() );
+		CHECK( c.result.value() == msg.size() );
+	}
+	CHECK( std::string_view( buffer.data(), msg.size() ) == msg );
+
+	// closing the connection completes a pending receive with 0 bytes
+	CHECK( queue.recv( server, mart::view_bytes_mutable( buffer ), 4 ) );
+	queue.submit();
+	client.close();
+	auto closed = reap_n( queue, 1 );
+	REQUIRE( closed.size() == 1 );
+	CHECK( closed[0].result.success() );
+	CHECK( closed[0].result.value() == 0 );
+}
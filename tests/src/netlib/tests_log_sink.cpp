@@ -0,0 +1,85 @@
+#include <mart-netlib/log_sink.hpp>
+
+#include <mart-common/logging/Logger.h>
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+TEST_CASE( "log_sink_batches_records_into_udp_datagrams", "[net][log]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint ep{"127.0.0.1:3591"};
+
+	udp::Socket receiver;
+	receiver.bind( ep );
+	receiver.set_rx_timeout( 1000ms );
+
+	auto sink = mart::nw::log::makeSink( mart::nw::log::DatagramLogSinkConfig_t<udp::endpoint>{
+		ep, mart::log::Level::TRACE, 1400, std::chrono::milliseconds( 1h )} );
+
+	mart::log::Logger logger( "net", sink, mart::log::Level::STATUS );
+	for( int i = 0; i < 3; ++i ) {
+		logger.log_structured( mart::log::Level::STATUS, "tick", mart::log::field( "i", i ) );
+	}
+	logger.log( mart::log::Level::STATUS, "plain text" );
+	sink->flush();
+
+	std::array<mart::ByteType, 2048> buffer{};
+	const auto                       datagram = receiver.try_recv( mart::MemoryView( buffer.data(), buffer.size() ) );
+	REQUIRE( datagram.isValid() );
+
+	std::vector<std::string> messages;
+	std::vector<std::int64_t> values;
+	const bool ok = mart::nw::log::forEachRecord( datagram, [&]( mart::ConstMemoryView record ) {
+		mart::log::StructuredRecordReader reader( record );
+		REQUIRE( reader.isValid() );
+		messages.emplace_back( reader.message() );
+		reader.forEachField(
+			[&]( std::string_view, mart::log::FieldType, const mart::log::FieldValue& v ) { values.push_back( v.i ); } );
+	} );
+	CHECK( ok );
+
+	// everything was sent in a single datagram
+	REQUIRE( messages.size() == 4 );
+	CHECK( messages[0] == "tick" );
+	CHECK( values == std::vector<std::int64_t>{0, 1, 2} );
+	CHECK( messages[3].find( "plain text" ) != std::string::npos );
+	CHECK( messages[3].back() == 't' );
+}
+
+TEST_CASE( "log_sink_sends_error_messages_immediately", "[net][log]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint ep{"127.0.0.1:3592"};
+
+	udp::Socket receiver;
+	receiver.bind( ep );
+	receiver.set_rx_timeout( 1000ms );
+
+	mart::nw::log::DatagramLogSink<udp::Socket> sink( {ep, mart::log::Level::TRACE, 1400, 1h} );
+	sink.writeToLog( "error\n", mart::log::Level::ERROR );
+
+	std::array<mart::ByteType, 2048> buffer{};
+	const auto                       datagram = receiver.try_recv( mart::MemoryView( buffer.data(), buffer.size() ) );
+	REQUIRE( datagram.isValid() );
+
+	int cnt = 0;
+	CHECK( mart::nw::log::forEachRecord( datagram, [&]( mart::ConstMemoryView record ) {
+		mart::log::StructuredRecordReader reader( record );
+		CHECK( reader.kind() == mart::log::RecordKind::Text );
+		CHECK( reader.level() == mart::log::Level::ERROR );
+		CHECK( reader.message() == "error" );
+		++cnt;
+	} ) );
+	CHECK( cnt == 1 );
+	CHECK( sink.failedSendCount() == 0 );
+}
@@ -0,0 +1,82 @@
+#include <mart-netlib/packet_pool.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE( "packet_pool_acquire_and_release", "[net][packet_pool]" )
+{
+	mart::nw::PacketPool pool( 3, 64 );
+	CHECK( pool.capacity() == 3 );
+	CHECK( pool.available() == 3 );
+
+	auto p1 = pool.try_acquire();
+	REQUIRE( p1 );
+	CHECK( p1.size() == 0 );
+	CHECK( p1.capacity() == 64 );
+	CHECK( p1.buffer().size() == 64 );
+
+	p1.buffer()[0] = 42;
+	p1.set_size( 1 );
+	CHECK( p1.data().size() == 1 );
+	CHECK( p1.data()[0] == 42 );
+
+	auto p2 = pool.try_acquire();
+	auto p3 = pool.try_acquire();
+	CHECK( p2 );
+	CHECK( p3 );
+	CHECK( pool.available() == 0 );
+	CHECK( !pool.try_acquire() );
+
+	// all buffers are distinct
+	CHECK( p1.buffer().data() != p2.buffer().data() );
+	CHECK( p2.buffer().data() != p3.buffer().data() );
+
+	// copies share the buffer
+	auto p1_copy = p1;
+	CHECK( p1.use_count() == 2 );
+	p1.reset();
+	CHECK( !p1 );
+	CHECK( pool.available() == 0 );
+	p1_copy = std::move( p2 );
+	CHECK( pool.available() == 1 );
+	p1_copy.reset();
+	p3.reset();
+	CHECK( pool.available() == 3 );
+
+	// a reused buffer starts empty
+	auto p4 = pool.try_acquire();
+	CHECK( p4.size() == 0 );
+	CHECK( p4.use_count() == 1 );
+}
+
+TEST_CASE( "packet_pool_concurrent_use", "[net][packet_pool]" )
+{
+	mart::nw::PacketPool pool( 8, 16 );
+
+	// catch assertions are not thread safe
+	std::atomic_int conflicts{0};
+
+	constexpr int            thread_cnt = 4;
+	std::vector<std::thread> threads;
+	for( int t = 0; t < thread_cnt; ++t ) {
+		threads.emplace_back( [&pool, &conflicts, t] {
+			for( int i = 0; i < 10000; ++i ) {
+				auto p = pool.try_acquire();
+				if( !p ) { continue; }
+				// nobody else may own the buffer at the same time
+				p.buffer()[0] = static_cast<mart::ByteType>( t );
+				auto copy     = p;
+				p.reset();
+				if( copy.buffer()[0] != t ) { conflicts++; }
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	CHECK( conflicts == 0 );
+	CHECK( pool.available() == pool.capacity() );
+}
@@ -0,0 +1,156 @@
+#include <mart-netlib/reactor.hpp>
+
+#include <mart-netlib/udp.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "reactor_dispatches_readable_sockets", "[net][reactor]" )
+{
+	using namespace mart::nw::ip;
+
+	mart::nw::Reactor reactor;
+
+	constexpr int            socket_cnt = 8;
+	std::vector<udp::Socket> sockets( socket_cnt );
+	std::vector<int>         received( socket_cnt, 0 );
+	for( int i = 0; i < socket_cnt; ++i ) {
+		sockets[i].bind( udp::endpoint{address_local_host, port_nr{static_cast<std::uint16_t>( 3460 + i )}} );
+		sockets[i].set_blocking( false );
+		reactor.add( sockets[i].as_raii_socket(), mart::nw::IoEvents::Readable, [&, i]( mart::nw::IoEvents ev ) {
+			CHECK( mart::nw::has_any( ev, mart::nw::IoEvents::Readable ) );
+			int value = 0;
+			while( sockets[i].try_recv( mart::view_bytes_mutable( value ) ).isValid() ) {
+				CHECK( value == i );
+				++received[i];
+			}
+		} );
+	}
+	CHECK( reactor.size() == socket_cnt );
+
+	udp::Socket sender;
+	for( int i = 0; i < socket_cnt; ++i ) {
+		sender.sendto( mart::view_bytes( i ), sockets[i].get_local_endpoint() );
+		sender.sendto( mart::view_bytes( i ), sockets[i].get_local_endpoint() );
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + 2s;
+	while( std::chrono::steady_clock::now() < deadline
+		   && std::count( received.begin(), received.end(), 2 ) != socket_cnt ) {
+		reactor.run_once( 100ms );
+	}
+	CHECK( std::count( received.begin(), received.end(), 2 ) == socket_cnt );
+
+	// removed sockets aren't dispatched anymore
+	CHECK( reactor.remove( sockets[0].as_raii_socket() ) );
+	CHECK( !reactor.remove( sockets[0].as_raii_socket() ) );
+	sender.sendto( mart::view_bytes( 0 ), sockets[0].get_local_endpoint() );
+	CHECK( reactor.run_once( 50ms ) == 0 );
+	CHECK( received[0] == 2 );
+
+	for( int i = 1; i < socket_cnt; ++i ) {
+		reactor.remove( sockets[i].as_raii_socket() );
+	}
+	CHECK( reactor.size() == 0 );
+}
+
+TEST_CASE( "reactor_runs_timers", "[net][reactor]" )
+{
+	mart::nw::Reactor reactor;
+
+	int  one_shot = 0;
+	int  periodic = 0;
+	bool canceled = false;
+
+	reactor.add_timer( 10ms, [&] { ++one_shot; } );
+	const auto periodic_id = reactor.add_timer( 1ms, [&] { ++periodic; }, 5ms );
+	const auto cancel_id   = reactor.add_timer( 20ms, [&] { canceled = true; } );
+	CHECK( reactor.cancel_timer( cancel_id ) );
+	reactor.add_timer( 60ms, [&] { reactor.stop(); } );
+
+	const auto start = std::chrono::steady_clock::now();
+	reactor.run();
+	CHECK( std::chrono::steady_clock::now() - start >= 60ms );
+	CHECK( reactor.is_stopped() );
+
+	CHECK( one_shot == 1 );
+	CHECK( periodic >= 2 );
+	CHECK( !canceled );
+	CHECK( reactor.cancel_timer( periodic_id ) );
+	CHECK( !reactor.cancel_timer( periodic_id ) );
+}
+
+TEST_CASE( "reactor_stop_wakes_up_all_threads", "[net][reactor]" )
+{
+	mart::nw::Reactor reactor;
+
+	std::atomic<int>         finished{0};
+	std::vector<std::thread> threads;
+	for( int i = 0; i < 3; ++i ) {
+		threads.emplace_back( [&] {
+			reactor.run();
+			++finished;
+		} );
+	}
+	std::this_thread::sleep_for( 20ms );
+	CHECK( finished == 0 );
+
+	reactor.stop();
+	for( auto& t : threads ) {
+		t.join();
+	}
+	CHECK( finished == 3 );
+}
+
+TEST_CASE( "reactor_never_runs_a_callback_concurrently_with_itself", "[net][reactor]" )
+{
+	using namespace mart::nw::ip;
+
+	mart::nw::Reactor reactor;
+
+	udp::Socket sock;
+	sock.bind( udp::endpoint{address_local_host, port_nr{3470}} );
+	sock.set_blocking( false );
+
+	std::atomic<int>  active{0};
+	std::atomic<bool> overlap{false};
+	std::atomic<int>  calls{0};
+	// data is never consumed, so the socket stays readable
+	reactor.add( sock.as_raii_socket(), mart::nw::IoEvents::Readable, [&]( mart::nw::IoEvents ) {
+		if( ++active != 1 ) { overlap = true; }
+		std::this_thread::yield();
+		--active;
+		++calls;
+	} );
+
+	udp::Socket sender;
+	sender.sendto( mart::view_bytes( 1 ), sock.get_local_endpoint() );
+
+	std::vector<std::thread> threads;
+	for( int i = 0; i < 4; ++i ) {
+		threads.emplace_back( [&] { reactor.run(); } );
+	}
+
+	// modify re-arms the handle, possibly while an event for it is in flight
+	const auto deadline = std::chrono::steady_clock::now() + 200ms;
+	while( std::chrono::steady_clock::now() < deadline ) {
+		reactor.modify( sock.as_raii_socket(), mart::nw::IoEvents::Readable );
+	}
+
+	reactor.stop();
+	for( auto& t : threads ) {
+		t.join();
+	}
+	reactor.remove( sock.as_raii_socket() );
+
+	CHECK( calls > 0 );
+	CHECK( !overlap );
+}
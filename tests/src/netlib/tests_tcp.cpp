@@ -6,6 +6,7 @@
 
 #include <future>
 #include <iostream>
+#include <thread>
 
 
 namespace mart::nw::ip::tcp {
@@ -76,4 +77,80 @@ TEST_CASE( "tcp_simple_exchange", "[net]" )
 	CHECK( rec.size_inBytes() == sizeof( int ) );
 	CHECK( data_orig == data_rec );
 
-}
\ No newline at end of file
+}
+TEST_CASE( "tcp_scatter_gather_exchange", "[net]" )
+{
+	using namespace mart::nw::ip;
+	tcp::endpoint e1 = { mart::nw::ip::address_local_host, mart::nw::ip::port_nr{ 1585 } };
+
+	auto s1_future = std::async( std::launch::async, [&] {
+		tcp::Acceptor ac( e1 );
+		return ac.accept( std::chrono::milliseconds( 1000 ) );
+	} );
+
+	std::this_thread::sleep_for( std::chrono::milliseconds( 1000 ) );
+
+	tcp::Socket s2;
+	s2.connect( e1 );
+
+	auto s1 = s1_future.get();
+	REQUIRE( s1.is_valid() );
+	s2.set_rx_timeout( std::chrono::milliseconds( 1000 ) );
+	s1.set_tcp_nodelay( true );
+	CHECK( s2.try_set_tcp_nodelay( true ) );
+
+	const int                  header = 0xffa1;
+	const std::array<char, 12> payload{ "hello world" };
+
+	const std::array<mart::ConstMemoryView, 2> tx_bufs{ mart::view_bytes( header ), mart::view_bytes( payload ) };
+	s1.send( tx_bufs );
+
+	int                                   rec_header{};
+	std::array<char, 12>                  rec_payload{};
+	const std::array<mart::MemoryView, 2> rx_bufs{ mart::view_bytes_mutable( rec_header ),
+												   mart::view_bytes_mutable( rec_payload ) };
+
+	// small amount of data over loopback arrives in one piece
+	CHECK( s2.recv( rx_bufs ) == sizeof( header ) + payload.size() );
+	CHECK( rec_header == header );
+	CHECK( rec_payload == payload );
+
+	const auto res = s2.try_send( tx_bufs );
+	REQUIRE( res.success() );
+	CHECK( res.value() == sizeof( header ) + payload.size() );
+}
+
+TEST_CASE( "tcp_acceptor_reports_errors", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using mart::nw::socks::ErrorCodeValues;
+	tcp::endpoint e1 = { mart::nw::ip::address_local_host, mart::nw::ip::port_nr{ 1586 } };
+
+	tcp::Acceptor ac( e1 );
+
+	tcp::Acceptor              ac2;
+	mart::nw::socks::ErrorCode bind_error = mart::nw::socks::ErrorCode::Ok();
+	CHECK( !ac2.try_bind( e1 ) );
+	CHECK( !ac2.try_bind( e1, bind_error ) );
+	CHECK( !bind_error.success() );
+
+	// no connection pending
+	const auto none = ac.try_accept_with_error();
+	CHECK( !none.socket.is_valid() );
+	CHECK( ( none.error.value() == ErrorCodeValues::WouldBlock || none.error.value() == ErrorCodeValues::TryAgain ) );
+
+	const auto timed_out = ac.try_accept_with_error( std::chrono::milliseconds( 10 ) );
+	CHECK( !timed_out.socket.is_valid() );
+	CHECK( !timed_out.error.success() );
+
+	tcp::Socket s2;
+	s2.connect( e1 );
+
+	const auto accepted = ac.try_accept_with_error( std::chrono::milliseconds( 1000 ) );
+	REQUIRE( accepted.error.success() );
+	CHECK( accepted.socket.is_valid() );
+	CHECK( accepted.socket.get_remote_endpoint() == s2.get_local_endpoint() );
+
+	// the client closes first, so the acceptor's port doesn't end up in TIME_WAIT
+	s2.close();
+}
@@ -0,0 +1,151 @@
+#include <mart-netlib/network_exceptions.hpp>
+#include <mart-netlib/tcp_framed_stream.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace mart::nw::ip;
+
+// returns a connected pair of sockets
+std::pair<tcp::Socket, tcp::Socket> make_connection( tcp::endpoint ep )
+{
+	tcp::Acceptor ac( ep );
+	auto          client_future = std::async( std::launch::async, [ep] { return tcp::connect( ep ); } );
+	auto          server        = ac.accept( std::chrono::milliseconds( 1000 ) );
+	return { std::move( server ), client_future.get() };
+}
+
+std::string_view as_string( mart::ConstMemoryView frame )
+{
+	return { reinterpret_cast<const char*>( frame.data() ), frame.size() };
+}
+
+mart::ConstMemoryView as_bytes( std::string_view str )
+{
+	return { reinterpret_cast<const mart::ByteType*>( str.data() ), str.size() };
+}
+
+} // namespace
+
+TEST_CASE( "tcp_framed_stream_length_prefix", "[net]" )
+{
+	auto [server, client] = make_connection( tcp::endpoint{ "127.0.0.1:1587" } );
+	REQUIRE( server.is_valid() );
+	REQUIRE( client.is_valid() );
+	client.set_rx_timeout( std::chrono::milliseconds( 1000 ) );
+
+	tcp::FramedStreamConfig cfg;
+	cfg.length_prefix_size = 2;
+	cfg.rx_buffer_size     = 64; // has to grow for the big frame
+	cfg.tx_buffer_size     = 256;
+
+	tcp::FramedStream tx( std::move( server ), cfg );
+	tcp::FramedStream rx( std::move( client ), cfg );
+
+	// small frames are only collected
+	tx.write_frame( as_bytes( "hello" ) );
+	tx.write_frame( as_bytes( "" ) );
+	const std::array<mart::ConstMemoryView, 2> parts{ as_bytes( "split " ), as_bytes( "frame" ) };
+	tx.write_frame( parts );
+	CHECK( tx.buffered_tx_bytes() == 3 * 2 + 5 + 0 + 11 );
+
+	// too big for the send buffer -> everything is sent at once
+	const std::vector<mart::ByteType> big( 1000, 'x' );
+	tx.write_frame( big );
+	CHECK( tx.buffered_tx_bytes() == 0 );
+
+	tx.write_frame( as_bytes( "last" ) );
+	tx.flush();
+	CHECK( tx.buffered_tx_bytes() == 0 );
+
+	CHECK( as_string( rx.read_frame() ) == "hello" );
+	const auto empty = rx.read_frame();
+	CHECK( empty.isValid() );
+	CHECK( empty.size() == 0 );
+	CHECK( as_string( rx.read_frame() ) == "split frame" );
+
+	mart::ConstMemoryView big_frame;
+	while( !big_frame.isValid() ) {
+		big_frame = rx.read_frame();
+	}
+	CHECK( std::equal( big_frame.begin(), big_frame.end(), big.begin(), big.end() ) );
+
+	mart::ConstMemoryView last;
+	while( !last.isValid() ) {
+		last = rx.read_frame();
+	}
+	CHECK( as_string( last ) == "last" );
+	CHECK( rx.buffered_rx_bytes() == 0 );
+
+	// frames bigger than the prefix allows are rejected
+	CHECK( tx.try_write_frame( std::vector<mart::ByteType>( 70000 ) ).value()
+		   == mart::nw::socks::ErrorCodeValues::MessageSize );
+
+	// peer closes the connection
+	tx.socket().close();
+
+	// after a failed send, the stream can't be used for writing anymore (even if the frame could be buffered)
+	const auto send_error = tx.try_write_frame( big );
+	CHECK( !send_error );
+	CHECK( !tx.tx_error() );
+	CHECK( tx.try_write_frame( as_bytes( "small" ) ).raw_value() == send_error.raw_value() );
+	CHECK( tx.buffered_tx_bytes() == 0 );
+	CHECK( tx.try_flush().raw_value() == send_error.raw_value() );
+
+	const auto res = rx.try_read_frame();
+	CHECK( !res.frame.isValid() );
+	CHECK( res.closed );
+}
+
+TEST_CASE( "tcp_framed_stream_delimiter", "[net]" )
+{
+	auto [server, client] = make_connection( tcp::endpoint{ "127.0.0.1:1588" } );
+	REQUIRE( server.is_valid() );
+	REQUIRE( client.is_valid() );
+	client.set_rx_timeout( std::chrono::milliseconds( 1000 ) );
+
+	tcp::FramedStreamConfig cfg;
+	cfg.framing        = tcp::Framing::Delimiter;
+	cfg.max_frame_size = 16;
+
+	tcp::FramedStream tx( std::move( server ), cfg );
+	tcp::FramedStream rx( std::move( client ), cfg );
+
+	for( std::string_view line : { "first", "second", "", "third" } ) {
+		tx.write_frame( as_bytes( line ) );
+	}
+	tx.flush();
+
+	std::vector<std::string> lines;
+	while( lines.size() < 4 ) {
+		const auto frame = rx.read_frame();
+		REQUIRE( ( frame.isValid() || rx.buffered_rx_bytes() > 0 ) );
+		if( frame.isValid() ) { lines.emplace_back( as_string( frame ) ); }
+	}
+	CHECK( lines == std::vector<std::string>{ "first", "second", "", "third" } );
+	CHECK( !rx.next_buffered_frame().isValid() );
+
+	// payloads containing the delimiter can't be framed
+	CHECK( tx.try_write_frame( as_bytes( "two\nlines" ) ).value() == mart::nw::socks::ErrorCodeValues::InvalidArgument );
+	CHECK( tx.buffered_tx_bytes() == 0 );
+
+	// a line without delimiter that exceeds the maximal frame size is a protocol error
+	const auto too_long = as_bytes( "this line is way too long" );
+	const std::array<mart::ConstMemoryView, 1> raw{ too_long };
+	tx.socket().send( raw );
+	CHECK_THROWS_AS(
+		[&] {
+			while( rx.buffered_rx_bytes() < too_long.size() ) {
+				rx.read_frame();
+			}
+		}(),
+		mart::nw::socket_error );
+}
@@ -1,9 +1,19 @@
+#include <mart-netlib/network_exceptions.hpp>
 #include <mart-netlib/udp.hpp>
 
 #include <mart-common/PrintWrappers.h>
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 TEST_CASE( "udp_socket_simple_member_check1", "[net]" )
 {
 	using namespace mart::nw::ip;
@@ -99,3 +109,294 @@ TEST_CASE( "invalid_endpoint_strings_fail" )
 	CHECK_THROWS( udp::endpoint{"127.0.0.1:66999"} );
 	CHECK_THROWS( udp::endpoint{"1.333.0.1:669"} );
 }
+
+TEST_CASE( "udp_socket_batch_send_and_receive", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3447" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3448" };
+
+	udp::Socket rx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 1000ms );
+	udp::Socket tx;
+	tx.bind( tx_ep );
+
+	// more messages than are passed to the os at once
+	constexpr int                          msg_cnt = 40;
+	std::array<int, msg_cnt>               payload{};
+	std::vector<udp::Socket::SendBatchEntry> tx_msgs;
+	for( int i = 0; i < msg_cnt; ++i ) {
+		payload[i] = i;
+		tx_msgs.push_back( { mart::view_bytes( payload[i] ), rx_ep } );
+	}
+	// invalid datagram size for the last one
+	tx_msgs.back().data = mart::view_bytes( payload ).subview( 0, 2 );
+
+	const auto sent = tx.send_batch( tx_msgs );
+	REQUIRE( sent.success() );
+	CHECK( sent.value() == msg_cnt );
+
+	std::array<std::array<int, 4>, 64>       buffers{};
+	std::vector<udp::Socket::RecvBatchEntry> rx_msgs;
+	for( auto& b : buffers ) {
+		rx_msgs.push_back( { mart::view_bytes_mutable( b ), {}, {} } );
+	}
+
+	std::size_t received = 0;
+	while( received < msg_cnt ) {
+		const auto res = rx.recv_batch( mart::ArrayView<udp::Socket::RecvBatchEntry>( rx_msgs ).subview( received ) );
+		REQUIRE( res.success() );
+		REQUIRE( res.value() > 0 );
+		received += res.value();
+	}
+	CHECK( received == msg_cnt );
+
+	for( int i = 0; i < msg_cnt - 1; ++i ) {
+		CHECK( rx_msgs[i].data.size() == sizeof( int ) );
+		CHECK( buffers[i][0] == i );
+		CHECK( rx_msgs[i].remote_address == tx_ep );
+	}
+	CHECK( rx_msgs[msg_cnt - 1].data.size() == 2 );
+
+	// nothing left -> non-blocking socket returns an error instead of waiting
+	rx.set_blocking( false );
+	CHECK( !rx.recv_batch( rx_msgs ).success() );
+
+	// invalid target address
+	std::array<udp::Socket::SendBatchEntry, 1> invalid{ { { mart::view_bytes( payload[0] ), udp::endpoint{} } } };
+	CHECK( !tx.send_batch( invalid ).success() );
+}
+
+TEST_CASE( "udp_socket_pooled_recvfrom_hands_packets_to_other_threads", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3449" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3450" };
+
+	udp::Socket rx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 1000ms );
+	udp::Socket tx;
+	tx.bind( tx_ep );
+
+	mart::nw::PacketPool pool( 2, 16 );
+
+	const std::array<char, 20> payload{ "0123456789abcdefghi" };
+	tx.sendto( mart::view_bytes( payload ).subview( 0, 4 ), rx_ep );
+	tx.sendto( mart::view_bytes( payload ), rx_ep );
+	tx.sendto( mart::view_bytes( payload ).subview( 0, 1 ), rx_ep );
+
+	auto first = rx.recvfrom( pool );
+	REQUIRE( first.packet );
+	CHECK( first.packet.size() == 4 );
+	CHECK( first.remote_address == tx_ep );
+	CHECK( first.error );
+
+	// datagrams bigger than the buffers are truncated
+	auto second = rx.try_recvfrom( pool );
+	REQUIRE( second.packet );
+	CHECK( second.packet.size() == 16 );
+	CHECK( std::equal( payload.begin(), payload.begin() + 16, second.packet.data().asConstCharPtr() ) );
+	CHECK( pool.available() == 0 );
+
+	// pool exhausted
+	const auto exhausted = rx.try_recvfrom( pool );
+	CHECK( !exhausted.packet );
+	CHECK( exhausted.error.raw_value() == ENOBUFS );
+	CHECK_THROWS( rx.recvfrom( pool ) );
+
+	// the buffer returns to the pool, when the last copy is released on another thread
+	auto copy = second.packet;
+	CHECK( copy.use_count() == 2 );
+	second.packet.reset();
+	std::thread( [p = std::move( copy )]() mutable { p.reset(); } ).join();
+	CHECK( pool.available() == 1 );
+
+	auto third = rx.recvfrom( pool );
+	REQUIRE( third.packet );
+	CHECK( third.packet.size() == 1 );
+
+	// nothing left to receive
+	first.packet.reset();
+	rx.set_blocking( false );
+	CHECK( !rx.recvfrom( pool ).packet );
+	const auto nothing = rx.try_recvfrom( pool );
+	CHECK( !nothing.packet );
+	CHECK( ( nothing.error.value() == mart::nw::socks::ErrorCodeValues::WouldBlock
+			 || nothing.error.value() == mart::nw::socks::ErrorCodeValues::TryAgain ) );
+	CHECK( pool.available() == 1 );
+}
+
+TEST_CASE( "udp_socket_scatter_gather_send_and_receive", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3451" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3452" };
+
+	udp::Socket rx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 1000ms );
+	udp::Socket tx;
+	tx.bind( tx_ep );
+
+	const std::int32_t         header = 0x1234;
+	const std::array<char, 10> payload{ "abcdefghi" };
+
+	const std::array<mart::ConstMemoryView, 2> tx_bufs{ mart::view_bytes( header ), mart::view_bytes( payload ) };
+	CHECK( tx.try_sendto( tx_bufs, rx_ep ) );
+	CHECK_NOTHROW( tx.sendto( tx_bufs, rx_ep ) );
+
+	// one datagram, split into header and payload
+	std::int32_t                        rx_header{};
+	std::array<char, 10>                rx_payload{};
+	const std::array<mart::MemoryView, 2> rx_bufs{ mart::view_bytes_mutable( rx_header ),
+												   mart::view_bytes_mutable( rx_payload ) };
+
+	auto res = rx.recvfrom( rx_bufs );
+	CHECK( res.size == sizeof( header ) + payload.size() );
+	CHECK( res.remote_address == tx_ep );
+	CHECK( rx_header == header );
+	CHECK( rx_payload == payload );
+
+	rx_header  = 0;
+	rx_payload = {};
+	res        = rx.try_recvfrom( rx_bufs );
+	CHECK( res.size == sizeof( header ) + payload.size() );
+	CHECK( rx_header == header );
+	CHECK( rx_payload == payload );
+
+	// nothing left to receive
+	rx.set_blocking( false );
+	CHECK( rx.try_recvfrom( rx_bufs ).size == 0 );
+	CHECK( rx.recvfrom( rx_bufs ).size == 0 );
+
+	// too many buffers and invalid target address
+	std::array<mart::ConstMemoryView, mart::nw::socks::port_layer::max_iov_cnt + 1> too_many{};
+	CHECK( !tx.try_sendto( too_many, rx_ep ) );
+	CHECK( !tx.try_sendto( tx_bufs, udp::endpoint{} ) );
+	CHECK_THROWS( tx.sendto( tx_bufs, udp::endpoint{} ) );
+}
+
+TEST_CASE( "udp_socket_errors_are_formatted_lazily", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using mart::nw::socks::ErrorCodeValues;
+
+	const udp::endpoint ep{ "127.0.0.1:3453" };
+
+	udp::Socket s1;
+	s1.bind( ep );
+	udp::Socket s2;
+
+	const auto ec = s2.try_bind( ep );
+	CHECK( !ec );
+
+	try {
+		s2.bind( ep );
+		FAIL( "bind to an address in use should throw" );
+	} catch( const mart::nw::socket_error& e ) {
+		CHECK( e.op() == mart::nw::socket_op::bind );
+		CHECK( e.error_code().raw_value() == ec.raw_value() );
+		const std::string_view msg = e.what();
+		CHECK( msg.find( "127.0.0.1:3453" ) != std::string_view::npos );
+		// the message is only rendered once
+		CHECK( e.what() == msg.data() );
+
+		// copies keep the message
+		const mart::nw::socket_error copy = e;
+		CHECK( copy.what() == msg );
+	}
+
+	// what() can be called concurrently (e.g. through an exception_ptr that is shared between threads)
+	const auto error = std::make_exception_ptr( mart::nw::socket_error( mart::nw::socket_op::bind, ec ) );
+	std::vector<std::string> messages( 4 );
+	std::vector<std::thread> threads;
+	for( auto& m : messages ) {
+		threads.emplace_back( [&m, error] {
+			try {
+				std::rethrow_exception( error );
+			} catch( const mart::nw::socket_error& e ) {
+				m = e.what();
+			}
+		} );
+	}
+	for( auto& t : threads ) {
+		t.join();
+	}
+	CHECK( !messages[0].empty() );
+	CHECK( std::count( messages.begin(), messages.end(), messages[0] ) == 4 );
+
+	// socket_error is still a generic_nw_error
+	CHECK_THROWS_AS( s2.bind( ep ), mart::nw::generic_nw_error );
+
+	// noexcept variants report the reason for a failure
+	const bool sent = s1.try_sendto( mart::view_bytes( 5 ), udp::endpoint{} );
+	CHECK( !sent );
+	mart::nw::socks::ErrorCode send_error = mart::nw::socks::ErrorCode::Ok();
+	CHECK( !s1.try_sendto( mart::view_bytes( 5 ), udp::endpoint{}, send_error ) );
+	CHECK( send_error.value() == ErrorCodeValues::InvalidArgument );
+
+	s1.set_blocking( false );
+	std::array<char, 4> buffer{};
+	const auto          recv_res = s1.try_recvfrom( mart::view_bytes_mutable( buffer ) );
+	CHECK( !recv_res.data.isValid() );
+	CHECK( ( recv_res.error.value() == ErrorCodeValues::WouldBlock
+			 || recv_res.error.value() == ErrorCodeValues::TryAgain ) );
+}
+
+TEST_CASE( "udp_socket_performance_options_and_rx_timestamps", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+	using mart::nw::socks::ErrorCodeValues;
+
+	const udp::endpoint rx_ep{ "127.0.0.1:3454" };
+	const udp::endpoint tx_ep{ "127.0.0.1:3455" };
+
+	udp::Socket rx;
+	rx.bind( rx_ep );
+	rx.set_rx_timeout( 1000ms );
+	udp::Socket tx;
+	tx.bind( tx_ep );
+
+	CHECK_NOTHROW( rx.set_rx_buffer_size( 1 << 18 ) );
+	CHECK_NOTHROW( tx.set_tx_buffer_size( 1 << 18 ) );
+
+	// tcp options are not applicable to udp sockets
+	CHECK( !tx.try_set_tcp_nodelay( true ) );
+	CHECK_THROWS_AS( tx.set_tcp_nodelay( true ), mart::nw::socket_error );
+
+#ifdef __linux__
+	CHECK( tx.try_set_priority( 1 ) );
+	CHECK( rx.try_set_busy_poll( 0us ) );
+	rx.set_rx_timestamps( true );
+
+	const auto before = std::chrono::system_clock::now();
+	tx.sendto( mart::view_bytes( 42 ), rx_ep );
+
+	int        value = 0;
+	const auto res   = rx.recvfrom_timestamped( mart::view_bytes_mutable( value ) );
+	const auto after = std::chrono::system_clock::now();
+
+	CHECK( res.data.size() == sizeof( value ) );
+	CHECK( value == 42 );
+	CHECK( res.remote_address == tx_ep );
+	CHECK( res.rx_time >= before - 1ms );
+	CHECK( res.rx_time <= after + 1ms );
+#else
+	CHECK( rx.try_set_rx_timestamps( true ).value() == ErrorCodeValues::InvalidArgument );
+#endif
+
+	// nothing left to receive
+	rx.set_blocking( false );
+	const auto empty = rx.try_recvfrom_timestamped( mart::view_bytes_mutable( value ) );
+	CHECK( !empty.data.isValid() );
+	CHECK( !empty.error );
+}
@@ -0,0 +1,74 @@
+#include <mart-netlib/udp_sharded_server.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+
+TEST_CASE( "udp_sharded_server_receives_from_all_senders", "[net]" )
+{
+	using namespace mart::nw::ip;
+	using namespace std::chrono_literals;
+
+	constexpr int sender_cnt = 8;
+	constexpr int msg_cnt    = 20;
+
+	std::atomic_int       received{ 0 };
+	std::atomic_int       checksum{ 0 };
+	std::atomic_int       invalid{ 0 };
+	std::mutex            mx;
+	std::set<std::size_t> used_shards;
+
+	udp::ShardedServerConfig cfg;
+	cfg.local          = udp::endpoint{ "127.0.0.1:0" };
+	cfg.shard_cnt      = 2;
+	cfg.batch_size     = 8;
+	cfg.stop_latency   = 10ms;
+	cfg.rx_buffer_size = 1 << 20;
+
+	udp::ShardedServer server( cfg, [&]( std::size_t shard, udp::ShardedServer::Batch batch ) {
+		for( const auto& msg : batch ) {
+			// catch assertions are not thread safe
+			if( msg.data.size() != sizeof( int ) ) {
+				++invalid;
+				continue;
+			}
+			int value{};
+			std::memcpy( &value, msg.data.data(), sizeof( value ) );
+			checksum += value;
+		}
+		received += static_cast<int>( batch.size() );
+		std::lock_guard<std::mutex> lg( mx );
+		used_shards.insert( shard );
+	} );
+
+	REQUIRE( server.shard_count() == 2 );
+	const auto ep = server.get_local_endpoint();
+	REQUIRE( ep.port.inHostOrder() != 0 );
+
+	std::array<udp::Socket, sender_cnt> senders;
+	int                                 expected_checksum = 0;
+	for( int i = 0; i < msg_cnt; ++i ) {
+		for( auto& s : senders ) {
+			s.sendto( mart::view_bytes( i ), ep );
+			expected_checksum += i;
+		}
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + 2s;
+	while( received < sender_cnt * msg_cnt && std::chrono::steady_clock::now() < deadline ) {
+		std::this_thread::sleep_for( 1ms );
+	}
+	server.stop();
+
+	CHECK( invalid == 0 );
+	CHECK( received == sender_cnt * msg_cnt );
+	CHECK( checksum == expected_checksum );
+	// each sender is assigned to a shard by the os - nothing guarantees that all shards get used
+	CHECK( !used_shards.empty() );
+}